@@ -26,6 +26,75 @@ SB_EXTERN_C_BEGIN
 
 typedef const struct _SBAlgorithm *SBAlgorithmRef;
 
+/**
+ * Function type for a unit of work handed over to an executor.
+ *
+ * @param context
+ *      The context pointer passed to the executor along with the function.
+ * @param taskIndex
+ *      The index of the task to perform, in the range [0, taskCount).
+ */
+typedef void (*SBAlgorithmTaskFunc)(void *context, SBUInteger taskIndex);
+
+/**
+ * Function type for running a batch of independent tasks, possibly in parallel.
+ *
+ * The function MUST invoke `task` exactly once for each index in [0, taskCount), in any order and
+ * on any thread, and MUST return only after all invocations have completed.
+ *
+ * @param taskCount
+ *      The number of tasks to run.
+ * @param task
+ *      The function performing a single task.
+ * @param context
+ *      The context pointer to pass to each invocation of `task`.
+ * @param info
+ *      User-defined context pointer provided in the executor.
+ */
+typedef void (*SBAlgorithmExecuteFunc)(SBUInteger taskCount,
+    SBAlgorithmTaskFunc task, void *context, void *info);
+
+/**
+ * Describes how the classification of code units may be spread across multiple threads.
+ */
+typedef struct _SBAlgorithmExecutor {
+    SBAlgorithmExecuteFunc execute; /**< The function running the classification tasks. */
+    void *info;                     /**< User-defined context pointer passed to the function. */
+    SBUInteger chunkLength;         /**< The approximate number of code units classified by each
+                                         task, or zero to use the default. */
+} SBAlgorithmExecutor;
+
+/**
+ * Function type polled periodically while a paragraph is being resolved, for example to check a
+ * deadline or a cancellation flag.
+ *
+ * @param info
+ *      User-defined context pointer provided in the paragraph limits.
+ * @return
+ *      `SBTrue` to abandon the resolution, `SBFalse` to continue it.
+ */
+typedef SBBoolean (*SBAlgorithmCancelFunc)(void *info);
+
+/**
+ * Bounds the work spent on resolving a single paragraph.
+ *
+ * Work units roughly correspond to the code units visited by the resolution passes, so a paragraph
+ * typically needs a small multiple of its length. Input crafted with deeply nested isolates may
+ * need considerably more.
+ */
+typedef struct _SBParagraphLimits {
+    SBUInteger maxLength;               /**< The maximum number of code units of the paragraph, or
+                                             zero for no limit. */
+    SBUInteger maxWorkUnits;            /**< The maximum number of work units, or zero for no
+                                             limit. */
+    SBAlgorithmCancelFunc shouldCancel; /**< The function polled every
+                                             `SB_CONFIG_RESOLUTION_POLL_INTERVAL` work units, or
+                                             NULL. */
+    void *info;                         /**< User-defined context pointer passed to the function. */
+    SBBoolean fallback;                 /**< Whether a limit being hit produces a degraded
+                                             paragraph instead of a failure. */
+} SBParagraphLimits;
+
 /**
  * Creates an algorithm object for the specified code point sequence. The source string inside the
  * code point sequence should not be freed until the algorithm object is in use.
@@ -37,6 +106,26 @@ typedef const struct _SBAlgorithm *SBAlgorithmRef;
  */
 SB_PUBLIC SBAlgorithmRef SBAlgorithmCreate(const SBCodepointSequence *codepointSequence);
 
+/**
+ * Creates an algorithm object for the specified code point sequence, classifying its code units in
+ * parallel with the given executor.
+ *
+ * The string is split into chunks aligned at code point boundaries and each chunk is classified as
+ * a separate task. The resulting bidirectional types are identical to those of
+ * `SBAlgorithmCreate()`. Strings not longer than a single chunk are classified on the calling
+ * thread.
+ *
+ * @param codepointSequence
+ *      The code point sequence to apply bidirectional algorithm on.
+ * @param executor
+ *      The executor running the classification tasks. It can be NULL, in which case this function
+ *      behaves the same as `SBAlgorithmCreate()`.
+ * @return
+ *      A reference to an algorithm object if the call was successful, NULL otherwise.
+ */
+SB_PUBLIC SBAlgorithmRef SBAlgorithmCreateWithExecutor(
+    const SBCodepointSequence *codepointSequence, const SBAlgorithmExecutor *executor);
+
 /**
  * Returns a direct pointer to the bidirectional types of code units, stored in the algorithm
  * object.
@@ -99,6 +188,36 @@ SB_PUBLIC void SBAlgorithmGetParagraphBoundary(SBAlgorithmRef algorithm,
 SB_PUBLIC SBParagraphRef SBAlgorithmCreateParagraph(SBAlgorithmRef algorithm,
     SBUInteger paragraphOffset, SBUInteger suggestedLength, SBLevel baseLevel);
 
+/**
+ * Creates a paragraph object processed with Unicode Bidirectional Algorithm, bounding the work
+ * spent on its resolution.
+ *
+ * When a limit is hit, the paragraph is either not created, or if `fallback` is set in the limits,
+ * created in a degraded form where all code units have the paragraph level determined by Rules
+ * P2-P3. Such a paragraph forms a single run in each of its lines and can be identified with
+ * `SBParagraphIsDegraded()`.
+ *
+ * The limits are not applied to the paragraphs of text objects, which are always resolved fully.
+ *
+ * @param algorithm
+ *      The algorithm object to use for creating the desired paragraph.
+ * @param paragraphOffset
+ *      The index to the first code unit of the paragraph in source string.
+ * @param suggestedLength
+ *      The number of code units covering the suggested length of the paragraph.
+ * @param baseLevel
+ *      The desired base level of the paragraph. Rules P2-P3 would be ignored if it is neither
+ *      SBLevelDefaultLTR nor SBLevelDefaultRTL.
+ * @param limits
+ *      The limits of the resolution. It can be NULL, in which case this function behaves the same
+ *      as `SBAlgorithmCreateParagraph()`.
+ * @return
+ *      A reference to a paragraph object if the call was successful, NULL otherwise.
+ */
+SB_PUBLIC SBParagraphRef SBAlgorithmCreateParagraphWithLimits(SBAlgorithmRef algorithm,
+    SBUInteger paragraphOffset, SBUInteger suggestedLength, SBLevel baseLevel,
+    const SBParagraphLimits *limits);
+
 /**
  * Increments the reference count of an algorithm object.
  *
@@ -180,6 +180,14 @@ SB_PUBLIC SBAllocatorRef SBAllocatorRetain(SBAllocatorRef allocator);
  */
 SB_PUBLIC void SBAllocatorRelease(SBAllocatorRef allocator);
 
+/**
+ * Deallocates all object blocks retained by the calling thread's object pool. The blocks are
+ * reclaimed automatically when a thread exits on most platforms, so it is only needed to trim the
+ * pool or on platforms without thread exit notifications. It does nothing unless
+ * `SB_CONFIG_ENABLE_OBJECT_POOL` is defined.
+ */
+SB_PUBLIC void SBAllocatorDrainObjectPool(void);
+
 SB_EXTERN_C_END
 
 #endif
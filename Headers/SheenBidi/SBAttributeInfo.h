@@ -34,6 +34,21 @@ enum {
  */
 typedef SBUInteger SBAttributeID;
 
+/**
+ * Makes the ID of the attribute at a given position in a registry created with
+ * `SBAttributeRegistryCreateWithFixedIDs`.
+ *
+ * The result is a constant expression when both arguments are constant, so frequently used
+ * attributes can be referred to without looking them up by name.
+ *
+ * @param index
+ *      Position of the attribute info in the array passed to the registry.
+ * @param valueSize
+ *      The value size passed to the registry.
+ */
+#define SBAttributeIDMakeFixed(index, valueSize) \
+    ((SBAttributeID)((((SBUInt32)((index) + 1)) << 8) | ((SBUInt32)(valueSize) & 0xFF)))
+
 enum {
     SBAttributeGroupNone = 0        /**< No Special Grouping */
 };
@@ -129,6 +144,16 @@ typedef struct _SBAttributeItem {
     /* Additional value field follows immediately after attributeID in memory */
 } SBAttributeItem;
 
+/**
+ * An attribute value spanning a range of code units.
+ */
+typedef struct _SBAttributeSpan {
+    SBUInteger index;               /**< Start index of the range (in code units). */
+    SBUInteger length;              /**< Length of the range (in code units). */
+    SBAttributeID attributeID;      /**< ID of the attribute to set. */
+    const void *attributeValue;     /**< Value to associate with the range. */
+} SBAttributeSpan;
+
 SB_EXTERN_C_END
 
 #endif
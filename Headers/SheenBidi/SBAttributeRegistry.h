@@ -48,6 +48,30 @@ typedef const struct _SBAttributeRegistry *SBAttributeRegistryRef;
 SB_PUBLIC SBAttributeRegistryRef SBAttributeRegistryCreate(const SBAttributeInfo *attributeInfos,
     SBUInteger count, SBUInt8 valueSize, const SBAttributeValueCallbacks *valueCallbacks);
 
+/**
+ * Creates an attribute registry whose attribute IDs are fixed by the order of attribute infos.
+ *
+ * The attribute at position `i` of the `attributeInfos` array gets the ID
+ * `SBAttributeIDMakeFixed(i, valueSize)`, allowing hot paths to use constant IDs without any
+ * lookup by name.
+ *
+ * @param attributeInfos
+ *      Pointer to an array of `SBAttributeInfo` entries. The array content is copied internally;
+ *      the caller retains ownership.
+ * @param count
+ *      Number of entries in the `attributeInfos` array.
+ * @param valueSize
+ *      The size in bytes of the value field for each attribute.
+ * @param valueCallbacks
+ *      Optional pointer to an `SBAttributeValueCallbacks` structure defining custom value lifecycle
+ *      and comparison behavior.
+ * @return
+ *      A reference to the attribute registry instance, or `NULL` on failure.
+ */
+SB_PUBLIC SBAttributeRegistryRef SBAttributeRegistryCreateWithFixedIDs(
+    const SBAttributeInfo *attributeInfos, SBUInteger count, SBUInt8 valueSize,
+    const SBAttributeValueCallbacks *valueCallbacks);
+
 /**
  * Copies the info for a given attribute ID into the `attributeInfo` parameter.
  * 
@@ -64,7 +88,7 @@ SB_PUBLIC SBBoolean SBAttributeRegistryGetAttributeInfo(SBAttributeRegistryRef r
     SBAttributeID attributeID, SBAttributeInfo *attributeInfo);
 
 /**
- * Looks up an attribute ID by name.
+ * Looks up an attribute ID by name using a hash index built when the registry is created.
  * 
  * @param registry
  *      The attribute registry object.
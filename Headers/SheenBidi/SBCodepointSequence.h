@@ -65,6 +65,29 @@ SB_PUBLIC SBCodepoint SBCodepointSequenceGetCodepointBefore(
 SB_PUBLIC SBCodepoint SBCodepointSequenceGetCodepointAt(
     const SBCodepointSequence *codepointSequence, SBUInteger *stringIndex);
 
+/**
+ * Converts an array of string indexes from one index space to another in place.
+ *
+ * The index space of an encoding counts the code units the string would have if it was encoded in
+ * it, so `SBStringEncodingUTF32` stands for code point indexes. An index falling inside a code
+ * point is mapped to the start of that code point, and an index beyond the string is mapped to its
+ * end. The whole array is converted in a single pass when the indexes are in ascending order.
+ *
+ * @param codepointSequence
+ *      The object holding the information of the string.
+ * @param sourceEncoding
+ *      The index space of the given indexes.
+ * @param targetEncoding
+ *      The index space to convert the indexes into.
+ * @param indexes
+ *      The indexes to convert.
+ * @param count
+ *      The number of indexes.
+ */
+SB_PUBLIC void SBCodepointSequenceConvertIndexes(const SBCodepointSequence *codepointSequence,
+    SBStringEncoding sourceEncoding, SBStringEncoding targetEncoding,
+    SBUInteger *indexes, SBUInteger count);
+
 SB_EXTERN_C_END
 
 #endif
@@ -29,6 +29,30 @@
  */
 /* #define SB_CONFIG_DISABLE_SCRATCH_MEMORY */
 
+/**
+ * Compiles out the tracing hooks of the processing pipeline.
+ * When defined, `SBTraceSetHandler()` does nothing and no trace events are emitted.
+ */
+/* #define SB_CONFIG_DISABLE_TRACE */
+
+/**
+ * Enables the runtime counters reported by `SBStatisticsGetSnapshot()`, such as allocations, object
+ * lifetimes, queue growth and analysis work. Each thread updates its own counters, which are summed
+ * when a snapshot is taken. When not defined, all counters are reported as zero.
+ */
+/* #define SB_CONFIG_ENABLE_STATISTICS */
+
+/**
+ * Enables a per-thread pool of recycled object blocks. When an object such as a paragraph, line,
+ * locator or iterator is released, its block is kept on a free list of its size class and handed
+ * out again by a later creation on the same thread, bypassing the allocator.
+ *
+ * The pool is engaged only while the default allocator is in use. Blocks retained by a thread are
+ * reclaimed when it exits on platforms with POSIX threads or Windows fiber local storage; elsewhere,
+ * call `SBAllocatorDrainObjectPool()` before the thread exits.
+ */
+/* #define SB_CONFIG_ENABLE_OBJECT_POOL */
+
 /**
  * Enables the optional text editing and analysis API, including support for inserting, removing,
  * and modifying code units, applying attributes, and querying logical, script, attribute, and
@@ -54,4 +78,29 @@
 #define SB_CONFIG_SCRATCH_POOL_SIZE 3
 #endif
 
+/**
+ * Define the default number of code units classified by each task of an algorithm executor.
+ * Default is 1048576 code units if not specified.
+ */
+#ifndef SB_CONFIG_CLASSIFICATION_CHUNK_LENGTH
+#define SB_CONFIG_CLASSIFICATION_CHUNK_LENGTH 1048576
+#endif
+
+/**
+ * Define the number of work units spent between two polls of the cancellation function of
+ * paragraph limits.
+ * Default is 4096 work units if not specified.
+ */
+#ifndef SB_CONFIG_RESOLUTION_POLL_INTERVAL
+#define SB_CONFIG_RESOLUTION_POLL_INTERVAL 4096
+#endif
+
+/**
+ * Define the maximum number of blocks retained per size class by each thread's object pool.
+ * Default is 16 blocks if not specified.
+ */
+#ifndef SB_CONFIG_OBJECT_POOL_CAPACITY
+#define SB_CONFIG_OBJECT_POOL_CAPACITY 16
+#endif
+
 #endif
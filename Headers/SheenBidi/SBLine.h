@@ -24,6 +24,45 @@ SB_EXTERN_C_BEGIN
 
 typedef const struct _SBLine *SBLineRef;
 
+/**
+ * A structure describing a visually contiguous part of a logical range within a line.
+ */
+typedef struct _SBVisualSegment {
+    SBUInteger visualOffset;    /**< The visual position of the leftmost code unit of the segment,
+                                     counted from the visually leftmost code unit of the line. */
+    SBUInteger length;          /**< The number of code units in the segment. */
+    SBLevel level;              /**< The embedding level of the segment. */
+} SBVisualSegment;
+
+enum {
+    SBCaretAffinityDownstream = 0x00,   /**< The caret is attached to the code unit following it
+                                             logically. */
+    SBCaretAffinityUpstream   = 0x01    /**< The caret is attached to the code unit preceding it
+                                             logically. */
+};
+/**
+ * A type to represent the side to which a caret is attached at a logical position.
+ */
+typedef SBUInt8 SBCaretAffinity;
+
+enum {
+    SBCaretDirectionLeft  = 0x00,   /**< Towards the visually leftmost end of the line. */
+    SBCaretDirectionRight = 0x01    /**< Towards the visually rightmost end of the line. */
+};
+/**
+ * A type to represent the visual direction of caret movement.
+ */
+typedef SBUInt8 SBCaretDirection;
+
+/**
+ * A structure describing a caret position within a line.
+ */
+typedef struct _SBCaret {
+    SBUInteger index;           /**< The logical position of the caret in source string, between
+                                     two code units. */
+    SBCaretAffinity affinity;   /**< The side to which the caret is attached. */
+} SBCaret;
+
 /**
  * Returns the index to the first code unit of the line in source string.
  *
@@ -64,6 +103,178 @@ SB_PUBLIC SBUInteger SBLineGetRunCount(SBLineRef line);
  */
 SB_PUBLIC const SBRun *SBLineGetRunsPtr(SBLineRef line);
 
+/**
+ * Copies the runs of the line with their offsets and lengths expressed in the index space of the
+ * given encoding, such as UTF-16 indexes for a UTF-8 string. `SBStringEncodingUTF32` stands for
+ * code point indexes.
+ *
+ * @param line
+ *      The line whose runs are copied.
+ * @param encoding
+ *      The index space in which to express the runs.
+ * @param runs
+ *      Output array with room for `SBLineGetRunCount()` runs, receiving them in the same order as
+ *      `SBLineGetRunsPtr()`.
+ * @return
+ *      `SBTrue` if the runs were copied, `SBFalse` if the encoding is invalid or the memory for
+ *      ordering the runs could not be allocated.
+ */
+SB_PUBLIC SBBoolean SBLineGetRunsInEncoding(SBLineRef line, SBStringEncoding encoding,
+    SBRun *runs);
+
+/**
+ * Returns a direct pointer to the logical to visual map of the line.
+ *
+ * The map contains one element for each code unit of the line. The element at index `i` holds the
+ * visual position of the code unit at `offset + i` in source string, where the visual position is
+ * counted from the visually leftmost code unit of the line. The map is built on first request and
+ * cached in the line.
+ *
+ * @param line
+ *      The line from which to access the map.
+ * @return
+ *      A pointer to an array of `length` indexes, or NULL if the memory could not be allocated.
+ */
+SB_PUBLIC const SBUInteger *SBLineGetLogicalToVisualMapPtr(SBLineRef line);
+
+/**
+ * Returns a direct pointer to the visual to logical map of the line.
+ *
+ * The map contains one element for each code unit of the line. The element at index `i` holds the
+ * position, relative to the offset of the line, of the code unit displayed at visual position `i`.
+ * The map is built on first request and cached in the line.
+ *
+ * @param line
+ *      The line from which to access the map.
+ * @return
+ *      A pointer to an array of `length` indexes, or NULL if the memory could not be allocated.
+ */
+SB_PUBLIC const SBUInteger *SBLineGetVisualToLogicalMapPtr(SBLineRef line);
+
+/**
+ * Finds the run holding the code unit at the specified index with a binary search over the runs of
+ * the line.
+ *
+ * @param line
+ *      The line in which to find the run.
+ * @param stringIndex
+ *      The index of a code unit in source string.
+ * @param runIndex
+ *      On output, the index of the run in the array returned by `SBLineGetRunsPtr()`. This
+ *      parameter can be set to NULL if not needed.
+ * @param visualIndex
+ *      On output, the visual position of the code unit within the line. This parameter can be set
+ *      to NULL if not needed.
+ * @return
+ *      `SBTrue` if the run was found, `SBFalse` if the code unit does not belong to the line or the
+ *      lookup tables could not be allocated.
+ */
+SB_PUBLIC SBBoolean SBLineFindRun(SBLineRef line, SBUInteger stringIndex,
+    SBUInteger *runIndex, SBUInteger *visualIndex);
+
+/**
+ * Computes the visual segments covered by a logical range of the line, such as a text selection.
+ *
+ * The segments are ordered from left to right and visually adjacent segments of the same level are
+ * merged, so the result is the minimal set of segments to draw.
+ *
+ * @param line
+ *      The line in which to find the segments.
+ * @param rangeOffset
+ *      The index to the first code unit of the range in source string.
+ * @param rangeLength
+ *      The number of code units in the range. The part of the range outside the line is ignored.
+ * @param segments
+ *      An array receiving the segments.
+ * @param maxCount
+ *      The maximum number of segments that the array can hold. It is always sufficient for it to be
+ *      equal to the run count of the line.
+ * @return
+ *      The number of segments written into the array. If the array might be too small, nothing is
+ *      written and the returned value is the number of elements needed instead, which is greater
+ *      than `maxCount`. Zero is returned if the range does not intersect the line or the lookup
+ *      tables could not be allocated.
+ */
+SB_PUBLIC SBUInteger SBLineGetVisualSegments(SBLineRef line,
+    SBUInteger rangeOffset, SBUInteger rangeLength,
+    SBVisualSegment *segments, SBUInteger maxCount);
+
+/**
+ * Moves a caret by one code point in visual direction within the line.
+ *
+ * A caret between two visually adjacent code points of different directions may correspond to two
+ * logical positions; the affinity tells which one of them it is attached to. The resulting caret is
+ * attached to the code point that has just been crossed. The lookup tables of the line are built on
+ * first use and reused by subsequent moves.
+ *
+ * @param line
+ *      The line in which to move the caret.
+ * @param caret
+ *      The current caret, whose index must be within the range of the line, including its end.
+ * @param direction
+ *      The visual direction of the movement.
+ * @param result
+ *      On output, the moved caret.
+ * @return
+ *      `SBTrue` if the caret was moved, `SBFalse` if it was already at the visual end of the line in
+ *      the given direction, the caret was invalid, or the lookup tables could not be allocated.
+ */
+SB_PUBLIC SBBoolean SBLineMoveCaret(SBLineRef line, const SBCaret *caret,
+    SBCaretDirection direction, SBCaret *result);
+
+/**
+ * Copies the code units of the line into a caller-provided buffer in visual order, applying rule
+ * L4 of Unicode Bidirectional Algorithm.
+ *
+ * The code points of right-to-left runs are reversed and replaced with their mirrors where
+ * available, while the code units of each code point, as well as a CR followed by LF, are kept in
+ * their logical order. A mirror is applied only if it needs the same number of code units as the
+ * original code point. A sequence cut by the end of a run is copied as it is.
+ *
+ * @param line
+ *      The line whose code units are copied.
+ * @param buffer
+ *      Output buffer receiving the code units in the encoding format of the line (can be `NULL`).
+ * @param capacity
+ *      The number of code units the buffer can hold.
+ * @return
+ *      The number of code units of the line. They are written only if they fit in the buffer.
+ */
+SB_PUBLIC SBUInteger SBLineGetVisualCodeUnits(SBLineRef line, void *buffer, SBUInteger capacity);
+
+/**
+ * Copies the elements of a caller array into another one, rearranging them from logical order
+ * into the visual order of the line.
+ *
+ * Without a cluster map, the arrays must hold one element for each code unit of the line, such as
+ * the advances of code units. With a cluster map, the arrays may hold any number of elements, such
+ * as shaped glyphs, in which case the elements belonging to right-to-left runs are reversed as a
+ * whole.
+ *
+ * @param line
+ *      The line whose visual order is applied.
+ * @param source
+ *      The array of elements in logical order.
+ * @param destination
+ *      The array receiving the elements in visual order. It must not overlap the source array.
+ * @param elementCount
+ *      The number of elements in the arrays.
+ * @param elementSize
+ *      The size of each element in bytes.
+ * @param stride
+ *      The distance in bytes between consecutive elements of both arrays. It must be at least
+ *      `elementSize`.
+ * @param clusterMap
+ *      An optional array of `elementCount` non-decreasing indexes, mapping each element to the
+ *      code unit it belongs to, relative to the offset of the line. It can be NULL, in which case
+ *      `elementCount` must be equal to the length of the line.
+ * @return
+ *      `SBTrue` if the elements were reordered, `SBFalse` if the arguments were invalid.
+ */
+SB_PUBLIC SBBoolean SBLineReorderElements(SBLineRef line, const void *source, void *destination,
+    SBUInteger elementCount, SBUInteger elementSize, SBUInteger stride,
+    const SBUInteger *clusterMap);
+
 /**
  * Increments the reference count of a line object.
  *
@@ -75,6 +75,26 @@ SB_PUBLIC const SBMirrorAgent *SBMirrorLocatorGetAgent(SBMirrorLocatorRef locato
  */
 SB_PUBLIC SBBoolean SBMirrorLocatorMoveNext(SBMirrorLocatorRef locator);
 
+/**
+ * Locates multiple mirrors of the loaded line in a single call, continuing from the current
+ * position of the locator.
+ *
+ * @param locator
+ *      The locator whom you want to instruct.
+ * @param agents
+ *      An array receiving the information of located mirrors in logical order.
+ * @param maxCount
+ *      The maximum number of agents that the array can hold.
+ * @return
+ *      The number of mirrors written into the array. A value less than `maxCount` indicates that
+ *      all mirrors of the line have been located.
+ * @note
+ *      The locator will be reset after locating last mirror. The agent of the locator is left
+ *      untouched by this function.
+ */
+SB_PUBLIC SBUInteger SBMirrorLocatorGetMirrors(SBMirrorLocatorRef locator,
+    SBMirrorAgent *agents, SBUInteger maxCount);
+
 /**
  * Instructs the locator to reset itself so that mirrors of the loaded line can be obatained from
  * the beginning.
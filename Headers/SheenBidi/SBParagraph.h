@@ -54,6 +54,17 @@ SB_PUBLIC SBUInteger SBParagraphGetLength(SBParagraphRef paragraph);
  */
 SB_PUBLIC SBLevel SBParagraphGetBaseLevel(SBParagraphRef paragraph);
 
+/**
+ * Returns whether the paragraph was created in a degraded form because a resolution limit was hit.
+ *
+ * @param paragraph
+ *      The paragraph to check.
+ * @return
+ *      `SBTrue` if all code units of the paragraph have its base level without being resolved,
+ *      `SBFalse` otherwise.
+ */
+SB_PUBLIC SBBoolean SBParagraphIsDegraded(SBParagraphRef paragraph);
+
 /**
  * Returns a direct pointer to the embedding levels, stored in the paragraph.
  *
@@ -81,6 +92,32 @@ SB_PUBLIC const SBLevel *SBParagraphGetLevelsPtr(SBParagraphRef paragraph);
 SB_PUBLIC SBLineRef SBParagraphCreateLine(SBParagraphRef paragraph, SBUInteger lineOffset,
     SBUInteger lineLength);
 
+/**
+ * Creates multiple consecutive line objects by applying rules L1-L2 of Unicode Bidirectional
+ * Algorithm in a single pass over their combined range.
+ *
+ * The result is the same as calling `SBParagraphCreateLine()` for each line, but the levels of the
+ * paragraph are copied only once for all of them and the lines share a single allocation, which is
+ * freed when the last of them is released.
+ *
+ * @param paragraph
+ *      The paragraph that creates the lines.
+ * @param lineBoundaries
+ *      An array of `lineCount + 1` strictly increasing indexes into the source string, where line
+ *      `i` covers the code units from `lineBoundaries[i]` up to `lineBoundaries[i + 1]`. All
+ *      indexes should occur within the range of paragraph, the last one being allowed to be at its
+ *      end.
+ * @param lineCount
+ *      The number of lines to create.
+ * @param lines
+ *      An array of `lineCount` elements receiving the references to the created line objects. Each
+ *      of them must be released with `SBLineRelease()`.
+ * @return
+ *      `SBTrue` if all lines were created, `SBFalse` otherwise, in which case no line is returned.
+ */
+SB_PUBLIC SBBoolean SBParagraphCreateLines(SBParagraphRef paragraph,
+    const SBUInteger *lineBoundaries, SBUInteger lineCount, SBLineRef *lines);
+
 /**
  * Increments the reference count of a paragraph object.
  *
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _SB_PUBLIC_STATISTICS_H
+#define _SB_PUBLIC_STATISTICS_H
+
+#include <SheenBidi/SBBase.h>
+
+SB_EXTERN_C_BEGIN
+
+/**
+ * A structure containing the library-wide runtime counters, accumulated across all threads since
+ * the start of the process.
+ */
+typedef struct _SBStatistics {
+    SBUInteger blockAllocations;     /**< Number of blocks requested from the allocator. */
+    SBUInteger blockDeallocations;   /**< Number of blocks returned to the allocator. */
+    SBUInteger scratchHits;          /**< Number of requests served by scratch memory. */
+    SBUInteger scratchMisses;        /**< Number of scratch requests that fell back to the heap. */
+    SBUInteger objectsCreated;       /**< Number of objects created. */
+    SBUInteger objectsAlive;         /**< Number of objects not yet destroyed. */
+    SBUInteger objectPoolHits;       /**< Number of objects created from a recycled block. */
+    SBUInteger objectPoolMisses;     /**< Number of pooled objects created from a new block. */
+    SBUInteger runQueueChunks;       /**< Number of level run queue chunks allocated. */
+    SBUInteger bracketQueueChunks;   /**< Number of bracket queue chunks allocated. */
+    SBUInteger bracketLimitHits;     /**< Number of times bracket pairing stopped at its limit. */
+    SBUInteger levelLimitHits;       /**< Number of embeddings and isolates exceeding the maximum
+                                          depth of the directional status stack. */
+    SBUInteger paragraphsResolved;   /**< Number of bidi paragraphs resolved. */
+    SBUInteger resolutionLimitHits;  /**< Number of paragraphs whose resolution hit a limit. */
+    SBUInteger paragraphsReanalyzed; /**< Number of text paragraphs reanalyzed after edits. */
+    SBUInteger codeUnitsClassified;  /**< Number of code units classified into bidi types. */
+    SBUInteger codeUnitsScripted;    /**< Number of text code units whose scripts were resolved. */
+    SBUInteger runReorderSteps;      /**< Number of runs and level sequences visited while
+                                          reordering the runs of lines. */
+} SBStatistics;
+
+/**
+ * Takes a snapshot of the library-wide runtime counters.
+ *
+ * @param statistics
+ *      The structure to receive the counters. All counters are zero if the library is built
+ *      without `SB_CONFIG_ENABLE_STATISTICS`.
+ * @note
+ *      Counters of other threads are read with relaxed atomic loads, so a snapshot taken while
+ *      processing is in progress may be slightly behind.
+ */
+SB_PUBLIC void SBStatisticsGetSnapshot(SBStatistics *statistics);
+
+SB_EXTERN_C_END
+
+#endif
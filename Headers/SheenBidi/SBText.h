@@ -28,6 +28,18 @@
 
 SB_EXTERN_C_BEGIN
 
+/**
+ * Function type for releasing the code units referenced by a text object.
+ *
+ * @param buffer
+ *      The buffer of code units passed when creating the text object.
+ * @param length
+ *      Number of code units in the buffer.
+ * @param info
+ *      User-defined context pointer passed when creating the text object.
+ */
+typedef void (*SBTextBufferReleaseFunc)(const void *buffer, SBUInteger length, void *info);
+
 /**
  * Creates an immutable text object from raw code units and configuration.
  *
@@ -48,6 +60,106 @@ SB_EXTERN_C_BEGIN
 SB_PUBLIC SBTextRef SBTextCreate(const void *string, SBUInteger length, SBStringEncoding encoding,
     SBTextConfigRef config);
 
+/**
+ * Creates an immutable text object that references the code units of a buffer instead of copying
+ * them.
+ *
+ * Only the bidirectional types, the resolved levels and the scripts are allocated by the text
+ * object. The buffer must remain valid and unchanged until it is released.
+ *
+ * @param buffer
+ *      Pointer to code units in the specified encoding.
+ * @param length
+ *      Number of code units in the buffer.
+ * @param encoding
+ *      String encoding (UTF-8, UTF-16, or UTF-32).
+ * @param config
+ *      Non-NULL configuration that supplies the attribute registry and defaults.
+ * @param release
+ *      The function invoked when the text object no longer needs the buffer (can be `NULL`).
+ * @param info
+ *      User-defined context pointer passed to the release function.
+ * @return
+ *      A reference to a text object if the call was successful, `NULL` otherwise. In case of
+ *      failure, the buffer is released before returning.
+ */
+SB_PUBLIC SBTextRef SBTextCreateWithBuffer(const void *buffer, SBUInteger length,
+    SBStringEncoding encoding, SBTextConfigRef config, SBTextBufferReleaseFunc release, void *info);
+
+/**
+ * Creates an immutable text object that analyzes the code units of a file in place by mapping it
+ * into memory.
+ *
+ * The code units are expected in the native byte order of the platform. The file is unmapped when
+ * the text object is destroyed and must not be modified in the meantime.
+ *
+ * @param path
+ *      The path of the file containing the code units.
+ * @param encoding
+ *      String encoding (UTF-8, UTF-16, or UTF-32).
+ * @param config
+ *      Non-NULL configuration that supplies the attribute registry and defaults.
+ * @return
+ *      A reference to a text object if the call was successful, `NULL` if the file could not be
+ *      mapped, its size is not a multiple of the code unit size, or memory mapping is not
+ *      supported on the platform.
+ */
+SB_PUBLIC SBTextRef SBTextCreateWithMappedFile(const char *path, SBStringEncoding encoding,
+    SBTextConfigRef config);
+
+/**
+ * Creates an immutable text object from raw code units and a snapshot of their analysis written by
+ * `SBTextWriteSnapshot`, without running the algorithm again.
+ *
+ * The snapshot is validated against the version of the library's Unicode data, the encoding, the
+ * base level of the configuration and a hash of the code units, and its contents are verified with
+ * a checksum so that a damaged snapshot is rejected. Attributes are not part of the snapshot and
+ * need to be applied again.
+ *
+ * @param string
+ *      Pointer to code units in the specified encoding.
+ * @param length
+ *      Number of code units in string.
+ * @param encoding
+ *      String encoding (UTF-8, UTF-16, or UTF-32).
+ * @param config
+ *      Non-NULL configuration that supplies the attribute registry and defaults.
+ * @param snapshot
+ *      Pointer to the snapshot.
+ * @param snapshotSize
+ *      Size of the snapshot in bytes.
+ * @return
+ *      A reference to a text object if the call was successful, `NULL` if the snapshot does not
+ *      match the code units or the creation failed. The text can be created with `SBTextCreate` in
+ *      the latter case.
+ */
+SB_PUBLIC SBTextRef SBTextCreateWithSnapshot(const void *string, SBUInteger length,
+    SBStringEncoding encoding, SBTextConfigRef config,
+    const void *snapshot, SBUInteger snapshotSize);
+
+/**
+ * Creates an immutable text object from raw code units and a snapshot file, which is mapped into
+ * memory while the text is being created.
+ *
+ * @param string
+ *      Pointer to code units in the specified encoding.
+ * @param length
+ *      Number of code units in string.
+ * @param encoding
+ *      String encoding (UTF-8, UTF-16, or UTF-32).
+ * @param config
+ *      Non-NULL configuration that supplies the attribute registry and defaults.
+ * @param snapshotPath
+ *      The path of the file containing the snapshot.
+ * @return
+ *      A reference to a text object if the call was successful, `NULL` if the snapshot could not be
+ *      mapped, it does not match the code units or the creation failed.
+ *
+ * @see SBTextCreateWithSnapshot
+ */
+SB_PUBLIC SBTextRef SBTextCreateWithSnapshotFile(const void *string, SBUInteger length,
+    SBStringEncoding encoding, SBTextConfigRef config, const char *snapshotPath);
+
 /**
  * Creates a new immutable text object that is an exact copy of the source text.
  *
@@ -185,6 +297,81 @@ SB_PUBLIC void SBTextGetScripts(SBTextRef text, SBUInteger index, SBUInteger len
 SB_PUBLIC void SBTextGetResolvedLevels(SBTextRef text, SBUInteger index, SBUInteger length,
     SBLevel *buffer);
 
+/**
+ * Returns a read-only view of the bidirectional types for a code-unit range without copying them.
+ *
+ * The bidi types of the whole text are stored contiguously, so the view always covers the complete
+ * range.
+ *
+ * @param text
+ *      Text object.
+ * @param index
+ *      Start index (in code units).
+ * @param length
+ *      Number of code units in the range; must be greater than zero.
+ * @param spanLength
+ *      On output, the number of entries in the view.
+ * @return
+ *      Pointer to the bidi type of the code unit at `index`. It remains valid until the text is
+ *      edited or released.
+ *
+ * @warning
+ *      Behavior is undefined if range is invalid or text is currently being edited.
+ */
+SB_PUBLIC const SBBidiType *SBTextGetBidiTypesSpan(SBTextRef text, SBUInteger index,
+    SBUInteger length, SBUInteger *spanLength);
+
+/**
+ * Returns a read-only view of the scripts for a code-unit range without copying them.
+ *
+ * The scripts are stored per paragraph, so the view ends at the end of the paragraph containing
+ * `index` if the range extends beyond it. The rest of the range can be viewed by calling the
+ * function again from the end of the view.
+ *
+ * @param text
+ *      Text object.
+ * @param index
+ *      Start index (in code units).
+ * @param length
+ *      Number of code units in the range; must be greater than zero.
+ * @param spanLength
+ *      On output, the number of entries in the view.
+ * @return
+ *      Pointer to the script of the code unit at `index`. It remains valid until the text is
+ *      edited or released.
+ *
+ * @warning
+ *      Behavior is undefined if range is invalid or text is currently being edited.
+ */
+SB_PUBLIC const SBScript *SBTextGetScriptsSpan(SBTextRef text, SBUInteger index,
+    SBUInteger length, SBUInteger *spanLength);
+
+/**
+ * Returns a read-only view of the resolved bidirectional levels for a code-unit range without
+ * copying them.
+ *
+ * The levels are stored per paragraph, so the view ends at the end of the paragraph containing
+ * `index` if the range extends beyond it. The rest of the range can be viewed by calling the
+ * function again from the end of the view.
+ *
+ * @param text
+ *      Text object.
+ * @param index
+ *      Start index (in code units).
+ * @param length
+ *      Number of code units in the range; must be greater than zero.
+ * @param spanLength
+ *      On output, the number of entries in the view.
+ * @return
+ *      Pointer to the resolved level of the code unit at `index`. It remains valid until the text
+ *      is edited or released.
+ *
+ * @warning
+ *      Behavior is undefined if range is invalid or text is currently being edited.
+ */
+SB_PUBLIC const SBLevel *SBTextGetResolvedLevelsSpan(SBTextRef text, SBUInteger index,
+    SBUInteger length, SBUInteger *spanLength);
+
 /**
  * Retrieves information for the paragraph containing a specific code unit.
  * 
@@ -201,6 +388,29 @@ SB_PUBLIC void SBTextGetResolvedLevels(SBTextRef text, SBUInteger index, SBUInte
 SB_PUBLIC void SBTextGetCodeUnitParagraphInfo(SBTextRef text, SBUInteger index,
     SBParagraphInfo *paragraphInfo);
 
+/**
+ * Writes a snapshot of the analysis of the text, from which the text can be recreated later with
+ * `SBTextCreateWithSnapshot`.
+ *
+ * The snapshot contains the bidirectional types, the paragraph boundaries with their base levels,
+ * the resolved levels and the script runs, tagged with the version of the library's Unicode data,
+ * a hash of the code units and a checksum of its contents. It is written in the native byte order
+ * of the platform.
+ *
+ * @param text
+ *      Text object.
+ * @param buffer
+ *      Buffer to receive the snapshot (can be `NULL`).
+ * @param capacity
+ *      Size of the buffer in bytes.
+ * @return
+ *      Size of the snapshot in bytes. The snapshot is written only if it fits in the buffer.
+ *
+ * @warning
+ *      Text must not be undergoing editing.
+ */
+SB_PUBLIC SBUInteger SBTextWriteSnapshot(SBTextRef text, void *buffer, SBUInteger capacity);
+
 /**
  * Creates a new paragraph iterator that can traverse all paragraphs in the text object.
  *
@@ -310,6 +520,12 @@ SB_PUBLIC SBMutableTextRef SBTextCreateMutable(SBStringEncoding encoding, SBText
  * Signals the start of a batch of editing operations. While in editing mode, text analysis
  * (bidirectional processing, script identification) is deferred until SBTextEndEditing() is called.
  * This improves performance when making multiple sequential modifications.
+ *
+ * Code unit modifications made in editing mode are recorded in an edit log instead of being applied
+ * one by one, and are applied together in a single pass over the text, so a batch of many small
+ * edits costs about as much as a single edit spanning all of them. Indices of each modification are
+ * still relative to the text produced by the preceding ones. Reading the contents of the text or
+ * modifying its attributes applies the pending modifications beforehand.
  * 
  * @param text
  *      Mutable text object.
@@ -444,6 +660,31 @@ SB_PUBLIC void SBTextReplaceCodeUnits(SBMutableTextRef text, SBUInteger index, S
 SB_PUBLIC void SBTextSetAttribute(SBMutableTextRef text, SBUInteger index, SBUInteger length,
     SBAttributeID attributeID, const void *attributeValue);
 
+/**
+ * Sets the attributes of multiple spans of code units at once, producing the same result as
+ * calling `SBTextSetAttribute` for each span in order.
+ *
+ * The spans are merged into the existing attributes in a single pass, so that applying the spans
+ * of a styled document costs time proportional to the number of spans and existing attribute runs
+ * rather than their product.
+ *
+ * @param text
+ *      Mutable text object.
+ * @param spans
+ *      Array of spans sorted by their start index. Spans may overlap; where spans with the same
+ *      attribute ID overlap, the later one takes precedence.
+ * @param count
+ *      Number of spans in the array.
+ *
+ * @warning
+ *      The range of each span must be within the current text bounds.
+ *      The attribute IDs must be registered in the text's attribute registry.
+ *      The attribute values must be compatible with the attributes' value types as defined in the
+ *      registry.
+ */
+SB_PUBLIC void SBTextApplyAttributeSpans(SBMutableTextRef text,
+    const SBAttributeSpan *spans, SBUInteger count);
+
 /**
  * Removes the specified attribute from the given range of code units. If the attribute is not
  * present in the range, this operation has no effect.
@@ -19,6 +19,7 @@
 
 #include <SheenBidi/SBAttributeList.h>
 #include <SheenBidi/SBBase.h>
+#include <SheenBidi/SBCodepointSequence.h>
 #include <SheenBidi/SBTextType.h>
 
 #if SB_TEXT_API_SUPPORTED
@@ -152,8 +153,8 @@ typedef struct _SBLogicalRunIterator *SBLogicalRunIteratorRef;
  * A run of uniform resolved bidi level in logical order.
  */
 typedef struct _SBLogicalRun {
-    SBUInteger index;  /**< Start index of the run in code units. */
-    SBUInteger length; /**< Length of the run in code units. */
+    SBUInteger index;  /**< Start index of the run in the index encoding of the iterator. */
+    SBUInteger length; /**< Length of the run in the index encoding of the iterator. */
     SBLevel level;     /**< Resolved bidi level of the run. */
 } SBLogicalRun;
 
@@ -183,6 +184,23 @@ SB_PUBLIC SBTextRef SBLogicalRunIteratorGetText(SBLogicalRunIteratorRef iterator
 SB_PUBLIC void SBLogicalRunIteratorReset(SBLogicalRunIteratorRef iterator, SBUInteger index,
     SBUInteger length);
 
+/**
+ * Sets the index encoding in which the logical runs are reported, and restarts the iteration of the
+ * current window.
+ *
+ * By default, runs are reported in code units of the text. Reporting them in another encoding saves
+ * clients, such as bindings whose strings are indexed in UTF-16 or code points, from translating
+ * each run themselves. The window passed to Reset is still specified in code units of the text and
+ * should start and end at code point boundaries.
+ *
+ * @param iterator
+ *      Logical run iterator.
+ * @param encoding
+ *      Encoding of the reported indexes; `SBStringEncodingUTF32` reports code point indexes.
+ */
+SB_PUBLIC void SBLogicalRunIteratorSetupIndexEncoding(SBLogicalRunIteratorRef iterator,
+    SBStringEncoding encoding);
+
 /**
  * Returns a pointer to the current logical run information owned by the iterator.
  * 
@@ -259,8 +277,8 @@ typedef struct _SBScriptRunIterator *SBScriptRunIteratorRef;
  * A run of uniform Unicode script property.
  */
 typedef struct _SBScriptRun {
-    SBUInteger index;  /**< Start index of the run in code units. */
-    SBUInteger length; /**< Length of the run in code units. */
+    SBUInteger index;  /**< Start index of the run in the index encoding of the iterator. */
+    SBUInteger length; /**< Length of the run in the index encoding of the iterator. */
     SBScript script;   /**< Script property value for the run. */
 } SBScriptRun;
 
@@ -290,6 +308,23 @@ SB_PUBLIC SBTextRef SBScriptRunIteratorGetText(SBScriptRunIteratorRef iterator);
 SB_PUBLIC void SBScriptRunIteratorReset(SBScriptRunIteratorRef iterator, SBUInteger index,
     SBUInteger length);
 
+/**
+ * Sets the index encoding in which the script runs are reported, and restarts the iteration of the
+ * current window.
+ *
+ * By default, runs are reported in code units of the text. Reporting them in another encoding saves
+ * clients, such as bindings whose strings are indexed in UTF-16 or code points, from translating
+ * each run themselves. The window passed to Reset is still specified in code units of the text and
+ * should start and end at code point boundaries.
+ *
+ * @param iterator
+ *      Script run iterator.
+ * @param encoding
+ *      Encoding of the reported indexes; `SBStringEncodingUTF32` reports code point indexes.
+ */
+SB_PUBLIC void SBScriptRunIteratorSetupIndexEncoding(SBScriptRunIteratorRef iterator,
+    SBStringEncoding encoding);
+
 /**
  * Returns a pointer to the current script run information owned by the iterator. The pointer
  * remains valid until the next call to MoveNext or Reset.
@@ -411,6 +446,26 @@ SB_PUBLIC void SBAttributeRunIteratorSetupAttributeID(SBAttributeRunIteratorRef
 SB_PUBLIC void SBAttributeRunIteratorSetupAttributeCollection(SBAttributeRunIteratorRef iterator,
     SBAttributeGroup attributeGroup, SBAttributeScope attributeScope);
 
+/**
+ * Configures the iterator to return runs over which none of the specified attributes changes.
+ * Each run carries the values of the specified attributes present in it, and a new run starts as
+ * soon as any of them appears, disappears or takes a different value. Runs containing none of the
+ * specified attributes are automatically skipped during iteration.
+ *
+ * This is more efficient than iterating each attribute separately and intersecting the resulting
+ * runs, as the text is traversed only once.
+ *
+ * @param iterator
+ *      Attribute run iterator.
+ * @param attributeIDs
+ *      An array of attribute IDs by which to filter the runs. IDs not belonging to the registry of
+ *      the text are ignored.
+ * @param count
+ *      The number of attribute IDs in the array.
+ */
+SB_PUBLIC void SBAttributeRunIteratorSetupAttributeIDs(SBAttributeRunIteratorRef iterator,
+    const SBAttributeID *attributeIDs, SBUInteger count);
+
 /**
  * Resets iteration to the specified code-unit range.
  *
@@ -506,8 +561,8 @@ typedef struct _SBVisualRunIterator *SBVisualRunIteratorRef;
  * A run of uniform resolved bidi level in visual order.
  */
 typedef struct _SBVisualRun {
-    SBUInteger index;  /**< Start index of the run in code units. */
-    SBUInteger length; /**< Length of the run in code units. */
+    SBUInteger index;  /**< Start index of the run in the index encoding of the iterator. */
+    SBUInteger length; /**< Length of the run in the index encoding of the iterator. */
     SBLevel level;     /**< Resolved bidi level of the run. */
 } SBVisualRun;
 
@@ -537,6 +592,23 @@ SB_PUBLIC SBTextRef SBVisualRunIteratorGetText(SBVisualRunIteratorRef iterator);
 SB_PUBLIC void SBVisualRunIteratorReset(SBVisualRunIteratorRef iterator, SBUInteger index,
     SBUInteger length);
 
+/**
+ * Sets the index encoding in which the visual runs are reported, and restarts the iteration of the
+ * current window.
+ *
+ * By default, runs are reported in code units of the text. Reporting them in another encoding saves
+ * clients, such as bindings whose strings are indexed in UTF-16 or code points, from translating
+ * each run themselves. The window passed to Reset is still specified in code units of the text and
+ * should start and end at code point boundaries.
+ *
+ * @param iterator
+ *      Visual run iterator.
+ * @param encoding
+ *      Encoding of the reported indexes; `SBStringEncodingUTF32` reports code point indexes.
+ */
+SB_PUBLIC void SBVisualRunIteratorSetupIndexEncoding(SBVisualRunIteratorRef iterator,
+    SBStringEncoding encoding);
+
 /**
  * Returns a pointer to the current visual run information owned by the iterator. The pointer
  * remains valid until the next call to MoveNext or Reset.
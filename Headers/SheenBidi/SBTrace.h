@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _SB_PUBLIC_TRACE_H
+#define _SB_PUBLIC_TRACE_H
+
+#include <SheenBidi/SBBase.h>
+
+SB_EXTERN_C_BEGIN
+
+enum {
+    SBTraceStageClassification  = 0x01, /**< Bidi type classification of code points. */
+    SBTraceStageBoundary        = 0x02, /**< Paragraph boundary detection. */
+    SBTraceStageExplicitLevels  = 0x03, /**< Explicit levels and directions (rules X1-X8). */
+    SBTraceStageIsolatingRun    = 0x04, /**< Weak, neutral and implicit resolution of an isolating
+                                             run (rules W1-W7, N0-N2, I1-I2). */
+    SBTraceStageLevelReset      = 0x05, /**< Resetting of whitespace levels in a line (rule L1). */
+    SBTraceStageReordering      = 0x06, /**< Reordering of runs in a line (rule L2). */
+    SBTraceStageScriptLocation  = 0x07, /**< Script resolution of a text paragraph. */
+    SBTraceStageTextAnalysis    = 0x08  /**< Reanalysis of an edited text paragraph. */
+};
+/**
+ * A type to represent a stage of the processing pipeline.
+ */
+typedef SBUInt8 SBTraceStage;
+
+/**
+ * A structure describing the beginning or the end of a pipeline stage.
+ *
+ * The callbacks are invoked synchronously on the processing thread, so a handler can take its own
+ * timestamps when receiving the events.
+ */
+typedef struct _SBTraceEvent {
+    SBUInteger codeUnitCount;   /**< The number of code units processed by the stage. */
+    SBTraceStage stage;         /**< The stage being traced. */
+} SBTraceEvent;
+
+/**
+ * Function type for receiving a trace event.
+ *
+ * @param event
+ *      The event describing the stage. It is valid only for the duration of the call.
+ * @param info
+ *      User-defined context pointer provided in the handler.
+ */
+typedef void (*SBTraceEventFunc)(const SBTraceEvent *event, void *info);
+
+/**
+ * Set of callbacks receiving the events of the processing pipeline.
+ *
+ * All functions are optional. The callbacks may be invoked concurrently from any thread performing
+ * bidirectional processing, so they must be thread safe.
+ */
+typedef struct _SBTraceHandler {
+    /**
+     * Invoked when a stage begins.
+     */
+    SBTraceEventFunc begin;
+    /**
+     * Invoked when a stage ends.
+     */
+    SBTraceEventFunc end;
+    /**
+     * User-defined context pointer passed to each callback.
+     */
+    void *info;
+} SBTraceHandler;
+
+/**
+ * Returns the global trace handler, or `NULL` if tracing is inactive.
+ */
+SB_PUBLIC const SBTraceHandler *SBTraceGetHandler(void);
+
+/**
+ * Sets the global trace handler.
+ *
+ * @param handler
+ *      The handler to receive the events of all subsequent processing. It is not copied, so it
+ *      must remain valid until replaced. If `NULL`, tracing becomes inactive.
+ * @note
+ *      Does nothing if the library is built with `SB_CONFIG_DISABLE_TRACE`.
+ */
+SB_PUBLIC void SBTraceSetHandler(const SBTraceHandler *handler);
+
+SB_EXTERN_C_END
+
+#endif
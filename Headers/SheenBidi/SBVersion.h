@@ -26,6 +26,12 @@ SB_EXTERN_C_BEGIN
 #define SHEENBIDI_VERSION_PATCH     0
 #define SHEENBIDI_VERSION_STRING    "3.0.0"
 
+/* Version of the Unicode Character Database implemented by the library. */
+#define SHEENBIDI_UNICODE_VERSION_MAJOR     17
+#define SHEENBIDI_UNICODE_VERSION_MINOR     0
+#define SHEENBIDI_UNICODE_VERSION_PATCH     0
+#define SHEENBIDI_UNICODE_VERSION_STRING    "17.0.0"
+
 /**
  * Returns the version string of the SheenBidi library.
  *
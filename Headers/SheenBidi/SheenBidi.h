@@ -32,10 +32,12 @@
 #include <SheenBidi/SBRun.h>
 #include <SheenBidi/SBScript.h>
 #include <SheenBidi/SBScriptLocator.h>
+#include <SheenBidi/SBStatistics.h>
 #include <SheenBidi/SBText.h>
 #include <SheenBidi/SBTextConfig.h>
 #include <SheenBidi/SBTextIterators.h>
 #include <SheenBidi/SBTextType.h>
+#include <SheenBidi/SBTrace.h>
 #include <SheenBidi/SBVersion.h>
 
 #endif
@@ -15,11 +15,16 @@
  */
 
 #include <stddef.h>
+#include <string.h>
 
 #include <API/SBBase.h>
 #include <API/SBCodepointSequence.h>
 #include <API/SBLog.h>
 #include <API/SBParagraph.h>
+#include <API/SBStatistics.h>
+#include <API/SBTrace.h>
+#include <Core/List.h>
+#include <Core/Memory.h>
 #include <Core/Object.h>
 
 #include "SBAlgorithm.h"
@@ -43,6 +48,8 @@ static SBMutableAlgorithmRef AllocateAlgorithm(SBUInteger stringLength)
 
     if (algorithm) {
         algorithm->fixedTypes = pointers[BIDI_TYPES];
+        algorithm->separatorIndexes = NULL;
+        algorithm->separatorCount = 0;
     }
 
     return algorithm;
@@ -52,7 +59,124 @@ static SBMutableAlgorithmRef AllocateAlgorithm(SBUInteger stringLength)
 #undef BIDI_TYPES
 #undef COUNT
 
-static SBAlgorithmRef CreateAlgorithm(const SBCodepointSequence *codepointSequence)
+/**
+ * Records the indexes of all paragraph separators in a single pass over the bidi types so that
+ * paragraph boundaries can be looked up without rescanning them. The lookup falls back to scanning
+ * if an allocation fails.
+ */
+static void IndexParagraphSeparators(SBMutableAlgorithmRef algorithm)
+{
+    const SBBidiType *bidiTypes = algorithm->fixedTypes;
+    SBUInteger stringLength = algorithm->codepointSequence.stringLength;
+    SBUInteger index = 0;
+    LIST(SBUInteger) separators;
+
+    ListInitialize(&separators, sizeof(SBUInteger));
+
+    while ((index = SBBidiTypesFindSeparator(bidiTypes, index, stringLength - index)) != SBInvalidIndex) {
+        if (!ListAdd(&separators, &index)) {
+            ListFinalize(&separators);
+            return;
+        }
+
+        index += 1;
+    }
+
+    if (separators.count > 0) {
+        SBUInteger byteCount = sizeof(SBUInteger) * separators.count;
+        SBUInteger *separatorIndexes = MemoryAllocateBlock(&algorithm->_base.memory,
+                                                           MemoryTypePermanent, byteCount);
+
+        if (separatorIndexes) {
+            memcpy(separatorIndexes, separators.items, byteCount);
+
+            algorithm->separatorIndexes = separatorIndexes;
+            algorithm->separatorCount = separators.count;
+        }
+    }
+
+    ListFinalize(&separators);
+}
+
+typedef struct _ClassificationContext {
+    const SBCodepointSequence *codepointSequence;
+    SBBidiType *bidiTypes;
+    const SBUInteger *chunkStarts;
+} ClassificationContext;
+
+static void ClassifyChunk(void *context, SBUInteger taskIndex)
+{
+    ClassificationContext *classification = context;
+    SBUInteger chunkStart = classification->chunkStarts[taskIndex];
+    SBUInteger chunkEnd = classification->chunkStarts[taskIndex + 1];
+
+    SBCodepointSequenceClassifyRange(classification->codepointSequence,
+        classification->bidiTypes, chunkStart, chunkEnd - chunkStart);
+}
+
+/**
+ * Splits the string into chunks aligned at code point boundaries and classifies them with the
+ * executor. Returns false without touching the bidi types if the work is not worth splitting.
+ */
+static SBBoolean ClassifyInParallel(SBMutableAlgorithmRef algorithm,
+    const SBAlgorithmExecutor *executor)
+{
+    const SBCodepointSequence *codepointSequence = &algorithm->codepointSequence;
+    SBUInteger stringLength = codepointSequence->stringLength;
+    SBUInteger chunkLength = executor->chunkLength;
+    SBUInteger chunkCount;
+    SBUInteger *chunkStarts;
+    ClassificationContext context;
+    Memory memory;
+    SBUInteger index;
+
+    if (chunkLength == 0) {
+        chunkLength = SB_CONFIG_CLASSIFICATION_CHUNK_LENGTH;
+    }
+    if (!executor->execute || stringLength <= chunkLength) {
+        return SBFalse;
+    }
+
+    MemoryInitialize(&memory);
+
+    chunkCount = (stringLength - 1) / chunkLength + 1;
+    chunkStarts = MemoryAllocateBlock(&memory, MemoryTypeScratch,
+                                      sizeof(SBUInteger) * (chunkCount + 1));
+    if (!chunkStarts) {
+        MemoryFinalize(&memory);
+        return SBFalse;
+    }
+
+    chunkStarts[0] = 0;
+
+    for (index = 1; index < chunkCount; index++) {
+        SBUInteger chunkStart = SBCodepointSequenceAlignChunkStart(codepointSequence,
+                                                                   index * chunkLength);
+        /* Keep the starts ascending even if a long malformed sequence crosses a chunk. */
+        if (chunkStart < chunkStarts[index - 1]) {
+            chunkStart = chunkStarts[index - 1];
+        }
+        chunkStarts[index] = chunkStart;
+    }
+
+    chunkStarts[chunkCount] = stringLength;
+
+    context.codepointSequence = codepointSequence;
+    context.bidiTypes = algorithm->fixedTypes;
+    context.chunkStarts = chunkStarts;
+
+    SB_TRACE_BEGIN(SBTraceStageClassification, stringLength);
+    executor->execute(chunkCount, ClassifyChunk, &context, executor->info);
+    SB_STATISTICS_ADD(StatisticCodeUnitsClassified, stringLength);
+    SB_TRACE_END(SBTraceStageClassification, stringLength);
+
+    MemoryFinalize(&memory);
+
+    return SBTrue;
+}
+
+static SBAlgorithmRef CreateAlgorithm(const SBCodepointSequence *codepointSequence,
+    const SBAlgorithmExecutor *executor)
 {
     SBUInteger stringLength = codepointSequence->stringLength;
     SBMutableAlgorithmRef algorithm;
@@ -66,7 +190,10 @@ static SBAlgorithmRef CreateAlgorithm(const SBCodepointSequence *codepointSequen
     if (algorithm) {
         algorithm->codepointSequence = *codepointSequence;
 
-        SBCodepointSequenceDetermineBidiTypes(codepointSequence, algorithm->fixedTypes);
+        if (!executor || !ClassifyInParallel(algorithm, executor)) {
+            SBCodepointSequenceDetermineBidiTypes(codepointSequence, algorithm->fixedTypes);
+        }
+        IndexParagraphSeparators(algorithm);
 
         SB_LOG_BLOCK_OPENER("Determined Types");
         SB_LOG_STATEMENT("Types",  1, SB_LOG_BIDI_TYPES_ARRAY(algorithm->fixedTypes, stringLength));
@@ -83,7 +210,19 @@ SBAlgorithmRef SBAlgorithmCreate(const SBCodepointSequence *codepointSequence)
     SBAlgorithmRef algorithm = NULL;
 
     if (SBCodepointSequenceIsValid(codepointSequence)) {
-        algorithm = CreateAlgorithm(codepointSequence);
+        algorithm = CreateAlgorithm(codepointSequence, NULL);
+    }
+
+    return algorithm;
+}
+
+SBAlgorithmRef SBAlgorithmCreateWithExecutor(
+    const SBCodepointSequence *codepointSequence, const SBAlgorithmExecutor *executor)
+{
+    SBAlgorithmRef algorithm = NULL;
+
+    if (SBCodepointSequenceIsValid(codepointSequence)) {
+        algorithm = CreateAlgorithm(codepointSequence, executor);
     }
 
     return algorithm;
@@ -94,23 +233,77 @@ const SBBidiType *SBAlgorithmGetBidiTypesPtr(SBAlgorithmRef algorithm)
     return algorithm->fixedTypes;
 }
 
-void SBAlgorithmGetParagraphBoundary(SBAlgorithmRef algorithm,
+SB_INTERNAL void SBAlgorithmFindParagraphBoundary(SBAlgorithmRef algorithm,
     SBUInteger paragraphOffset, SBUInteger suggestedLength,
     SBUInteger *actualLength, SBUInteger *separatorLength)
 {
     const SBCodepointSequence *codepointSequence = &algorithm->codepointSequence;
-    SBBidiType *bidiTypes = algorithm->fixedTypes;
+    const SBUInteger *separatorIndexes = algorithm->separatorIndexes;
+    SBUInteger limit = paragraphOffset + suggestedLength;
+    SBUInteger codeUnitCount = 0;
+    SBUInteger low;
+    SBUInteger high;
+
+    if (!separatorIndexes) {
+        SBCodepointSequenceGetParagraphBoundary(
+            codepointSequence, algorithm->fixedTypes, paragraphOffset, suggestedLength,
+            actualLength, separatorLength
+        );
+        return;
+    }
+
+    SB_TRACE_BEGIN(SBTraceStageBoundary, suggestedLength);
+
+    /* Find the first separator at or after the paragraph offset. */
+    low = 0;
+    high = algorithm->separatorCount;
 
-    SBUIntegerNormalizeRange(codepointSequence->stringLength, &paragraphOffset, &suggestedLength);
+    while (low < high) {
+        SBUInteger mid = low + (high - low) / 2;
 
-    SBCodepointSequenceGetParagraphBoundary(
-        codepointSequence, bidiTypes, paragraphOffset, suggestedLength,
-        actualLength, separatorLength
-    );
+        if (separatorIndexes[mid] < paragraphOffset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low < algorithm->separatorCount && separatorIndexes[low] < limit) {
+        codeUnitCount = SBCodepointSequenceGetSeparatorLength(codepointSequence, separatorIndexes[low]);
+        limit = separatorIndexes[low] + codeUnitCount;
+    }
+
+    if (actualLength) {
+        *actualLength = limit - paragraphOffset;
+    }
+    if (separatorLength) {
+        *separatorLength = codeUnitCount;
+    }
+
+    SB_TRACE_END(SBTraceStageBoundary, limit - paragraphOffset);
+}
+
+void SBAlgorithmGetParagraphBoundary(SBAlgorithmRef algorithm,
+    SBUInteger paragraphOffset, SBUInteger suggestedLength,
+    SBUInteger *actualLength, SBUInteger *separatorLength)
+{
+    SBUIntegerNormalizeRange(algorithm->codepointSequence.stringLength,
+                             &paragraphOffset, &suggestedLength);
+
+    SBAlgorithmFindParagraphBoundary(algorithm, paragraphOffset, suggestedLength,
+                                     actualLength, separatorLength);
 }
 
 SBParagraphRef SBAlgorithmCreateParagraph(SBAlgorithmRef algorithm,
     SBUInteger paragraphOffset, SBUInteger suggestedLength, SBLevel baseLevel)
+{
+    return SBAlgorithmCreateParagraphWithLimits(algorithm,
+        paragraphOffset, suggestedLength, baseLevel, NULL);
+}
+
+SBParagraphRef SBAlgorithmCreateParagraphWithLimits(SBAlgorithmRef algorithm,
+    SBUInteger paragraphOffset, SBUInteger suggestedLength, SBLevel baseLevel,
+    const SBParagraphLimits *limits)
 {
     const SBCodepointSequence *codepointSequence = &algorithm->codepointSequence;
     SBUInteger stringLength = codepointSequence->stringLength;
@@ -120,7 +313,7 @@ SBParagraphRef SBAlgorithmCreateParagraph(SBAlgorithmRef algorithm,
 
     if (suggestedLength > 0) {
         paragraph = SBParagraphCreateWithAlgorithm(
-            algorithm, paragraphOffset, suggestedLength, baseLevel
+            algorithm, paragraphOffset, suggestedLength, baseLevel, limits
         );
     }
 
@@ -21,12 +21,19 @@
 #include <SheenBidi/SBBidiType.h>
 #include <SheenBidi/SBCodepointSequence.h>
 
+#include <API/SBBase.h>
 #include <Core/Object.h>
 
 typedef struct _SBAlgorithm {
     ObjectBase _base;
     SBCodepointSequence codepointSequence;
     SBBidiType *fixedTypes;
+    SBUInteger *separatorIndexes;
+    SBUInteger separatorCount;
 } SBAlgorithm;
 
+SB_INTERNAL void SBAlgorithmFindParagraphBoundary(SBAlgorithmRef algorithm,
+    SBUInteger paragraphOffset, SBUInteger suggestedLength,
+    SBUInteger *actualLength, SBUInteger *separatorLength);
+
 #endif
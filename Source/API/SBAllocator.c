@@ -18,8 +18,10 @@
 #include <stdlib.h>
 
 #include <API/SBBase.h>
+#include <API/SBStatistics.h>
 #include <Core/AtomicPointer.h>
 #include <Core/Object.h>
+#include <Core/ObjectPool.h>
 #include <Core/Once.h>
 #include <Core/ThreadLocalStorage.h>
 
@@ -197,7 +199,7 @@ static void FinalizeAllocator(ObjectRef object)
     }
 }
 
-static SBAllocatorRef SBAllocatorGetCurrent(void)
+SB_INTERNAL SBAllocatorRef SBAllocatorGetCurrent(void)
 {
     SBAllocatorRef allocator = AtomicPointerLoad(&DefaultAllocator);
 
@@ -214,6 +216,8 @@ SB_INTERNAL void *SBAllocatorAllocateBlock(SBAllocatorRef allocator, SBUInteger
         allocator = SBAllocatorGetCurrent();
     }
 
+    SB_STATISTICS_INCREMENT(StatisticBlockAllocations);
+
     return allocator->_protocol.allocateBlock(size, allocator->_info);
 }
 
@@ -223,6 +227,10 @@ SB_INTERNAL void *SBAllocatorReallocateBlock(SBAllocatorRef allocator, void *poi
         allocator = SBAllocatorGetCurrent();
     }
 
+    if (!pointer) {
+        SB_STATISTICS_INCREMENT(StatisticBlockAllocations);
+    }
+
     return allocator->_protocol.reallocateBlock(pointer, newSize, allocator->_info);
 }
 
@@ -232,6 +240,10 @@ SB_INTERNAL void SBAllocatorDeallocateBlock(SBAllocatorRef allocator, void *poin
         allocator = SBAllocatorGetCurrent();
     }
 
+    if (pointer) {
+        SB_STATISTICS_INCREMENT(StatisticBlockDeallocations);
+    }
+
     allocator->_protocol.deallocateBlock(pointer, allocator->_info);
 }
 
@@ -303,3 +315,8 @@ void SBAllocatorRelease(SBAllocatorRef allocator)
 {
     ObjectRelease((ObjectRef)allocator);
 }
+
+void SBAllocatorDrainObjectPool(void)
+{
+    ObjectPoolDrain();
+}
@@ -25,7 +25,7 @@
 #include <SheenBidi/SBAttributeInfo.h>
 
 #define SBAttributeIDMake(index, size)                  \
-    ((((SBUInt32)((index) + 1)) << 8) | ((SBUInt32)(size) & 0xFF))
+    SBAttributeIDMakeFixed(index, size)
 
 #define SBAttributeIDGetSize(id)                        \
     ((SBUInt8)((id) & 0xFF))
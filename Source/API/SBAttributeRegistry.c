@@ -35,12 +35,34 @@ static int AttributeInfoComparison(const void *first, const void *second)
     return strcmp(info1->name, info2->name);
 }
 
-static int AttributeNameComparison(const void *key, const void *array)
+/**
+ * Computes the FNV-1a hash of an attribute name.
+ */
+static SBUInt32 HashAttributeName(const char *name)
 {
-    const char *name = key;
-    const SBAttributeInfo *attributeInfo = array;
+    SBUInt32 hash = 2166136261U;
+
+    while (*name) {
+        hash ^= (SBUInt8)*name;
+        hash *= 16777619U;
+        name += 1;
+    }
 
-    return strcmp(name, attributeInfo->name);
+    return hash;
+}
+
+/**
+ * Returns the number of name slots, a power of two keeping the load factor at most one half.
+ */
+static SBUInteger GetNameSlotCount(SBUInteger attributeCount)
+{
+    SBUInteger slotCount = 1;
+
+    while (slotCount < attributeCount * 2) {
+        slotCount *= 2;
+    }
+
+    return slotCount;
 }
 
 static SBUInteger CountCombinedNamesLength(
@@ -60,11 +82,13 @@ static SBUInteger CountCombinedNamesLength(
 
 #define ATTRIBUTE_REGISTRY  0
 #define ATTRIBUTE_INFOS     1
-#define ATTRIBUTE_NAMES     2
-#define COUNT               3
+#define NAME_HASHES         2
+#define NAME_SLOTS          3
+#define ATTRIBUTE_NAMES     4
+#define COUNT               5
 
-static SBAttributeRegistry *AllocateAttributeRegistry(
-    SBUInteger attributeCount, SBUInteger namesLength, char **namesPointer)
+static SBAttributeRegistry *AllocateAttributeRegistry(SBUInteger attributeCount,
+    SBUInteger slotCount, SBUInteger namesLength, char **namesPointer)
 {
     void *pointers[COUNT] = { NULL };
     SBUInteger sizes[COUNT] = { 0 };
@@ -72,12 +96,17 @@ static SBAttributeRegistry *AllocateAttributeRegistry(
 
     sizes[ATTRIBUTE_REGISTRY] = sizeof(SBAttributeRegistry);
     sizes[ATTRIBUTE_INFOS]    = sizeof(SBAttributeInfo) * attributeCount;
+    sizes[NAME_HASHES]        = sizeof(SBUInt32) * attributeCount;
+    sizes[NAME_SLOTS]         = sizeof(SBUInt32) * slotCount;
     sizes[ATTRIBUTE_NAMES]    = namesLength;
 
     attributeRegistry = ObjectCreate(sizes, COUNT, pointers, NULL);
 
     if (attributeRegistry) {
         attributeRegistry->attributeInfos = pointers[ATTRIBUTE_INFOS];
+        attributeRegistry->_nameHashes = pointers[NAME_HASHES];
+        attributeRegistry->_nameSlots = pointers[NAME_SLOTS];
+        attributeRegistry->_slotMask = slotCount - 1;
         *namesPointer = pointers[ATTRIBUTE_NAMES];
     }
 
@@ -86,9 +115,70 @@ static SBAttributeRegistry *AllocateAttributeRegistry(
 
 #undef ATTRIBUTE_REGISTRY
 #undef ATTRIBUTE_INFOS
+#undef NAME_HASHES
+#undef NAME_SLOTS
 #undef ATTRIBUTE_NAMES
 #undef COUNT
 
+/**
+ * Builds the open addressing name index of the registry, keeping the first of duplicate names.
+ */
+static void BuildNameIndex(SBAttributeRegistry *registry)
+{
+    SBUInteger slotIndex;
+    SBUInteger index;
+
+    for (slotIndex = 0; slotIndex <= registry->_slotMask; slotIndex++) {
+        registry->_nameSlots[slotIndex] = 0;
+    }
+
+    for (index = 0; index < registry->count; index++) {
+        const char *name = registry->attributeInfos[index].name;
+        SBUInt32 hash = HashAttributeName(name);
+
+        registry->_nameHashes[index] = hash;
+        slotIndex = hash & registry->_slotMask;
+
+        /* Probe linearly for an empty slot */
+        while (registry->_nameSlots[slotIndex] != 0) {
+            SBUInteger existing = registry->_nameSlots[slotIndex] - 1;
+
+            if (registry->_nameHashes[existing] == hash
+                    && strcmp(registry->attributeInfos[existing].name, name) == 0) {
+                break;
+            }
+
+            slotIndex = (slotIndex + 1) & registry->_slotMask;
+        }
+
+        if (registry->_nameSlots[slotIndex] == 0) {
+            registry->_nameSlots[slotIndex] = (SBUInt32)(index + 1);
+        }
+    }
+}
+
+/**
+ * Returns the index of the attribute having the given name, or SBInvalidIndex if not found.
+ */
+static SBUInteger FindAttributeIndex(SBAttributeRegistryRef registry, const char *name)
+{
+    SBUInt32 hash = HashAttributeName(name);
+    SBUInteger slotIndex = hash & registry->_slotMask;
+
+    while (registry->_nameSlots[slotIndex] != 0) {
+        SBUInteger index = registry->_nameSlots[slotIndex] - 1;
+
+        if (registry->_nameHashes[index] == hash
+                && strcmp(registry->attributeInfos[index].name, name) == 0) {
+            return index;
+        }
+
+        slotIndex = (slotIndex + 1) & registry->_slotMask;
+    }
+
+    return SBInvalidIndex;
+}
+
 static SBAttributeInfo *GetAttributeInfoForID(SBAttributeRegistryRef registry, SBAttributeID id)
 {
     SBUInteger index = SBAttributeIDGetIndex(id);
@@ -140,14 +230,16 @@ SB_INTERNAL const SBAttributeInfo *SBAttributeRegistryGetInfoReference(
     return GetAttributeInfoForID(registry, attributeID);
 }
 
-SBAttributeRegistryRef SBAttributeRegistryCreate(const SBAttributeInfo *attributeInfos,
-    SBUInteger count, SBUInt8 valueSize, const SBAttributeValueCallbacks *valueCallbacks)
+static SBAttributeRegistry *CreateAttributeRegistry(const SBAttributeInfo *attributeInfos,
+    SBUInteger count, SBUInt8 valueSize, const SBAttributeValueCallbacks *valueCallbacks,
+    SBBoolean sortsByName)
 {
     SBUInteger namesLength = CountCombinedNamesLength(attributeInfos, count);
+    SBUInteger slotCount = GetNameSlotCount(count);
     char *namesPointer;
     SBAttributeRegistry *attributeRegistry;
 
-    attributeRegistry = AllocateAttributeRegistry(count, namesLength, &namesPointer);
+    attributeRegistry = AllocateAttributeRegistry(count, slotCount, namesLength, &namesPointer);
 
     if (attributeRegistry) {
         SBAttributeInfo *destination = attributeRegistry->attributeInfos;
@@ -173,38 +265,53 @@ SBAttributeRegistryRef SBAttributeRegistryCreate(const SBAttributeInfo *attribut
             attributeRegistry->_valueCallbacks.retain = NULL;
         }
 
-        qsort(attributeRegistry->attributeInfos, count, sizeof(SBAttributeInfo), AttributeInfoComparison);
+        if (sortsByName) {
+            qsort(attributeRegistry->attributeInfos, count, sizeof(SBAttributeInfo),
+                AttributeInfoComparison);
+        }
+
+        BuildNameIndex(attributeRegistry);
     }
 
     return attributeRegistry;
 }
 
+SBAttributeRegistryRef SBAttributeRegistryCreate(const SBAttributeInfo *attributeInfos,
+    SBUInteger count, SBUInt8 valueSize, const SBAttributeValueCallbacks *valueCallbacks)
+{
+    return CreateAttributeRegistry(attributeInfos, count, valueSize, valueCallbacks, SBTrue);
+}
+
+SBAttributeRegistryRef SBAttributeRegistryCreateWithFixedIDs(
+    const SBAttributeInfo *attributeInfos, SBUInteger count, SBUInt8 valueSize,
+    const SBAttributeValueCallbacks *valueCallbacks)
+{
+    return CreateAttributeRegistry(attributeInfos, count, valueSize, valueCallbacks, SBFalse);
+}
+
 SBBoolean SBAttributeRegistryGetAttributeInfo(SBAttributeRegistryRef registry,
     SBAttributeID attributeID, SBAttributeInfo *attributeInfo)
 {
-    SBBoolean idExists = SBFalse;
+    const SBAttributeInfo *source = NULL;
 
     if (SBAttributeIDIsValid(attributeID)) {
-        SBUInteger index = SBAttributeIDGetIndex(attributeID);
+        source = GetAttributeInfoForID(registry, attributeID);
 
-        *attributeInfo = registry->attributeInfos[index];
-        idExists = SBTrue;
+        if (source) {
+            *attributeInfo = *source;
+        }
     }
 
-    return idExists;
+    return (source != NULL);
 }
 
 SBAttributeID SBAttributeRegistryGetAttributeID(
     SBAttributeRegistryRef registry, const char *name)
 {
-    SBAttributeInfo *attributeInfo = bsearch(name, registry->attributeInfos, registry->count,
-        sizeof(SBAttributeInfo), AttributeNameComparison);
-
-    if (attributeInfo) {
-        SBUInteger index = attributeInfo - registry->attributeInfos;
-        SBUInt8 size = registry->valueSize;
+    SBUInteger index = FindAttributeIndex(registry, name);
 
-        return SBAttributeIDMake(index, size);
+    if (index != SBInvalidIndex) {
+        return SBAttributeIDMake(index, registry->valueSize);
     }
 
     return SBAttributeIDNone;
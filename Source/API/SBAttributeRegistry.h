@@ -29,6 +29,9 @@
 typedef struct _SBAttributeRegistry {
     ObjectBase _base;
     SBAttributeInfo *attributeInfos;
+    SBUInt32 *_nameHashes;                  /**< Hash of the name of each attribute */
+    SBUInt32 *_nameSlots;                   /**< Open addressing table of attribute index + 1 */
+    SBUInteger _slotMask;
     SBUInteger count;
     SBUInt8 valueSize;
     SBAttributeValueCallbacks _valueCallbacks;
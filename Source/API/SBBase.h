@@ -80,6 +80,11 @@
 #endif
 
 
+/**
+ * A type to represent a 64-bit unsigned integer in fixed width data.
+ */
+typedef uint64_t SBUInt64;
+
 /**
  * A value that indicates an invalid unsigned index.
  */
@@ -14,26 +14,166 @@
  * limitations under the License.
  */
 
+#include <stddef.h>
+#include <string.h>
+
 #include <API/SBBase.h>
 #include <API/SBCodepoint.h>
+#include <API/SBStatistics.h>
+#include <API/SBTrace.h>
 #include <Data/BidiTypeLookup.h>
 
 #include "SBCodepointSequence.h"
 
-SB_INTERNAL SBBoolean SBCodepointSequenceIsValid(const SBCodepointSequence *sequence)
+static SBBoolean IsEncodingValid(SBStringEncoding encoding)
 {
-    if (sequence) {
-        SBBoolean encodingValid = SBFalse;
+    switch (encoding) {
+    case SBStringEncodingUTF8:
+    case SBStringEncodingUTF16:
+    case SBStringEncodingUTF32:
+        return SBTrue;
+    }
+
+    return SBFalse;
+}
+
+/**
+ * Returns the number of units taken by a code point in the given index space, where `unitCount`
+ * is the number of code units actually consumed in the native encoding of the sequence.
+ */
+static SBUInteger GetIndexUnitCount(const SBCodepointSequence *sequence,
+    SBStringEncoding encoding, SBCodepoint codepoint, SBUInteger unitCount)
+{
+    if (encoding == sequence->stringEncoding) {
+        return unitCount;
+    }
+
+    switch (encoding) {
+    case SBStringEncodingUTF8:
+        if (codepoint < 0x80) {
+            return 1;
+        }
+        if (codepoint < 0x800) {
+            return 2;
+        }
+        if (codepoint < 0x10000) {
+            return 3;
+        }
+        return 4;
+
+    case SBStringEncodingUTF16:
+        return (codepoint < 0x10000 ? 1 : 2);
+
+    default:
+        return 1;
+    }
+}
+
+SB_INTERNAL void IndexConverterInitialize(IndexConverter *converter,
+    const SBCodepointSequence *sequence,
+    SBStringEncoding sourceEncoding, SBStringEncoding targetEncoding)
+{
+    converter->sequence = sequence;
+    converter->sourceEncoding = sourceEncoding;
+    converter->targetEncoding = targetEncoding;
+    converter->stringIndex = 0;
+    converter->sourceIndex = 0;
+    converter->targetIndex = 0;
+    converter->originString = 0;
+    converter->originSource = 0;
+    converter->originTarget = 0;
+}
 
-        switch (sequence->stringEncoding) {
-        case SBStringEncodingUTF8:
-        case SBStringEncodingUTF16:
-        case SBStringEncodingUTF32:
-            encodingValid = SBTrue;
+SB_INTERNAL void IndexConverterSetOrigin(IndexConverter *converter,
+    SBUInteger stringIndex, SBUInteger sourceIndex, SBUInteger targetIndex)
+{
+    converter->stringIndex = stringIndex;
+    converter->sourceIndex = sourceIndex;
+    converter->targetIndex = targetIndex;
+    converter->originString = stringIndex;
+    converter->originSource = sourceIndex;
+    converter->originTarget = targetIndex;
+}
+
+SB_INTERNAL SBUInteger IndexConverterConvert(IndexConverter *converter, SBUInteger index)
+{
+    const SBCodepointSequence *sequence = converter->sequence;
+    SBUInteger stringIndex;
+    SBUInteger sourceIndex;
+    SBUInteger targetIndex;
+
+    if (converter->sourceEncoding == converter->targetEncoding) {
+        return index;
+    }
+
+    if (index < converter->sourceIndex) {
+        converter->stringIndex = converter->originString;
+        converter->sourceIndex = converter->originSource;
+        converter->targetIndex = converter->originTarget;
+    }
+
+    stringIndex = converter->stringIndex;
+    sourceIndex = converter->sourceIndex;
+    targetIndex = converter->targetIndex;
+
+    while (sourceIndex < index) {
+        SBUInteger nextIndex = stringIndex;
+        SBCodepoint codepoint;
+        SBUInteger unitCount;
+        SBUInteger sourceCount;
+
+        /* ASCII takes a single unit in every index space, so skip it without decoding. */
+        if (sequence->stringEncoding == SBStringEncodingUTF8) {
+            const SBUInt8 *buffer = sequence->stringBuffer;
+            SBUInteger limit = stringIndex + (index - sourceIndex);
+
+            if (limit > sequence->stringLength) {
+                limit = sequence->stringLength;
+            }
+
+            while (nextIndex < limit && buffer[nextIndex] < 0x80) {
+                nextIndex += 1;
+            }
+
+            if (nextIndex != stringIndex) {
+                unitCount = nextIndex - stringIndex;
+                stringIndex = nextIndex;
+                sourceIndex += unitCount;
+                targetIndex += unitCount;
+                continue;
+            }
+        }
+
+        codepoint = SBCodepointSequenceGetCodepointAt(sequence, &nextIndex);
+        if (codepoint == SBCodepointInvalid) {
             break;
         }
 
-        return (encodingValid && sequence->stringBuffer && sequence->stringLength > 0);
+        unitCount = nextIndex - stringIndex;
+        sourceCount = GetIndexUnitCount(sequence, converter->sourceEncoding, codepoint, unitCount);
+
+        /* An index inside a code point maps to its start. */
+        if (sourceIndex + sourceCount > index) {
+            break;
+        }
+
+        stringIndex = nextIndex;
+        sourceIndex += sourceCount;
+        targetIndex += GetIndexUnitCount(sequence, converter->targetEncoding, codepoint, unitCount);
+    }
+
+    converter->stringIndex = stringIndex;
+    converter->sourceIndex = sourceIndex;
+    converter->targetIndex = targetIndex;
+
+    return targetIndex;
+}
+
+SB_INTERNAL SBBoolean SBCodepointSequenceIsValid(const SBCodepointSequence *sequence)
+{
+    if (sequence) {
+        return (IsEncodingValid(sequence->stringEncoding)
+                && sequence->stringBuffer && sequence->stringLength > 0);
     }
 
     return SBFalse;
@@ -63,14 +203,71 @@ SB_INTERNAL SBUInteger SBCodepointSequenceGetSeparatorLength(
     return separatorLength;
 }
 
-SB_INTERNAL void SBCodepointSequenceDetermineBidiTypes(
-    const SBCodepointSequence *sequence, SBBidiType *bidiTypes)
+SB_INTERNAL SBUInteger SBBidiTypesFindSeparator(const SBBidiType *bidiTypes,
+    SBUInteger offset, SBUInteger length)
 {
-    SBUInteger stringIndex = 0;
-    SBUInteger firstIndex = 0;
-    SBCodepoint codepoint;
+    const SBBidiType *separator = NULL;
+
+    if (length > 0) {
+        /* Bidi types are single bytes, so the optimized byte search of the C library applies. */
+        separator = memchr(&bidiTypes[offset], SBBidiTypeB, length);
+    }
+
+    if (separator) {
+        return (SBUInteger)(separator - bidiTypes);
+    }
+
+    return SBInvalidIndex;
+}
+
+SB_INTERNAL SBUInteger SBCodepointSequenceAlignChunkStart(
+    const SBCodepointSequence *sequence, SBUInteger index)
+{
+    SBUInteger stringLength = sequence->stringLength;
+
+    if (index == 0 || index >= stringLength) {
+        return (index == 0 ? 0 : stringLength);
+    }
+
+    SBCodepointSkipToStart(sequence->stringBuffer, stringLength, sequence->stringEncoding, &index);
+
+    /*
+     * Backward decoding of malformed input may settle on a continuation unit that forward decoding
+     * would have consumed as part of a preceding sequence. Skip such units so that the chunk starts
+     * exactly where decoding from the beginning of the string would.
+     */
+    switch (sequence->stringEncoding) {
+    case SBStringEncodingUTF8: {
+        const SBUInt8 *codeUnits = sequence->stringBuffer;
+
+        while (index < stringLength && (codeUnits[index] & 0xC0) == 0x80) {
+            index += 1;
+        }
+        break;
+    }
+
+    case SBStringEncodingUTF16: {
+        const SBUInt16 *codeUnits = sequence->stringBuffer;
+
+        while (index < stringLength && (codeUnits[index] & 0xFC00) == 0xDC00) {
+            index += 1;
+        }
+        break;
+    }
+    }
 
-    while ((codepoint = SBCodepointSequenceGetCodepointAt(sequence, &stringIndex)) != SBCodepointInvalid) {
+    return index;
+}
+
+SB_INTERNAL void SBCodepointSequenceClassifyRange(const SBCodepointSequence *sequence,
+    SBBidiType *bidiTypes, SBUInteger offset, SBUInteger length)
+{
+    SBUInteger stringIndex = offset;
+    SBUInteger firstIndex = offset;
+    SBUInteger limitIndex = offset + length;
+
+    while (stringIndex < limitIndex) {
+        SBCodepoint codepoint = SBCodepointSequenceGetCodepointAt(sequence, &stringIndex);
         bidiTypes[firstIndex] = LookupBidiType(codepoint);
 
         /* Subsequent code units get 'BN' type. */
@@ -80,36 +277,48 @@ SB_INTERNAL void SBCodepointSequenceDetermineBidiTypes(
     }
 }
 
+SB_INTERNAL void SBCodepointSequenceDetermineBidiTypes(
+    const SBCodepointSequence *sequence, SBBidiType *bidiTypes)
+{
+    SB_TRACE_BEGIN(SBTraceStageClassification, sequence->stringLength);
+
+    SBCodepointSequenceClassifyRange(sequence, bidiTypes, 0, sequence->stringLength);
+
+    SB_STATISTICS_ADD(StatisticCodeUnitsClassified, sequence->stringLength);
+    SB_TRACE_END(SBTraceStageClassification, sequence->stringLength);
+}
+
 SB_INTERNAL void SBCodepointSequenceGetParagraphBoundary(
     const SBCodepointSequence *sequence, const SBBidiType *bidiTypes,
     SBUInteger paragraphOffset, SBUInteger suggestedLength,
     SBUInteger *actualLength, SBUInteger *separatorLength)
 {
-    SBUInteger limit = paragraphOffset + suggestedLength;
-    SBUInteger index;
+    SBUInteger index = paragraphOffset + suggestedLength;
+    SBUInteger separatorIndex;
+
+    SB_TRACE_BEGIN(SBTraceStageBoundary, suggestedLength);
 
     if (separatorLength) {
         *separatorLength = 0;
     }
 
-    for (index = paragraphOffset; index < limit; index++) {
-        SBBidiType currentType = bidiTypes[index];
+    separatorIndex = SBBidiTypesFindSeparator(bidiTypes, paragraphOffset, suggestedLength);
 
-        if (currentType == SBBidiTypeB) {
-            SBUInteger codeUnitCount = SBCodepointSequenceGetSeparatorLength(sequence, index);
+    if (separatorIndex != SBInvalidIndex) {
+        SBUInteger codeUnitCount = SBCodepointSequenceGetSeparatorLength(sequence, separatorIndex);
 
-            index += codeUnitCount;
+        index = separatorIndex + codeUnitCount;
 
-            if (separatorLength) {
-                *separatorLength = codeUnitCount;
-            }
-            break;
+        if (separatorLength) {
+            *separatorLength = codeUnitCount;
         }
     }
 
     if (actualLength) {
         *actualLength = index - paragraphOffset;
     }
+
+    SB_TRACE_END(SBTraceStageBoundary, index - paragraphOffset);
 }
 
 SBCodepoint SBCodepointSequenceGetCodepointBefore(const SBCodepointSequence *codepointSequence, SBUInteger *stringIndex)
@@ -171,3 +380,20 @@ SBCodepoint SBCodepointSequenceGetCodepointAt(const SBCodepointSequence *codepoi
 
     return codepoint;
 }
+
+void SBCodepointSequenceConvertIndexes(const SBCodepointSequence *codepointSequence,
+    SBStringEncoding sourceEncoding, SBStringEncoding targetEncoding,
+    SBUInteger *indexes, SBUInteger count)
+{
+    if (SBCodepointSequenceIsValid(codepointSequence)
+            && IsEncodingValid(sourceEncoding) && IsEncodingValid(targetEncoding)) {
+        IndexConverter converter;
+        SBUInteger index;
+
+        IndexConverterInitialize(&converter, codepointSequence, sourceEncoding, targetEncoding);
+
+        for (index = 0; index < count; index++) {
+            indexes[index] = IndexConverterConvert(&converter, indexes[index]);
+        }
+    }
+}
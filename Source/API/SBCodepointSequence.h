@@ -21,11 +21,61 @@
 
 #include <API/SBBase.h>
 
+/**
+ * A cursor translating ascending indexes between two index spaces of a code point sequence.
+ */
+typedef struct _IndexConverter {
+    const SBCodepointSequence *sequence;
+    SBStringEncoding sourceEncoding;
+    SBStringEncoding targetEncoding;
+    SBUInteger stringIndex;     /**< Position in the code units of the sequence. */
+    SBUInteger sourceIndex;     /**< Position in the source index space. */
+    SBUInteger targetIndex;     /**< Position in the target index space. */
+    SBUInteger originString;    /**< Code unit from which a walk restarts. */
+    SBUInteger originSource;    /**< Source index from which a walk restarts. */
+    SBUInteger originTarget;    /**< Target index from which a walk restarts. */
+} IndexConverter;
+
+SB_INTERNAL void IndexConverterInitialize(IndexConverter *converter,
+    const SBCodepointSequence *sequence,
+    SBStringEncoding sourceEncoding, SBStringEncoding targetEncoding);
+
+/**
+ * Moves the converter to a code point boundary whose indexes are already known and makes it the
+ * point from which later walks restart. Indexes before the origin MUST NOT be translated
+ * afterwards.
+ */
+SB_INTERNAL void IndexConverterSetOrigin(IndexConverter *converter,
+    SBUInteger stringIndex, SBUInteger sourceIndex, SBUInteger targetIndex);
+
+/**
+ * Translates the given index, which is expected to be at or after the previously translated one
+ * for a single forward walk; a smaller index restarts the walk from the origin.
+ */
+SB_INTERNAL SBUInteger IndexConverterConvert(IndexConverter *converter, SBUInteger index);
+
 SB_INTERNAL SBBoolean SBCodepointSequenceIsValid(const SBCodepointSequence *sequence);
 
 SB_INTERNAL SBUInteger SBCodepointSequenceGetSeparatorLength(
     const SBCodepointSequence *sequence, SBUInteger separatorIndex);
 
+SB_INTERNAL SBUInteger SBBidiTypesFindSeparator(const SBBidiType *bidiTypes,
+    SBUInteger offset, SBUInteger length);
+
+/**
+ * Returns the first index at or after the given one from which decoding yields the same code points
+ * as decoding from the start of the sequence.
+ */
+SB_INTERNAL SBUInteger SBCodepointSequenceAlignChunkStart(
+    const SBCodepointSequence *sequence, SBUInteger index);
+
+/**
+ * Determines the bidi types of the code units in the given range, whose bounds MUST be aligned
+ * with `SBCodepointSequenceAlignChunkStart()`.
+ */
+SB_INTERNAL void SBCodepointSequenceClassifyRange(const SBCodepointSequence *sequence,
+    SBBidiType *bidiTypes, SBUInteger offset, SBUInteger length);
+
 SB_INTERNAL void SBCodepointSequenceDetermineBidiTypes(
     const SBCodepointSequence *sequence, SBBidiType *bidiTypes);
 
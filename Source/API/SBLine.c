@@ -15,37 +15,34 @@
  */
 
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <API/SBAlgorithm.h>
 #include <API/SBAllocator.h>
 #include <API/SBAssert.h>
 #include <API/SBBase.h>
+#include <API/SBCodepoint.h>
+#include <API/SBCodepointSequence.h>
 #include <API/SBParagraph.h>
+#include <API/SBStatistics.h>
+#include <API/SBTrace.h>
 #include <Core/Memory.h>
 #include <Core/Object.h>
+#include <Data/PairingLookup.h>
 
 #include "SBLine.h"
 
 typedef SBLine *SBMutableLineRef;
 
-typedef struct _LineContext {
-    const SBBidiType *refTypes;
-    SBLevel *fixedLevels;
-    SBUInteger runCount;
-    SBLevel maxLevel;
-} LineContext, *LineContextRef;
-
-static SBLevel CopyLevels(SBLevel *destination,
-    const SBLevel *source, SBUInteger length, SBUInteger *runCount);
-static void ResetLevels(LineContextRef context, SBLevel baseLevel, SBUInteger charCount);
+static void ResetLevels(SBLevel *levels, const SBBidiType *types,
+    SBUInteger charCount, SBLevel baseLevel);
 
 #define LEVELS       0
 #define COUNT        1
 
-static SBBoolean InitializeLineContext(LineContextRef context, MemoryRef memory,
-    const SBBidiType *types, const SBLevel *levels, SBUInteger length, SBLevel baseLevel)
+static SBLevel *CopyLevels(MemoryRef memory, const SBLevel *levels, SBUInteger length)
 {
-    SBBoolean isInitialized = SBFalse;
     void *pointers[COUNT] = { NULL };
     SBUInteger sizes[COUNT];
 
@@ -53,22 +50,35 @@ static SBBoolean InitializeLineContext(LineContextRef context, MemoryRef memory,
 
     if (MemoryAllocateChunks(memory, MemoryTypeScratch, sizes, COUNT, pointers)) {
         SBLevel *fixedLevels = pointers[LEVELS];
+        SBUInteger index;
 
-        context->refTypes = types;
-        context->fixedLevels = fixedLevels;
-        context->maxLevel = CopyLevels(fixedLevels, levels, length, &context->runCount);
-
-        ResetLevels(context, baseLevel, length);
+        for (index = 0; index < length; index++) {
+            fixedLevels[index] = levels[index];
+        }
 
-        isInitialized = SBTrue;
+        return fixedLevels;
     }
 
-    return isInitialized;
+    return NULL;
 }
 
 #undef LEVELS
 #undef COUNT
 
+static void FinalizeLine(ObjectRef object)
+{
+    SBMutableLineRef line = object;
+    LineMaps *maps = AtomicPointerLoad(&line->maps);
+
+    if (maps) {
+        SBAllocatorDeallocateBlock(NULL, maps);
+    }
+
+    if (line->owner) {
+        ObjectRelease(line->owner);
+    }
+}
+
 #define LINE  0
 #define RUNS  1
 #define COUNT 2
@@ -84,10 +94,12 @@ static SBMutableLineRef AllocateLine(SBUInteger runCount)
         sizes[LINE] = sizeof(SBLine);
         sizes[RUNS] = sizeof(SBRun) * runCount;
 
-        line = ObjectCreate(sizes, COUNT, pointers, NULL);
+        line = ObjectCreate(sizes, COUNT, pointers, FinalizeLine);
 
         if (line) {
             line->fixedRuns = pointers[RUNS];
+            line->maps = NULL;
+            line->owner = NULL;
         }
     }
 
@@ -98,30 +110,29 @@ static SBMutableLineRef AllocateLine(SBUInteger runCount)
 #undef RUNS
 #undef COUNT
 
-static SBLevel CopyLevels(SBLevel *destination,
-    const SBLevel *source, SBUInteger length, SBUInteger *runCount)
+static SBUInteger CountRuns(const SBLevel *levels, SBUInteger length, SBLevel *maxLevel)
 {
     SBLevel lastLevel = SBLevelInvalid;
-    SBLevel maxLevel = 0;
-    SBUInteger totalRuns = 0;
+    SBLevel highestLevel = 0;
+    SBUInteger runCount = 0;
     SBUInteger index;
 
     for (index = 0; index < length; index++) {
-        SBLevel level = source[index];
-        destination[index] = level;
+        SBLevel level = levels[index];
 
         if (level != lastLevel) {
-            totalRuns += 1;
+            runCount += 1;
+            lastLevel = level;
 
-            if (level > maxLevel) {
-                maxLevel = level;
+            if (level > highestLevel) {
+                highestLevel = level;
             }
         }
     }
 
-    *runCount = totalRuns;
+    *maxLevel = highestLevel;
 
-    return maxLevel;
+    return runCount;
 }
 
 static void SetNewLevel(SBLevel *levels, SBUInteger length, SBLevel newLevel)
@@ -133,14 +144,15 @@ static void SetNewLevel(SBLevel *levels, SBUInteger length, SBLevel newLevel)
     }
 }
 
-static void ResetLevels(LineContextRef context, SBLevel baseLevel, SBUInteger charCount)
+static void ResetLevels(SBLevel *levels, const SBBidiType *types,
+    SBUInteger charCount, SBLevel baseLevel)
 {
-    const SBBidiType *types = context->refTypes;
-    SBLevel *levels = context->fixedLevels;
     SBUInteger index;
     SBUInteger length;
     SBBoolean reset;
 
+    SB_TRACE_BEGIN(SBTraceStageLevelReset, charCount);
+
     index = charCount;
     length = 0;
     reset = SBTrue;
@@ -154,7 +166,6 @@ static void ResetLevels(LineContextRef context, SBLevel baseLevel, SBUInteger ch
             SetNewLevel(levels + index, length + 1, baseLevel);
             length = 0;
             reset = SBTrue;
-            context->runCount += 1;
             break;
 
         case SBBidiTypeLRE:
@@ -174,8 +185,6 @@ static void ResetLevels(LineContextRef context, SBLevel baseLevel, SBUInteger ch
             if (reset) {
                 SetNewLevel(levels + index, length + 1, baseLevel);
                 length = 0;
-
-                context->runCount += 1;
             }
             break;
 
@@ -185,6 +194,7 @@ static void ResetLevels(LineContextRef context, SBLevel baseLevel, SBUInteger ch
             break;
         }
     }
+    SB_TRACE_END(SBTraceStageLevelReset, charCount);
 }
 
 static SBUInteger InitializeRuns(SBRun *runs,
@@ -231,13 +241,15 @@ static void ReverseRunSequence(SBRun *runs, SBUInteger runCount)
     }
 }
 
-static void ReorderRuns(SBRun *runs, SBUInteger runCount, SBLevel maxLevel)
+static void ReorderRunsByLevels(SBRun *runs, SBUInteger runCount, SBLevel maxLevel)
 {
     SBLevel newLevel;
 
     for (newLevel = maxLevel; newLevel; newLevel--) {
         SBUInteger start = runCount;
 
+        SB_STATISTICS_ADD(StatisticRunReorderSteps, runCount);
+
         while (start--) {
             if (runs[start].level >= newLevel) {
                 SBUInteger count = 1;
@@ -252,6 +264,291 @@ static void ReorderRuns(SBRun *runs, SBUInteger runCount, SBLevel maxLevel)
     }
 }
 
+#define NO_ELEMENT SBInvalidIndex
+
+typedef struct _RunTree {
+    SBUInteger *nextElements;
+    SBUInteger *previousElements;
+    SBUInteger *firstElements;
+    SBUInteger *lastElements;
+    SBLevel *nodeLevels;
+    SBUInteger runCount;
+    SBUInteger nodeCount;
+} RunTree, *RunTreeRef;
+
+/*
+ * Elements of the tree are identified by a single index. Indexes below the run count refer to
+ * runs whereas the rest refer to nodes, each holding the runs and nodes of a maximal sequence
+ * whose lowest level is the level of the node.
+ */
+
+static SBUInteger RunTreeAddNode(RunTreeRef tree, SBLevel level)
+{
+    SBUInteger node = tree->nodeCount++;
+
+    tree->firstElements[node] = NO_ELEMENT;
+    tree->lastElements[node] = NO_ELEMENT;
+    tree->nodeLevels[node] = level;
+
+    return node;
+}
+
+static void RunTreeAppend(RunTreeRef tree, SBUInteger node, SBUInteger element)
+{
+    SBUInteger lastElement = tree->lastElements[node];
+
+    tree->previousElements[element] = lastElement;
+    tree->nextElements[element] = NO_ELEMENT;
+
+    if (lastElement == NO_ELEMENT) {
+        tree->firstElements[node] = element;
+    } else {
+        tree->nextElements[lastElement] = element;
+    }
+
+    tree->lastElements[node] = element;
+}
+
+static SBUInteger RunTreeRemoveLast(RunTreeRef tree, SBUInteger node)
+{
+    SBUInteger lastElement = tree->lastElements[node];
+    SBUInteger previousElement = tree->previousElements[lastElement];
+
+    tree->lastElements[node] = previousElement;
+
+    if (previousElement == NO_ELEMENT) {
+        tree->firstElements[node] = NO_ELEMENT;
+    } else {
+        tree->nextElements[previousElement] = NO_ELEMENT;
+    }
+
+    return lastElement;
+}
+
+static void BuildRunTree(RunTreeRef tree, const SBRun *runs)
+{
+    SBUInteger nodeStack[SBLevelMax + 2];
+    SBUInteger stackTop = 0;
+    SBUInteger runIndex;
+
+    /* The root node is never reversed and holds the runs of level zero. */
+    nodeStack[0] = tree->runCount + RunTreeAddNode(tree, 0);
+
+    for (runIndex = 0; runIndex < tree->runCount; runIndex++) {
+        SBLevel level = runs[runIndex].level;
+        SBUInteger closedNode = NO_ELEMENT;
+        SBUInteger topNode;
+
+        /* Close the nodes of higher levels. */
+        while (tree->nodeLevels[nodeStack[stackTop] - tree->runCount] > level) {
+            closedNode = nodeStack[stackTop--];
+        }
+
+        topNode = nodeStack[stackTop] - tree->runCount;
+
+        if (tree->nodeLevels[topNode] < level) {
+            SBUInteger newNode = tree->runCount + RunTreeAddNode(tree, level);
+
+            /* A closed node of higher level starts the new node as its lowest level is higher. */
+            if (closedNode != NO_ELEMENT) {
+                RunTreeAppend(tree, newNode - tree->runCount, RunTreeRemoveLast(tree, topNode));
+            }
+
+            RunTreeAppend(tree, topNode, newNode);
+            nodeStack[++stackTop] = newNode;
+            topNode = newNode - tree->runCount;
+        }
+
+        RunTreeAppend(tree, topNode, runIndex);
+    }
+}
+
+static void EmitRunTree(RunTreeRef tree, const SBRun *runs, SBRun *output)
+{
+    SBUInteger nodeStack[SBLevelMax + 2];
+    SBUInteger cursorStack[SBLevelMax + 2];
+    SBUInteger depth = 1;
+
+    nodeStack[0] = 0;
+    cursorStack[0] = tree->firstElements[0];
+
+    while (depth > 0) {
+        SBUInteger node = nodeStack[depth - 1];
+        SBUInteger element = cursorStack[depth - 1];
+
+        if (element == NO_ELEMENT) {
+            depth -= 1;
+        } else {
+            /* The elements of a node are reversed once by each level up to its own. */
+            cursorStack[depth - 1] = (tree->nodeLevels[node] & 1
+                                      ? tree->previousElements[element]
+                                      : tree->nextElements[element]);
+
+            if (element < tree->runCount) {
+                *(output++) = runs[element];
+            } else {
+                SBUInteger child = element - tree->runCount;
+
+                nodeStack[depth] = child;
+                cursorStack[depth] = (tree->nodeLevels[child] & 1
+                                      ? tree->lastElements[child]
+                                      : tree->firstElements[child]);
+                depth += 1;
+            }
+        }
+    }
+}
+
+#define NEXT_ELEMENTS     0
+#define PREVIOUS_ELEMENTS 1
+#define FIRST_ELEMENTS    2
+#define LAST_ELEMENTS     3
+#define ORDERED_RUNS      4
+#define NODE_LEVELS       5
+#define COUNT             6
+
+/**
+ * Applies rule L2 in time linear to the number of runs by building a tree of nested level
+ * sequences and visiting it once, instead of reversing the runs once for each level.
+ */
+static void ReorderRuns(SBRun *runs, SBUInteger runCount, SBLevel maxLevel)
+{
+    SBBoolean isReordered = SBFalse;
+
+    /* A single pass is enough when there is only one level to reverse. */
+    if (maxLevel > 1 && runCount > 1) {
+        SBUInteger elementCount = runCount * 2 + 1;
+        SBUInteger nodeCount = runCount + 1;
+        void *pointers[COUNT] = { NULL };
+        SBUInteger sizes[COUNT];
+        Memory memory;
+
+        sizes[NEXT_ELEMENTS]     = sizeof(SBUInteger) * elementCount;
+        sizes[PREVIOUS_ELEMENTS] = sizeof(SBUInteger) * elementCount;
+        sizes[FIRST_ELEMENTS]    = sizeof(SBUInteger) * nodeCount;
+        sizes[LAST_ELEMENTS]     = sizeof(SBUInteger) * nodeCount;
+        sizes[ORDERED_RUNS]      = sizeof(SBRun) * runCount;
+        sizes[NODE_LEVELS]       = sizeof(SBLevel) * nodeCount;
+
+        MemoryInitialize(&memory);
+
+        if (MemoryAllocateChunks(&memory, MemoryTypeScratch, sizes, COUNT, pointers)) {
+            SBRun *orderedRuns = pointers[ORDERED_RUNS];
+            RunTree tree;
+            SBUInteger index;
+
+            tree.nextElements = pointers[NEXT_ELEMENTS];
+            tree.previousElements = pointers[PREVIOUS_ELEMENTS];
+            tree.firstElements = pointers[FIRST_ELEMENTS];
+            tree.lastElements = pointers[LAST_ELEMENTS];
+            tree.nodeLevels = pointers[NODE_LEVELS];
+            tree.runCount = runCount;
+            tree.nodeCount = 0;
+
+            BuildRunTree(&tree, runs);
+            EmitRunTree(&tree, runs, orderedRuns);
+
+            /* Each run and node is visited once for building the tree and once for emitting it. */
+            SB_STATISTICS_ADD(StatisticRunReorderSteps, (runCount + tree.nodeCount) * 2);
+
+            for (index = 0; index < runCount; index++) {
+                runs[index] = orderedRuns[index];
+            }
+
+            isReordered = SBTrue;
+        }
+
+        MemoryFinalize(&memory);
+    }
+
+    if (!isReordered) {
+        ReorderRunsByLevels(runs, runCount, maxLevel);
+    }
+}
+
+#undef NEXT_ELEMENTS
+#undef PREVIOUS_ELEMENTS
+#undef FIRST_ELEMENTS
+#undef LAST_ELEMENTS
+#undef ORDERED_RUNS
+#undef NODE_LEVELS
+#undef COUNT
+#undef NO_ELEMENT
+
+/**
+ * Fills an allocated line from the levels of its range, which MUST have already been reset by rule
+ * L1.
+ */
+static void LayoutLine(SBMutableLineRef line, SBParagraphRef paragraph,
+    const SBLevel *levels, SBUInteger lineOffset, SBUInteger lineLength, SBLevel maxLevel)
+{
+    line->runCount = InitializeRuns(line->fixedRuns, levels, lineLength, lineOffset);
+
+    SB_TRACE_BEGIN(SBTraceStageReordering, lineLength);
+    ReorderRuns(line->fixedRuns, line->runCount, maxLevel);
+    SB_TRACE_END(SBTraceStageReordering, lineLength);
+
+    line->codepointSequence = paragraph->codepointSequence;
+    line->offset = lineOffset;
+    line->length = lineLength;
+}
+
+static SBMutableLineRef CreateLine(SBParagraphRef paragraph,
+    const SBLevel *levels, SBUInteger lineOffset, SBUInteger lineLength)
+{
+    SBMutableLineRef line;
+    SBLevel maxLevel;
+
+    line = AllocateLine(CountRuns(levels, lineLength, &maxLevel));
+
+    if (line) {
+        LayoutLine(line, paragraph, levels, lineOffset, lineLength, maxLevel);
+    }
+
+    return line;
+}
+
+/**
+ * Holds the storage of lines created together, which is freed once all of them are released.
+ */
+typedef struct _LineBatch {
+    ObjectBase _base;
+    SBUInteger lineCount;
+} LineBatch, *LineBatchRef;
+
+#define BATCH 0
+#define LINES 1
+#define RUNS  2
+#define COUNT 3
+
+static LineBatchRef AllocateLineBatch(SBUInteger lineCount, SBUInteger runCount,
+    SBLine **lines, SBRun **runs)
+{
+    void *pointers[COUNT] = { NULL };
+    SBUInteger sizes[COUNT];
+    LineBatchRef batch;
+
+    sizes[BATCH] = sizeof(LineBatch);
+    sizes[LINES] = sizeof(SBLine) * lineCount;
+    sizes[RUNS]  = sizeof(SBRun) * runCount;
+
+    batch = ObjectCreate(sizes, COUNT, pointers, NULL);
+
+    if (batch) {
+        batch->lineCount = lineCount;
+
+        *lines = pointers[LINES];
+        *runs = pointers[RUNS];
+    }
+
+    return batch;
+}
+
+#undef BATCH
+#undef LINES
+#undef RUNS
+#undef COUNT
+
 SB_INTERNAL SBLineRef SBLineCreate(SBParagraphRef paragraph,
     SBUInteger lineOffset, SBUInteger lineLength)
 {
@@ -259,8 +556,8 @@ SB_INTERNAL SBLineRef SBLineCreate(SBParagraphRef paragraph,
     const SBBidiType *refTypes = paragraph->refTypes + innerOffset;
     const SBLevel *refLevels = paragraph->fixedLevels + innerOffset;
     SBMutableLineRef line = NULL;
+    SBLevel *fixedLevels;
     Memory memory;
-    LineContext context;
 
     /* Line range MUST be valid. */
     SBAssert(lineOffset < (lineOffset + lineLength)
@@ -269,23 +566,91 @@ SB_INTERNAL SBLineRef SBLineCreate(SBParagraphRef paragraph,
 
     MemoryInitialize(&memory);
 
-    if (InitializeLineContext(&context, &memory, refTypes, refLevels, lineLength, paragraph->baseLevel)) {
-        line = AllocateLine(context.runCount);
+    fixedLevels = CopyLevels(&memory, refLevels, lineLength);
 
-        if (line) {
-            line->runCount = InitializeRuns(line->fixedRuns, context.fixedLevels, lineLength, lineOffset);
-            ReorderRuns(line->fixedRuns, line->runCount, context.maxLevel);
+    if (fixedLevels) {
+        ResetLevels(fixedLevels, refTypes, lineLength, paragraph->baseLevel);
+        line = CreateLine(paragraph, fixedLevels, lineOffset, lineLength);
+    }
+
+    MemoryFinalize(&memory);
+    SBAllocatorResetScratch(NULL);
+
+    return line;
+}
+
+SB_INTERNAL SBBoolean SBLineCreateBatch(SBParagraphRef paragraph,
+    const SBUInteger *lineBoundaries, SBUInteger lineCount, SBLineRef *lines)
+{
+    SBUInteger batchOffset = lineBoundaries[0];
+    SBUInteger batchLength = lineBoundaries[lineCount] - batchOffset;
+    SBUInteger innerOffset = batchOffset - paragraph->offset;
+    const SBBidiType *refTypes = paragraph->refTypes + innerOffset;
+    SBBoolean isSucceeded = SBFalse;
+    SBLevel *fixedLevels;
+    Memory memory;
+
+    MemoryInitialize(&memory);
+
+    /* Copy the levels of all lines at once as rule L1 affects each line within its own range. */
+    fixedLevels = CopyLevels(&memory, paragraph->fixedLevels + innerOffset, batchLength);
+
+    if (fixedLevels) {
+        SBUInteger totalRuns = 0;
+        SBUInteger lineIndex;
+        LineBatchRef batch;
+        SBLine *batchLines;
+        SBRun *batchRuns;
+        SBLevel maxLevel;
+
+        for (lineIndex = 0; lineIndex < lineCount; lineIndex++) {
+            SBUInteger lineOffset = lineBoundaries[lineIndex];
+            SBUInteger lineLength = lineBoundaries[lineIndex + 1] - lineOffset;
+            SBUInteger levelsOffset = lineOffset - batchOffset;
+
+            ResetLevels(fixedLevels + levelsOffset, refTypes + levelsOffset,
+                        lineLength, paragraph->baseLevel);
+            totalRuns += CountRuns(fixedLevels + levelsOffset, lineLength, &maxLevel);
+        }
+
+        /* Place all lines along with their runs in a single block shared by them. */
+        batch = AllocateLineBatch(lineCount, totalRuns, &batchLines, &batchRuns);
+
+        if (batch) {
+            for (lineIndex = 0; lineIndex < lineCount; lineIndex++) {
+                SBMutableLineRef line = &batchLines[lineIndex];
+                SBUInteger lineOffset = lineBoundaries[lineIndex];
+                SBUInteger lineLength = lineBoundaries[lineIndex + 1] - lineOffset;
+                SBUInteger levelsOffset = lineOffset - batchOffset;
+                SBUInteger runCount;
+
+                runCount = CountRuns(fixedLevels + levelsOffset, lineLength, &maxLevel);
+
+                ObjectInitializeEmbedded(line, FinalizeLine);
+                line->fixedRuns = batchRuns;
+                line->maps = NULL;
+                line->owner = batch;
+
+                LayoutLine(line, paragraph, fixedLevels + levelsOffset,
+                           lineOffset, lineLength, maxLevel);
+
+                /* Each line keeps the batch alive until it is released. */
+                if (lineIndex > 0) {
+                    ObjectRetain(batch);
+                }
 
-            line->codepointSequence = paragraph->codepointSequence;
-            line->offset = lineOffset;
-            line->length = lineLength;
+                lines[lineIndex] = line;
+                batchRuns += runCount;
+            }
+
+            isSucceeded = SBTrue;
         }
     }
 
     MemoryFinalize(&memory);
     SBAllocatorResetScratch(NULL);
 
-    return line;
+    return isSucceeded;
 }
 
 SBUInteger SBLineGetOffset(SBLineRef line)
@@ -308,6 +673,676 @@ const SBRun *SBLineGetRunsPtr(SBLineRef line)
     return line->fixedRuns;
 }
 
+static int CompareRunOffsets(const void *first, const void *second)
+{
+    SBUInteger firstOffset = (*(const SBRun * const *)first)->offset;
+    SBUInteger secondOffset = (*(const SBRun * const *)second)->offset;
+
+    return (firstOffset > secondOffset) - (firstOffset < secondOffset);
+}
+
+static void FillMaps(const LineMaps *maps, const SBRun *runs, SBUInteger runCount,
+    SBUInteger lineOffset)
+{
+    SBUInteger *logicalToVisual = maps->logicalToVisual;
+    SBUInteger *visualToLogical = maps->visualToLogical;
+    SBUInteger visualIndex = 0;
+    SBUInteger runIndex;
+
+    for (runIndex = 0; runIndex < runCount; runIndex++) {
+        const SBRun *run = &runs[runIndex];
+        SBUInteger logicalStart = run->offset - lineOffset;
+        SBUInteger *visualRun = visualToLogical + visualIndex;
+        SBUInteger index;
+
+        /* Code units of a right-to-left run are displayed in reverse order. */
+        if (run->level & 1) {
+            SBUInteger last = logicalStart + run->length - 1;
+
+            for (index = 0; index < run->length; index++) {
+                visualRun[index] = last - index;
+            }
+        } else {
+            for (index = 0; index < run->length; index++) {
+                visualRun[index] = logicalStart + index;
+            }
+        }
+
+        for (index = 0; index < run->length; index++) {
+            logicalToVisual[visualRun[index]] = visualIndex + index;
+        }
+
+        maps->logicalRuns[runIndex] = run;
+        visualIndex += run->length;
+    }
+
+    qsort(maps->logicalRuns, runCount, sizeof(const SBRun *), CompareRunOffsets);
+}
+
+#define MAPS              0
+#define LOGICAL_TO_VISUAL 1
+#define VISUAL_TO_LOGICAL 2
+#define LOGICAL_RUNS      3
+#define COUNT             4
+
+static const LineMaps *GetMaps(SBLineRef line)
+{
+    SBMutableLineRef mutableLine = (SBMutableLineRef)line;
+    LineMaps *maps = AtomicPointerLoad(&mutableLine->maps);
+
+    if (!maps) {
+        SBUInteger sizes[COUNT];
+        SBUInteger offsets[COUNT];
+        SBUInteger totalSize = 0;
+        SBUInteger index;
+        SBUInt8 *block;
+
+        sizes[MAPS]              = sizeof(LineMaps);
+        sizes[LOGICAL_TO_VISUAL] = sizeof(SBUInteger) * line->length;
+        sizes[VISUAL_TO_LOGICAL] = sizeof(SBUInteger) * line->length;
+        sizes[LOGICAL_RUNS]      = sizeof(const SBRun *) * line->runCount;
+
+        for (index = 0; index < COUNT; index++) {
+            offsets[index] = totalSize;
+            totalSize += sizes[index];
+        }
+
+        block = SBAllocatorAllocateBlock(NULL, totalSize);
+
+        if (block) {
+            LineMaps *expected = NULL;
+
+            maps = (LineMaps *)(block + offsets[MAPS]);
+            maps->logicalToVisual = (SBUInteger *)(block + offsets[LOGICAL_TO_VISUAL]);
+            maps->visualToLogical = (SBUInteger *)(block + offsets[VISUAL_TO_LOGICAL]);
+            maps->logicalRuns = (const SBRun **)(block + offsets[LOGICAL_RUNS]);
+
+            FillMaps(maps, line->fixedRuns, line->runCount, line->offset);
+
+            /* Another thread may have published its maps in the meantime. */
+            if (!AtomicPointerCompareAndSet(&mutableLine->maps, &expected, maps)) {
+                SBAllocatorDeallocateBlock(NULL, block);
+                maps = AtomicPointerLoad(&mutableLine->maps);
+            }
+        }
+    }
+
+    return maps;
+}
+
+#undef MAPS
+#undef LOGICAL_TO_VISUAL
+#undef VISUAL_TO_LOGICAL
+#undef LOGICAL_RUNS
+#undef COUNT
+
+const SBUInteger *SBLineGetLogicalToVisualMapPtr(SBLineRef line)
+{
+    const LineMaps *maps = GetMaps(line);
+    return (maps ? maps->logicalToVisual : NULL);
+}
+
+const SBUInteger *SBLineGetVisualToLogicalMapPtr(SBLineRef line)
+{
+    const LineMaps *maps = GetMaps(line);
+    return (maps ? maps->visualToLogical : NULL);
+}
+
+SB_INTERNAL SBBoolean SBLineConvertRuns(SBLineRef line, IndexConverter *converter, SBRun *runs)
+{
+    const SBRun **logicalRuns;
+    SBBoolean isSucceeded = SBFalse;
+    Memory memory;
+
+    MemoryInitialize(&memory);
+
+    /* Only the runs are sorted, so the cost does not depend on the length of the line. */
+    logicalRuns = MemoryAllocateBlock(&memory, MemoryTypeScratch,
+                                      sizeof(const SBRun *) * line->runCount);
+
+    if (logicalRuns) {
+        SBUInteger index;
+
+        for (index = 0; index < line->runCount; index++) {
+            logicalRuns[index] = &line->fixedRuns[index];
+        }
+
+        qsort(logicalRuns, line->runCount, sizeof(const SBRun *), CompareRunOffsets);
+
+        /* Visit the runs in logical order so that the conversion is a single forward walk. */
+        for (index = 0; index < line->runCount; index++) {
+            const SBRun *source = logicalRuns[index];
+            SBRun *destination = &runs[source - line->fixedRuns];
+            SBUInteger start = IndexConverterConvert(converter, source->offset);
+            SBUInteger end = IndexConverterConvert(converter, source->offset + source->length);
+
+            destination->offset = start;
+            destination->length = end - start;
+            destination->level = source->level;
+        }
+
+        isSucceeded = SBTrue;
+    }
+
+    MemoryFinalize(&memory);
+
+    return isSucceeded;
+}
+
+SBBoolean SBLineGetRunsInEncoding(SBLineRef line, SBStringEncoding encoding, SBRun *runs)
+{
+    IndexConverter converter;
+
+    switch (encoding) {
+    case SBStringEncodingUTF8:
+    case SBStringEncodingUTF16:
+    case SBStringEncodingUTF32:
+        break;
+
+    default:
+        return SBFalse;
+    }
+
+    IndexConverterInitialize(&converter, &line->codepointSequence,
+        line->codepointSequence.stringEncoding, encoding);
+
+    return SBLineConvertRuns(line, &converter, runs);
+}
+
+/**
+ * Returns the position in logical order of the run holding the code unit at the given index.
+ */
+static SBUInteger FindLogicalRun(SBLineRef line, const LineMaps *maps, SBUInteger stringIndex)
+{
+    SBUInteger low = 0;
+    SBUInteger high = line->runCount;
+
+    /* Find the last run in logical order starting at or before the index. */
+    while (high - low > 1) {
+        SBUInteger mid = low + (high - low) / 2;
+
+        if (maps->logicalRuns[mid]->offset <= stringIndex) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+SBBoolean SBLineFindRun(SBLineRef line, SBUInteger stringIndex,
+    SBUInteger *runIndex, SBUInteger *visualIndex)
+{
+    const LineMaps *maps;
+
+    if (stringIndex < line->offset || stringIndex >= line->offset + line->length) {
+        return SBFalse;
+    }
+
+    maps = GetMaps(line);
+    if (!maps) {
+        return SBFalse;
+    }
+
+    if (runIndex) {
+        SBUInteger logicalIndex = FindLogicalRun(line, maps, stringIndex);
+        *runIndex = (SBUInteger)(maps->logicalRuns[logicalIndex] - line->fixedRuns);
+    }
+    if (visualIndex) {
+        *visualIndex = maps->logicalToVisual[stringIndex - line->offset];
+    }
+
+    return SBTrue;
+}
+
+static int CompareVisualSegments(const void *first, const void *second)
+{
+    SBUInteger firstOffset = ((const SBVisualSegment *)first)->visualOffset;
+    SBUInteger secondOffset = ((const SBVisualSegment *)second)->visualOffset;
+
+    return (firstOffset > secondOffset) - (firstOffset < secondOffset);
+}
+
+SBUInteger SBLineGetVisualSegments(SBLineRef line, SBUInteger rangeOffset, SBUInteger rangeLength,
+    SBVisualSegment *segments, SBUInteger maxCount)
+{
+    SBUInteger lineOffset = line->offset;
+    SBUInteger lineLimit = lineOffset + line->length;
+    SBUInteger rangeLimit;
+    const LineMaps *maps;
+    SBUInteger firstRun;
+    SBUInteger lastRun;
+    SBUInteger segmentCount;
+    SBUInteger index;
+
+    /* Clip the range to the line. */
+    if (rangeOffset < lineOffset) {
+        rangeLength = (rangeLength > lineOffset - rangeOffset
+                       ? rangeLength - (lineOffset - rangeOffset)
+                       : 0);
+        rangeOffset = lineOffset;
+    }
+    if (rangeOffset >= lineLimit || rangeLength == 0) {
+        return 0;
+    }
+    rangeLimit = (rangeLength > lineLimit - rangeOffset ? lineLimit : rangeOffset + rangeLength);
+
+    maps = GetMaps(line);
+    if (!maps) {
+        return 0;
+    }
+
+    firstRun = FindLogicalRun(line, maps, rangeOffset);
+    lastRun = FindLogicalRun(line, maps, rangeLimit - 1);
+    segmentCount = lastRun - firstRun + 1;
+
+    if (segmentCount > maxCount) {
+        return segmentCount;
+    }
+
+    for (index = 0; index < segmentCount; index++) {
+        const SBRun *run = maps->logicalRuns[firstRun + index];
+        SBUInteger start = (run->offset > rangeOffset ? run->offset : rangeOffset);
+        SBUInteger limit = run->offset + run->length;
+        SBVisualSegment *segment = &segments[index];
+
+        if (limit > rangeLimit) {
+            limit = rangeLimit;
+        }
+
+        /* The leftmost code unit of a right-to-left segment is its logically last one. */
+        if (run->level & 1) {
+            segment->visualOffset = maps->logicalToVisual[limit - 1 - lineOffset];
+        } else {
+            segment->visualOffset = maps->logicalToVisual[start - lineOffset];
+        }
+        segment->length = limit - start;
+        segment->level = run->level;
+    }
+
+    if (segmentCount > 1) {
+        SBUInteger mergedCount = 1;
+
+        qsort(segments, segmentCount, sizeof(SBVisualSegment), CompareVisualSegments);
+
+        /* Merge the visually adjacent segments of the same level. */
+        for (index = 1; index < segmentCount; index++) {
+            SBVisualSegment *previous = &segments[mergedCount - 1];
+            const SBVisualSegment *current = &segments[index];
+
+            if (previous->level == current->level
+                && previous->visualOffset + previous->length == current->visualOffset) {
+                previous->length += current->length;
+            } else {
+                segments[mergedCount++] = *current;
+            }
+        }
+
+        segmentCount = mergedCount;
+    }
+
+    return segmentCount;
+}
+
+static SBBoolean IsRightToLeftAt(SBLineRef line, const LineMaps *maps, SBUInteger stringIndex)
+{
+    return (maps->logicalRuns[FindLogicalRun(line, maps, stringIndex)]->level & 1);
+}
+
+/**
+ * Returns the visual position of a caret, counted in boundaries between visual code units.
+ */
+static SBUInteger GetCaretVisualIndex(SBLineRef line, const LineMaps *maps, const SBCaret *caret)
+{
+    SBUInteger lineOffset = line->offset;
+    SBUInteger stringIndex = caret->index;
+    SBUInteger visualIndex;
+
+    if ((caret->affinity == SBCaretAffinityDownstream && stringIndex < lineOffset + line->length)
+        || stringIndex == lineOffset) {
+        /* The caret is at the logically leading edge of the following code unit. */
+        visualIndex = maps->logicalToVisual[stringIndex - lineOffset];
+
+        if (IsRightToLeftAt(line, maps, stringIndex)) {
+            visualIndex += 1;
+        }
+    } else {
+        /* The caret is at the logically trailing edge of the preceding code unit. */
+        visualIndex = maps->logicalToVisual[stringIndex - 1 - lineOffset];
+
+        if (!IsRightToLeftAt(line, maps, stringIndex - 1)) {
+            visualIndex += 1;
+        }
+    }
+
+    return visualIndex;
+}
+
+SBBoolean SBLineMoveCaret(SBLineRef line, const SBCaret *caret,
+    SBCaretDirection direction, SBCaret *result)
+{
+    const SBCodepointSequence *sequence = &line->codepointSequence;
+    SBUInteger lineOffset = line->offset;
+    SBUInteger visualIndex;
+    SBUInteger crossedIndex;
+    SBUInteger codepointStart;
+    SBUInteger codepointEnd;
+    SBBoolean isRightToLeft;
+    SBBoolean isLeadingEdge;
+    const LineMaps *maps;
+
+    if (caret->index < lineOffset || caret->index > lineOffset + line->length) {
+        return SBFalse;
+    }
+
+    maps = GetMaps(line);
+    if (!maps) {
+        return SBFalse;
+    }
+
+    visualIndex = GetCaretVisualIndex(line, maps, caret);
+
+    /* Find the code unit to be crossed. */
+    if (direction == SBCaretDirectionRight) {
+        if (visualIndex == line->length) {
+            return SBFalse;
+        }
+        crossedIndex = maps->visualToLogical[visualIndex];
+    } else {
+        if (visualIndex == 0) {
+            return SBFalse;
+        }
+        crossedIndex = maps->visualToLogical[visualIndex - 1];
+    }
+    crossedIndex += lineOffset;
+
+    /* Cross the whole code point, which lies in a single run. */
+    codepointStart = crossedIndex;
+    SBCodepointSkipToStart(sequence->stringBuffer, sequence->stringLength,
+                           sequence->stringEncoding, &codepointStart);
+    if (codepointStart < lineOffset) {
+        codepointStart = lineOffset;
+    }
+    codepointEnd = codepointStart;
+    SBCodepointSequenceGetCodepointAt(sequence, &codepointEnd);
+    if (codepointEnd > lineOffset + line->length) {
+        codepointEnd = lineOffset + line->length;
+    }
+
+    isRightToLeft = IsRightToLeftAt(line, maps, crossedIndex);
+    /* The caret ends up at the left edge when moving left and at the right edge otherwise. */
+    isLeadingEdge = ((direction == SBCaretDirectionLeft) != isRightToLeft);
+
+    if (isLeadingEdge) {
+        result->index = codepointStart;
+        result->affinity = SBCaretAffinityDownstream;
+    } else {
+        result->index = codepointEnd;
+        result->affinity = SBCaretAffinityUpstream;
+    }
+
+    return SBTrue;
+}
+
+typedef union _CodeUnits {
+    SBUInt8 utf8[4];
+    SBUInt16 utf16[2];
+    SBUInt32 utf32[1];
+} CodeUnits;
+
+static SBUInteger EncodeCodepoint(SBCodepoint codepoint, SBStringEncoding encoding,
+    CodeUnits *codeUnits)
+{
+    switch (encoding) {
+    case SBStringEncodingUTF8:
+        if (codepoint < 0x80) {
+            codeUnits->utf8[0] = (SBUInt8)codepoint;
+            return 1;
+        }
+        if (codepoint < 0x800) {
+            codeUnits->utf8[0] = (SBUInt8)(0xC0 | (codepoint >> 6));
+            codeUnits->utf8[1] = (SBUInt8)(0x80 | (codepoint & 0x3F));
+            return 2;
+        }
+        if (codepoint < 0x10000) {
+            codeUnits->utf8[0] = (SBUInt8)(0xE0 | (codepoint >> 12));
+            codeUnits->utf8[1] = (SBUInt8)(0x80 | ((codepoint >> 6) & 0x3F));
+            codeUnits->utf8[2] = (SBUInt8)(0x80 | (codepoint & 0x3F));
+            return 3;
+        }
+        codeUnits->utf8[0] = (SBUInt8)(0xF0 | (codepoint >> 18));
+        codeUnits->utf8[1] = (SBUInt8)(0x80 | ((codepoint >> 12) & 0x3F));
+        codeUnits->utf8[2] = (SBUInt8)(0x80 | ((codepoint >> 6) & 0x3F));
+        codeUnits->utf8[3] = (SBUInt8)(0x80 | (codepoint & 0x3F));
+        return 4;
+
+    case SBStringEncodingUTF16:
+        if (codepoint < 0x10000) {
+            codeUnits->utf16[0] = (SBUInt16)codepoint;
+            return 1;
+        }
+        codepoint -= 0x10000;
+        codeUnits->utf16[0] = (SBUInt16)(0xD800 | (codepoint >> 10));
+        codeUnits->utf16[1] = (SBUInt16)(0xDC00 | (codepoint & 0x3FF));
+        return 2;
+
+    case SBStringEncodingUTF32:
+        codeUnits->utf32[0] = codepoint;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Writes the code points of a right-to-left run in reverse order, decoding them forward so that
+ * malformed sequences are split exactly as in the rest of the library.
+ */
+static void WriteReversedRun(const SBCodepointSequence *sequence, const SBRun *run,
+    SBUInteger unitSize, SBUInt8 *output)
+{
+    const SBUInt8 *input = sequence->stringBuffer;
+    SBUInteger runLimit = run->offset + run->length;
+    SBUInteger stringIndex = run->offset;
+    SBCodepointSequence runSequence;
+
+    /* Decode within the run so that a sequence cut by its end is copied as it is. */
+    runSequence = *sequence;
+    runSequence.stringLength = runLimit;
+    sequence = &runSequence;
+
+    while (stringIndex < runLimit) {
+        SBUInteger startIndex = stringIndex;
+        SBCodepoint codepoint = SBCodepointSequenceGetCodepointAt(sequence, &stringIndex);
+        SBCodepoint mirror = LookupMirror(codepoint);
+        SBUInteger unitCount;
+        SBUInt8 *target;
+
+        if (codepoint == '\r' && stringIndex < runLimit) {
+            SBUInteger nextIndex = stringIndex;
+
+            /* Don't separate 'CR' and 'LF'. */
+            if (SBCodepointSequenceGetCodepointAt(sequence, &nextIndex) == '\n') {
+                stringIndex = nextIndex;
+            }
+        }
+
+        unitCount = stringIndex - startIndex;
+        target = output + (runLimit - stringIndex) * unitSize;
+
+        if (mirror) {
+            CodeUnits codeUnits;
+
+            if (EncodeCodepoint(mirror, sequence->stringEncoding, &codeUnits) == unitCount) {
+                memcpy(target, &codeUnits, unitCount * unitSize);
+                continue;
+            }
+        }
+
+        memcpy(target, input + startIndex * unitSize, unitCount * unitSize);
+    }
+}
+
+SBUInteger SBLineGetVisualCodeUnits(SBLineRef line, void *buffer, SBUInteger capacity)
+{
+    const SBCodepointSequence *sequence = &line->codepointSequence;
+    const SBUInt8 *input = sequence->stringBuffer;
+    SBUInt8 *output = buffer;
+    SBUInteger unitSize = 0;
+    SBUInteger runIndex;
+
+    switch (sequence->stringEncoding) {
+    case SBStringEncodingUTF8:
+        unitSize = sizeof(SBUInt8);
+        break;
+    case SBStringEncodingUTF16:
+        unitSize = sizeof(SBUInt16);
+        break;
+    case SBStringEncodingUTF32:
+        unitSize = sizeof(SBUInt32);
+        break;
+    }
+
+    if (!buffer || capacity < line->length) {
+        return line->length;
+    }
+
+    for (runIndex = 0; runIndex < line->runCount; runIndex++) {
+        const SBRun *run = &line->fixedRuns[runIndex];
+
+        if (run->level & 1) {
+            WriteReversedRun(sequence, run, unitSize, output);
+        } else {
+            memcpy(output, input + run->offset * unitSize, run->length * unitSize);
+        }
+
+        output += run->length * unitSize;
+    }
+
+    return line->length;
+}
+
+static void CopyElements(SBUInt8 *destination, const SBUInt8 *source,
+    SBUInteger count, SBUInteger elementSize, SBUInteger stride)
+{
+    if (stride == elementSize) {
+        memcpy(destination, source, count * elementSize);
+    } else {
+        SBUInteger index;
+
+        for (index = 0; index < count; index++) {
+            memcpy(destination + index * stride, source + index * stride, elementSize);
+        }
+    }
+}
+
+#define REVERSE_ELEMENTS(type, destination, source, count)      \
+{                                                               \
+    type *output = (type *)(destination);                       \
+    const type *input = (const type *)(source) + (count);       \
+    SBUInteger remaining = (count);                             \
+                                                                \
+    while (remaining--) {                                       \
+        *(output++) = *(--input);                               \
+    }                                                           \
+}
+
+static void ReverseElements(SBUInt8 *destination, const SBUInt8 *source,
+    SBUInteger count, SBUInteger elementSize, SBUInteger stride)
+{
+    /* Use typed loops for packed arrays of aligned primitives so that they can be vectorized. */
+    if (stride == elementSize
+        && ((SBUInteger)destination % elementSize) == 0
+        && ((SBUInteger)source % elementSize) == 0) {
+        switch (elementSize) {
+        case 1:
+            REVERSE_ELEMENTS(SBUInt8, destination, source, count);
+            return;
+        case 2:
+            REVERSE_ELEMENTS(SBUInt16, destination, source, count);
+            return;
+        case 4:
+            REVERSE_ELEMENTS(SBUInt32, destination, source, count);
+            return;
+        case 8:
+            REVERSE_ELEMENTS(SBUInt64, destination, source, count);
+            return;
+        }
+    }
+
+    {
+        SBUInteger index;
+
+        for (index = 0; index < count; index++) {
+            memcpy(destination + index * stride,
+                   source + (count - index - 1) * stride, elementSize);
+        }
+    }
+}
+
+#undef REVERSE_ELEMENTS
+
+static SBUInteger FindFirstElement(const SBUInteger *clusterMap, SBUInteger elementCount,
+    SBUInteger codeUnitIndex)
+{
+    SBUInteger low = 0;
+    SBUInteger high = elementCount;
+
+    while (low < high) {
+        SBUInteger mid = low + (high - low) / 2;
+
+        if (clusterMap[mid] < codeUnitIndex) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+SBBoolean SBLineReorderElements(SBLineRef line, const void *source, void *destination,
+    SBUInteger elementCount, SBUInteger elementSize, SBUInteger stride,
+    const SBUInteger *clusterMap)
+{
+    const SBUInt8 *input = source;
+    SBUInt8 *output = destination;
+    SBUInteger runIndex;
+
+    if (elementSize == 0 || stride < elementSize) {
+        return SBFalse;
+    }
+    if (!clusterMap && elementCount != line->length) {
+        return SBFalse;
+    }
+
+    for (runIndex = 0; runIndex < line->runCount; runIndex++) {
+        const SBRun *run = &line->fixedRuns[runIndex];
+        SBUInteger runStart = run->offset - line->offset;
+        SBUInteger first;
+        SBUInteger count;
+
+        if (clusterMap) {
+            first = FindFirstElement(clusterMap, elementCount, runStart);
+            count = FindFirstElement(clusterMap, elementCount, runStart + run->length) - first;
+        } else {
+            first = runStart;
+            count = run->length;
+        }
+
+        if (run->level & 1) {
+            ReverseElements(output, input + first * stride, count, elementSize, stride);
+        } else {
+            CopyElements(output, input + first * stride, count, elementSize, stride);
+        }
+
+        output += count * stride;
+    }
+
+    return SBTrue;
+}
+
 SBLineRef SBLineRetain(SBLineRef line)
 {
     return ObjectRetain((ObjectRef)line);
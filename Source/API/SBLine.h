@@ -23,12 +23,25 @@
 #include <SheenBidi/SBRun.h>
 
 #include <API/SBBase.h>
+#include <API/SBCodepointSequence.h>
+#include <Core/AtomicPointer.h>
 #include <Core/Object.h>
 
+/**
+ * Index tables of a line, built lazily in a single block on first request.
+ */
+typedef struct _LineMaps {
+    SBUInteger *logicalToVisual;
+    SBUInteger *visualToLogical;
+    const SBRun **logicalRuns;  /**< Runs sorted by their offsets. */
+} LineMaps;
+
 typedef struct _SBLine {
     ObjectBase _base;
     SBCodepointSequence codepointSequence;
     SBRun *fixedRuns;
+    AtomicPointerType(LineMaps) maps;
+    ObjectRef owner;            /**< Object holding the storage of a batched line, or NULL. */
     SBUInteger runCount;
     SBUInteger offset;
     SBUInteger length;
@@ -37,4 +50,17 @@ typedef struct _SBLine {
 SB_INTERNAL SBLineRef SBLineCreate(SBParagraphRef paragraph,
     SBUInteger lineOffset, SBUInteger lineLength);
 
+SB_INTERNAL SBBoolean SBLineCreateBatch(SBParagraphRef paragraph,
+    const SBUInteger *lineBoundaries, SBUInteger lineCount, SBLineRef *lines);
+
+/**
+ * Copies the runs of the line in the same order with their offsets and lengths translated by the
+ * given converter, visiting them in logical order so that the converter walks only forward.
+ *
+ * @return
+ *      `SBTrue` if the runs were copied, `SBFalse` if the memory for ordering them could not be
+ *      allocated.
+ */
+SB_INTERNAL SBBoolean SBLineConvertRuns(SBLineRef line, IndexConverter *converter, SBRun *runs);
+
 #endif
@@ -65,11 +65,38 @@ const SBMirrorAgent *SBMirrorLocatorGetAgent(SBMirrorLocatorRef locator)
     return &locator->agent;
 }
 
-SBBoolean SBMirrorLocatorMoveNext(SBMirrorLocatorRef locator)
+/**
+ * Bitmap of ASCII code points having a mirror, letting the common case of plain ASCII text be
+ * skipped without decoding or looking up the pairing data.
+ */
+static const SBUInt32 ASCIIMirrorBitmap[4] = {
+    0x00000000, 0x50000300, 0x28000000, 0x28000000
+};
+
+#define IsASCIIMirrorCandidate(codeUnit) \
+    (ASCIIMirrorBitmap[(codeUnit) >> 5] & ((SBUInt32)1 << ((codeUnit) & 0x1F)))
+
+static SBUInteger GetCodeUnitAt(const SBCodepointSequence *sequence, SBUInteger index)
+{
+    switch (sequence->stringEncoding) {
+    case SBStringEncodingUTF8:
+        return ((const SBUInt8 *)sequence->stringBuffer)[index];
+    case SBStringEncodingUTF16:
+        return ((const SBUInt16 *)sequence->stringBuffer)[index];
+    case SBStringEncodingUTF32:
+        return ((const SBUInt32 *)sequence->stringBuffer)[index];
+    }
+
+    return 0;
+}
+
+static SBUInteger LocateMirrors(SBMirrorLocatorRef locator, SBMirrorAgent *agents,
+    SBUInteger maxCount)
 {
     SBLineRef line = locator->_line;
+    SBUInteger count = 0;
 
-    if (line) {
+    if (line && maxCount > 0) {
         const SBCodepointSequence *sequence = &line->codepointSequence;
 
         do {
@@ -86,30 +113,65 @@ SBBoolean SBMirrorLocatorMoveNext(SBMirrorLocatorRef locator)
                 stringLimit = run->offset + run->length;
 
                 while (stringIndex < stringLimit) {
-                    SBUInteger initialIndex = stringIndex;
-                    SBCodepoint codepoint = SBCodepointSequenceGetCodepointAt(sequence, &stringIndex);
-                    SBCodepoint mirror = LookupMirror(codepoint);
+                    SBUInteger codeUnit = GetCodeUnitAt(sequence, stringIndex);
+                    SBUInteger initialIndex;
+                    SBCodepoint codepoint;
+                    SBCodepoint mirror;
+
+                    if (codeUnit < 0x80 && !IsASCIIMirrorCandidate(codeUnit)) {
+                        stringIndex += 1;
+                        continue;
+                    }
 
-                    if (mirror) {
-                        locator->_stringIndex = stringIndex;
-                        locator->agent.index = initialIndex;
-                        locator->agent.mirror = mirror;
-                        locator->agent.codepoint = codepoint;
+                    initialIndex = stringIndex;
+                    codepoint = SBCodepointSequenceGetCodepointAt(sequence, &stringIndex);
+                    mirror = LookupMirror(codepoint);
 
-                        return SBTrue;
+                    if (mirror) {
+                        SBMirrorAgent *agent = &agents[count++];
+                        agent->index = initialIndex;
+                        agent->mirror = mirror;
+                        agent->codepoint = codepoint;
+
+                        if (count == maxCount) {
+                            locator->_stringIndex = stringIndex;
+                            return count;
+                        }
                     }
                 }
             }
-            
+
             locator->_stringIndex = SBInvalidIndex;
         } while (++locator->_runIndex < line->runCount);
-        
+
+        locator->_runIndex = 0;
+        locator->_stringIndex = SBInvalidIndex;
+    }
+
+    return count;
+}
+
+#undef IsASCIIMirrorCandidate
+
+SBBoolean SBMirrorLocatorMoveNext(SBMirrorLocatorRef locator)
+{
+    if (LocateMirrors(locator, &locator->agent, 1)) {
+        return SBTrue;
+    }
+
+    if (locator->_line) {
         SBMirrorLocatorReset(locator);
     }
-    
+
     return SBFalse;
 }
 
+SBUInteger SBMirrorLocatorGetMirrors(SBMirrorLocatorRef locator,
+    SBMirrorAgent *agents, SBUInteger maxCount)
+{
+    return LocateMirrors(locator, agents, maxCount);
+}
+
 void SBMirrorLocatorReset(SBMirrorLocatorRef locator)
 {
     locator->_runIndex = 0;
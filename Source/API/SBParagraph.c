@@ -16,6 +16,7 @@
 
 
 #include <stddef.h>
+#include <string.h>
 
 #include <API/SBAlgorithm.h>
 #include <API/SBAllocator.h>
@@ -24,11 +25,14 @@
 #include <API/SBCodepointSequence.h>
 #include <API/SBLine.h>
 #include <API/SBLog.h>
+#include <API/SBStatistics.h>
+#include <API/SBTrace.h>
 #include <Core/Memory.h>
 #include <Core/Object.h>
 #include <UBA/BidiChain.h>
 #include <UBA/IsolatingRun.h>
 #include <UBA/LevelRun.h>
+#include <UBA/ResolutionBudget.h>
 #include <UBA/RunQueue.h>
 #include <UBA/StatusStack.h>
 
@@ -41,6 +45,7 @@ typedef struct _ParagraphContext {
     StatusStack statusStack;
     RunQueue runQueue;
     IsolatingRun isolatingRun;
+    ResolutionBudgetRef budget;
 } ParagraphContext, *ParagraphContextRef;
 
 static void PopulateBidiChain(BidiChainRef chain, const SBBidiType *types, SBUInteger length);
@@ -102,6 +107,7 @@ static SBMutableParagraphRef AllocateParagraph(SBUInteger length)
     paragraph = ObjectCreate(sizes, COUNT, pointers, FinalizeParagraph);
 
     if (paragraph) {
+        paragraph->_algorithm = NULL;
         paragraph->fixedLevels = pointers[LEVELS];
     }
 
@@ -124,21 +130,21 @@ static void FinalizeParagraph(ObjectRef object)
     }
 }
 
-static SBUInteger DetermineBoundary(const SBCodepointSequence *codepointSequence,
-    const SBBidiType *bidiTypes, SBUInteger paragraphOffset, SBUInteger suggestedLength)
+static SBUInteger DetermineBoundary(SBAlgorithmRef algorithm,
+    const SBCodepointSequence *codepointSequence, const SBBidiType *bidiTypes,
+    SBUInteger paragraphOffset, SBUInteger suggestedLength)
 {
-    SBUInteger suggestedLimit = paragraphOffset + suggestedLength;
-    SBUInteger stringIndex;
+    SBUInteger actualLength;
 
-    for (stringIndex = paragraphOffset; stringIndex < suggestedLimit; stringIndex++) {
-        if (bidiTypes[stringIndex] == SBBidiTypeB) {
-            stringIndex += SBCodepointSequenceGetSeparatorLength(codepointSequence, stringIndex);
-            goto Return;
-        }
+    if (algorithm) {
+        SBAlgorithmFindParagraphBoundary(algorithm, paragraphOffset, suggestedLength,
+                                         &actualLength, NULL);
+    } else {
+        SBCodepointSequenceGetParagraphBoundary(codepointSequence, bidiTypes,
+            paragraphOffset, suggestedLength, &actualLength, NULL);
     }
 
-Return:
-    return (stringIndex - paragraphOffset);
+    return actualLength;
 }
 
 static void PopulateBidiChain(BidiChainRef chain, const SBBidiType *types, SBUInteger length)
@@ -185,7 +191,8 @@ AddLast:
     BidiChainAdd(chain, SBBidiTypeNil, index - priorIndex);
 }
 
-static BidiLink SkipIsolatingRun(BidiChainRef chain, BidiLink skipLink, BidiLink breakLink)
+static BidiLink SkipIsolatingRun(BidiChainRef chain, BidiLink skipLink, BidiLink breakLink,
+    ResolutionBudgetRef budget)
 {
     BidiLink link = skipLink;
     SBUInteger depth = 1;
@@ -193,6 +200,10 @@ static BidiLink SkipIsolatingRun(BidiChainRef chain, BidiLink skipLink, BidiLink
     while ((link = BidiChainGetNext(chain, link)) != breakLink) {
         SBBidiType type = BidiChainGetType(chain, link);
 
+        if (budget && !ResolutionBudgetSpend(budget, 1)) {
+            break;
+        }
+
         switch (type) {
         case SBBidiTypeLRI:
         case SBBidiTypeRLI:
@@ -211,7 +222,8 @@ static BidiLink SkipIsolatingRun(BidiChainRef chain, BidiLink skipLink, BidiLink
     return BidiLinkNone;
 }
 
-static SBLevel DetermineBaseLevel(BidiChainRef chain, BidiLink skipLink, BidiLink breakLink, SBLevel defaultLevel, SBBoolean isIsolate)
+static SBLevel DetermineBaseLevel(BidiChainRef chain, BidiLink skipLink, BidiLink breakLink,
+    SBLevel defaultLevel, SBBoolean isIsolate, ResolutionBudgetRef budget)
 {
     BidiLink link = skipLink;
 
@@ -219,6 +231,11 @@ static SBLevel DetermineBaseLevel(BidiChainRef chain, BidiLink skipLink, BidiLin
     while ((link = BidiChainGetNext(chain, link)) != breakLink) {
         SBBidiType type = BidiChainGetType(chain, link);
 
+        /* The caller checks the budget, so the level is irrelevant once it is exhausted. */
+        if (budget && !ResolutionBudgetSpend(budget, 1)) {
+            break;
+        }
+
         switch (type) {
         case SBBidiTypeL:
             return 0;
@@ -230,7 +247,7 @@ static SBLevel DetermineBaseLevel(BidiChainRef chain, BidiLink skipLink, BidiLin
         case SBBidiTypeLRI:
         case SBBidiTypeRLI:
         case SBBidiTypeFSI:
-            link = SkipIsolatingRun(chain, link, breakLink);
+            link = SkipIsolatingRun(chain, link, breakLink, budget);
             if (link == BidiLinkNone) {
                 goto Default;
             }
@@ -258,7 +275,7 @@ static SBLevel DetermineParagraphLevel(BidiChainRef chain, SBLevel baseLevel)
     if (baseLevel >= SBLevelMax) {
         return DetermineBaseLevel(chain, chain->roller, chain->roller,
                                   (baseLevel != SBLevelDefaultRTL ? 0 : 1),
-                                  SBFalse);
+                                  SBFalse, NULL);
     }
 
     return baseLevel;
@@ -302,6 +319,10 @@ static SBBoolean DetermineLevels(ParagraphContextRef context, SBLevel baseLevel)
         SBBoolean bnEquivalent = SBFalse;
         SBBidiType type;
 
+        if (context->budget && !ResolutionBudgetSpend(context->budget, 1)) {
+            return SBFalse;
+        }
+
         type = BidiChainGetType(chain, link);
 
 #define LeastGreaterOddLevel()                                              \
@@ -332,6 +353,8 @@ static SBBoolean DetermineLevels(ParagraphContextRef context, SBLevel baseLevel)
                 return SBFalse;                                             \
             }                                                               \
         } else {                                                            \
+            SB_STATISTICS_INCREMENT(StatisticLevelLimitHits);               \
+                                                                            \
             if (!overIsolate) {                                             \
                 overEmbedding += 1;                                         \
             }                                                               \
@@ -353,6 +376,7 @@ static SBBoolean DetermineLevels(ParagraphContextRef context, SBLevel baseLevel)
                 return SBFalse;                                             \
             }                                                               \
         } else {                                                            \
+            SB_STATISTICS_INCREMENT(StatisticLevelLimitHits);               \
             overIsolate += 1;                                               \
         }                                                                   \
                                                                             \
@@ -396,7 +420,12 @@ static SBBoolean DetermineLevels(ParagraphContextRef context, SBLevel baseLevel)
         /* Rule X5c */
         case SBBidiTypeFSI:
         {
-            SBBoolean isRTL = (DetermineBaseLevel(chain, link, roller, 0, SBTrue) == 1);
+            SBBoolean isRTL = (DetermineBaseLevel(chain, link, roller, 0, SBTrue, context->budget) == 1);
+
+            if (context->budget && context->budget->isExhausted) {
+                return SBFalse;
+            }
+
             PushIsolate(isRTL ? LeastGreaterOddLevel() : LeastGreaterEvenLevel(), SBBidiTypeON);
             break;
         }
@@ -579,7 +608,7 @@ static void SaveLevels(BidiChainRef chain, SBLevel *levels, SBLevel baseLevel)
 
 static SBBoolean ResolveParagraph(SBMutableParagraphRef paragraph, MemoryRef memory,
     const SBCodepointSequence *codepointSequence, const SBBidiType *refBidiTypes,
-    SBUInteger offset, SBUInteger length, SBLevel baseLevel)
+    SBUInteger offset, SBUInteger length, SBLevel baseLevel, ResolutionBudgetRef budget)
 {
     const SBBidiType *bidiTypes = &refBidiTypes[offset];
     SBBoolean isSucceeded = SBFalse;
@@ -597,8 +626,15 @@ static SBBoolean ResolveParagraph(SBMutableParagraphRef paragraph, MemoryRef mem
         context.isolatingRun.bidiChain = &context.bidiChain;
         context.isolatingRun.paragraphOffset = offset;
         context.isolatingRun.paragraphLevel = resolvedLevel;
+        context.isolatingRun.budget = budget;
+        /* Explicit levels are resolved without counting the work when nothing limits it. */
+        context.budget = (ResolutionBudgetIsLimited(budget) ? budget : NULL);
+
+        SB_TRACE_BEGIN(SBTraceStageExplicitLevels, length);
+        isSucceeded = DetermineLevels(&context, resolvedLevel);
+        SB_TRACE_END(SBTraceStageExplicitLevels, length);
 
-        if (DetermineLevels(&context, resolvedLevel)) {
+        if (isSucceeded) {
             SaveLevels(&context.bidiChain, paragraph->fixedLevels, resolvedLevel);
 
             SB_LOG_BLOCK_OPENER("Determined Embedding Levels");
@@ -610,19 +646,90 @@ static SBBoolean ResolveParagraph(SBMutableParagraphRef paragraph, MemoryRef mem
             paragraph->offset = offset;
             paragraph->length = length;
             paragraph->baseLevel = resolvedLevel;
+            paragraph->isDegraded = SBFalse;
 
-            isSucceeded = SBTrue;
+            SB_STATISTICS_INCREMENT(StatisticParagraphsResolved);
         }
     }
 
     return isSucceeded;
 }
 
+/**
+ * Applies Rules P2-P3 directly on the bidi types, without building a bidi chain.
+ */
+static SBLevel DetermineFallbackLevel(const SBBidiType *bidiTypes, SBUInteger length,
+    SBLevel baseLevel)
+{
+    SBUInteger isolateDepth = 0;
+    SBUInteger index;
+
+    if (baseLevel < SBLevelMax) {
+        return baseLevel;
+    }
+
+    for (index = 0; index < length; index++) {
+        switch (bidiTypes[index]) {
+        case SBBidiTypeL:
+            if (isolateDepth == 0) {
+                return 0;
+            }
+            break;
+
+        case SBBidiTypeR:
+        case SBBidiTypeAL:
+            if (isolateDepth == 0) {
+                return 1;
+            }
+            break;
+
+        case SBBidiTypeLRI:
+        case SBBidiTypeRLI:
+        case SBBidiTypeFSI:
+            isolateDepth += 1;
+            break;
+
+        case SBBidiTypePDI:
+            if (isolateDepth > 0) {
+                isolateDepth -= 1;
+            }
+            break;
+        }
+    }
+
+    return (baseLevel != SBLevelDefaultRTL ? 0 : 1);
+}
+
+/**
+ * Gives all code units of the paragraph its base level, for use when a resolution limit is hit.
+ */
+static void DegradeParagraph(SBMutableParagraphRef paragraph,
+    const SBCodepointSequence *codepointSequence, const SBBidiType *refBidiTypes,
+    SBUInteger offset, SBUInteger length, SBLevel baseLevel)
+{
+    const SBBidiType *bidiTypes = &refBidiTypes[offset];
+    SBLevel resolvedLevel = DetermineFallbackLevel(bidiTypes, length, baseLevel);
+    SBUInteger index;
+
+    for (index = 0; index < length; index++) {
+        paragraph->fixedLevels[index] = resolvedLevel;
+    }
+
+    paragraph->codepointSequence = *codepointSequence;
+    paragraph->refTypes = bidiTypes;
+    paragraph->offset = offset;
+    paragraph->length = length;
+    paragraph->baseLevel = resolvedLevel;
+    paragraph->isDegraded = SBTrue;
+}
+
 static SBParagraphRef CreateParagraph(SBAlgorithmRef algorithm,
     const SBCodepointSequence *codepointSequence, const SBBidiType *refBidiTypes,
-    SBUInteger paragraphOffset, SBUInteger suggestedLength, SBLevel baseLevel)
+    SBUInteger paragraphOffset, SBUInteger suggestedLength, SBLevel baseLevel,
+    const SBParagraphLimits *limits)
 {
     SBUInteger actualLength;
+    SBBoolean isOverLength;
     SBMutableParagraphRef paragraph;
 
     if (algorithm) {
@@ -636,23 +743,50 @@ static SBParagraphRef CreateParagraph(SBAlgorithmRef algorithm,
     SB_LOG_STATEMENT("Base Direction",   1, SB_LOG_BASE_LEVEL(baseLevel));
     SB_LOG_BLOCK_CLOSER();
 
-    actualLength = DetermineBoundary(codepointSequence, refBidiTypes, paragraphOffset, suggestedLength);
+    actualLength = DetermineBoundary(algorithm, codepointSequence, refBidiTypes,
+                                     paragraphOffset, suggestedLength);
 
     SB_LOG_BLOCK_OPENER("Determined Paragraph Boundary");
     SB_LOG_STATEMENT("Actual Length", 1, SB_LOG_NUMBER(actualLength));
     SB_LOG_BLOCK_CLOSER();
 
+    isOverLength = (limits && limits->maxLength > 0 && actualLength > limits->maxLength);
+
+    if (isOverLength && !limits->fallback) {
+        SB_STATISTICS_INCREMENT(StatisticResolutionLimitHits);
+        SB_LOG_BREAKER();
+
+        return NULL;
+    }
+
     paragraph = AllocateParagraph(actualLength);
 
     if (paragraph) {
-        SBBoolean isResolved;
+        SBBoolean isResolved = SBFalse;
+        ResolutionBudget budget;
         Memory memory;
 
+        ResolutionBudgetInitialize(&budget, limits);
         MemoryInitialize(&memory);
-        isResolved = ResolveParagraph(
-            paragraph, &memory, codepointSequence, refBidiTypes,
-            paragraphOffset, actualLength, baseLevel
-        );
+
+        if (!isOverLength) {
+            isResolved = ResolveParagraph(
+                paragraph, &memory, codepointSequence, refBidiTypes,
+                paragraphOffset, actualLength, baseLevel, &budget
+            );
+        } else {
+            budget.isExhausted = SBTrue;
+        }
+
+        if (!isResolved && budget.isExhausted) {
+            SB_STATISTICS_INCREMENT(StatisticResolutionLimitHits);
+
+            if (limits->fallback) {
+                DegradeParagraph(paragraph, codepointSequence, refBidiTypes,
+                                 paragraphOffset, actualLength, baseLevel);
+                isResolved = SBTrue;
+            }
+        }
 
         if (isResolved) {
             paragraph->_algorithm = (algorithm ? SBAlgorithmRetain(algorithm) : NULL);
@@ -671,14 +805,15 @@ static SBParagraphRef CreateParagraph(SBAlgorithmRef algorithm,
 }
 
 SB_INTERNAL SBParagraphRef SBParagraphCreateWithAlgorithm(SBAlgorithmRef algorithm,
-    SBUInteger paragraphOffset, SBUInteger suggestedLength, SBLevel baseLevel)
+    SBUInteger paragraphOffset, SBUInteger suggestedLength, SBLevel baseLevel,
+    const SBParagraphLimits *limits)
 {
     SBUInteger stringLength = algorithm->codepointSequence.stringLength;
 
     /* The specified range MUST be valid */
     SBAssert(SBUIntegerVerifyRange(stringLength, paragraphOffset, suggestedLength) && suggestedLength > 0);
 
-    return CreateParagraph(algorithm, NULL, NULL, paragraphOffset, suggestedLength, baseLevel);
+    return CreateParagraph(algorithm, NULL, NULL, paragraphOffset, suggestedLength, baseLevel, limits);
 }
 
 SB_INTERNAL SBParagraphRef SBParagraphCreateWithCodepointSequence(
@@ -690,7 +825,34 @@ SB_INTERNAL SBParagraphRef SBParagraphCreateWithCodepointSequence(
     /* The specified range MUST be valid */
     SBAssert(SBUIntegerVerifyRange(stringLength, paragraphOffset, suggestedLength) && suggestedLength > 0);
 
-    return CreateParagraph(NULL, codepointSequence, refBidiTypes, paragraphOffset, suggestedLength, baseLevel);
+    return CreateParagraph(NULL, codepointSequence, refBidiTypes, paragraphOffset, suggestedLength, baseLevel, NULL);
+}
+
+SB_INTERNAL SBParagraphRef SBParagraphCreateWithResolvedLevels(
+    const SBCodepointSequence *codepointSequence, const SBBidiType *refBidiTypes,
+    SBUInteger paragraphOffset, SBUInteger paragraphLength, SBLevel baseLevel,
+    const SBLevel *resolvedLevels, SBBoolean isDegraded)
+{
+    SBMutableParagraphRef paragraph;
+
+    /* The specified range MUST be valid */
+    SBAssert(SBUIntegerVerifyRange(codepointSequence->stringLength, paragraphOffset, paragraphLength)
+             && paragraphLength > 0);
+
+    paragraph = AllocateParagraph(paragraphLength);
+
+    if (paragraph) {
+        memcpy(paragraph->fixedLevels, resolvedLevels, sizeof(SBLevel) * paragraphLength);
+
+        paragraph->codepointSequence = *codepointSequence;
+        paragraph->refTypes = &refBidiTypes[paragraphOffset];
+        paragraph->offset = paragraphOffset;
+        paragraph->length = paragraphLength;
+        paragraph->baseLevel = baseLevel;
+        paragraph->isDegraded = isDegraded;
+    }
+
+    return paragraph;
 }
 
 SBUInteger SBParagraphGetOffset(SBParagraphRef paragraph)
@@ -708,6 +870,11 @@ SBLevel SBParagraphGetBaseLevel(SBParagraphRef paragraph)
     return paragraph->baseLevel;
 }
 
+SBBoolean SBParagraphIsDegraded(SBParagraphRef paragraph)
+{
+    return paragraph->isDegraded;
+}
+
 const SBLevel *SBParagraphGetLevelsPtr(SBParagraphRef paragraph)
 {
     return paragraph->fixedLevels;
@@ -727,6 +894,27 @@ SBLineRef SBParagraphCreateLine(SBParagraphRef paragraph, SBUInteger lineOffset,
     return NULL;
 }
 
+SBBoolean SBParagraphCreateLines(SBParagraphRef paragraph,
+    const SBUInteger *lineBoundaries, SBUInteger lineCount, SBLineRef *lines)
+{
+    SBUInteger paragraphOffset = paragraph->offset;
+    SBUInteger paragraphLimit = paragraphOffset + paragraph->length;
+    SBUInteger index;
+
+    if (lineCount == 0 || lineBoundaries[0] < paragraphOffset
+        || lineBoundaries[lineCount] > paragraphLimit) {
+        return SBFalse;
+    }
+
+    for (index = 0; index < lineCount; index++) {
+        if (lineBoundaries[index] >= lineBoundaries[index + 1]) {
+            return SBFalse;
+        }
+    }
+
+    return SBLineCreateBatch(paragraph, lineBoundaries, lineCount, lines);
+}
+
 SBParagraphRef SBParagraphRetain(SBParagraphRef paragraph)
 {
     return ObjectRetain((ObjectRef)paragraph);
@@ -32,13 +32,24 @@ typedef struct _SBParagraph {
     SBUInteger offset;
     SBUInteger length;
     SBLevel baseLevel;
+    SBBoolean isDegraded;
 } SBParagraph;
 
 SB_INTERNAL SBParagraphRef SBParagraphCreateWithAlgorithm(SBAlgorithmRef algorithm,
-    SBUInteger paragraphOffset, SBUInteger suggestedLength, SBLevel baseLevel);
+    SBUInteger paragraphOffset, SBUInteger suggestedLength, SBLevel baseLevel,
+    const SBParagraphLimits *limits);
 
 SB_INTERNAL SBParagraphRef SBParagraphCreateWithCodepointSequence(
     const SBCodepointSequence *codepointSequence, const SBBidiType *refBidiTypes,
     SBUInteger paragraphOffset, SBUInteger suggestedLength, SBLevel baseLevel);
 
+/**
+ * Creates a paragraph from the levels resolved previously for the exact same range, without running
+ * the algorithm again.
+ */
+SB_INTERNAL SBParagraphRef SBParagraphCreateWithResolvedLevels(
+    const SBCodepointSequence *codepointSequence, const SBBidiType *refBidiTypes,
+    SBUInteger paragraphOffset, SBUInteger paragraphLength, SBLevel baseLevel,
+    const SBLevel *resolvedLevels, SBBoolean isDegraded);
+
 #endif
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <API/SBBase.h>
+#include <Core/AtomicPointer.h>
+#include <Core/AtomicUInt.h>
+#include <Core/Once.h>
+#include <Core/ThreadLocalStorage.h>
+
+#include "SBStatistics.h"
+
+#ifdef USE_STATISTICS
+
+/**
+ * Counters of a single thread. Records are never freed so that the counts of finished threads
+ * remain part of the totals; they are allocated with the C runtime so that the allocation
+ * counters do not observe themselves.
+ *
+ * Each counter is only written by its own thread but may be read by any thread taking a snapshot,
+ * so it is accessed with relaxed atomic operations.
+ */
+typedef struct _StatisticsRecord {
+    struct _StatisticsRecord *next;
+    AtomicUInt values[StatisticCount];
+} StatisticsRecord, *StatisticsRecordRef;
+typedef AtomicPointerType(StatisticsRecord) AtomicStatisticsRecordRef;
+
+static AtomicStatisticsRecordRef StatisticsRecordList = NULL;
+static ThreadLocalStorage CurrentStatisticsRecord;
+
+static void InitializeCurrentStatisticsRecord(void *info)
+{
+    ThreadLocalStorageInitialize(CurrentStatisticsRecord);
+}
+
+static SBBoolean TryLazyInitializeCurrentStatisticsRecord(void)
+{
+    static Once once = OnceMake();
+    return OnceTryExecute(&once, InitializeCurrentStatisticsRecord, NULL);
+}
+
+static StatisticsRecordRef AttachStatisticsRecord(void)
+{
+    StatisticsRecordRef record = malloc(sizeof(StatisticsRecord));
+
+    if (record) {
+        StatisticsRecordRef top;
+        StatisticsRecordRef expected;
+        SBUInteger index;
+
+        for (index = 0; index < StatisticCount; index++) {
+            AtomicUIntInitialize(&record->values[index], 0);
+        }
+
+        do {
+            top = AtomicPointerLoad(&StatisticsRecordList);
+            expected = top;
+            record->next = top;
+        } while (!AtomicPointerCompareAndSet(&StatisticsRecordList, &expected, record));
+
+        ThreadLocalStorageSet(CurrentStatisticsRecord, record);
+    }
+
+    return record;
+}
+
+SB_INTERNAL void SBStatisticsAdd(Statistic statistic, SBUInteger value)
+{
+    if (TryLazyInitializeCurrentStatisticsRecord()) {
+        StatisticsRecordRef record = ThreadLocalStorageGet(CurrentStatisticsRecord);
+
+        if (!record) {
+            record = AttachStatisticsRecord();
+        }
+
+        if (record) {
+            AtomicUIntAddRelaxed(&record->values[statistic], value);
+        }
+    }
+}
+
+#endif
+
+void SBStatisticsGetSnapshot(SBStatistics *statistics)
+{
+    SBUInteger values[StatisticCount] = { 0 };
+
+#ifdef USE_STATISTICS
+    StatisticsRecordRef record = AtomicPointerLoad(&StatisticsRecordList);
+
+    while (record) {
+        SBUInteger index;
+
+        for (index = 0; index < StatisticCount; index++) {
+            values[index] += AtomicUIntLoadRelaxed(&record->values[index]);
+        }
+
+        record = record->next;
+    }
+#endif
+
+    statistics->blockAllocations = values[StatisticBlockAllocations];
+    statistics->blockDeallocations = values[StatisticBlockDeallocations];
+    statistics->scratchHits = values[StatisticScratchHits];
+    statistics->scratchMisses = values[StatisticScratchMisses];
+    statistics->objectsCreated = values[StatisticObjectCreations];
+    statistics->objectsAlive = values[StatisticObjectCreations] - values[StatisticObjectDestructions];
+    statistics->objectPoolHits = values[StatisticObjectPoolHits];
+    statistics->objectPoolMisses = values[StatisticObjectPoolMisses];
+    statistics->runQueueChunks = values[StatisticRunQueueChunks];
+    statistics->bracketQueueChunks = values[StatisticBracketQueueChunks];
+    statistics->bracketLimitHits = values[StatisticBracketLimitHits];
+    statistics->levelLimitHits = values[StatisticLevelLimitHits];
+    statistics->paragraphsResolved = values[StatisticParagraphsResolved];
+    statistics->resolutionLimitHits = values[StatisticResolutionLimitHits];
+    statistics->paragraphsReanalyzed = values[StatisticParagraphsReanalyzed];
+    statistics->codeUnitsClassified = values[StatisticCodeUnitsClassified];
+    statistics->codeUnitsScripted = values[StatisticCodeUnitsScripted];
+    statistics->runReorderSteps = values[StatisticRunReorderSteps];
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _SB_INTERNAL_STATISTICS_H
+#define _SB_INTERNAL_STATISTICS_H
+
+#include <SheenBidi/SBStatistics.h>
+
+#include <API/SBBase.h>
+#include <Core/AtomicPointer.h>
+#include <Core/AtomicUInt.h>
+#include <Core/Once.h>
+#include <Core/ThreadLocalStorage.h>
+
+#ifdef SB_CONFIG_ENABLE_STATISTICS
+
+#if defined(HAS_ATOMIC_POINTER_SUPPORT) && defined(HAS_ATOMIC_UINT_SUPPORT) \
+        && defined(HAS_TLS_SUPPORT) && defined(HAS_ONCE_SUPPORT)
+#define USE_STATISTICS
+#else
+#error "Statistics functionality requires atomic operations, thread-local, and once support. To \
+proceed without statistics, undefine `SB_CONFIG_ENABLE_STATISTICS`."
+#endif
+
+#endif
+
+enum {
+    StatisticBlockAllocations = 0,
+    StatisticBlockDeallocations,
+    StatisticScratchHits,
+    StatisticScratchMisses,
+    StatisticObjectCreations,
+    StatisticObjectDestructions,
+    StatisticObjectPoolHits,
+    StatisticObjectPoolMisses,
+    StatisticRunQueueChunks,
+    StatisticBracketQueueChunks,
+    StatisticBracketLimitHits,
+    StatisticLevelLimitHits,
+    StatisticParagraphsResolved,
+    StatisticResolutionLimitHits,
+    StatisticParagraphsReanalyzed,
+    StatisticCodeUnitsClassified,
+    StatisticCodeUnitsScripted,
+    StatisticRunReorderSteps,
+
+    StatisticCount
+};
+typedef SBUInt8 Statistic;
+
+#ifdef USE_STATISTICS
+
+SB_INTERNAL void SBStatisticsAdd(Statistic statistic, SBUInteger value);
+
+#define SB_STATISTICS_ADD(s, v)         SBStatisticsAdd(s, v)
+
+#else
+
+#define SB_STATISTICS_ADD(s, v)
+
+#endif
+
+#define SB_STATISTICS_INCREMENT(s)      SB_STATISTICS_ADD(s, 1)
+
+#endif
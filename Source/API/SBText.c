@@ -28,14 +28,26 @@
 #include <API/SBCodepointSequence.h>
 #include <API/SBParagraph.h>
 #include <API/SBScriptLocator.h>
+#include <API/SBStatistics.h>
 #include <API/SBTextConfig.h>
 #include <API/SBTextIterators.h>
+#include <API/SBTrace.h>
 #include <Core/List.h>
 #include <Core/Object.h>
 #include <Text/AttributeManager.h>
+#include <Text/EditLog.h>
+#include <Text/FileMapping.h>
+#include <Text/TextSnapshot.h>
 
 #include "SBText.h"
 
+static void ApplyPendingEdits(SBMutableTextRef text);
+static void ProcessInsertedCodeUnits(SBMutableTextRef text, SBUInteger index, SBUInteger length);
+static void InsertCodeUnitsImmediately(SBMutableTextRef text, SBUInteger index,
+    const void *codeUnitBuffer, SBUInteger codeUnitCount);
+static void DeleteCodeUnitsImmediately(SBMutableTextRef text, SBUInteger index, SBUInteger length);
+static TextParagraphRef InsertEmptyParagraph(SBMutableTextRef text, SBUInteger listIndex);
+
 /* =========================================================================
  * Text Paragraph Implementation
  * ========================================================================= */
@@ -48,9 +60,12 @@ static void InitializeTextParagraph(TextParagraphRef paragraph)
     paragraph->index = SBInvalidIndex;
     paragraph->length = 0;
     paragraph->needsReanalysis = SBTrue;
+    paragraph->scriptEditStart = SBInvalidIndex;
+    paragraph->scriptEditEnd = SBInvalidIndex;
     paragraph->bidiParagraph = NULL;
 
-    ListInitialize(&paragraph->scripts, sizeof(SBScriptRun));
+    ListInitialize(&paragraph->scripts, sizeof(SBScript));
+    ListInitialize(&paragraph->scriptAnchors, sizeof(SBUInteger));
 }
 
 /**
@@ -65,6 +80,35 @@ static void FinalizeTextParagraph(TextParagraphRef paragraph)
     }
 
     ListFinalize(&paragraph->scripts);
+    ListFinalize(&paragraph->scriptAnchors);
+}
+
+/**
+ * Records the code units of a paragraph whose scripts become outdated by a replacement, before the
+ * paragraph is updated to its new range. The scripts can be kept partially only if the paragraph
+ * retains its start and either absorbs the whole replacement or lies completely before it.
+ */
+static void MarkOutdatedScripts(TextParagraphRef paragraph, SBUInteger newIndex, SBUInteger newLength,
+    SBUInteger replaceStart, SBUInteger oldLength, SBUInteger replacementLength)
+{
+    SBUInteger paragraphStart = paragraph->index;
+    SBUInteger paragraphEnd = paragraphStart + paragraph->length;
+
+    paragraph->scriptEditStart = SBInvalidIndex;
+    paragraph->scriptEditEnd = SBInvalidIndex;
+
+    if (!paragraph->needsReanalysis && paragraphStart == newIndex) {
+        if (replaceStart >= paragraphStart && replaceStart + oldLength <= paragraphEnd
+                && newLength == paragraph->length - oldLength + replacementLength) {
+            /* Only the replaced code units are outdated */
+            paragraph->scriptEditStart = replaceStart - paragraphStart;
+            paragraph->scriptEditEnd = paragraph->scriptEditStart + replacementLength;
+        } else if (replaceStart >= paragraphEnd && newLength == paragraph->length) {
+            /* None of the scripts are outdated */
+            paragraph->scriptEditStart = newLength;
+            paragraph->scriptEditEnd = newLength;
+        }
+    }
 }
 
 /* =========================================================================
@@ -122,6 +166,29 @@ static SBUInteger GetMaxCodeUnitsPerCodepoint(SBTextRef text)
     }
 }
 
+/**
+ * Returns the number of code units of the text, including the edits pending in an editing session.
+ */
+static SBUInteger GetEditedLength(SBTextRef text)
+{
+    if (text->editLog.hasEdits) {
+        return text->editLog.length;
+    }
+
+    return text->codeUnits.count;
+}
+
+/**
+ * Applies the edits pending in an editing session before the contents of the text are read. The
+ * text is logically unchanged by this, so it is done through an immutable reference as well.
+ */
+static void PrepareForReading(SBTextRef text)
+{
+    if (text->editLog.hasEdits) {
+        ApplyPendingEdits((SBMutableTextRef)text);
+    }
+}
+
 /**
  * Finalizes all paragraphs in the text object by releasing their resources.
  */
@@ -226,6 +293,294 @@ SBTextRef SBTextCreate(const void *string, SBUInteger length, SBStringEncoding e
     return text;
 }
 
+/**
+ * Creates an immutable text referencing the code units of an external buffer.
+ */
+static SBTextRef CreateTextWithExternalBuffer(const void *buffer, SBUInteger length,
+    SBStringEncoding encoding, SBTextConfigRef config, TextBufferKind bufferKind,
+    SBTextBufferReleaseFunc release, void *info)
+{
+    SBMutableTextRef text = SBTextCreateMutable(encoding, config);
+
+    if (text) {
+        ListRef codeUnits = &text->codeUnits;
+
+        /* Refer to the buffer as the code units of the list without taking its ownership */
+        codeUnits->data = (void *)buffer;
+        codeUnits->count = length;
+        codeUnits->capacity = length;
+
+        text->bufferKind = bufferKind;
+        text->bufferRelease = release;
+        text->bufferInfo = info;
+
+        if (length > 0) {
+            ProcessInsertedCodeUnits(text, 0, length);
+        }
+
+        text->isMutable = SBFalse;
+    }
+
+    return text;
+}
+
+SBTextRef SBTextCreateWithBuffer(const void *buffer, SBUInteger length,
+    SBStringEncoding encoding, SBTextConfigRef config, SBTextBufferReleaseFunc release, void *info)
+{
+    SBTextRef text = CreateTextWithExternalBuffer(buffer, length, encoding, config,
+        TextBufferExternal, release, info);
+
+    if (!text && release) {
+        release(buffer, length, info);
+    }
+
+    return text;
+}
+
+SBTextRef SBTextCreateWithMappedFile(const char *path, SBStringEncoding encoding,
+    SBTextConfigRef config)
+{
+    SBUInteger codeUnitSize = GetCodeUnitSize(encoding);
+    SBTextRef text = NULL;
+    const void *buffer;
+    SBUInteger size;
+
+    if (codeUnitSize > 0 && FileMappingOpen(path, &buffer, &size)) {
+        if (size % codeUnitSize == 0) {
+            text = CreateTextWithExternalBuffer(buffer, size / codeUnitSize, encoding, config,
+                TextBufferMapped, NULL, NULL);
+        }
+
+        if (!text) {
+            FileMappingClose(buffer, size);
+        }
+    }
+
+    return text;
+}
+
+/**
+ * Reads the bidi types and the analyzed paragraphs of a snapshot into a text already holding the
+ * code units, validating every field against them.
+ */
+static SBBoolean ReadSnapshotAnalysis(SBMutableTextRef text, TextSnapshotReaderRef reader)
+{
+    SBUInteger codeUnitCount = text->codeUnits.count;
+    const SBBidiType *bidiTypes;
+    SBCodepointSequence codepointSequence;
+    SBUInt64 paragraphCount;
+    SBUInteger paragraphStart;
+    SBUInteger index;
+
+    /* Read bidi types */
+    bidiTypes = TextSnapshotReadBytes(reader, codeUnitCount * sizeof(SBBidiType));
+    if (!bidiTypes || !ListReserveRange(&text->bidiTypes, 0, codeUnitCount)) {
+        return SBFalse;
+    }
+
+    for (index = 0; index < codeUnitCount; index++) {
+        if (bidiTypes[index] > SBBidiTypePDF) {
+            return SBFalse;
+        }
+
+        ListSetVal(&text->bidiTypes, index, bidiTypes[index]);
+    }
+
+    codepointSequence.stringEncoding = text->encoding;
+    codepointSequence.stringBuffer = text->codeUnits.data;
+    codepointSequence.stringLength = codeUnitCount;
+
+    /* Read paragraphs */
+    paragraphCount = TextSnapshotReadUInt64(reader);
+    paragraphStart = 0;
+
+    if (paragraphCount > codeUnitCount) {
+        return SBFalse;
+    }
+
+    for (index = 0; index < paragraphCount; index++) {
+        SBUInt64 paragraphIndex = TextSnapshotReadUInt64(reader);
+        SBUInt64 paragraphLength = TextSnapshotReadUInt64(reader);
+        SBLevel baseLevel = TextSnapshotReadUInt8(reader);
+        SBUInt8 isDegraded = TextSnapshotReadUInt8(reader);
+        const SBLevel *levels;
+        SBUInt64 runCount;
+        SBUInt64 anchorCount;
+        SBUInteger runStart;
+        SBUInteger levelIndex;
+        SBUInteger anchorIndex;
+        SBUInteger lastAnchor;
+        TextParagraphRef paragraph;
+
+        if (paragraphIndex != paragraphStart || paragraphLength == 0
+                || paragraphLength > codeUnitCount - paragraphStart
+                || baseLevel > SBLevelMax || isDegraded > 1) {
+            return SBFalse;
+        }
+
+        levels = TextSnapshotReadBytes(reader, (SBUInteger)paragraphLength * sizeof(SBLevel));
+        if (!levels) {
+            return SBFalse;
+        }
+
+        /* Resolved levels never go below the paragraph level */
+        for (levelIndex = 0; levelIndex < paragraphLength; levelIndex++) {
+            if (levels[levelIndex] < baseLevel || levels[levelIndex] > SBLevelMax + 1) {
+                return SBFalse;
+            }
+        }
+
+        /* The paragraph is finalized along with the text if anything fails afterwards */
+        paragraph = InsertEmptyParagraph(text, index);
+        if (!paragraph) {
+            return SBFalse;
+        }
+
+        paragraph->index = paragraphStart;
+        paragraph->length = (SBUInteger)paragraphLength;
+        paragraph->needsReanalysis = SBFalse;
+        paragraph->bidiParagraph = SBParagraphCreateWithResolvedLevels(&codepointSequence,
+            text->bidiTypes.items, paragraph->index, paragraph->length, baseLevel,
+            levels, isDegraded);
+
+        if (!paragraph->bidiParagraph
+                || !ListReserveRange(&paragraph->scripts, 0, paragraph->length)) {
+            return SBFalse;
+        }
+
+        /* Expand the script runs */
+        runCount = TextSnapshotReadUInt64(reader);
+        runStart = 0;
+
+        while (runCount > 0 && reader->isValid) {
+            SBUInt64 runLength = TextSnapshotReadUInt64(reader);
+            SBScript runScript = TextSnapshotReadUInt8(reader);
+
+            if (runLength == 0 || runLength > paragraph->length - runStart
+                    || runScript > SBScriptTOLS) {
+                return SBFalse;
+            }
+
+            while (runLength > 0) {
+                ListSetVal(&paragraph->scripts, runStart, runScript);
+                runStart += 1;
+                runLength -= 1;
+            }
+
+            runCount -= 1;
+        }
+
+        if (runStart != paragraph->length) {
+            return SBFalse;
+        }
+
+        /* Read the script anchors, which lie strictly inside the paragraph in ascending order */
+        anchorCount = TextSnapshotReadUInt64(reader);
+        lastAnchor = 0;
+
+        if (anchorCount >= paragraph->length
+                || !ListReserveRange(&paragraph->scriptAnchors, 0, (SBUInteger)anchorCount)) {
+            return SBFalse;
+        }
+
+        for (anchorIndex = 0; anchorIndex < anchorCount; anchorIndex++) {
+            SBUInt64 anchor = TextSnapshotReadUInt64(reader);
+
+            if (anchor <= lastAnchor || anchor >= paragraph->length) {
+                return SBFalse;
+            }
+
+            lastAnchor = (SBUInteger)anchor;
+            ListSetVal(&paragraph->scriptAnchors, anchorIndex, lastAnchor);
+        }
+
+        paragraphStart += paragraph->length;
+    }
+
+    return (reader->isValid && paragraphStart == codeUnitCount);
+}
+
+SBTextRef SBTextCreateWithSnapshot(const void *string, SBUInteger length,
+    SBStringEncoding encoding, SBTextConfigRef config,
+    const void *snapshot, SBUInteger snapshotSize)
+{
+    SBUInteger codeUnitSize = GetCodeUnitSize(encoding);
+    SBMutableTextRef text = NULL;
+    TextSnapshotReader reader;
+    SBUInt64 payloadSize;
+    SBUInt64 payloadHash;
+    SBBoolean isValid;
+
+    TextSnapshotReaderInitialize(&reader, snapshot, snapshotSize);
+
+    /* Validate the header before allocating anything */
+    isValid = TextSnapshotReadUInt32(&reader) == TextSnapshotMagic
+           && TextSnapshotReadUInt32(&reader) == TextSnapshotFormatVersion
+           && TextSnapshotReadUInt32(&reader) == TextSnapshotUnicodeVersion
+           && TextSnapshotReadUInt8(&reader) == encoding
+           && TextSnapshotReadUInt8(&reader) == config->baseLevel
+           && TextSnapshotReadUInt64(&reader) == length
+           && TextSnapshotReadUInt64(&reader) == TextSnapshotHashBytes(string, length * codeUnitSize);
+
+    payloadSize = TextSnapshotReadUInt64(&reader);
+    payloadHash = TextSnapshotReadUInt64(&reader);
+
+    /* Verify the whole payload so that no damaged field is ever interpreted */
+    if (isValid && payloadSize == (SBUInteger)payloadSize) {
+        const void *payload = TextSnapshotReadBytes(&reader, (SBUInteger)payloadSize);
+
+        isValid = payload && TextSnapshotHashBytes(payload, (SBUInteger)payloadSize) == payloadHash;
+
+        /* The fields of the analysis are read from the payload alone */
+        TextSnapshotReaderInitialize(&reader, payload, (SBUInteger)payloadSize);
+    } else {
+        isValid = SBFalse;
+    }
+
+    if (isValid) {
+        text = SBTextCreateMutable(encoding, config);
+    }
+
+    if (text) {
+        if (length > 0) {
+            isValid = ListReserveRange(&text->codeUnits, 0, length);
+
+            if (isValid) {
+                memcpy(text->codeUnits.data, string, length * codeUnitSize);
+                isValid = ReadSnapshotAnalysis(text, &reader);
+            }
+
+            if (isValid) {
+                AttributeManagerReserveRange(&text->attributeManager, 0, length);
+            }
+        }
+
+        if (isValid) {
+            text->isMutable = SBFalse;
+        } else {
+            SBTextRelease(text);
+            text = NULL;
+        }
+    }
+
+    return text;
+}
+
+SBTextRef SBTextCreateWithSnapshotFile(const void *string, SBUInteger length,
+    SBStringEncoding encoding, SBTextConfigRef config, const char *snapshotPath)
+{
+    SBTextRef text = NULL;
+    const void *snapshot;
+    SBUInteger snapshotSize;
+
+    if (FileMappingOpen(snapshotPath, &snapshot, &snapshotSize)) {
+        text = SBTextCreateWithSnapshot(string, length, encoding, config, snapshot, snapshotSize);
+        FileMappingClose(snapshot, snapshotSize);
+    }
+
+    return text;
+}
+
 SBTextRef SBTextCreateCopy(SBTextRef text)
 {
     SBMutableTextRef copy = SBTextCreateMutableCopy(text);
@@ -249,15 +604,18 @@ SBAttributeRegistryRef SBTextGetAttributeRegistry(SBTextRef text)
 
 SBUInteger SBTextGetLength(SBTextRef text)
 {
-    return text->codeUnits.count;
+    return GetEditedLength(text);
 }
 
 void SBTextGetCodeUnits(SBTextRef text, SBUInteger index, SBUInteger length, void *buffer)
 {
-    SBBoolean isRangeValid = SBUIntegerVerifyRange(text->codeUnits.count, index, length);
+    SBBoolean isRangeValid;
     SBUInteger byteCount;
     const void *source;
 
+    PrepareForReading(text);
+
+    isRangeValid = SBUIntegerVerifyRange(text->codeUnits.count, index, length);
     SBAssert(isRangeValid);
 
     byteCount = length * text->codeUnits.itemSize;
@@ -268,10 +626,13 @@ void SBTextGetCodeUnits(SBTextRef text, SBUInteger index, SBUInteger length, voi
 
 void SBTextGetBidiTypes(SBTextRef text, SBUInteger index, SBUInteger length, SBBidiType *buffer)
 {
-    SBBoolean isRangeValid = SBUIntegerVerifyRange(text->codeUnits.count, index, length);
+    SBBoolean isRangeValid;
     const SBBidiType *bidiTypes;
     SBUInteger byteCount;
 
+    PrepareForReading(text);
+
+    isRangeValid = SBUIntegerVerifyRange(text->codeUnits.count, index, length);
     SBAssert(isRangeValid);
 
     bidiTypes = &text->bidiTypes.items[index];
@@ -280,43 +641,42 @@ void SBTextGetBidiTypes(SBTextRef text, SBUInteger index, SBUInteger length, SBB
     memcpy(buffer, bidiTypes, byteCount);
 }
 
+/**
+ * Returns the number of code units from an index within a paragraph up to the end of either the
+ * paragraph or the range starting at the index.
+ */
+static SBUInteger GetParagraphSpanLength(const TextParagraph *paragraph,
+    SBUInteger index, SBUInteger length)
+{
+    SBUInteger paragraphEnd = paragraph->index + paragraph->length;
+
+    return (paragraphEnd - index < length ? paragraphEnd - index : length);
+}
+
 void SBTextGetScripts(SBTextRef text, SBUInteger index, SBUInteger length, SBScript *buffer)
 {
     SBBoolean isRangeValid = SBUIntegerVerifyRange(text->codeUnits.count, index, length);
-    SBUInteger rangeStart;
-    SBUInteger rangeEnd;
     SBUInteger paragraphIndex;
 
     SBAssert(isRangeValid && !text->isEditing);
 
-    rangeStart = index;
-    rangeEnd = index + length;
-    paragraphIndex = SBTextGetCodeUnitParagraphIndex(text, rangeStart);
-
-    while (rangeStart < rangeEnd) {
-        const TextParagraph *textParagraph = ListGetRef(&text->paragraphs, paragraphIndex);
-        SBUInteger copyStart = textParagraph->index;
-        SBUInteger copyEnd = copyStart + textParagraph->length;
-        const SBScript *scriptArray;
-        SBUInteger scriptCount;
-        SBUInteger byteCount;
+    if (length == 0) {
+        return;
+    }
 
-        /* Clamp copy range to requested range */
-        if (copyStart < rangeStart) {
-            copyStart = rangeStart;
-        }
-        if (copyEnd > rangeEnd) {
-            copyEnd = rangeEnd;
-        }
+    /* The range continues through the paragraphs following the first one */
+    paragraphIndex = SBTextGetCodeUnitParagraphIndex(text, index);
 
-        scriptArray = ListGetRef(&textParagraph->scripts, copyStart - textParagraph->index);
-        scriptCount = copyEnd - copyStart;
-        byteCount = scriptCount * sizeof(SBScript);
+    while (length > 0) {
+        const TextParagraph *paragraph = ListGetRef(&text->paragraphs, paragraphIndex);
+        SBUInteger spanLength = GetParagraphSpanLength(paragraph, index, length);
 
-        memcpy(buffer, scriptArray, byteCount);
+        memcpy(buffer, &paragraph->scripts.items[index - paragraph->index],
+            spanLength * sizeof(SBScript));
 
-        buffer += scriptCount;
-        rangeStart = copyEnd;
+        buffer += spanLength;
+        index += spanLength;
+        length -= spanLength;
         paragraphIndex += 1;
     }
 }
@@ -324,46 +684,82 @@ void SBTextGetScripts(SBTextRef text, SBUInteger index, SBUInteger length, SBScr
 void SBTextGetResolvedLevels(SBTextRef text, SBUInteger index, SBUInteger length, SBLevel *buffer)
 {
     SBBoolean isRangeValid = SBUIntegerVerifyRange(text->codeUnits.count, index, length);
-    SBUInteger rangeStart;
-    SBUInteger rangeEnd;
     SBUInteger paragraphIndex;
 
     SBAssert(isRangeValid && !text->isEditing);
 
-    rangeStart = index;
-    rangeEnd = index + length;
-    paragraphIndex = SBTextGetCodeUnitParagraphIndex(text, index);
-
-    while (rangeStart < rangeEnd) {
-        const TextParagraph *textParagraph = ListGetRef(&text->paragraphs, paragraphIndex);
-        SBUInteger copyStart = textParagraph->index;
-        SBUInteger copyEnd = copyStart + textParagraph->length;
-        SBParagraphRef bidiParagraph;
-        const SBLevel *levelArray;
-        SBUInteger levelCount;
-        SBUInteger byteCount;
+    if (length == 0) {
+        return;
+    }
 
-        /* Clamp copy range to requested range */
-        if (copyStart < rangeStart) {
-            copyStart = rangeStart;
-        }
-        if (copyEnd > rangeEnd) {
-            copyEnd = rangeEnd;
-        }
+    /* The range continues through the paragraphs following the first one */
+    paragraphIndex = SBTextGetCodeUnitParagraphIndex(text, index);
 
-        bidiParagraph = textParagraph->bidiParagraph;
-        levelArray = &bidiParagraph->fixedLevels[copyStart - bidiParagraph->offset];
-        levelCount = copyEnd - copyStart;
-        byteCount = levelCount * sizeof(SBLevel);
+    while (length > 0) {
+        const TextParagraph *paragraph = ListGetRef(&text->paragraphs, paragraphIndex);
+        SBParagraphRef bidiParagraph = paragraph->bidiParagraph;
+        SBUInteger spanLength = GetParagraphSpanLength(paragraph, index, length);
 
-        memcpy(buffer, levelArray, byteCount);
+        memcpy(buffer, &bidiParagraph->fixedLevels[index - bidiParagraph->offset],
+            spanLength * sizeof(SBLevel));
 
-        buffer += levelCount;
-        rangeStart = copyEnd;
+        buffer += spanLength;
+        index += spanLength;
+        length -= spanLength;
         paragraphIndex += 1;
     }
 }
 
+/**
+ * Returns the paragraph containing the first code unit of a range, along with the number of code
+ * units from the start of the range up to the end of either the paragraph or the range.
+ */
+static const TextParagraph *GetParagraphSpan(SBTextRef text,
+    SBUInteger index, SBUInteger length, SBUInteger *spanLength)
+{
+    SBBoolean isRangeValid = SBUIntegerVerifyRange(text->codeUnits.count, index, length);
+    const TextParagraph *paragraph;
+
+    SBAssert(isRangeValid && length > 0 && !text->isEditing);
+
+    paragraph = ListGetRef(&text->paragraphs, SBTextGetCodeUnitParagraphIndex(text, index));
+    *spanLength = GetParagraphSpanLength(paragraph, index, length);
+
+    return paragraph;
+}
+
+const SBBidiType *SBTextGetBidiTypesSpan(SBTextRef text, SBUInteger index,
+    SBUInteger length, SBUInteger *spanLength)
+{
+    SBBoolean isRangeValid;
+
+    PrepareForReading(text);
+
+    isRangeValid = SBUIntegerVerifyRange(text->codeUnits.count, index, length);
+    SBAssert(isRangeValid && length > 0);
+
+    *spanLength = length;
+
+    return &text->bidiTypes.items[index];
+}
+
+const SBScript *SBTextGetScriptsSpan(SBTextRef text, SBUInteger index,
+    SBUInteger length, SBUInteger *spanLength)
+{
+    const TextParagraph *paragraph = GetParagraphSpan(text, index, length, spanLength);
+
+    return &paragraph->scripts.items[index - paragraph->index];
+}
+
+const SBLevel *SBTextGetResolvedLevelsSpan(SBTextRef text, SBUInteger index,
+    SBUInteger length, SBUInteger *spanLength)
+{
+    const TextParagraph *paragraph = GetParagraphSpan(text, index, length, spanLength);
+    SBParagraphRef bidiParagraph = paragraph->bidiParagraph;
+
+    return &bidiParagraph->fixedLevels[index - bidiParagraph->offset];
+}
+
 void SBTextGetCodeUnitParagraphInfo(SBTextRef text, SBUInteger index,
     SBParagraphInfo *paragraphInfo)
 {
@@ -383,30 +779,173 @@ void SBTextGetCodeUnitParagraphInfo(SBTextRef text, SBUInteger index,
     paragraphInfo->baseLevel = bidiParagraph->baseLevel;
 }
 
+/**
+ * Writes the script runs of a paragraph into a snapshot, preceded by their count.
+ */
+static void WriteSnapshotScriptRuns(TextSnapshotWriterRef writer, const TextParagraph *paragraph)
+{
+    const SBScript *scripts = paragraph->scripts.items;
+    SBUInteger length = paragraph->length;
+    SBUInteger runCount = 0;
+    SBUInteger runStart;
+    SBUInteger index;
+
+    for (index = 0; index < length; index++) {
+        if (index == 0 || scripts[index] != scripts[index - 1]) {
+            runCount += 1;
+        }
+    }
+
+    TextSnapshotWriteUInt64(writer, runCount);
+
+    runStart = 0;
+
+    for (index = 1; index <= length; index++) {
+        if (index == length || scripts[index] != scripts[runStart]) {
+            TextSnapshotWriteUInt64(writer, index - runStart);
+            TextSnapshotWriteUInt8(writer, scripts[runStart]);
+            runStart = index;
+        }
+    }
+}
+
+/**
+ * Writes the script anchors of a paragraph, so that the first edit of a restored text resumes
+ * script resolution from the nearest anchor instead of rescanning the whole paragraph.
+ */
+static void WriteSnapshotScriptAnchors(TextSnapshotWriterRef writer, const TextParagraph *paragraph)
+{
+    SBUInteger anchorCount = paragraph->scriptAnchors.count;
+    SBUInteger anchorIndex;
+
+    TextSnapshotWriteUInt64(writer, anchorCount);
+
+    for (anchorIndex = 0; anchorIndex < anchorCount; anchorIndex++) {
+        TextSnapshotWriteUInt64(writer, paragraph->scriptAnchors.items[anchorIndex]);
+    }
+}
+
+/**
+ * Writes the header of a snapshot, identifying the code units and the payload it covers.
+ */
+static void WriteSnapshotHeader(SBTextRef text, SBUInt64 contentHash,
+    SBUInteger payloadSize, SBUInt64 payloadHash, TextSnapshotWriterRef writer)
+{
+    TextSnapshotWriteUInt32(writer, TextSnapshotMagic);
+    TextSnapshotWriteUInt32(writer, TextSnapshotFormatVersion);
+    TextSnapshotWriteUInt32(writer, TextSnapshotUnicodeVersion);
+    TextSnapshotWriteUInt8(writer, text->encoding);
+    TextSnapshotWriteUInt8(writer, text->baseLevel);
+    TextSnapshotWriteUInt64(writer, text->codeUnits.count);
+    TextSnapshotWriteUInt64(writer, contentHash);
+    TextSnapshotWriteUInt64(writer, payloadSize);
+    TextSnapshotWriteUInt64(writer, payloadHash);
+}
+
+/**
+ * Writes the payload of a snapshot holding the analysis of a text.
+ */
+static void WriteSnapshotPayload(SBTextRef text, TextSnapshotWriterRef writer)
+{
+    SBUInteger paragraphCount = text->paragraphs.count;
+    SBUInteger paragraphIndex;
+
+    /* Write the bidi types */
+    TextSnapshotWriteBytes(writer, text->bidiTypes.items,
+        text->bidiTypes.count * sizeof(SBBidiType));
+
+    /* Write the paragraphs */
+    TextSnapshotWriteUInt64(writer, paragraphCount);
+
+    for (paragraphIndex = 0; paragraphIndex < paragraphCount; paragraphIndex++) {
+        const TextParagraph *paragraph = ListGetRef(&text->paragraphs, paragraphIndex);
+        const SBParagraph *bidiParagraph = paragraph->bidiParagraph;
+
+        TextSnapshotWriteUInt64(writer, paragraph->index);
+        TextSnapshotWriteUInt64(writer, paragraph->length);
+        TextSnapshotWriteUInt8(writer, bidiParagraph->baseLevel);
+        TextSnapshotWriteUInt8(writer, bidiParagraph->isDegraded);
+        TextSnapshotWriteBytes(writer, bidiParagraph->fixedLevels,
+            paragraph->length * sizeof(SBLevel));
+
+        WriteSnapshotScriptRuns(writer, paragraph);
+        WriteSnapshotScriptAnchors(writer, paragraph);
+    }
+}
+
+SBUInteger SBTextWriteSnapshot(SBTextRef text, void *buffer, SBUInteger capacity)
+{
+    TextSnapshotWriter writer;
+    SBUInteger headerSize;
+    SBUInteger payloadSize;
+
+    SBAssert(!text->isEditing);
+
+    /* Measure the snapshot before writing it */
+    TextSnapshotWriterInitialize(&writer, NULL, 0);
+    WriteSnapshotHeader(text, 0, 0, 0, &writer);
+    headerSize = writer.size;
+
+    TextSnapshotWriterInitialize(&writer, NULL, 0);
+    WriteSnapshotPayload(text, &writer);
+    payloadSize = writer.size;
+
+    if (buffer && capacity >= headerSize + payloadSize) {
+        SBUInt8 *payload = (SBUInt8 *)buffer + headerSize;
+        SBUInteger byteCount = text->codeUnits.count * text->codeUnits.itemSize;
+        SBUInt64 contentHash;
+        SBUInt64 payloadHash;
+
+        /* Write the payload first as the header holds its checksum */
+        TextSnapshotWriterInitialize(&writer, payload, payloadSize);
+        WriteSnapshotPayload(text, &writer);
+
+        contentHash = TextSnapshotHashBytes(text->codeUnits.data, byteCount);
+        payloadHash = TextSnapshotHashBytes(payload, payloadSize);
+
+        TextSnapshotWriterInitialize(&writer, buffer, headerSize);
+        WriteSnapshotHeader(text, contentHash, payloadSize, payloadHash, &writer);
+    }
+
+    return headerSize + payloadSize;
+}
+
 SBParagraphIteratorRef SBTextCreateParagraphIterator(SBTextRef text)
 {
+    PrepareForReading(text);
+
     return SBParagraphIteratorCreate(text);
 }
 
 SBLogicalRunIteratorRef SBTextCreateLogicalRunIterator(SBTextRef text)
 {
+    PrepareForReading(text);
+
     return SBLogicalRunIteratorCreate(text);
 }
 
 SBScriptRunIteratorRef SBTextCreateScriptRunIterator(SBTextRef text)
 {
+    PrepareForReading(text);
+
     return SBScriptRunIteratorCreate(text);
 }
 
 SBAttributeRunIteratorRef SBTextCreateAttributeRunIterator(SBTextRef text)
 {
+    PrepareForReading(text);
+
     return SBAttributeRunIteratorCreate(text);
 }
 
 SBVisualRunIteratorRef SBTextCreateVisualRunIterator(SBTextRef text,
     SBUInteger index, SBUInteger length)
 {
-    SBVisualRunIteratorRef iterator = SBVisualRunIteratorCreate(text);
+    SBVisualRunIteratorRef iterator;
+
+    PrepareForReading(text);
+
+    iterator = SBVisualRunIteratorCreate(text);
 
     if (iterator) {
         SBVisualRunIteratorReset(iterator, index, length);
@@ -515,17 +1054,23 @@ static void ShiftParagraphRanges(SBMutableTextRef text, SBUInteger listIndex, SB
     }
 }
 
+/**
+ * Rescans the paragraphs touched by a replacement whose code units and bidi types are already in
+ * place. The scan starts at the paragraph before the replaced code units, as its separator may join
+ * the new ones, and ends with the paragraph continuing after them, whose end remains a boundary.
+ */
 static void UpdateParagraphsForTextReplacement(SBMutableTextRef text,
     SBUInteger replaceStart, SBUInteger oldLength, SBUInteger newLength)
 {
     SBUInteger oldEnd = replaceStart + oldLength;
-    SBUInteger newEnd = replaceStart + newLength;
+    SBUInteger oldTextLength = text->codeUnits.count - newLength + oldLength;
     SBInteger lengthDelta = (SBInteger)(newLength - oldLength);
     SBUInteger paragraphIndex;
-    SBUInteger removalEnd;
+    SBUInteger affectedEnd;
+    SBUInteger scanIndex;
+    SBUInteger scanEnd;
     SBCodepointSequence sequence;
     TextParagraphRef paragraph;
-    SBUInteger scanIndex;
 
     /* Find the first affected paragraph */
     paragraphIndex = SBTextGetCodeUnitParagraphIndex(text, replaceStart > 0 ? replaceStart - 1 : 0);
@@ -546,59 +1091,45 @@ static void UpdateParagraphsForTextReplacement(SBMutableTextRef text,
     sequence.stringBuffer = text->codeUnits.data;
     sequence.stringLength = text->codeUnits.count;
 
-    while (scanIndex < sequence.stringLength) {
+    /* Find the last affected paragraph, i.e. the one containing the first code unit after the
+     * replaced ones */
+    if (oldEnd < oldTextLength) {
+        affectedEnd = SBTextGetCodeUnitParagraphIndex(text, oldEnd);
+        paragraph = ListGetRef(&text->paragraphs, affectedEnd);
+        scanEnd = (SBUInteger)(paragraph->index + paragraph->length + lengthDelta);
+        affectedEnd += 1;
+    } else {
+        affectedEnd = text->paragraphs.count;
+        scanEnd = sequence.stringLength;
+    }
+
+    while (scanIndex < scanEnd) {
         SBUInteger separatorLength;
         SBUInteger paraLength;
 
         SBCodepointSequenceGetParagraphBoundary(&sequence, text->bidiTypes.items,
-            scanIndex, sequence.stringLength - scanIndex, &paraLength, &separatorLength);
+            scanIndex, scanEnd - scanIndex, &paraLength, &separatorLength);
 
-        /* Get or create paragraph slot */
-        if (paragraphIndex < text->paragraphs.count) {
+        /* Reuse an affected slot or create a new one */
+        if (paragraphIndex < affectedEnd) {
             paragraph = ListGetRef(&text->paragraphs, paragraphIndex);
-
-            /* Check if this slot is within reusable range */
-            if (paragraph->index > oldEnd) {
-                /* Slot is after affected region, insert new one */
-                paragraph = InsertEmptyParagraph(text, paragraphIndex);
-            } else {
-                SBUInteger paragraphEnd = paragraph->index + paragraph->length;
-
-                /* Check for splitting */
-                if (paragraphEnd > oldEnd && separatorLength > 0) {
-                    newEnd = paragraphEnd + lengthDelta;
-                }
-            }
         } else {
-            /* Need new slot */
             paragraph = InsertEmptyParagraph(text, paragraphIndex);
+            affectedEnd += 1;
         }
 
         /* Update paragraph */
+        MarkOutdatedScripts(paragraph, scanIndex, paraLength, replaceStart, oldLength, newLength);
         paragraph->index = scanIndex;
         paragraph->length = paraLength;
         paragraph->needsReanalysis = SBTrue;
 
         scanIndex += paraLength;
         paragraphIndex += 1;
+    }
 
-        if (scanIndex > replaceStart && scanIndex >= newEnd) {
-            break;
-        }
-    }
-
-    /* Remove any leftover slots that weren't reused */
-    removalEnd = paragraphIndex;
-    while (removalEnd < text->paragraphs.count) {
-        paragraph = ListGetRef(&text->paragraphs, removalEnd);
-        if (paragraph->index > oldEnd) {
-            break;
-        }
-
-        removalEnd += 1;
-    }
-
-    RemoveParagraphRange(text, paragraphIndex, removalEnd - paragraphIndex);
+    /* Remove any affected slots that weren't reused */
+    RemoveParagraphRange(text, paragraphIndex, affectedEnd - paragraphIndex);
 
     /* Shift paragraphs after the affected region */
     if (lengthDelta != 0 && paragraphIndex < text->paragraphs.count) {
@@ -612,6 +1143,297 @@ static void UpdateParagraphsForTextReplacement(SBMutableTextRef text,
 #define UpdateParagraphsForTextRemoval(text, index, length) \
     UpdateParagraphsForTextReplacement(text, index, length, 0)
 
+/**
+ * Appends the paragraphs found in a range of code units to a list, marking them for analysis.
+ */
+static void AppendScannedParagraphs(SBMutableTextRef text, ListRef paragraphs,
+    SBUInteger rangeStart, SBUInteger rangeEnd)
+{
+    SBCodepointSequence sequence;
+    SBUInteger scanIndex;
+
+    sequence.stringEncoding = text->encoding;
+    sequence.stringBuffer = text->codeUnits.data;
+    sequence.stringLength = text->codeUnits.count;
+
+    scanIndex = rangeStart;
+
+    while (scanIndex < rangeEnd) {
+        SBUInteger separatorLength;
+        SBUInteger paragraphLength;
+        TextParagraph paragraph;
+
+        SBCodepointSequenceGetParagraphBoundary(&sequence, text->bidiTypes.items,
+            scanIndex, rangeEnd - scanIndex, &paragraphLength, &separatorLength);
+
+        InitializeTextParagraph(&paragraph);
+        paragraph.index = scanIndex;
+        paragraph.length = paragraphLength;
+
+        if (!ListAdd(paragraphs, &paragraph)) {
+            FinalizeTextParagraph(&paragraph);
+            break;
+        }
+
+        scanIndex += paragraphLength;
+    }
+}
+
+/**
+ * Checks whether a paragraph edited by a single region lying strictly inside it still forms a single
+ * paragraph at its new position, so that its scripts can be updated around the region only.
+ */
+static SBBoolean IsParagraphKeptByRegion(SBTextRef text, TextParagraphRef paragraph,
+    const EditRegion *region, const EditRegion *nextRegion, SBUInteger newStart)
+{
+    SBUInteger paragraphEnd = paragraph->index + paragraph->length;
+    SBUInteger newLength = paragraph->length - region->oldLength + region->newLength;
+    SBUInteger separatorLength;
+    SBUInteger paragraphLength;
+    SBCodepointSequence sequence;
+
+    if (region->oldIndex <= paragraph->index
+        || region->oldIndex + region->oldLength >= paragraphEnd
+        || (nextRegion && nextRegion->oldIndex <= paragraphEnd)) {
+        return SBFalse;
+    }
+
+    sequence.stringEncoding = text->encoding;
+    sequence.stringBuffer = text->codeUnits.data;
+    sequence.stringLength = text->codeUnits.count;
+
+    SBCodepointSequenceGetParagraphBoundary(&sequence, text->bidiTypes.items,
+        newStart, newLength, &paragraphLength, &separatorLength);
+
+    return (paragraphLength == newLength);
+}
+
+/**
+ * Rebuilds the paragraph list in a single pass after the code units have been replaced by the
+ * regions of the edit log.
+ *
+ * A paragraph touched by no region, not even at its boundaries, keeps both its separator and the
+ * code units around it, so it is moved to its new position along with its analysis. A paragraph
+ * edited by a single region inside it is kept as well, marking only the scripts of the region as
+ * outdated. The code units between such paragraphs are scanned again for paragraph boundaries.
+ */
+static void RebuildParagraphsForEditRegions(SBMutableTextRef text)
+{
+    const EditRegion *regions = text->editLog.regions.items;
+    SBUInteger regionCount = text->editLog.regions.count;
+    SBUInteger regionIndex = 0;
+    SBInteger indexDelta = 0;
+    SBUInteger scanIndex = 0;
+    SBUInteger paragraphIndex;
+    List paragraphs;
+
+    ListInitialize(&paragraphs, sizeof(TextParagraph));
+
+    for (paragraphIndex = 0; paragraphIndex < text->paragraphs.count; paragraphIndex++) {
+        TextParagraphRef paragraph = ListGetRef(&text->paragraphs, paragraphIndex);
+        SBUInteger paragraphStart = paragraph->index;
+        SBUInteger paragraphEnd = paragraphStart + paragraph->length;
+        SBBoolean isUntouched;
+
+        /* Skip the regions ending before the paragraph */
+        while (regionIndex < regionCount
+               && regions[regionIndex].oldIndex + regions[regionIndex].oldLength < paragraphStart) {
+            indexDelta += (SBInteger)(regions[regionIndex].newLength - regions[regionIndex].oldLength);
+            regionIndex += 1;
+        }
+
+        isUntouched = (regionIndex == regionCount || regions[regionIndex].oldIndex > paragraphEnd);
+
+        if (isUntouched) {
+            SBUInteger newStart = paragraphStart + indexDelta;
+
+            AppendScannedParagraphs(text, &paragraphs, scanIndex, newStart);
+
+            paragraph->index = newStart;
+            scanIndex = newStart + paragraph->length;
+
+            if (!ListAdd(&paragraphs, paragraph)) {
+                FinalizeTextParagraph(paragraph);
+            }
+        } else if (IsParagraphKeptByRegion(text, paragraph, &regions[regionIndex],
+                       regionIndex + 1 < regionCount ? &regions[regionIndex + 1] : NULL,
+                       paragraphStart + indexDelta)) {
+            const EditRegion *region = &regions[regionIndex];
+            SBUInteger newStart = paragraphStart + indexDelta;
+            SBUInteger newLength = paragraph->length - region->oldLength + region->newLength;
+
+            AppendScannedParagraphs(text, &paragraphs, scanIndex, newStart);
+
+            MarkOutdatedScripts(paragraph, paragraphStart, newLength,
+                region->oldIndex, region->oldLength, region->newLength);
+            paragraph->index = newStart;
+            paragraph->length = newLength;
+            paragraph->needsReanalysis = SBTrue;
+            scanIndex = newStart + newLength;
+
+            if (!ListAdd(&paragraphs, paragraph)) {
+                FinalizeTextParagraph(paragraph);
+            }
+        } else {
+            FinalizeTextParagraph(paragraph);
+        }
+    }
+
+    AppendScannedParagraphs(text, &paragraphs, scanIndex, text->codeUnits.count);
+
+    ListFinalize(&text->paragraphs);
+    *(ListRef)&text->paragraphs = paragraphs;
+}
+
+/**
+ * Copies the bidi types of the code units outside the regions of the edit log to their new
+ * positions.
+ */
+static void CopyUneditedBidiTypes(EditLogRef editLog,
+    const SBBidiType *oldTypes, SBBidiType *newTypes)
+{
+    const EditRegion *regions = editLog->regions.items;
+    SBUInteger regionCount = editLog->regions.count;
+    SBUInteger oldIndex = 0;
+    SBUInteger newIndex = 0;
+    SBUInteger regionIndex;
+
+    for (regionIndex = 0; regionIndex <= regionCount; regionIndex++) {
+        SBUInteger spanEnd;
+        SBUInteger spanLength;
+
+        if (regionIndex < regionCount) {
+            spanEnd = regions[regionIndex].oldIndex;
+        } else {
+            spanEnd = editLog->originalLength;
+        }
+
+        spanLength = spanEnd - oldIndex;
+
+        if (spanLength > 0) {
+            memcpy(&newTypes[newIndex], &oldTypes[oldIndex], spanLength * sizeof(SBBidiType));
+        }
+
+        if (regionIndex < regionCount) {
+            oldIndex = spanEnd + regions[regionIndex].oldLength;
+            newIndex = regions[regionIndex].newIndex + regions[regionIndex].newLength;
+        }
+    }
+}
+
+/**
+ * Applies the pieces of the edit log one at a time through immediate editing, for when the memory
+ * needed to apply them in a single pass is not available. The inserted code units then take their
+ * attributes from the code units preceding each piece rather than from each recorded edit.
+ */
+static void ApplyEditPiecesSeparately(SBMutableTextRef text)
+{
+    EditLogRef editLog = &text->editLog;
+    SBUInteger originalIndex = 0;
+    SBUInteger index = 0;
+    SBUInteger pieceIndex;
+
+    for (pieceIndex = 0; pieceIndex < editLog->pieces.count; pieceIndex++) {
+        const EditPiece *piece = ListGetRef(&editLog->pieces, pieceIndex);
+
+        if (piece->isInserted) {
+            InsertCodeUnitsImmediately(text, index,
+                EditLogGetInsertedUnits(editLog, piece), piece->length);
+        } else {
+            /* Remove the original code units skipped by the piece */
+            if (piece->offset > originalIndex) {
+                DeleteCodeUnitsImmediately(text, index, piece->offset - originalIndex);
+            }
+
+            originalIndex = piece->offset + piece->length;
+        }
+
+        index += piece->length;
+    }
+
+    if (originalIndex < editLog->originalLength) {
+        DeleteCodeUnitsImmediately(text, index, editLog->originalLength - originalIndex);
+    }
+}
+
+/**
+ * Applies all the edits recorded during an editing session in a single pass, rebuilding the code
+ * units, the bidi types, the paragraph list and the attribute entries once, regardless of the
+ * number of edits. If the memory for that is not available, the edits are applied one at a time
+ * instead, so they are never lost.
+ */
+static void ApplyPendingEdits(SBMutableTextRef text)
+{
+    EditLogRef editLog = &text->editLog;
+
+    if (editLog->hasEdits) {
+        List codeUnits;
+        List bidiTypes;
+
+        ListInitialize(&codeUnits, text->codeUnits.itemSize);
+        ListInitialize(&bidiTypes, sizeof(SBBidiType));
+
+        if (EditLogCollectRegions(editLog)
+            && ListReserveRange(&codeUnits, 0, editLog->length)
+            && ListReserveRange(&bidiTypes, 0, editLog->length)) {
+            const EditRegion *regions = editLog->regions.items;
+            SBUInteger regionCount = editLog->regions.count;
+            SBUInteger regionIndex;
+
+            /* Build the edited code units and carry over the unaffected bidi types */
+            EditLogCopyCodeUnits(editLog, text->codeUnits.data, codeUnits.data);
+            CopyUneditedBidiTypes(editLog, text->bidiTypes.items, (SBBidiType *)bidiTypes.data);
+
+            ListFinalize(&text->codeUnits);
+            text->codeUnits = codeUnits;
+
+            ListFinalize(&text->bidiTypes);
+            *(ListRef)&text->bidiTypes = bidiTypes;
+
+            /* Determine the bidi types in and around each region */
+            for (regionIndex = 0; regionIndex < regionCount; regionIndex++) {
+                DetermineChunkBidiTypes(text, regions[regionIndex].newIndex,
+                    regions[regionIndex].newLength);
+            }
+
+            RebuildParagraphsForEditRegions(text);
+            AttributeManagerReplaceRegions(&text->attributeManager, editLog);
+        } else {
+            ListFinalize(&codeUnits);
+            ListFinalize(&bidiTypes);
+
+            /* The text is edited directly from now on, so it must not look pending anymore */
+            editLog->hasEdits = SBFalse;
+            ApplyEditPiecesSeparately(text);
+        }
+
+        EditLogReset(editLog);
+    }
+}
+
+/**
+ * Records an edit in the log of the current editing session.
+ *
+ * @return
+ *      SBTrue if the edit was recorded, SBFalse if the text is not being edited or the edit could
+ *      not be recorded, in which case it must be applied immediately.
+ */
+static SBBoolean RecordPendingEdit(SBMutableTextRef text, SBUInteger index, SBUInteger oldLength,
+    const void *codeUnitBuffer, SBUInteger newLength)
+{
+    if (text->isEditing) {
+        if (EditLogRecord(&text->editLog, text->codeUnits.count,
+                index, oldLength, codeUnitBuffer, newLength)) {
+            return SBTrue;
+        }
+
+        /* Fall back to applying the edit immediately */
+        ApplyPendingEdits(text);
+    }
+
+    return SBFalse;
+}
+
 static void GenerateBidiParagraph(SBMutableTextRef text, TextParagraphRef paragraph)
 {
     SBCodepointSequence codepointSequence;
@@ -633,6 +1455,10 @@ static void GenerateBidiParagraph(SBMutableTextRef text, TextParagraphRef paragr
         &codepointSequence, bidiTypes, paragraph->index, paragraph->length, text->baseLevel);
 }
 
+/**
+ * Resolves the scripts of a whole paragraph. The starts of the script runs at which no paired
+ * punctuation is open are kept as anchors, since resolution can be restarted from any of them.
+ */
 static void PopulateParagraphScripts(SBMutableTextRef text, TextParagraphRef paragraph)
 {
     SBScriptLocatorRef scriptLocator;
@@ -647,6 +1473,9 @@ static void PopulateParagraphScripts(SBMutableTextRef text, TextParagraphRef par
 
     ListRemoveAll(&paragraph->scripts);
     ListReserveRange(&paragraph->scripts, 0, paragraph->length);
+    ListRemoveAll(&paragraph->scriptAnchors);
+
+    SB_TRACE_BEGIN(SBTraceStageScriptLocation, paragraph->length);
 
     scriptAgent = &scriptLocator->agent;
     SBScriptLocatorLoadCodepoints(scriptLocator, &codepointSequence);
@@ -660,6 +1489,177 @@ static void PopulateParagraphScripts(SBMutableTextRef text, TextParagraphRef par
             ListSetVal(&paragraph->scripts, runStart, runScript);
             runStart += 1;
         }
+
+        if (runEnd < paragraph->length && ScriptStackIsEmpty(&scriptLocator->_scriptStack)) {
+            ListAdd(&paragraph->scriptAnchors, &runEnd);
+        }
+    }
+
+    SB_STATISTICS_ADD(StatisticCodeUnitsScripted, paragraph->length);
+    SB_TRACE_END(SBTraceStageScriptLocation, paragraph->length);
+}
+
+/**
+ * Re-resolves the scripts of a paragraph around its outdated code units and splices them into the
+ * existing ones. Resolution restarts from the last anchor before the edit and stops at the first
+ * run start after it which matches a previous anchor, as the remaining runs cannot change anymore.
+ */
+static void UpdateParagraphScripts(SBMutableTextRef text, TextParagraphRef paragraph)
+{
+    SBUInteger editStart = paragraph->scriptEditStart;
+    SBUInteger editEnd = paragraph->scriptEditEnd;
+    SBUInteger oldLength = paragraph->scripts.count;
+    SBUInteger newLength = paragraph->length;
+    SBUInteger oldEditEnd = editEnd + oldLength - newLength;
+    SBScriptLocatorRef scriptLocator;
+    SBCodepointSequence codepointSequence;
+    const SBScriptAgent *scriptAgent;
+    SBUInteger anchorIndex;
+    SBUInteger restartIndex;
+    SBBoolean isStable;
+
+    if (editStart == editEnd && oldLength == newLength) {
+        return;
+    }
+
+    /* Move the scripts after the edit to their new positions */
+    if (newLength > oldLength) {
+        ListReserveRange(&paragraph->scripts, editStart, newLength - oldLength);
+    } else if (newLength < oldLength) {
+        ListRemoveRange(&paragraph->scripts, editStart, oldLength - newLength);
+    }
+
+    /* Find the last anchor before the edit */
+    anchorIndex = 0;
+    while (anchorIndex < paragraph->scriptAnchors.count
+           && ListGetVal(&paragraph->scriptAnchors, anchorIndex) < editStart) {
+        anchorIndex += 1;
+    }
+    restartIndex = (anchorIndex > 0 ? ListGetVal(&paragraph->scriptAnchors, anchorIndex - 1) : 0);
+
+    scriptLocator = text->scriptLocator;
+    scriptAgent = &scriptLocator->agent;
+    isStable = SBFalse;
+
+    codepointSequence.stringEncoding = text->encoding;
+    codepointSequence.stringBuffer = ListGetPtr(&text->codeUnits, paragraph->index + restartIndex);
+    codepointSequence.stringLength = newLength - restartIndex;
+
+    SB_TRACE_BEGIN(SBTraceStageScriptLocation, codepointSequence.stringLength);
+
+    SBScriptLocatorLoadCodepoints(scriptLocator, &codepointSequence);
+
+    while (SBScriptLocatorMoveNext(scriptLocator)) {
+        SBUInteger runStart = restartIndex + scriptAgent->offset;
+        SBUInteger runEnd = runStart + scriptAgent->length;
+        SBScript runScript = scriptAgent->script;
+        SBUInteger staleEnd;
+
+        while (runStart < runEnd) {
+            ListSetVal(&paragraph->scripts, runStart, runScript);
+            runStart += 1;
+        }
+
+        if (runEnd == newLength || !ScriptStackIsEmpty(&scriptLocator->_scriptStack)) {
+            continue;
+        }
+
+        /* Drop the previous anchors that are either edited or passed by the new runs */
+        staleEnd = anchorIndex;
+        while (staleEnd < paragraph->scriptAnchors.count) {
+            SBUInteger anchor = ListGetVal(&paragraph->scriptAnchors, staleEnd);
+
+            if (anchor >= oldEditEnd && anchor - oldEditEnd + editEnd >= runEnd) {
+                break;
+            }
+
+            staleEnd += 1;
+        }
+        ListRemoveRange(&paragraph->scriptAnchors, anchorIndex, staleEnd - anchorIndex);
+
+        if (anchorIndex < paragraph->scriptAnchors.count) {
+            SBUInteger anchor = ListGetVal(&paragraph->scriptAnchors, anchorIndex);
+
+            if (anchor - oldEditEnd + editEnd == runEnd) {
+                isStable = SBTrue;
+                break;
+            }
+        }
+
+        if (ListInsert(&paragraph->scriptAnchors, anchorIndex, &runEnd)) {
+            anchorIndex += 1;
+        }
+    }
+
+    if (isStable) {
+        /* Shift the remaining anchors by the change in length */
+        while (anchorIndex < paragraph->scriptAnchors.count) {
+            SBUInteger *anchor = ListGetRef(&paragraph->scriptAnchors, anchorIndex);
+            *anchor = *anchor - oldLength + newLength;
+            anchorIndex += 1;
+        }
+
+        SB_STATISTICS_ADD(StatisticCodeUnitsScripted,
+            scriptAgent->offset + scriptAgent->length);
+    } else {
+        ListRemoveRange(&paragraph->scriptAnchors, anchorIndex,
+            paragraph->scriptAnchors.count - anchorIndex);
+
+        SB_STATISTICS_ADD(StatisticCodeUnitsScripted, codepointSequence.stringLength);
+    }
+
+    SB_TRACE_END(SBTraceStageScriptLocation, codepointSequence.stringLength);
+}
+
+/**
+ * Gives a paragraph a bidi paragraph over the current code units and bidi types of the text,
+ * taking the levels already resolved by another bidi paragraph of the same content. The paragraph
+ * is marked for reanalysis if the new bidi paragraph cannot be allocated.
+ */
+static void RebuildBidiParagraph(SBMutableTextRef text, TextParagraphRef paragraph,
+    SBParagraphRef resolvedParagraph)
+{
+    SBCodepointSequence codepointSequence;
+    SBParagraphRef bidiParagraph;
+
+    codepointSequence.stringEncoding = text->encoding;
+    codepointSequence.stringBuffer = text->codeUnits.data;
+    codepointSequence.stringLength = text->codeUnits.count;
+
+    bidiParagraph = SBParagraphCreateWithResolvedLevels(&codepointSequence,
+        text->bidiTypes.items, paragraph->index, paragraph->length,
+        resolvedParagraph->baseLevel, resolvedParagraph->fixedLevels,
+        resolvedParagraph->isDegraded);
+
+    if (bidiParagraph) {
+        if (paragraph->bidiParagraph) {
+            SBParagraphRelease(paragraph->bidiParagraph);
+        }
+
+        paragraph->bidiParagraph = bidiParagraph;
+    } else {
+        /* The scripts are still valid */
+        paragraph->needsReanalysis = SBTrue;
+        paragraph->scriptEditStart = paragraph->length;
+        paragraph->scriptEditEnd = paragraph->length;
+    }
+}
+
+/**
+ * Rebuilds the bidi paragraph of an analyzed paragraph if the code units and bidi types it refers
+ * to have been moved by edits made elsewhere in the text. Its levels are still valid, so they are
+ * kept as they are rather than resolved again.
+ */
+static void RelocateBidiParagraph(SBMutableTextRef text, TextParagraphRef paragraph)
+{
+    SBParagraphRef bidiParagraph = paragraph->bidiParagraph;
+    const SBCodepointSequence *codepointSequence = &bidiParagraph->codepointSequence;
+
+    if (bidiParagraph->offset != paragraph->index
+        || bidiParagraph->refTypes != &text->bidiTypes.items[paragraph->index]
+        || codepointSequence->stringBuffer != text->codeUnits.data
+        || codepointSequence->stringLength != text->codeUnits.count) {
+        RebuildBidiParagraph(text, paragraph, bidiParagraph);
     }
 }
 
@@ -675,11 +1675,25 @@ static void AnalyzeDirtyParagraphs(SBMutableTextRef text)
     for (paragraphIndex = 0; paragraphIndex < paragraphCount; paragraphIndex++) {
         TextParagraphRef paragraph = ListGetRef(&text->paragraphs, paragraphIndex);
 
+        if (!paragraph->needsReanalysis) {
+            RelocateBidiParagraph(text, paragraph);
+        }
+
         if (paragraph->needsReanalysis) {
+            SB_TRACE_BEGIN(SBTraceStageTextAnalysis, paragraph->length);
+
             GenerateBidiParagraph(text, paragraph);
-            PopulateParagraphScripts(text, paragraph);
+
+            if (paragraph->scriptEditStart == SBInvalidIndex) {
+                PopulateParagraphScripts(text, paragraph);
+            } else {
+                UpdateParagraphScripts(text, paragraph);
+            }
 
             paragraph->needsReanalysis = SBFalse;
+            SB_STATISTICS_INCREMENT(StatisticParagraphsReanalyzed);
+
+            SB_TRACE_END(SBTraceStageTextAnalysis, paragraph->length);
         }
     }
 }
@@ -693,8 +1707,24 @@ static void FinalizeMutableText(ObjectRef object)
 
     AttributeManagerFinalize(&text->attributeManager);
     FinalizeAllParagraphs(text);
+    EditLogFinalize(&text->editLog);
+
+    switch (text->bufferKind) {
+    case TextBufferExternal:
+        if (text->bufferRelease) {
+            text->bufferRelease(text->codeUnits.data, text->codeUnits.count, text->bufferInfo);
+        }
+        break;
+
+    case TextBufferMapped:
+        FileMappingClose(text->codeUnits.data, text->codeUnits.count * text->codeUnits.itemSize);
+        break;
+
+    default:
+        ListFinalize(&text->codeUnits);
+        break;
+    }
 
-    ListFinalize(&text->codeUnits);
     ListFinalize(&text->bidiTypes);
     ListFinalize(&text->paragraphs);
 
@@ -716,6 +1746,8 @@ SB_INTERNAL SBMutableTextRef SBTextCreateMutableWithParameters(SBStringEncoding
     text = ObjectCreate(&size, 1, &pointer, FinalizeMutableText);
 
     if (text) {
+        SBBoolean isInitialized;
+
         if (attributeRegistry) {
             attributeRegistry = SBAttributeRegistryRetain(attributeRegistry);
         }
@@ -724,13 +1756,23 @@ SB_INTERNAL SBMutableTextRef SBTextCreateMutableWithParameters(SBStringEncoding
         text->isMutable = SBTrue;
         text->baseLevel = baseLevel;
         text->isEditing = SBFalse;
+        text->bufferKind = TextBufferOwned;
+        text->bufferRelease = NULL;
+        text->bufferInfo = NULL;
         text->scriptLocator = SBScriptLocatorCreate();
         text->attributeRegistry = attributeRegistry;
 
-        AttributeManagerInitialize(&text->attributeManager, text, attributeRegistry);
+        isInitialized = AttributeManagerInitialize(&text->attributeManager, text,
+            attributeRegistry);
         ListInitialize(&text->codeUnits, GetCodeUnitSize(encoding));
         ListInitialize(&text->bidiTypes, sizeof(SBBidiType));
         ListInitialize(&text->paragraphs, sizeof(TextParagraph));
+        EditLogInitialize(&text->editLog, GetCodeUnitSize(encoding));
+
+        if (!isInitialized) {
+            SBTextRelease(text);
+            text = NULL;
+        }
     }
 
     return text;
@@ -750,7 +1792,11 @@ SBMutableTextRef SBTextCreateMutable(SBStringEncoding encoding, SBTextConfigRef
 
 SBMutableTextRef SBTextCreateMutableCopy(SBTextRef text)
 {
-    SBMutableTextRef copy = SBTextCreateMutableWithParameters(text->encoding,
+    SBMutableTextRef copy;
+
+    PrepareForReading(text);
+
+    copy = SBTextCreateMutableWithParameters(text->encoding,
         text->attributeRegistry, text->baseLevel);
 
     if (copy) {
@@ -759,14 +1805,18 @@ SBMutableTextRef SBTextCreateMutableCopy(SBTextRef text)
         SBUInteger paragraphIndex;
 
         /* Copy code units */
-        ListReserveRange(&copy->codeUnits, 0, text->codeUnits.count);
-        byteCount = text->codeUnits.count * text->codeUnits.itemSize;
-        memcpy(copy->codeUnits.data, text->codeUnits.data, byteCount);
+        if (text->codeUnits.count > 0) {
+            ListReserveRange(&copy->codeUnits, 0, text->codeUnits.count);
+            byteCount = text->codeUnits.count * text->codeUnits.itemSize;
+            memcpy(copy->codeUnits.data, text->codeUnits.data, byteCount);
+        }
 
         /* Copy bidi types */
-        ListReserveRange(&copy->bidiTypes, 0, text->bidiTypes.count);
-        byteCount = text->bidiTypes.count * sizeof(SBBidiType);
-        memcpy(copy->bidiTypes.items, text->bidiTypes.items, byteCount);
+        if (text->bidiTypes.count > 0) {
+            ListReserveRange(&copy->bidiTypes, 0, text->bidiTypes.count);
+            byteCount = text->bidiTypes.count * sizeof(SBBidiType);
+            memcpy(copy->bidiTypes.items, text->bidiTypes.items, byteCount);
+        }
 
         /* Copy paragraphs */
         paragraphCount = text->paragraphs.count;
@@ -776,29 +1826,41 @@ SBMutableTextRef SBTextCreateMutableCopy(SBTextRef text)
             TextParagraphRef source = ListGetRef(&text->paragraphs, paragraphIndex);
             TextParagraphRef destination = ListGetRef(&copy->paragraphs, paragraphIndex);
 
+            InitializeTextParagraph(destination);
             destination->index = source->index;
             destination->length = source->length;
-            ListInitialize(&destination->scripts, sizeof(SBScript));
 
-            if (source->needsReanalysis) {
-                destination->needsReanalysis = SBTrue;
-                destination->bidiParagraph = NULL;
-            } else {
+            if (!source->needsReanalysis) {
                 SBUInteger scriptCount = source->scripts.count;
+                SBUInteger anchorCount = source->scriptAnchors.count;
 
                 destination->needsReanalysis = SBFalse;
-                destination->bidiParagraph = SBParagraphRetain(source->bidiParagraph);
 
-                ListReserveRange(&destination->scripts, 0, scriptCount);
-                byteCount = scriptCount * sizeof(SBScript);
-                memcpy(destination->scripts.items, source->scripts.items, byteCount);
+                if (scriptCount > 0) {
+                    ListReserveRange(&destination->scripts, 0, scriptCount);
+                    byteCount = scriptCount * sizeof(SBScript);
+                    memcpy(destination->scripts.items, source->scripts.items, byteCount);
+                }
+
+                /* Paragraphs of a single run have no anchors */
+                if (anchorCount > 0) {
+                    ListReserveRange(&destination->scriptAnchors, 0, anchorCount);
+                    byteCount = anchorCount * sizeof(SBUInteger);
+                    memcpy(destination->scriptAnchors.items, source->scriptAnchors.items, byteCount);
+                }
+
+                /* The copy owns a bidi paragraph over its own buffers with the resolved levels */
+                RebuildBidiParagraph(copy, destination, source->bidiParagraph);
             }
         }
 
         AnalyzeDirtyParagraphs(copy);
 
         /* Copy attributes */
-        AttributeManagerCopyAttributes(&copy->attributeManager, &text->attributeManager);
+        if (!AttributeManagerCopyAttributes(&copy->attributeManager, &text->attributeManager)) {
+            SBTextRelease(copy);
+            copy = NULL;
+        }
     }
 
     return copy;
@@ -815,74 +1877,95 @@ void SBTextEndEditing(SBMutableTextRef text)
 {
     SBAssert(text->isMutable);
 
+    ApplyPendingEdits(text);
     AnalyzeDirtyParagraphs(text);
     text->isEditing = SBFalse;
 }
 
+/**
+ * Updates the bidi types, paragraphs and attributes for the code units already placed at the
+ * specified range, analyzing them right away if not in batch editing mode.
+ */
+static void ProcessInsertedCodeUnits(SBMutableTextRef text, SBUInteger index, SBUInteger length)
+{
+    /* Insert bidi types */
+    ReplaceBidiTypes(text, index, 0, length);
+
+    /* Update paragraph structures */
+    UpdateParagraphsForTextInsertion(text, index, length);
+
+    /* Reserve attribute manager space */
+    AttributeManagerReserveRange(&text->attributeManager, index, length);
+
+    /* Perform immediate analysis if not in batch editing mode */
+    if (!text->isEditing) {
+        AnalyzeDirtyParagraphs(text);
+    }
+}
+
 void SBTextAppendCodeUnits(SBMutableTextRef text,
     const void *codeUnitBuffer, SBUInteger codeUnitCount)
 {
     SBAssert(text->isMutable);
 
-    SBTextInsertCodeUnits(text, text->codeUnits.count, codeUnitBuffer, codeUnitCount);
+    SBTextInsertCodeUnits(text, GetEditedLength(text), codeUnitBuffer, codeUnitCount);
 }
 
 void SBTextInsertCodeUnits(SBMutableTextRef text, SBUInteger index,
     const void *codeUnitBuffer, SBUInteger codeUnitCount)
 {
-    SBAssert(text->isMutable && index <= text->codeUnits.count);
-
-    if (codeUnitCount > 0) {
-        SBUInteger byteCount;
-        void *destination;
+    SBAssert(text->isMutable && index <= GetEditedLength(text));
 
-        /* Reserve space in code units */
-        ListReserveRange(&text->codeUnits, index, codeUnitCount);
-
-        byteCount = codeUnitCount * text->codeUnits.itemSize;
-        destination = ListGetPtr(&text->codeUnits, index);
-        memcpy(destination, codeUnitBuffer, byteCount);
+    if (codeUnitCount > 0 && !RecordPendingEdit(text, index, 0, codeUnitBuffer, codeUnitCount)) {
+        InsertCodeUnitsImmediately(text, index, codeUnitBuffer, codeUnitCount);
+    }
+}
 
-        /* Insert bidi types */
-        ReplaceBidiTypes(text, index, 0, codeUnitCount);
+static void InsertCodeUnitsImmediately(SBMutableTextRef text, SBUInteger index,
+    const void *codeUnitBuffer, SBUInteger codeUnitCount)
+{
+    SBUInteger byteCount;
+    void *destination;
 
-        /* Update paragraph structures */
-        UpdateParagraphsForTextInsertion(text, index, codeUnitCount);
+    /* Reserve space in code units */
+    ListReserveRange(&text->codeUnits, index, codeUnitCount);
 
-        /* Reserve attribute manager space */
-        AttributeManagerReserveRange(&text->attributeManager, index, codeUnitCount);
+    byteCount = codeUnitCount * text->codeUnits.itemSize;
+    destination = ListGetPtr(&text->codeUnits, index);
+    memcpy(destination, codeUnitBuffer, byteCount);
 
-        /* Perform immediate analysis if not in batch editing mode */
-        if (!text->isEditing) {
-            AnalyzeDirtyParagraphs(text);
-        }
-    }
+    ProcessInsertedCodeUnits(text, index, codeUnitCount);
 }
 
 void SBTextDeleteCodeUnits(SBMutableTextRef text, SBUInteger index, SBUInteger length)
 {
     SBUInteger rangeEnd = index + length;
-    SBBoolean isRangeValid = (rangeEnd <= text->codeUnits.count && index <= rangeEnd);
+    SBBoolean isRangeValid = (rangeEnd <= GetEditedLength(text) && index <= rangeEnd);
 
     SBAssert(text->isMutable && isRangeValid);
 
-    if (length > 0) {
-        /* Remove code units */
-        ListRemoveRange(&text->codeUnits, index, length);
+    if (length > 0 && !RecordPendingEdit(text, index, length, NULL, 0)) {
+        DeleteCodeUnitsImmediately(text, index, length);
+    }
+}
 
-        /* Remove bidi types */
-        ReplaceBidiTypes(text, index, length, 0);
+static void DeleteCodeUnitsImmediately(SBMutableTextRef text, SBUInteger index, SBUInteger length)
+{
+    /* Remove code units */
+    ListRemoveRange(&text->codeUnits, index, length);
 
-        /* Update paragraph structures */
-        UpdateParagraphsForTextRemoval(text, index, length);
+    /* Remove bidi types */
+    ReplaceBidiTypes(text, index, length, 0);
 
-        /* Remove from attribute manager */
-        AttributeManagerRemoveRange(&text->attributeManager, index, length);
+    /* Update paragraph structures */
+    UpdateParagraphsForTextRemoval(text, index, length);
 
-        if (!text->isEditing) {
-            /* Perform immediate analysis if not in batch editing mode */
-            AnalyzeDirtyParagraphs(text);
-        }
+    /* Remove from attribute manager */
+    AttributeManagerRemoveRange(&text->attributeManager, index, length);
+
+    if (!text->isEditing) {
+        /* Perform immediate analysis if not in batch editing mode */
+        AnalyzeDirtyParagraphs(text);
     }
 }
 
@@ -891,18 +1974,19 @@ void SBTextSetCodeUnits(SBMutableTextRef text,
 {
     SBAssert(text->isMutable);
 
-    SBTextReplaceCodeUnits(text, 0, text->codeUnits.count, codeUnitBuffer, codeUnitCount);
+    SBTextReplaceCodeUnits(text, 0, GetEditedLength(text), codeUnitBuffer, codeUnitCount);
 }
 
 void SBTextReplaceCodeUnits(SBMutableTextRef text, SBUInteger index, SBUInteger length,
     const void *codeUnitBuffer, SBUInteger codeUnitCount)
 {
     SBUInteger rangeEnd = index + length;
-    SBBoolean isRangeValid = (rangeEnd <= text->codeUnits.count && index <= rangeEnd);
+    SBBoolean isRangeValid = (rangeEnd <= GetEditedLength(text) && index <= rangeEnd);
 
     SBAssert(text->isMutable && isRangeValid);
 
-    if (length > 0 || codeUnitCount > 0) {
+    if ((length > 0 || codeUnitCount > 0)
+        && !RecordPendingEdit(text, index, length, codeUnitBuffer, codeUnitCount)) {
         if (codeUnitCount > length) {
             ListReserveRange(&text->codeUnits, index, codeUnitCount - length);
         } else {
@@ -935,8 +2019,12 @@ void SBTextSetAttribute(SBMutableTextRef text, SBUInteger index, SBUInteger leng
     SBAttributeID attributeID, const void *attributeValue)
 {
     SBUInteger rangeEnd = index + length;
-    SBBoolean isRangeValid = (rangeEnd <= text->codeUnits.count && index <= rangeEnd);
+    SBBoolean isRangeValid;
+
+    /* Attributes are resolved against the paragraphs, so apply the pending edits first */
+    ApplyPendingEdits(text);
 
+    isRangeValid = (rangeEnd <= text->codeUnits.count && index <= rangeEnd);
     SBAssert(text->isMutable && isRangeValid);
 
     if (length > 0) {
@@ -945,12 +2033,38 @@ void SBTextSetAttribute(SBMutableTextRef text, SBUInteger index, SBUInteger leng
     }
 }
 
+void SBTextApplyAttributeSpans(SBMutableTextRef text,
+    const SBAttributeSpan *spans, SBUInteger count)
+{
+    SBUInteger spanIndex;
+
+    SBAssert(text->isMutable && (spans || count == 0));
+
+    ApplyPendingEdits(text);
+
+    /* Validate the ranges and the order of spans */
+    for (spanIndex = 0; spanIndex < count; spanIndex++) {
+        SBUInteger rangeEnd = spans[spanIndex].index + spans[spanIndex].length;
+        SBBoolean isRangeValid = (rangeEnd <= text->codeUnits.count
+            && spans[spanIndex].index <= rangeEnd);
+        SBBoolean isOrderValid = (spanIndex == 0
+            || spans[spanIndex - 1].index <= spans[spanIndex].index);
+
+        SBAssert(isRangeValid && isOrderValid);
+    }
+
+    AttributeManagerApplyAttributeSpans(&text->attributeManager, spans, count);
+}
+
 void SBTextRemoveAttribute(SBMutableTextRef text, SBUInteger index, SBUInteger length,
     SBAttributeID attributeID)
 {
     SBUInteger rangeEnd = index + length;
-    SBBoolean isRangeValid = (rangeEnd <= text->codeUnits.count && index <= rangeEnd);
+    SBBoolean isRangeValid;
+
+    ApplyPendingEdits(text);
 
+    isRangeValid = (rangeEnd <= text->codeUnits.count && index <= rangeEnd);
     SBAssert(text->isMutable && isRangeValid);
 
     if (length > 0) {
@@ -30,13 +30,24 @@
 #include <Core/List.h>
 #include <Core/Object.h>
 #include <Text/AttributeManager.h>
+#include <Text/EditLog.h>
+
+enum {
+    TextBufferOwned = 0,        /**< The code units are owned by the text */
+    TextBufferExternal = 1,     /**< The code units are referenced from a caller's buffer */
+    TextBufferMapped = 2        /**< The code units are referenced from a mapped file */
+};
+typedef SBUInt8 TextBufferKind;
 
 typedef struct _TextParagraph {
     SBUInteger index;
     SBUInteger length;
     SBBoolean needsReanalysis;
+    SBUInteger scriptEditStart;
+    SBUInteger scriptEditEnd;
     SBParagraphRef bidiParagraph;
     LIST(SBScript) scripts;
+    LIST(SBUInteger) scriptAnchors;
 } TextParagraph, *TextParagraphRef;
 
 typedef struct _SBText {
@@ -45,12 +56,16 @@ typedef struct _SBText {
     SBBoolean isMutable;
     SBLevel baseLevel;
     SBBoolean isEditing;
+    TextBufferKind bufferKind;
+    SBTextBufferReleaseFunc bufferRelease;
+    void *bufferInfo;
     SBScriptLocatorRef scriptLocator;
     SBAttributeRegistryRef attributeRegistry;
     AttributeManager attributeManager;
     List codeUnits;
     LIST(SBBidiType) bidiTypes;
     LIST(TextParagraph) paragraphs;
+    EditLog editLog;
 } SBText;
 
 /**
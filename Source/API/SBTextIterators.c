@@ -21,8 +21,10 @@
 #include <stddef.h>
 
 #include <API/SBAssert.h>
+#include <API/SBAttributeInfo.h>
 #include <API/SBAttributeList.h>
 #include <API/SBAttributeRegistry.h>
+#include <API/SBCodepointSequence.h>
 #include <API/SBLine.h>
 #include <API/SBParagraph.h>
 #include <API/SBText.h>
@@ -67,6 +69,7 @@ static void InitializeTextIterator(TextIteratorRef iterator, SBTextRef text,
 {
     iterator->text = SBTextRetain(text);
     iterator->visualDirectionMode = visualDirectionMode;
+    iterator->indexEncoding = text->encoding;
 
     ResetTextIterator(iterator, 0, text->codeUnits.count);
 }
@@ -146,6 +149,81 @@ static void ResetTextIterator(TextIteratorRef iterator, SBUInteger index, SBUInt
     iterator->currentParagraph = NULL;
     iterator->paragraphStart = SBInvalidIndex;
     iterator->paragraphEnd = SBInvalidIndex;
+
+    /* Remember the window so that it can be iterated again in another index encoding */
+    iterator->windowStart = startIndex;
+    iterator->windowEnd = endIndex;
+    iterator->convertsIndexes = (iterator->indexEncoding != text->encoding);
+
+    if (iterator->convertsIndexes) {
+        SBCodepointSequence *sequence = &iterator->codepointSequence;
+
+        sequence->stringEncoding = text->encoding;
+        sequence->stringBuffer = text->codeUnits.data;
+        sequence->stringLength = text->codeUnits.count;
+
+        /* Translate the side of the window from which the paragraphs are visited */
+        IndexConverterInitialize(&iterator->indexConverter, sequence,
+            text->encoding, iterator->indexEncoding);
+        iterator->convertedIndex = IndexConverterConvert(&iterator->indexConverter,
+            forwardMode ? startIndex : endIndex);
+    }
+}
+
+/**
+ * Sets up the index converter of a text iterator for its current paragraph, measuring the paragraph
+ * in the index encoding to keep track of the translated bounds of the remaining range.
+ */
+static void LoadParagraphConversion(TextIteratorRef iterator)
+{
+    IndexConverter *converter = &iterator->indexConverter;
+    SBUInteger paragraphStart = iterator->paragraphStart;
+    SBUInteger convertedLength;
+    SBUInteger convertedStart;
+
+    IndexConverterSetOrigin(converter, paragraphStart, paragraphStart, 0);
+    convertedLength = IndexConverterConvert(converter, iterator->paragraphEnd);
+
+    if (iterator->forwardMode) {
+        convertedStart = iterator->convertedIndex;
+        iterator->convertedIndex += convertedLength;
+    } else {
+        iterator->convertedIndex -= convertedLength;
+        convertedStart = iterator->convertedIndex;
+    }
+
+    /* Runs of the paragraph are translated from its start */
+    IndexConverterSetOrigin(converter, paragraphStart, paragraphStart, convertedStart);
+}
+
+/**
+ * Translates a range of code units within the current paragraph to the index encoding of a text
+ * iterator, leaving it as is if the iterator reports code units of the text.
+ */
+static void ConvertTextIteratorRange(TextIteratorRef iterator,
+    SBUInteger *index, SBUInteger *length)
+{
+    if (iterator->convertsIndexes) {
+        IndexConverter *converter = &iterator->indexConverter;
+        SBUInteger start = IndexConverterConvert(converter, *index);
+        SBUInteger end = IndexConverterConvert(converter, *index + *length);
+
+        *index = start;
+        *length = end - start;
+    }
+}
+
+/**
+ * Changes the index encoding of a text iterator and restarts the iteration of its window.
+ */
+static void SetupTextIteratorIndexEncoding(TextIteratorRef iterator, SBStringEncoding encoding)
+{
+    SBAssert(encoding == SBStringEncodingUTF8 || encoding == SBStringEncodingUTF16
+             || encoding == SBStringEncodingUTF32);
+
+    iterator->indexEncoding = encoding;
+
+    ResetTextIterator(iterator, iterator->windowStart, iterator->windowEnd - iterator->windowStart);
 }
 
 static SBBoolean AdvanceTextIterator(TextIteratorRef iterator)
@@ -173,6 +251,10 @@ static SBBoolean AdvanceTextIterator(TextIteratorRef iterator)
         iterator->paragraphStart = paragraphStart;
         iterator->paragraphEnd = paragraphEnd;
 
+        if (iterator->convertsIndexes) {
+            LoadParagraphConversion(iterator);
+        }
+
         /* Update iterator position based on the direction */
         if (iterator->forwardMode) {
             /* Move forward to the next paragraph */
@@ -353,6 +435,15 @@ void SBLogicalRunIteratorReset(SBLogicalRunIteratorRef iterator, SBUInteger inde
     iterator->levelIndex = SBInvalidIndex;
 }
 
+void SBLogicalRunIteratorSetupIndexEncoding(SBLogicalRunIteratorRef iterator,
+    SBStringEncoding encoding)
+{
+    SetupTextIteratorIndexEncoding(&iterator->parent, encoding);
+    InitializeLogicalRun(&iterator->currentRun);
+
+    iterator->levelIndex = SBInvalidIndex;
+}
+
 const SBLogicalRun *SBLogicalRunIteratorGetCurrent(SBLogicalRunIteratorRef iterator)
 {
     return &iterator->currentRun;
@@ -366,19 +457,14 @@ SBBoolean SBLogicalRunIteratorMoveNext(SBLogicalRunIteratorRef iterator)
 
     /* Check if we need to load a new paragraph */
     if (iterator->levelIndex == SBInvalidIndex) {
-        SBLogicalRun *currentRun = &iterator->currentRun;
-        SBUInteger runStart = parent->startIndex;
-
         /* Attempt to load the next paragraph */
         if (AdvanceTextIterator(parent)) {
             textParagraph = parent->currentParagraph;
             iterator->levelIndex = 0;
-            currentRun->index = runStart;
-            currentRun->length = 0;
         } else {
             /* No more paragraphs available */
             textParagraph = NULL;
-            InitializeLogicalRun(currentRun);
+            InitializeLogicalRun(&iterator->currentRun);
         }
     }
 
@@ -403,9 +489,10 @@ SBBoolean SBLogicalRunIteratorMoveNext(SBLogicalRunIteratorRef iterator)
         }
 
         /* Update the run information */
-        currentRun->index += currentRun->length;
+        currentRun->index = parent->paragraphStart + currentLevelStart;
         currentRun->length = iterator->levelIndex - currentLevelStart;
         currentRun->level = currentLevel;
+        ConvertTextIteratorRange(parent, &currentRun->index, &currentRun->length);
 
         /* Check if the end of the paragraph is reached */
         if (iterator->levelIndex == paragraphLength) {
@@ -495,6 +582,15 @@ void SBScriptRunIteratorReset(SBScriptRunIteratorRef iterator, SBUInteger index,
     iterator->scriptIndex = SBInvalidIndex;
 }
 
+void SBScriptRunIteratorSetupIndexEncoding(SBScriptRunIteratorRef iterator,
+    SBStringEncoding encoding)
+{
+    SetupTextIteratorIndexEncoding(&iterator->parent, encoding);
+    InitializeScriptRun(&iterator->currentRun);
+
+    iterator->scriptIndex = SBInvalidIndex;
+}
+
 const SBScriptRun *SBScriptRunIteratorGetCurrent(SBScriptRunIteratorRef iterator)
 {
     return &iterator->currentRun;
@@ -508,19 +604,14 @@ SBBoolean SBScriptRunIteratorMoveNext(SBScriptRunIteratorRef iterator)
 
     /* Check if there's a need to load a new paragraph */
     if (iterator->scriptIndex == SBInvalidIndex) {
-        SBScriptRun *currentRun = &iterator->currentRun;
-        SBUInteger runStart = parent->startIndex;
-
         /* Attempt to load the next paragraph */
         if (AdvanceTextIterator(parent)) {
             textParagraph = parent->currentParagraph;
             iterator->scriptIndex = 0;
-            currentRun->index = runStart;
-            currentRun->length = 0;
         } else {
             /* No more paragraphs available */
             textParagraph = NULL;
-            InitializeScriptRun(currentRun);
+            InitializeScriptRun(&iterator->currentRun);
         }
     }
 
@@ -543,9 +634,10 @@ SBBoolean SBScriptRunIteratorMoveNext(SBScriptRunIteratorRef iterator)
         }
 
         /* Update the run information */
-        currentRun->index += currentRun->length;
+        currentRun->index = parent->paragraphStart + scriptStart;
         currentRun->length = iterator->scriptIndex - scriptStart;
         currentRun->script = currentScript;
+        ConvertTextIteratorRange(parent, &currentRun->index, &currentRun->length);
 
         /* Check if the end of the paragraph is reached */
         if (iterator->scriptIndex == paragraphLength) {
@@ -667,16 +759,57 @@ static SBBoolean LoadOnwardAttributeRunByFilteringCollection(SBAttributeRunItera
     return result;
 }
 
+/**
+ * Advances the iterator to find the next run of text in which none of the attributes of the
+ * specified ID set changes.
+ *
+ * @param iterator
+ *      The attribute run iterator.
+ * @return
+ *      `SBTrue` if a matching run was found, `SBFalse` if the end was reached.
+ */
+static SBBoolean LoadOnwardAttributeRunByFilteringMask(SBAttributeRunIteratorRef iterator)
+{
+    SBTextRef text = iterator->text;
+    AttributeManagerRef manager = (AttributeManagerRef)&text->attributeManager;
+    SBAttributeRun *currentRun = &iterator->currentRun;
+    SBUInteger index;
+    SBBoolean result;
+
+    index = iterator->currentIndex;
+    result = AttributeManagerGetOnwardRunByFilteringMask(manager, &index, iterator->endIndex,
+        iterator->filterMask, &iterator->items);
+
+    /* Populate the current run */
+    currentRun->index = iterator->currentIndex;
+    currentRun->length = index - iterator->currentIndex;
+    currentRun->attributes = &iterator->items._list;
+
+    iterator->currentIndex = index;
+
+    return result;
+}
+
+#define ITERATOR    0
+#define MASK        1
+#define COUNT       2
+
 SB_INTERNAL SBAttributeRunIteratorRef SBAttributeRunIteratorCreate(SBTextRef text)
 {
-    const SBUInteger size = sizeof(SBAttributeRunIterator);
-    void *pointer = NULL;
+    void *pointers[COUNT] = { NULL };
+    SBUInteger sizes[COUNT] = { 0 };
+    SBUInteger maskWordCount;
     SBAttributeRunIteratorRef iterator;
 
     /* Text MUST be available. */
     SBAssert(text != NULL);
 
-    iterator = ObjectCreate(&size, 1, &pointer, FinalizeAttributeRunIterator);
+    maskWordCount = AttributeMaskGetWordCount(text->attributeRegistry->count);
+
+    sizes[ITERATOR] = sizeof(SBAttributeRunIterator);
+    sizes[MASK] = sizeof(SBUInt32) * maskWordCount;
+
+    iterator = ObjectCreate(sizes, COUNT, pointers, FinalizeAttributeRunIterator);
 
     if (iterator) {
         iterator->text = SBTextRetain(text);
@@ -686,6 +819,9 @@ SB_INTERNAL SBAttributeRunIteratorRef SBAttributeRunIteratorCreate(SBTextRef tex
         iterator->filterAttributeID = SBAttributeIDNone;
         iterator->filterGroup = SBAttributeGroupNone;
         iterator->filterScope = SBAttributeScopeCharacter;
+        iterator->filterMask = pointers[MASK];
+        iterator->maskWordCount = maskWordCount;
+        iterator->filtersByMask = SBFalse;
 
         AttributeDictionaryInitialize(&iterator->items, text->attributeRegistry->valueSize);
         InitializeAttributeRun(&iterator->currentRun);
@@ -694,6 +830,10 @@ SB_INTERNAL SBAttributeRunIteratorRef SBAttributeRunIteratorCreate(SBTextRef tex
     return iterator;
 }
 
+#undef ITERATOR
+#undef MASK
+#undef COUNT
+
 SBTextRef SBAttributeRunIteratorGetText(SBAttributeRunIteratorRef iterator)
 {
     return iterator->text;
@@ -703,6 +843,7 @@ void SBAttributeRunIteratorSetupAttributeID(SBAttributeRunIteratorRef iterator,
 {
     iterator->filterAttributeID = attributeID;
     iterator->filterGroup = SBAttributeGroupNone;
+    iterator->filtersByMask = SBFalse;
 
     /* Reset the iterator */
     iterator->currentIndex = SBInvalidIndex;
@@ -715,6 +856,37 @@ void SBAttributeRunIteratorSetupAttributeCollection(SBAttributeRunIteratorRef it
     iterator->filterAttributeID = SBAttributeIDNone;
     iterator->filterGroup = group;
     iterator->filterScope = scope;
+    iterator->filtersByMask = SBFalse;
+
+    /* Reset the iterator */
+    iterator->currentIndex = SBInvalidIndex;
+    InitializeAttributeRun(&iterator->currentRun);
+}
+
+void SBAttributeRunIteratorSetupAttributeIDs(SBAttributeRunIteratorRef iterator,
+    const SBAttributeID *attributeIDs, SBUInteger count)
+{
+    SBAttributeRegistryRef registry = iterator->text->attributeRegistry;
+    SBUInt32 *filterMask = iterator->filterMask;
+    SBUInteger wordIndex;
+    SBUInteger idIndex;
+
+    for (wordIndex = 0; wordIndex < iterator->maskWordCount; wordIndex++) {
+        filterMask[wordIndex] = 0;
+    }
+
+    for (idIndex = 0; idIndex < count; idIndex++) {
+        SBUInteger attributeIndex = SBAttributeIDGetIndex(attributeIDs[idIndex]);
+
+        /* Ignore the IDs that do not belong to the registry */
+        if (attributeIDs[idIndex] != SBAttributeIDNone && attributeIndex < registry->count) {
+            AttributeMaskAdd(filterMask, attributeIndex);
+        }
+    }
+
+    iterator->filterAttributeID = SBAttributeIDNone;
+    iterator->filterGroup = SBAttributeGroupNone;
+    iterator->filtersByMask = SBTrue;
 
     /* Reset the iterator */
     iterator->currentIndex = SBInvalidIndex;
@@ -744,7 +916,9 @@ SBBoolean SBAttributeRunIteratorMoveNext(SBAttributeRunIteratorRef iterator)
     }
 
     while (iterator->currentIndex < iterator->endIndex) {
-        if (iterator->filterAttributeID != SBAttributeIDNone) {
+        if (iterator->filtersByMask) {
+            hasRun = LoadOnwardAttributeRunByFilteringMask(iterator);
+        } else if (iterator->filterAttributeID != SBAttributeIDNone) {
             hasRun = LoadOnwardAttributeRunByFilteringID(iterator);
         } else {
             hasRun = LoadOnwardAttributeRunByFilteringCollection(iterator);
@@ -811,12 +985,13 @@ static void FinalizeVisualRunIterator(ObjectRef object)
         SBLineRelease(iterator->bidiLine);
     }
 
+    ListFinalize(&iterator->convertedRuns);
     FinalizeTextIterator(&iterator->parent);
 }
 
 SB_INTERNAL SBVisualRunIteratorRef SBVisualRunIteratorCreate(SBTextRef text)
 {
-    const SBUInteger size = sizeof(SBText);
+    const SBUInteger size = sizeof(SBVisualRunIterator);
     void *pointer = NULL;
     SBVisualRunIteratorRef iterator;
 
@@ -828,6 +1003,7 @@ SB_INTERNAL SBVisualRunIteratorRef SBVisualRunIteratorCreate(SBTextRef text)
     if (iterator) {
         InitializeTextIterator(&iterator->parent, text, SBTrue);
         InitializeVisualRun(&iterator->currentRun);
+        ListInitialize(&iterator->convertedRuns, sizeof(SBRun));
 
         iterator->bidiLine = NULL;
         iterator->runIndex = SBInvalidIndex;
@@ -841,13 +1017,31 @@ SBTextRef SBVisualRunIteratorGetText(SBVisualRunIteratorRef iterator)
     return iterator->parent.text;
 }
 
+static void ClearVisualRunIteratorLine(SBVisualRunIteratorRef iterator)
+{
+    if (iterator->bidiLine) {
+        SBLineRelease(iterator->bidiLine);
+    }
+
+    ListRemoveAll(&iterator->convertedRuns);
+
+    iterator->bidiLine = NULL;
+    iterator->runIndex = SBInvalidIndex;
+}
+
 void SBVisualRunIteratorReset(SBVisualRunIteratorRef iterator, SBUInteger index, SBUInteger length)
 {
     ResetTextIterator(&iterator->parent, index, length);
     InitializeVisualRun(&iterator->currentRun);
+    ClearVisualRunIteratorLine(iterator);
+}
 
-    iterator->bidiLine = NULL;
-    iterator->runIndex = SBInvalidIndex;
+void SBVisualRunIteratorSetupIndexEncoding(SBVisualRunIteratorRef iterator,
+    SBStringEncoding encoding)
+{
+    SetupTextIteratorIndexEncoding(&iterator->parent, encoding);
+    InitializeVisualRun(&iterator->currentRun);
+    ClearVisualRunIteratorLine(iterator);
 }
 
 const SBVisualRun *SBVisualRunIteratorGetCurrent(SBVisualRunIteratorRef iterator)
@@ -877,6 +1071,21 @@ SBBoolean SBVisualRunIteratorMoveNext(SBVisualRunIteratorRef iterator)
             /* Create a new bidirectional line from the paragraph */
             bidiLine = SBParagraphCreateLine(bidiParagraph, paragraphStart, paragraphLength);
 
+            /* Translate all runs of the line together as they are in visual order */
+            if (bidiLine && parentIterator->convertsIndexes) {
+                SBBoolean isConverted = SBFalse;
+
+                if (ListReserveRange(&iterator->convertedRuns, 0, bidiLine->runCount)) {
+                    isConverted = SBLineConvertRuns(bidiLine, &parentIterator->indexConverter,
+                        iterator->convertedRuns.items);
+                }
+
+                /* Fall back to translating the runs one by one */
+                if (!isConverted) {
+                    ListRemoveAll(&iterator->convertedRuns);
+                }
+            }
+
             /* Initialize line processing */
             iterator->bidiLine = bidiLine;
             iterator->runIndex = 0;
@@ -891,13 +1100,21 @@ SBBoolean SBVisualRunIteratorMoveNext(SBVisualRunIteratorRef iterator)
         SBRun *bidiRun;
 
         /* Get the current bidirectional run */
-        bidiRun = &bidiLine->fixedRuns[iterator->runIndex];
+        if (iterator->convertedRuns.count > 0) {
+            bidiRun = ListGetRef(&iterator->convertedRuns, iterator->runIndex);
+        } else {
+            bidiRun = &bidiLine->fixedRuns[iterator->runIndex];
+        }
 
         /* Update the current run with bidirectional properties */
         currentRun->index = bidiRun->offset;
         currentRun->length = bidiRun->length;
         currentRun->level = bidiRun->level;
 
+        if (iterator->convertedRuns.count == 0) {
+            ConvertTextIteratorRange(&iterator->parent, &currentRun->index, &currentRun->length);
+        }
+
         /* Move to the next run in the line */
         iterator->runIndex += 1;
 
@@ -905,6 +1122,7 @@ SBBoolean SBVisualRunIteratorMoveNext(SBVisualRunIteratorRef iterator)
         if (iterator->runIndex == bidiLine->runCount) {
             /* Clean up and prepare for the next line */
             SBLineRelease(bidiLine);
+            ListRemoveAll(&iterator->convertedRuns);
             iterator->bidiLine = NULL;
         }
 
@@ -24,7 +24,9 @@
 #include <SheenBidi/SBLine.h>
 #include <SheenBidi/SBTextIterators.h>
 
+#include <API/SBCodepointSequence.h>
 #include <API/SBText.h>
+#include <Core/List.h>
 #include <Core/Object.h>
 #include <Text/AttributeDictionary.h>
 
@@ -38,6 +40,13 @@ typedef struct _TextIterator {
     TextParagraphRef currentParagraph;
     SBUInteger paragraphStart;
     SBUInteger paragraphEnd;
+    SBUInteger windowStart;
+    SBUInteger windowEnd;
+    SBStringEncoding indexEncoding;
+    SBBoolean convertsIndexes;
+    SBCodepointSequence codepointSequence;
+    IndexConverter indexConverter;
+    SBUInteger convertedIndex;  /**< Start or end of the remaining range in the index encoding. */
 } TextIterator, *TextIteratorRef;
 
 typedef struct _SBParagraphIterator {
@@ -71,6 +80,9 @@ typedef struct _SBAttributeRunIterator {
     SBAttributeID filterAttributeID;
     SBAttributeGroup filterGroup;
     SBAttributeScope filterScope;
+    SBUInt32 *filterMask;
+    SBUInteger maskWordCount;
+    SBBoolean filtersByMask;
 } SBAttributeRunIterator;
 
 typedef struct _SBVisualRunIterator {
@@ -79,6 +91,7 @@ typedef struct _SBVisualRunIterator {
     SBLineRef bidiLine;
     SBUInteger runIndex;
     SBVisualRun currentRun;
+    LIST(SBRun) convertedRuns;
 } SBVisualRunIterator;
 
 /**
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stddef.h>
+
+#include <API/SBBase.h>
+#include <Core/AtomicPointer.h>
+
+#include "SBTrace.h"
+
+#ifndef SB_CONFIG_DISABLE_TRACE
+
+typedef AtomicPointerType(SBTraceHandler) AtomicTraceHandlerRef;
+
+static AtomicTraceHandlerRef ActiveTraceHandler = NULL;
+
+SB_INTERNAL void SBTraceEmit(const SBTraceHandler *handler, SBTraceEventFunc func,
+    SBTraceStage stage, SBUInteger codeUnitCount)
+{
+    SBTraceEvent event;
+
+    event.codeUnitCount = codeUnitCount;
+    event.stage = stage;
+
+    func(&event, handler->info);
+}
+
+const SBTraceHandler *SBTraceGetHandler(void)
+{
+    return AtomicPointerLoad(&ActiveTraceHandler);
+}
+
+void SBTraceSetHandler(const SBTraceHandler *handler)
+{
+    AtomicPointerStore(&ActiveTraceHandler, (SBTraceHandler *)handler);
+}
+
+#else
+
+const SBTraceHandler *SBTraceGetHandler(void)
+{
+    return NULL;
+}
+
+void SBTraceSetHandler(const SBTraceHandler *handler)
+{
+}
+
+#endif
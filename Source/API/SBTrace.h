@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _SB_INTERNAL_TRACE_H
+#define _SB_INTERNAL_TRACE_H
+
+#include <SheenBidi/SBTrace.h>
+
+#include <API/SBBase.h>
+
+#ifndef SB_CONFIG_DISABLE_TRACE
+
+SB_INTERNAL void SBTraceEmit(const SBTraceHandler *handler, SBTraceEventFunc func,
+    SBTraceStage stage, SBUInteger codeUnitCount);
+
+/**
+ * Emits an event through the given callback of the active handler. The code unit count is only
+ * evaluated when a handler is active, so it may be an expression of moderate cost.
+ */
+#define SB_TRACE_EVENT(member, stage, count)                        \
+do {                                                                \
+    const SBTraceHandler *_handler = SBTraceGetHandler();           \
+                                                                    \
+    if (_handler && _handler->member) {                             \
+        SBTraceEmit(_handler, _handler->member, stage, count);      \
+    }                                                               \
+} while (0)
+
+#define SB_TRACE_BEGIN(stage, count)    SB_TRACE_EVENT(begin, stage, count)
+#define SB_TRACE_END(stage, count)      SB_TRACE_EVENT(end, stage, count)
+
+/**
+ * Tells whether a handler is installed, for counts that are too costly to compute otherwise.
+ */
+#define SB_TRACE_IS_ACTIVE()            (SBTraceGetHandler() != NULL)
+
+#else
+
+#define SB_TRACE_NONE()
+
+#define SB_TRACE_IS_ACTIVE()            SBFalse
+
+#define SB_TRACE_BEGIN(stage, count)    SB_TRACE_NONE()
+#define SB_TRACE_END(stage, count)      SB_TRACE_NONE()
+
+#endif
+
+#endif
@@ -37,11 +37,11 @@ typedef SBUInteger AtomicUInt;
 #define HAS_ATOMIC_UINT_SUPPORT
 #ifdef _WIN64
 #pragma intrinsic(_InterlockedExchange64, _InterlockedCompareExchange64)
-#pragma intrinsic(_InterlockedIncrement64, _InterlockedDecrement64)
+#pragma intrinsic(_InterlockedIncrement64, _InterlockedDecrement64, _InterlockedExchangeAdd64)
 typedef volatile __int64 AtomicUInt;
 #else
 #pragma intrinsic(_InterlockedExchange, _InterlockedCompareExchange)
-#pragma intrinsic(_InterlockedIncrement, _InterlockedDecrement)
+#pragma intrinsic(_InterlockedIncrement, _InterlockedDecrement, _InterlockedExchangeAdd)
 typedef volatile long AtomicUInt;
 #endif
 
@@ -73,6 +73,9 @@ typedef AtomicUInt *AtomicUIntRef;
     atomic_compare_exchange_strong(aui, expected, desired)
 #define AtomicUIntIncrement(aui)            ((SBUInteger)(atomic_fetch_add(aui, 1) + 1))
 #define AtomicUIntDecrement(aui)            ((SBUInteger)(atomic_fetch_sub(aui, 1) - 1))
+#define AtomicUIntLoadRelaxed(aui)          atomic_load_explicit(aui, memory_order_relaxed)
+#define AtomicUIntAddRelaxed(aui, value)    \
+    ((void)atomic_fetch_add_explicit(aui, value, memory_order_relaxed))
 
 #elif defined(USE_ATOMIC_BUILTINS)
 
@@ -83,6 +86,8 @@ typedef AtomicUInt *AtomicUIntRef;
     __atomic_compare_exchange_n(aui, expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
 #define AtomicUIntIncrement(aui)            __atomic_add_fetch(aui, 1, __ATOMIC_SEQ_CST)
 #define AtomicUIntDecrement(aui)            __atomic_sub_fetch(aui, 1, __ATOMIC_SEQ_CST)
+#define AtomicUIntLoadRelaxed(aui)          __atomic_load_n(aui, __ATOMIC_RELAXED)
+#define AtomicUIntAddRelaxed(aui, value)    ((void)__atomic_fetch_add(aui, value, __ATOMIC_RELAXED))
 
 #elif defined(USE_SYNC_BUILTINS)
 
@@ -93,6 +98,8 @@ typedef AtomicUInt *AtomicUIntRef;
     __sync_bool_compare_and_swap(aui, *(expected), desired)
 #define AtomicUIntIncrement(aui)            __sync_add_and_fetch(aui, 1)
 #define AtomicUIntDecrement(aui)            __sync_sub_and_fetch(aui, 1)
+#define AtomicUIntLoadRelaxed(aui)          AtomicUIntLoad(aui)
+#define AtomicUIntAddRelaxed(aui, value)    ((void)__sync_fetch_and_add(aui, value))
 
 #elif defined(USE_WIN_INTRINSICS)
 
@@ -104,6 +111,7 @@ typedef AtomicUInt *AtomicUIntRef;
     (((SBUInteger)_InterlockedCompareExchange64(aui, (__int64)(desired), (__int64)(*(expected)))) == *(expected))
 #define AtomicUIntIncrement(aui)            ((SBUInteger)_InterlockedIncrement64(aui))
 #define AtomicUIntDecrement(aui)            ((SBUInteger)_InterlockedDecrement64(aui))
+#define AtomicUIntAddRelaxed(aui, value)    ((void)_InterlockedExchangeAdd64(aui, (__int64)(value)))
 #else
 #define AtomicUIntInitialize(aui, value)    (*(aui) = (long)(value))
 #define AtomicUIntLoad(aui)                 ((SBUInteger)_InterlockedCompareExchange(aui, 0, 0))
@@ -112,7 +120,9 @@ typedef AtomicUInt *AtomicUIntRef;
     (((SBUInteger)_InterlockedCompareExchange(aui, (long)(desired), (long)(*(expected)))) == *(expected))
 #define AtomicUIntIncrement(aui)            ((SBUInteger)_InterlockedIncrement(aui))
 #define AtomicUIntDecrement(aui)            ((SBUInteger)_InterlockedDecrement(aui))
+#define AtomicUIntAddRelaxed(aui, value)    ((void)_InterlockedExchangeAdd(aui, (long)(value)))
 #endif
+#define AtomicUIntLoadRelaxed(aui)          AtomicUIntLoad(aui)
 
 #elif defined(USE_WIN_INTERLOCKED)
 
@@ -124,6 +134,7 @@ typedef AtomicUInt *AtomicUIntRef;
     (((SBUInteger)InterlockedCompareExchange64(aui, (LONG64)(desired), (LONG64)(*(expected)))) == *(expected))
 #define AtomicUIntIncrement(aui)            ((SBUInteger)InterlockedIncrement64(aui))
 #define AtomicUIntDecrement(aui)            ((SBUInteger)InterlockedDecrement64(aui))
+#define AtomicUIntAddRelaxed(aui, value)    ((void)InterlockedExchangeAdd64(aui, (LONG64)(value)))
 #else
 #define AtomicUIntInitialize(aui, value)    (*(aui) = (LONG)(value))
 #define AtomicUIntLoad(aui)                 ((SBUInteger)InterlockedCompareExchange(aui, 0, 0))
@@ -132,7 +143,9 @@ typedef AtomicUInt *AtomicUIntRef;
     (((SBUInteger)InterlockedCompareExchange(aui, (LONG)(desired), (LONG)(*(expected)))) == *(expected))
 #define AtomicUIntIncrement(aui)            ((SBUInteger)InterlockedIncrement(aui))
 #define AtomicUIntDecrement(aui)            ((SBUInteger)InterlockedDecrement(aui))
+#define AtomicUIntAddRelaxed(aui, value)    ((void)InterlockedExchangeAdd(aui, (LONG)(value)))
 #endif
+#define AtomicUIntLoadRelaxed(aui)          AtomicUIntLoad(aui)
 
 #else /* Non-atomic fallback */
 
@@ -143,6 +156,8 @@ typedef AtomicUInt *AtomicUIntRef;
 #define AtomicUIntStore(aui, value)         (*(aui) = (value))
 #define AtomicUIntIncrement(aui)            (++(*(aui)))
 #define AtomicUIntDecrement(aui)            (--(*(aui)))
+#define AtomicUIntLoadRelaxed(aui)          (*(aui))
+#define AtomicUIntAddRelaxed(aui, value)    ((void)(*(aui) += (value)))
 
 #endif
 
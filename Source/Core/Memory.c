@@ -19,6 +19,7 @@
 #include <API/SBBase.h>
 #include <API/SBAllocator.h>
 #include <API/SBAssert.h>
+#include <API/SBStatistics.h>
 
 #include "Memory.h"
 
@@ -67,6 +68,12 @@ SB_INTERNAL void *MemoryAllocateBlock(MemoryRef memory, MemoryType type, SBUInte
 
     if (type == MemoryTypeScratch) {
         pointer = SBAllocatorAllocateScratch(NULL, size);
+
+        if (pointer) {
+            SB_STATISTICS_INCREMENT(StatisticScratchHits);
+        } else {
+            SB_STATISTICS_INCREMENT(StatisticScratchMisses);
+        }
     }
 
     if (!pointer) {
@@ -131,6 +138,45 @@ SB_INTERNAL SBBoolean MemoryAllocateChunks(MemoryRef memory, MemoryType type,
     return succeeded;
 }
 
+SB_INTERNAL SBUInteger MemoryGetAdoptableSize(const SBUInteger *chunkSizes, SBUInteger chunkCount)
+{
+    return sizeof(MemoryList) + CalculateTotalSize(chunkSizes, chunkCount);
+}
+
+SB_INTERNAL void MemoryAdoptChunks(MemoryRef memory, void *block,
+    const SBUInteger *chunkSizes, SBUInteger chunkCount, void **outPointers)
+{
+    MemoryListRef memoryList = block;
+    SBUInt8 *base = block;
+
+    /* The memory MUST not be tracking any block yet. */
+    SBAssert(memory->_list == NULL);
+
+    memoryList->first.next = NULL;
+    memoryList->last = &memoryList->first;
+
+    memory->_list = memoryList;
+
+    SplitMemoryBlock(base + sizeof(MemoryList), chunkSizes, chunkCount, outPointers);
+}
+
+SB_INTERNAL void *MemoryRelinquish(MemoryRef memory)
+{
+    MemoryListRef memoryList = memory->_list;
+    MemoryBlockRef block = memoryList->first.next;
+
+    while (block) {
+        MemoryBlockRef next = block->next;
+        SBAllocatorDeallocateBlock(NULL, block);
+
+        block = next;
+    }
+
+    memory->_list = NULL;
+
+    return memoryList;
+}
+
 SB_INTERNAL void MemoryFinalize(MemoryRef memory)
 {
     MemoryListRef memoryList = memory->_list;
@@ -95,6 +95,49 @@ SB_INTERNAL void *MemoryAllocateBlock(MemoryRef memory, MemoryType type, SBUInte
 SB_INTERNAL SBBoolean MemoryAllocateChunks(MemoryRef memory, MemoryType type,
     const SBUInteger *chunkSizes, SBUInteger chunkCount, void **outPointers);
 
+/**
+ * Computes the size of a raw block able to hold the given chunks along with the bookkeeping needed
+ * by `MemoryAdoptChunks()`.
+ *
+ * @param chunkSizes
+ *      Array of chunk sizes.
+ * @param chunkCount
+ *      Number of chunks.
+ * @return
+ *      The required size of the raw block, in bytes.
+ */
+SB_INTERNAL SBUInteger MemoryGetAdoptableSize(const SBUInteger *chunkSizes, SBUInteger chunkCount);
+
+/**
+ * Adopts a caller-provided raw block as the first block of an empty Memory and splits it into
+ * multiple chunks. The block MUST be at least `MemoryGetAdoptableSize()` bytes and MUST be given
+ * back with `MemoryRelinquish()` instead of being freed by `MemoryFinalize()`.
+ *
+ * @param memory
+ *      The Memory to adopt the block into.
+ * @param block
+ *      The raw block to adopt.
+ * @param chunkSizes
+ *      Array of chunk sizes.
+ * @param chunkCount
+ *      Number of chunks.
+ * @param outPointers
+ *      Output array to receive chunk pointers.
+ */
+SB_INTERNAL void MemoryAdoptChunks(MemoryRef memory, void *block,
+    const SBUInteger *chunkSizes, SBUInteger chunkCount, void **outPointers);
+
+/**
+ * Frees all memory blocks tracked by the given Memory except the adopted one, which is returned to
+ * the caller.
+ *
+ * @param memory
+ *      The Memory whose adopted block is relinquished.
+ * @return
+ *      The raw block previously passed to `MemoryAdoptChunks()`.
+ */
+SB_INTERNAL void *MemoryRelinquish(MemoryRef memory);
+
 /**
  * Frees all memory blocks tracked by the given Memory.
  *
@@ -18,8 +18,10 @@
 
 #include <API/SBBase.h>
 #include <API/SBAssert.h>
+#include <API/SBStatistics.h>
 #include <Core/AtomicUInt.h>
 #include <Core/Memory.h>
+#include <Core/ObjectPool.h>
 
 #include "Object.h"
 
@@ -43,8 +45,25 @@ SB_INTERNAL ObjectRef ObjectCreate(const SBUInteger *chunkSizes, SBUInteger chun
 
     MemoryInitialize(&memory);
 
+#ifdef USE_OBJECT_POOL
+    {
+        SBUInteger blockSize = MemoryGetAdoptableSize(chunkSizes, chunkCount);
+        void *block = ObjectPoolAcquire(blockSize);
+
+        if (block) {
+            MemoryAdoptChunks(&memory, block, chunkSizes, chunkCount, outPointers);
+            base = outPointers[0];
+        }
+    }
+#else
     if (MemoryAllocateChunks(&memory, MemoryTypePermanent, chunkSizes, chunkCount, outPointers)) {
         base = outPointers[0];
+    }
+#endif
+
+    if (base) {
+        SB_STATISTICS_INCREMENT(StatisticObjectCreations);
+
         base->memory = memory;
         base->finalize = finalizer;
 
@@ -54,6 +73,18 @@ SB_INTERNAL ObjectRef ObjectCreate(const SBUInteger *chunkSizes, SBUInteger chun
     return base;
 }
 
+SB_INTERNAL void ObjectInitializeEmbedded(ObjectRef object, FinalizeFunc finalizer)
+{
+    ObjectBaseRef base = (ObjectBaseRef)object;
+
+    SB_STATISTICS_INCREMENT(StatisticObjectCreations);
+
+    MemoryInitialize(&base->memory);
+    base->finalize = finalizer;
+
+    AtomicUIntInitialize(&base->retainCount, 1);
+}
+
 SB_INTERNAL SBUInteger ObjectGetRetainCount(ObjectRef object)
 {
     ObjectBaseRef base = (ObjectBaseRef)object;
@@ -75,10 +106,21 @@ SB_INTERNAL void ObjectRelease(ObjectRef object)
     ObjectBaseRef base = (ObjectBaseRef)object;
 
     if (AtomicUIntDecrement(&base->retainCount) == 0) {
+        /* Keep the memory aside as the finalizer of an embedded object may free its storage. */
+        Memory memory = base->memory;
+
+        SB_STATISTICS_INCREMENT(StatisticObjectDestructions);
+
         if (base->finalize) {
             base->finalize(object);
         }
 
-        MemoryFinalize(&base->memory);
+        if (memory._list) {
+#ifdef USE_OBJECT_POOL
+            ObjectPoolRecycle(MemoryRelinquish(&memory));
+#else
+            MemoryFinalize(&memory);
+#endif
+        }
     }
 }
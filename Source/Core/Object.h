@@ -97,6 +97,19 @@ SB_INTERNAL void ObjectBaseInitialize(ObjectBaseRef objectBase);
 SB_INTERNAL ObjectRef ObjectCreate(const SBUInteger *chunkSizes, SBUInteger chunkCount,
     void **outPointers, FinalizeFunc finalizer);
 
+/**
+ * Initializes a reference-counted object that lives inside the memory of another object.
+ *
+ * Such an object owns no memory of its own. Its finalizer is responsible for releasing the object
+ * holding it, which may free the storage of the embedded object as well.
+ *
+ * @param object
+ *      The embedded object, having `ObjectBase` as its first field.
+ * @param finalizer
+ *      Optional function to finalize the object when its reference count drops to zero.
+ */
+SB_INTERNAL void ObjectInitializeEmbedded(ObjectRef object, FinalizeFunc finalizer);
+
 /**
  * Retrieves the current reference count of an object.
  * 
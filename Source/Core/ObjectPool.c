@@ -0,0 +1,331 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stddef.h>
+
+#include <API/SBBase.h>
+#include <API/SBAllocator.h>
+#include <API/SBStatistics.h>
+#include <Core/Once.h>
+#include <Core/ThreadLocalStorage.h>
+
+#include "ObjectPool.h"
+
+#ifdef USE_OBJECT_POOL
+
+/* Detect a mechanism for releasing the pool of a thread when it exits. */
+#if defined(_WIN32)
+#include <windows.h>
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0600
+#define USE_FLS_EXIT_CALLBACK
+#endif
+#elif defined(_POSIX_THREADS) || defined(__unix__) || defined(__unix) || defined(unix) \
+        || (defined(__APPLE__) && defined(__MACH__)) || defined(__linux__)
+#include <pthread.h>
+#define USE_PTHREAD_EXIT_DESTRUCTOR
+#endif
+
+#define SIZE_CLASS_COUNT    7
+#define SIZE_CLASS_MIN      64
+#define SIZE_CLASS_NONE     SIZE_CLASS_COUNT
+
+/**
+ * Header preceding the usable memory of every block handed out by the pool. The block is always
+ * returned to the allocator it was obtained from, regardless of the allocator installed at that
+ * time.
+ */
+typedef struct _PoolBlock {
+    SBAllocatorRef allocator;
+    SBUInteger sizeClass;
+} PoolBlock, *PoolBlockRef;
+
+/* While a block rests on a free list, its usable memory holds the link to the next block. */
+#define PoolBlockNext(block)    (*(PoolBlockRef *)((block) + 1))
+
+/**
+ * Free list of recycled blocks belonging to a single size class.
+ */
+typedef struct _PoolBucket {
+    PoolBlockRef head;
+    SBUInteger count;
+} PoolBucket;
+
+/**
+ * Per-thread state of the pool.
+ */
+typedef struct _PoolState {
+    SBAllocatorRef allocator;
+    PoolBucket buckets[SIZE_CLASS_COUNT];
+    ObjectPoolCounters counters;
+} PoolState, *PoolStateRef;
+
+static ThreadLocalStorage PoolStateStorage;
+
+/**
+ * Deallocates all blocks retained by a pool state along with the state itself.
+ */
+static void ReleasePoolState(PoolStateRef state)
+{
+    SBUInteger index;
+
+    for (index = 0; index < SIZE_CLASS_COUNT; index++) {
+        PoolBlockRef block = state->buckets[index].head;
+
+        while (block) {
+            PoolBlockRef next = PoolBlockNext(block);
+            SBAllocatorDeallocateBlock(block->allocator, block);
+
+            block = next;
+        }
+    }
+
+    SBAllocatorDeallocateBlock(state->allocator, state);
+}
+
+#if defined(USE_PTHREAD_EXIT_DESTRUCTOR)
+
+static pthread_key_t PoolExitKey;
+
+static void HandleThreadExit(void *state)
+{
+    ThreadLocalStorageSet(PoolStateStorage, NULL);
+    ReleasePoolState(state);
+}
+
+#define PoolExitKeyInitialize()     pthread_key_create(&PoolExitKey, HandleThreadExit)
+#define PoolExitKeySet(state)       pthread_setspecific(PoolExitKey, state)
+
+#elif defined(USE_FLS_EXIT_CALLBACK)
+
+static DWORD PoolExitKey = FLS_OUT_OF_INDEXES;
+
+static VOID WINAPI HandleThreadExit(PVOID state)
+{
+    if (state) {
+        ThreadLocalStorageSet(PoolStateStorage, NULL);
+        ReleasePoolState(state);
+    }
+}
+
+#define PoolExitKeyInitialize()     (PoolExitKey = FlsAlloc(HandleThreadExit))
+#define PoolExitKeySet(state)       FlsSetValue(PoolExitKey, state)
+
+#else
+
+#define PoolExitKeyInitialize()
+#define PoolExitKeySet(state)
+
+#endif
+
+static void InitializePoolStateStorage(void *info)
+{
+    ThreadLocalStorageInitialize(PoolStateStorage);
+    PoolExitKeyInitialize();
+}
+
+static SBBoolean TryLazyInitializePoolStateStorage(void)
+{
+    static Once once = OnceMake();
+    return OnceTryExecute(&once, InitializePoolStateStorage, NULL);
+}
+
+static PoolStateRef GetPoolState(SBBoolean create)
+{
+    PoolStateRef state = NULL;
+
+    if (TryLazyInitializePoolStateStorage()) {
+        state = ThreadLocalStorageGet(PoolStateStorage);
+
+        if (!state && create) {
+            SBAllocatorRef allocator = SBAllocatorGetCurrent();
+
+            state = SBAllocatorAllocateBlock(allocator, sizeof(PoolState));
+
+            if (state) {
+                SBUInteger index;
+
+                state->allocator = allocator;
+
+                for (index = 0; index < SIZE_CLASS_COUNT; index++) {
+                    state->buckets[index].head = NULL;
+                    state->buckets[index].count = 0;
+                }
+
+                state->counters.hits = 0;
+                state->counters.misses = 0;
+                state->counters.recycles = 0;
+                state->counters.discards = 0;
+
+                ThreadLocalStorageSet(PoolStateStorage, state);
+                PoolExitKeySet(state);
+            }
+        }
+    }
+
+    return state;
+}
+
+/**
+ * Determines the smallest size class able to hold a block of the given total size.
+ */
+static SBUInteger DetermineSizeClass(SBUInteger totalSize)
+{
+    SBUInteger classSize = SIZE_CLASS_MIN;
+    SBUInteger sizeClass;
+
+    for (sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; sizeClass++) {
+        if (totalSize <= classSize) {
+            break;
+        }
+
+        classSize <<= 1;
+    }
+
+    return sizeClass;
+}
+
+static SBBoolean IsPoolingAllowed(void)
+{
+    /* Custom allocators own their recycling policy, so the pool stays out of their way. */
+    return SBAllocatorGetDefault() == NULL;
+}
+
+SB_INTERNAL void *ObjectPoolAcquire(SBUInteger size)
+{
+    SBUInteger totalSize = sizeof(PoolBlock) + size;
+    SBUInteger sizeClass = DetermineSizeClass(totalSize);
+    PoolStateRef state = NULL;
+    PoolBlockRef block = NULL;
+
+    if (sizeClass != SIZE_CLASS_NONE && IsPoolingAllowed()) {
+        state = GetPoolState(SBTrue);
+
+        if (state) {
+            PoolBucket *bucket = &state->buckets[sizeClass];
+
+            block = bucket->head;
+
+            if (block) {
+                bucket->head = PoolBlockNext(block);
+                bucket->count -= 1;
+                state->counters.hits += 1;
+                SB_STATISTICS_INCREMENT(StatisticObjectPoolHits);
+            } else {
+                state->counters.misses += 1;
+                SB_STATISTICS_INCREMENT(StatisticObjectPoolMisses);
+            }
+        }
+    }
+
+    if (!block) {
+        SBAllocatorRef allocator = SBAllocatorGetCurrent();
+
+        if (sizeClass != SIZE_CLASS_NONE) {
+            /* Allocate the complete class so that the block can serve any request of its class. */
+            totalSize = (SBUInteger)SIZE_CLASS_MIN << sizeClass;
+        }
+
+        block = SBAllocatorAllocateBlock(allocator, totalSize);
+
+        if (!block) {
+            return NULL;
+        }
+
+        block->allocator = allocator;
+        block->sizeClass = sizeClass;
+    }
+
+    return block + 1;
+}
+
+SB_INTERNAL void ObjectPoolRecycle(void *pointer)
+{
+    PoolBlockRef block = (PoolBlockRef)pointer - 1;
+    SBUInteger sizeClass = block->sizeClass;
+    SBBoolean isRetained = SBFalse;
+
+    if (sizeClass != SIZE_CLASS_NONE && IsPoolingAllowed()
+            && block->allocator == SBAllocatorGetCurrent()) {
+        PoolStateRef state = GetPoolState(SBTrue);
+
+        if (state) {
+            PoolBucket *bucket = &state->buckets[sizeClass];
+
+            if (bucket->count < SB_CONFIG_OBJECT_POOL_CAPACITY) {
+                PoolBlockNext(block) = bucket->head;
+                bucket->head = block;
+                bucket->count += 1;
+
+                isRetained = SBTrue;
+                state->counters.recycles += 1;
+            } else {
+                state->counters.discards += 1;
+            }
+        }
+    }
+
+    if (!isRetained) {
+        SBAllocatorDeallocateBlock(block->allocator, block);
+    }
+}
+
+SB_INTERNAL void ObjectPoolDrain(void)
+{
+    PoolStateRef state = GetPoolState(SBFalse);
+
+    if (state) {
+        ThreadLocalStorageSet(PoolStateStorage, NULL);
+        PoolExitKeySet(NULL);
+
+        ReleasePoolState(state);
+    }
+}
+
+SB_INTERNAL void ObjectPoolGetCounters(ObjectPoolCountersRef counters)
+{
+    PoolStateRef state = GetPoolState(SBFalse);
+
+    if (state) {
+        *counters = state->counters;
+    } else {
+        counters->hits = 0;
+        counters->misses = 0;
+        counters->recycles = 0;
+        counters->discards = 0;
+    }
+}
+
+#undef USE_FLS_EXIT_CALLBACK
+#undef USE_PTHREAD_EXIT_DESTRUCTOR
+#undef SIZE_CLASS_COUNT
+#undef SIZE_CLASS_MIN
+#undef SIZE_CLASS_NONE
+#undef PoolBlockNext
+#undef PoolExitKeyInitialize
+#undef PoolExitKeySet
+
+#else
+
+SB_INTERNAL void ObjectPoolGetCounters(ObjectPoolCountersRef counters)
+{
+    counters->hits = 0;
+    counters->misses = 0;
+    counters->recycles = 0;
+    counters->discards = 0;
+}
+
+#endif
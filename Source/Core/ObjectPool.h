@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _SB_INTERNAL_OBJECT_POOL_H
+#define _SB_INTERNAL_OBJECT_POOL_H
+
+#include <API/SBBase.h>
+#include <Core/Once.h>
+#include <Core/ThreadLocalStorage.h>
+
+#ifdef SB_CONFIG_ENABLE_OBJECT_POOL
+
+#if defined(HAS_TLS_SUPPORT) && defined(HAS_ONCE_SUPPORT)
+#define USE_OBJECT_POOL
+#else
+#error "Object pool functionality requires thread-local and once support. To proceed without \
+object pooling, undefine `SB_CONFIG_ENABLE_OBJECT_POOL`."
+#endif
+
+#endif
+
+/**
+ * Counters describing the activity of the calling thread's object pool.
+ */
+typedef struct _ObjectPoolCounters {
+    SBUInteger hits;        /**< Number of acquisitions served from a free list. */
+    SBUInteger misses;      /**< Number of acquisitions served by the allocator. */
+    SBUInteger recycles;    /**< Number of blocks retained on a free list upon release. */
+    SBUInteger discards;    /**< Number of blocks returned to the allocator upon release. */
+} ObjectPoolCounters, *ObjectPoolCountersRef;
+
+#ifdef USE_OBJECT_POOL
+
+/**
+ * Acquires a raw block of at least `size` bytes, preferring a recycled block of the matching size
+ * class from the calling thread's free lists.
+ *
+ * @param size
+ *      Minimum usable size of the block, in bytes.
+ * @return
+ *      Pointer to the usable memory of the block, or NULL on failure.
+ */
+SB_INTERNAL void *ObjectPoolAcquire(SBUInteger size);
+
+/**
+ * Returns a block obtained from `ObjectPoolAcquire()` to the calling thread's free list of its
+ * size class. The block is deallocated with the allocator it was obtained from instead if its class
+ * is already at capacity, if it does not belong to any class, or if a custom default allocator is
+ * installed.
+ *
+ * @param pointer
+ *      Pointer previously returned by `ObjectPoolAcquire()`.
+ */
+SB_INTERNAL void ObjectPoolRecycle(void *pointer);
+
+/**
+ * Deallocates all blocks retained by the calling thread's free lists.
+ */
+SB_INTERNAL void ObjectPoolDrain(void);
+
+#else
+
+#define ObjectPoolDrain()
+
+#endif
+
+/**
+ * Retrieves the counters of the calling thread's object pool. All counters are zero if the pool is
+ * not enabled.
+ *
+ * @param counters
+ *      The structure to receive the counters.
+ */
+SB_INTERNAL void ObjectPoolGetCounters(ObjectPoolCountersRef counters);
+
+#endif
@@ -31,13 +31,16 @@
 #include <API/SBMirrorLocator.c>
 #include <API/SBParagraph.c>
 #include <API/SBScriptLocator.c>
+#include <API/SBStatistics.c>
 #include <API/SBText.c>
 #include <API/SBTextConfig.c>
 #include <API/SBTextIterators.c>
+#include <API/SBTrace.c>
 
 #include <Core/List.c>
 #include <Core/Memory.c>
 #include <Core/Object.c>
+#include <Core/ObjectPool.c>
 #include <Core/Once.c>
 
 #include <Data/BidiTypeLookup.c>
@@ -48,12 +51,17 @@
 #include <Script/ScriptStack.c>
 
 #include <Text/AttributeDictionary.c>
+#include <Text/AttributeEntryTree.c>
 #include <Text/AttributeManager.c>
+#include <Text/EditLog.c>
+#include <Text/FileMapping.c>
+#include <Text/TextSnapshot.c>
 
 #include <UBA/BidiChain.c>
 #include <UBA/BracketQueue.c>
 #include <UBA/IsolatingRun.c>
 #include <UBA/LevelRun.c>
+#include <UBA/ResolutionBudget.c>
 #include <UBA/RunQueue.c>
 #include <UBA/StatusStack.c>
 
@@ -121,6 +121,58 @@ SB_INTERNAL SBBoolean AttributeDictionaryIsEmpty(AttributeDictionaryRef dictiona
     return (SBAttributeListSize(&dictionary->_list) == 0);
 }
 
+SB_INTERNAL SBUInteger AttributeDictionaryGetHash(AttributeDictionaryRef dictionary,
+    SBAttributeRegistryRef registry)
+{
+    SBUInteger itemCount = SBAttributeListSize(&dictionary->_list);
+    SBBoolean hashesValues = (registry->_valueCallbacks.equal == NULL);
+    SBUInt32 hash = 2166136261U;
+    SBUInteger itemIndex;
+
+    /* FNV-1a over the attribute IDs, and the value bytes when they are compared bitwise */
+    for (itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+        SBAttributeItem *item = SBAttributeListGetAt(&dictionary->_list, itemIndex);
+
+        hash = (hash ^ item->attributeID) * 16777619U;
+
+        if (hashesValues) {
+            const SBUInt8 *bytes = SBAttributeItemGetValuePtr(item);
+            SBUInteger size = SBAttributeIDGetSize(item->attributeID);
+            SBUInteger byteIndex;
+
+            for (byteIndex = 0; byteIndex < size; byteIndex++) {
+                hash = (hash ^ bytes[byteIndex]) * 16777619U;
+            }
+        }
+    }
+
+    return hash;
+}
+
+SB_INTERNAL SBBoolean AttributeDictionaryIsEqual(AttributeDictionaryRef dictionary,
+    AttributeDictionaryRef other, SBAttributeRegistryRef registry)
+{
+    SBUInteger itemCount = SBAttributeListSize(&dictionary->_list);
+    SBUInteger itemIndex;
+
+    if (itemCount != SBAttributeListSize(&other->_list)) {
+        return SBFalse;
+    }
+
+    for (itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+        SBAttributeItem *dictItem = SBAttributeListGetAt(&dictionary->_list, itemIndex);
+        SBAttributeItem *otherItem = SBAttributeListGetAt(&other->_list, itemIndex);
+
+        if (dictItem->attributeID != otherItem->attributeID ||
+            !SBAttributeRegistryIsEqualAttribute(registry, dictItem->attributeID,
+                SBAttributeItemGetValuePtr(dictItem), SBAttributeItemGetValuePtr(otherItem))) {
+            return SBFalse;
+        }
+    }
+
+    return SBTrue;
+}
+
 SB_INTERNAL void AttributeDictionarySet(AttributeDictionaryRef dictionary,
     AttributeDictionaryRef other, SBAttributeRegistryRef registry)
 {
@@ -254,6 +306,69 @@ SB_INTERNAL void AttributeDictionaryFilter(AttributeDictionaryRef dictionary,
     }
 }
 
+SB_INTERNAL void AttributeDictionaryGetPresenceMask(AttributeDictionaryRef dictionary,
+    SBUInt32 *mask, SBUInteger wordCount)
+{
+    SBUInteger itemCount = SBAttributeListSize(&dictionary->_list);
+    SBUInteger wordIndex;
+    SBUInteger itemIndex;
+
+    for (wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+        mask[wordIndex] = 0;
+    }
+
+    for (itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+        SBAttributeItem *currentItem = SBAttributeListGetAt(&dictionary->_list, itemIndex);
+        SBUInteger attributeIndex = SBAttributeIDGetIndex(currentItem->attributeID);
+
+        AttributeMaskAdd(mask, attributeIndex);
+    }
+}
+
+SB_INTERNAL void AttributeDictionaryFilterByMask(AttributeDictionaryRef dictionary,
+    const SBUInt32 *mask, AttributeDictionaryRef result)
+{
+    SBUInteger itemCount = SBAttributeListSize(&dictionary->_list);
+    SBUInteger itemIndex;
+
+    /* Clear the result dictionary before populating it */
+    AttributeDictionaryClear(result, NULL);
+
+    for (itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+        SBAttributeItem *currentItem = SBAttributeListGetAt(&dictionary->_list, itemIndex);
+        SBUInteger attributeIndex = SBAttributeIDGetIndex(currentItem->attributeID);
+
+        if (AttributeMaskContains(mask, attributeIndex)) {
+            const void *valuePtr = SBAttributeItemGetValuePtr(currentItem);
+            SBAttributeItem *newItem;
+
+            SBAttributeListReserveEnd(&result->_list, 1);
+            newItem = SBAttributeListGetLast(&result->_list);
+
+            SBAttributeItemSet(newItem, currentItem->attributeID, valuePtr);
+        }
+    }
+}
+
+SB_INTERNAL SBBoolean AttributeDictionaryContainsAll(AttributeDictionaryRef dictionary,
+    AttributeDictionaryRef other, SBAttributeRegistryRef registry)
+{
+    SBUInteger otherCount = SBAttributeListSize(&other->_list);
+    SBUInteger otherIndex;
+
+    for (otherIndex = 0; otherIndex < otherCount; otherIndex++) {
+        SBAttributeItem *otherItem = SBAttributeListGetAt(&other->_list, otherIndex);
+        const void *value = AttributeDictionaryFindValue(dictionary, otherItem->attributeID);
+
+        if (!value || !SBAttributeRegistryIsEqualAttribute(registry, otherItem->attributeID,
+                value, SBAttributeItemGetValuePtr(otherItem))) {
+            return SBFalse;
+        }
+    }
+
+    return SBTrue;
+}
+
 SB_INTERNAL const void *AttributeDictionaryFindValue(
     AttributeDictionaryRef dictionary, SBAttributeID attributeID)
 {
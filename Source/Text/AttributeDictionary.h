@@ -28,6 +28,18 @@ typedef struct _AttributeDictionary {
     SBAttributeList _list;
 } AttributeDictionary, *AttributeDictionaryRef;
 
+/**
+ * Attribute masks are bitsets indexed by the dense index of attribute IDs in their registry.
+ */
+#define AttributeMaskGetWordCount(attributeCount)   \
+    (((attributeCount) + 31) / 32)
+
+#define AttributeMaskAdd(mask, attributeIndex)      \
+    ((mask)[(attributeIndex) >> 5] |= ((SBUInt32)1 << ((attributeIndex) & 31)))
+
+#define AttributeMaskContains(mask, attributeIndex) \
+    (((mask)[(attributeIndex) >> 5] >> ((attributeIndex) & 31)) & 1)
+
 /**
  * Initializes an attribute dictionary.
  *
@@ -83,6 +95,37 @@ SB_INTERNAL void AttributeDictionaryDestroy(AttributeDictionaryRef dictionary,
  */
 SB_INTERNAL SBBoolean AttributeDictionaryIsEmpty(AttributeDictionaryRef dictionary);
 
+/**
+ * Computes a hash of the attributes, consistent with `AttributeDictionaryIsEqual()`.
+ *
+ * Attribute values are only hashed when the registry compares them bitwise; otherwise the hash
+ * covers the attribute IDs alone.
+ *
+ * @param dictionary
+ *      The attribute dictionary to hash.
+ * @param registry
+ *      The attribute registry defining the equality of attribute values.
+ * @return
+ *      The hash of the dictionary.
+ */
+SB_INTERNAL SBUInteger AttributeDictionaryGetHash(AttributeDictionaryRef dictionary,
+    SBAttributeRegistryRef registry);
+
+/**
+ * Checks whether two dictionaries have the same attribute IDs with equal values.
+ *
+ * @param dictionary
+ *      The attribute dictionary to check.
+ * @param other
+ *      The other attribute dictionary to compare against.
+ * @param registry
+ *      The attribute registry used to compare the attribute values.
+ * @return
+ *      SBTrue if both dictionaries hold equal attributes, SBFalse otherwise.
+ */
+SB_INTERNAL SBBoolean AttributeDictionaryIsEqual(AttributeDictionaryRef dictionary,
+    AttributeDictionaryRef other, SBAttributeRegistryRef registry);
+
 /**
  * Clears this dictionary and copies all attributes from the source, retaining their values.
  *
@@ -153,6 +196,47 @@ SB_INTERNAL void AttributeDictionaryFilter(AttributeDictionaryRef dictionary,
     SBAttributeScope targetScope, SBAttributeGroup targetGroup,
     SBAttributeRegistryRef registry, AttributeDictionaryRef result);
 
+/**
+ * Computes the mask of attributes present in a dictionary.
+ *
+ * @param dictionary
+ *      The attribute dictionary to examine.
+ * @param mask
+ *      The mask to fill, having a bit for each attribute of the registry.
+ * @param wordCount
+ *      The number of words in the mask.
+ */
+SB_INTERNAL void AttributeDictionaryGetPresenceMask(AttributeDictionaryRef dictionary,
+    SBUInt32 *mask, SBUInteger wordCount);
+
+/**
+ * Filters attributes present in a mask into a result dictionary.
+ *
+ * @param dictionary
+ *      The attribute dictionary to filter.
+ * @param mask
+ *      The mask of attributes to keep, having a bit for each attribute of the registry.
+ * @param result
+ *      The dictionary where matching items will be added. Always cleared at the start.
+ */
+SB_INTERNAL void AttributeDictionaryFilterByMask(AttributeDictionaryRef dictionary,
+    const SBUInt32 *mask, AttributeDictionaryRef result);
+
+/**
+ * Checks if all attributes of another dictionary exist in the dictionary with equal values.
+ *
+ * @param dictionary
+ *      The attribute dictionary to check.
+ * @param other
+ *      The attribute dictionary whose items are looked up.
+ * @param registry
+ *      The attribute registry used to compare equality.
+ * @return
+ *      SBTrue if every item of `other` has an equal value in `dictionary`, SBFalse otherwise.
+ */
+SB_INTERNAL SBBoolean AttributeDictionaryContainsAll(AttributeDictionaryRef dictionary,
+    AttributeDictionaryRef other, SBAttributeRegistryRef registry);
+
 /**
  * Searches for an attribute value by ID.
  *
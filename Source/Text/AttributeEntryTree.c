@@ -0,0 +1,379 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <API/SBBase.h>
+
+#if SB_TEXT_API_SUPPORTED
+
+#include <stddef.h>
+
+#include <API/SBAllocator.h>
+#include <API/SBAssert.h>
+
+#include "AttributeEntryTree.h"
+
+#define InitialSeed     0x9E3779B9
+
+/**
+ * Returns the priority of a new entry using a xorshift generator, so that the shape of the tree
+ * does not depend on the order of edits.
+ */
+static SBUInt32 GenerateEntryPriority(AttributeEntryTreeRef tree)
+{
+    SBUInt32 seed = tree->_seed;
+
+    seed ^= (SBUInt32)(seed << 13);
+    seed ^= seed >> 17;
+    seed ^= (SBUInt32)(seed << 5);
+
+    tree->_seed = seed;
+
+    return seed;
+}
+
+static void UpdateSubtreeLength(AttributeEntryRef entry)
+{
+    SBUInteger length = entry->length;
+
+    if (entry->_left) {
+        length += entry->_left->_subtreeLength;
+    }
+    if (entry->_right) {
+        length += entry->_right->_subtreeLength;
+    }
+
+    entry->_subtreeLength = length;
+}
+
+/**
+ * Adds a (possibly wrapped around negative) delta to the subtree lengths of all the ancestors.
+ */
+static void AddLengthToAncestors(AttributeEntryRef entry, SBUInteger delta)
+{
+    AttributeEntryRef ancestor;
+
+    for (ancestor = entry->_parent; ancestor; ancestor = ancestor->_parent) {
+        ancestor->_subtreeLength += delta;
+    }
+}
+
+/**
+ * Rotates an entry above its parent while preserving the order of entries.
+ */
+static void RotateEntryUp(AttributeEntryTreeRef tree, AttributeEntryRef entry)
+{
+    AttributeEntryRef parent = entry->_parent;
+    AttributeEntryRef grandparent = parent->_parent;
+
+    if (parent->_left == entry) {
+        parent->_left = entry->_right;
+        if (entry->_right) {
+            entry->_right->_parent = parent;
+        }
+        entry->_right = parent;
+    } else {
+        parent->_right = entry->_left;
+        if (entry->_left) {
+            entry->_left->_parent = parent;
+        }
+        entry->_left = parent;
+    }
+
+    parent->_parent = entry;
+    entry->_parent = grandparent;
+
+    if (!grandparent) {
+        tree->_root = entry;
+    } else if (grandparent->_left == parent) {
+        grandparent->_left = entry;
+    } else {
+        grandparent->_right = entry;
+    }
+
+    UpdateSubtreeLength(parent);
+    UpdateSubtreeLength(entry);
+}
+
+static void DeallocateEntryChain(AttributeEntryRef entry)
+{
+    while (entry) {
+        AttributeEntryRef next = entry->next;
+        SBAllocatorDeallocateBlock(NULL, entry);
+        entry = next;
+    }
+}
+
+SB_INTERNAL void AttributeEntryTreeInitialize(AttributeEntryTreeRef tree)
+{
+    tree->_root = NULL;
+    tree->_freeEntries = NULL;
+    tree->first = NULL;
+    tree->last = NULL;
+    tree->count = 0;
+    tree->_seed = InitialSeed;
+}
+
+SB_INTERNAL void AttributeEntryTreeFinalize(AttributeEntryTreeRef tree)
+{
+    DeallocateEntryChain(tree->first);
+    DeallocateEntryChain(tree->_freeEntries);
+}
+
+SB_INTERNAL AttributeEntryRef AttributeEntryTreeFind(AttributeEntryTreeRef tree,
+    SBUInteger index, SBUInteger *entryStart)
+{
+    AttributeEntryRef entry = tree->_root;
+    SBUInteger offset = 0;
+
+    while (entry) {
+        SBUInteger leftLength = (entry->_left ? entry->_left->_subtreeLength : 0);
+
+        if (index < offset + leftLength) {
+            entry = entry->_left;
+        } else {
+            offset += leftLength;
+
+            if (index < offset + entry->length) {
+                *entryStart = offset;
+                return entry;
+            }
+
+            offset += entry->length;
+            entry = entry->_right;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Returns a new unattached entry, threaded in text order right after the previous one.
+ */
+static AttributeEntryRef CreateThreadedEntry(AttributeEntryTreeRef tree,
+    AttributeEntryRef previous, SBUInteger length, AttributeDictionaryRef attributes)
+{
+    AttributeEntryRef entry = tree->_freeEntries;
+
+    if (entry) {
+        tree->_freeEntries = entry->next;
+    } else {
+        entry = SBAllocatorAllocateBlock(NULL, sizeof(AttributeEntry));
+        if (!entry) {
+            return NULL;
+        }
+    }
+
+    entry->_left = NULL;
+    entry->_right = NULL;
+    entry->length = length;
+    entry->_subtreeLength = length;
+    entry->_priority = GenerateEntryPriority(tree);
+    entry->attributes = attributes;
+
+    /* Thread the entry in text order */
+    entry->previous = previous;
+    entry->next = (previous ? previous->next : tree->first);
+
+    if (entry->previous) {
+        entry->previous->next = entry;
+    } else {
+        tree->first = entry;
+    }
+    if (entry->next) {
+        entry->next->previous = entry;
+    } else {
+        tree->last = entry;
+    }
+
+    tree->count += 1;
+
+    return entry;
+}
+
+SB_INTERNAL AttributeEntryRef AttributeEntryTreeInsertAfter(AttributeEntryTreeRef tree,
+    AttributeEntryRef previous, SBUInteger length, AttributeDictionaryRef attributes)
+{
+    AttributeEntryRef entry = CreateThreadedEntry(tree, previous, length, attributes);
+
+    if (!entry) {
+        return NULL;
+    }
+
+    /* Attach the entry as a leaf right after the previous one */
+    if (!tree->_root) {
+        entry->_parent = NULL;
+        tree->_root = entry;
+    } else if (!previous) {
+        entry->_parent = entry->next;
+        entry->next->_left = entry;
+    } else if (!previous->_right) {
+        entry->_parent = previous;
+        previous->_right = entry;
+    } else {
+        /* The successor is the leftmost entry of the right subtree, so has no left child */
+        entry->_parent = entry->next;
+        entry->next->_left = entry;
+    }
+
+    AddLengthToAncestors(entry, length);
+
+    /* Restore the heap order of priorities */
+    while (entry->_parent && entry->_parent->_priority < entry->_priority) {
+        RotateEntryUp(tree, entry);
+    }
+
+    return entry;
+}
+
+SB_INTERNAL AttributeEntryRef AttributeEntryTreeBulkAppend(AttributeEntryTreeRef tree,
+    SBUInteger length, AttributeDictionaryRef attributes)
+{
+    AttributeEntryRef ancestor = tree->last;
+    AttributeEntryRef child = NULL;
+    AttributeEntryRef entry;
+
+    entry = CreateThreadedEntry(tree, ancestor, length, attributes);
+    if (!entry) {
+        return NULL;
+    }
+
+    /*
+     * Climb the right spine past the entries of lower priority, which become the left subtree of
+     * the new entry. As climbed entries leave the spine for good, the total work is linear.
+     */
+    while (ancestor && ancestor->_priority < entry->_priority) {
+        child = ancestor;
+        ancestor = ancestor->_parent;
+    }
+
+    entry->_left = child;
+    entry->_parent = ancestor;
+
+    if (child) {
+        child->_parent = entry;
+    }
+    if (ancestor) {
+        ancestor->_right = entry;
+    } else {
+        tree->_root = entry;
+    }
+
+    return entry;
+}
+
+SB_INTERNAL void AttributeEntryTreeEndBulkAppend(AttributeEntryTreeRef tree)
+{
+    AttributeEntryRef previous = NULL;
+    AttributeEntryRef entry = tree->_root;
+
+    /* Update the subtree lengths in post order without recursion */
+    while (entry) {
+        AttributeEntryRef next;
+
+        if (previous == entry->_parent && entry->_left) {
+            next = entry->_left;
+        } else if (previous != entry->_right && entry->_right) {
+            next = entry->_right;
+        } else {
+            UpdateSubtreeLength(entry);
+            next = entry->_parent;
+        }
+
+        previous = entry;
+        entry = next;
+    }
+}
+
+SB_INTERNAL void AttributeEntryTreeRemove(AttributeEntryTreeRef tree, AttributeEntryRef entry)
+{
+    AttributeEntryRef parent;
+    AttributeEntryRef child;
+
+    /* Push the entry down until it has at most one child */
+    while (entry->_left && entry->_right) {
+        if (entry->_left->_priority > entry->_right->_priority) {
+            RotateEntryUp(tree, entry->_left);
+        } else {
+            RotateEntryUp(tree, entry->_right);
+        }
+    }
+
+    parent = entry->_parent;
+    child = (entry->_left ? entry->_left : entry->_right);
+
+    if (child) {
+        child->_parent = parent;
+    }
+
+    if (!parent) {
+        tree->_root = child;
+    } else if (parent->_left == entry) {
+        parent->_left = child;
+    } else {
+        parent->_right = child;
+    }
+
+    AddLengthToAncestors(entry, (SBUInteger)0 - entry->length);
+
+    /* Unthread the entry */
+    if (entry->previous) {
+        entry->previous->next = entry->next;
+    } else {
+        tree->first = entry->next;
+    }
+    if (entry->next) {
+        entry->next->previous = entry->previous;
+    } else {
+        tree->last = entry->previous;
+    }
+
+    /* Keep the memory of the entry for reuse */
+    entry->next = tree->_freeEntries;
+    tree->_freeEntries = entry;
+
+    tree->count -= 1;
+}
+
+SB_INTERNAL void AttributeEntryTreeRemoveAll(AttributeEntryTreeRef tree)
+{
+    if (tree->last) {
+        tree->last->next = tree->_freeEntries;
+        tree->_freeEntries = tree->first;
+    }
+
+    tree->_root = NULL;
+    tree->first = NULL;
+    tree->last = NULL;
+    tree->count = 0;
+}
+
+SB_INTERNAL void AttributeEntryTreeSetLength(AttributeEntryTreeRef tree,
+    AttributeEntryRef entry, SBUInteger length)
+{
+    SBUInteger delta = length - entry->length;
+
+    SBAssert(tree->_root != NULL);
+
+    entry->length = length;
+    entry->_subtreeLength += delta;
+
+    AddLengthToAncestors(entry, delta);
+}
+
+#undef InitialSeed
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _SB_INTERNAL_ATTRIBUTE_ENTRY_TREE_H
+#define _SB_INTERNAL_ATTRIBUTE_ENTRY_TREE_H
+
+#include <API/SBBase.h>
+
+#if SB_TEXT_API_SUPPORTED
+
+#include <Text/AttributeDictionary.h>
+
+/**
+ * An attribute entry covering a contiguous range of code units.
+ *
+ * Entries do not store their absolute index; each one only knows its own length, and every node of
+ * the tree keeps the total length of its subtree, so that shifting all the following entries is a
+ * matter of updating the sums along a single path.
+ */
+typedef struct _AttributeEntry {
+    struct _AttributeEntry *_parent;
+    struct _AttributeEntry *_left;
+    struct _AttributeEntry *_right;
+    struct _AttributeEntry *previous;       /**< Preceding entry in text order */
+    struct _AttributeEntry *next;           /**< Following entry in text order */
+    SBUInteger length;                      /**< Number of code units covered, read only */
+    SBUInteger _subtreeLength;
+    SBUInt32 _priority;
+    AttributeDictionaryRef attributes;      /**< Interned attributes, compared by pointer */
+} AttributeEntry, *AttributeEntryRef;
+
+/**
+ * A randomized balanced tree (treap) of attribute entries ordered by their position in the text.
+ *
+ * Finding, inserting, removing and resizing an entry take expected O(log n) time, whereas the
+ * entries are also threaded in text order for walking from one entry to the next in O(1).
+ */
+typedef struct _AttributeEntryTree {
+    AttributeEntryRef _root;
+    AttributeEntryRef _freeEntries;
+    AttributeEntryRef first;
+    AttributeEntryRef last;
+    SBUInteger count;
+    SBUInt32 _seed;
+} AttributeEntryTree, *AttributeEntryTreeRef;
+
+SB_INTERNAL void AttributeEntryTreeInitialize(AttributeEntryTreeRef tree);
+SB_INTERNAL void AttributeEntryTreeFinalize(AttributeEntryTreeRef tree);
+
+/**
+ * Returns the total number of code units covered by all the entries of the tree.
+ */
+#define AttributeEntryTreeGetLength(tree) \
+    ((tree)->_root ? (tree)->_root->_subtreeLength : 0)
+
+/**
+ * Finds the entry covering a code unit index.
+ *
+ * @param tree
+ *      The tree to search.
+ * @param index
+ *      The code unit index to find.
+ * @param[out] entryStart
+ *      Receives the index of the first code unit covered by the found entry.
+ * @return
+ *      The entry covering the code unit, or NULL if the index is beyond the tree length.
+ */
+SB_INTERNAL AttributeEntryRef AttributeEntryTreeFind(AttributeEntryTreeRef tree,
+    SBUInteger index, SBUInteger *entryStart);
+
+/**
+ * Inserts a new entry right after an existing one.
+ *
+ * @param tree
+ *      The tree to insert into.
+ * @param previous
+ *      The entry after which the new entry is placed, or NULL to place it at the front.
+ * @param length
+ *      The number of code units covered by the new entry.
+ * @param attributes
+ *      The attributes of the new entry, whose ownership is transferred to it.
+ * @return
+ *      The inserted entry, or NULL if the allocation failed.
+ */
+SB_INTERNAL AttributeEntryRef AttributeEntryTreeInsertAfter(AttributeEntryTreeRef tree,
+    AttributeEntryRef previous, SBUInteger length, AttributeDictionaryRef attributes);
+
+/**
+ * Removes an entry from the tree. The attributes of the entry are left to the caller.
+ */
+SB_INTERNAL void AttributeEntryTreeRemove(AttributeEntryTreeRef tree, AttributeEntryRef entry);
+
+/**
+ * Removes all the entries from the tree, keeping their memory for reuse.
+ */
+SB_INTERNAL void AttributeEntryTreeRemoveAll(AttributeEntryTreeRef tree);
+
+/**
+ * Appends an entry at the end of the tree in amortized O(1) time without maintaining the subtree
+ * lengths, so that a whole tree can be built in linear time.
+ *
+ * The tree must not be searched or resized until AttributeEntryTreeEndBulkAppend is called.
+ *
+ * @return
+ *      The appended entry, or NULL if the allocation failed.
+ */
+SB_INTERNAL AttributeEntryRef AttributeEntryTreeBulkAppend(AttributeEntryTreeRef tree,
+    SBUInteger length, AttributeDictionaryRef attributes);
+
+/**
+ * Computes the subtree lengths of the tree in linear time after bulk appending the entries.
+ */
+SB_INTERNAL void AttributeEntryTreeEndBulkAppend(AttributeEntryTreeRef tree);
+
+/**
+ * Changes the number of code units covered by an entry, shifting all the following entries.
+ */
+SB_INTERNAL void AttributeEntryTreeSetLength(AttributeEntryTreeRef tree,
+    AttributeEntryRef entry, SBUInteger length);
+
+#endif
+
+#endif
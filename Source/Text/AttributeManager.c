@@ -20,78 +20,199 @@
 
 #include <stddef.h>
 
+#include <API/SBAllocator.h>
 #include <API/SBAttributeRegistry.h>
 #include <API/SBText.h>
 #include <Core/List.h>
 #include <Text/AttributeDictionary.h>
+#include <Text/AttributeEntryTree.h>
 
 #include "AttributeManager.h"
 
 /* =========================================================================
- * Attribute Dictionary Cache Implementation
+ * Attribute Dictionary Pool Implementation
  * ========================================================================= */
 
+#define InitialBucketCount  16
+
+#define GetInternedDictionary(dictionary)   ((InternedDictionaryRef)(dictionary))
+
 /**
- * Initializes an attribute dictionary cache.
+ * Initializes an attribute dictionary pool.
  *
- * The cache stores reusable attribute dictionaries to reduce memory allocations
- * when attributes are frequently added and removed.
+ * The pool interns attribute dictionaries so that memory and copy cost scale with the number of
+ * distinct attribute sets rather than the number of entries.
  */
-static void InitializeAttributeDictionaryCache(AttributeDictionaryCacheRef cache, SBUInt8 valueSize)
+static void InitializeAttributeDictionaryPool(AttributeDictionaryPoolRef pool,
+    SBUInt8 valueSize, SBUInteger attributeCount)
 {
-    ListInitialize(&cache->_attributeDicts, sizeof(AttributeDictionaryRef));
-    cache->_valueSize = valueSize;
+    pool->_buckets = NULL;
+    pool->_bucketCount = 0;
+    pool->_count = 0;
+    pool->_maskWordCount = AttributeMaskGetWordCount(attributeCount);
+    pool->_valueSize = valueSize;
 }
 
 /**
- * Finalizes an attribute dictionary cache and destroys all cached dictionaries.
+ * Finalizes an attribute dictionary pool and destroys all remaining dictionaries.
  */
-static void FinalizeAttributeDictionaryCache(AttributeDictionaryCacheRef cache,
+static void FinalizeAttributeDictionaryPool(AttributeDictionaryPoolRef pool,
     SBAttributeRegistryRef registry)
 {
-    SBUInteger dictCount = cache->_attributeDicts.count;
-    SBUInteger dictIndex;
+    SBUInteger bucketIndex;
+
+    for (bucketIndex = 0; bucketIndex < pool->_bucketCount; bucketIndex++) {
+        InternedDictionaryRef interned = pool->_buckets[bucketIndex];
 
-    /* Destroy all cached attribute dictionaries */
-    for (dictIndex = 0; dictIndex < dictCount; dictIndex++) {
-        AttributeDictionaryRef dictionary = ListGetVal(&cache->_attributeDicts, dictIndex);
-        AttributeDictionaryDestroy(dictionary, registry);
+        while (interned) {
+            InternedDictionaryRef next = interned->next;
+
+            AttributeDictionaryFinalize(&interned->dictionary, registry);
+            SBAllocatorDeallocateBlock(NULL, interned);
+
+            interned = next;
+        }
     }
 
-    /* Finalize the cache list */
-    ListFinalize(&cache->_attributeDicts);
+    SBAllocatorDeallocateBlock(NULL, pool->_buckets);
 }
 
 /**
- * Retrieves a cached attribute dictionary or creates a new one if the cache is empty.
+ * Doubles the number of buckets of the pool, redistributing the existing dictionaries.
  */
-static AttributeDictionaryRef AcquireAttributeDictionaryFromCache(AttributeDictionaryCacheRef cache)
+static SBBoolean GrowAttributeDictionaryPool(AttributeDictionaryPoolRef pool)
 {
-    AttributeDictionaryRef dictionary = NULL;
-    SBUInteger dictCount = cache->_attributeDicts.count;
+    SBUInteger bucketCount = (pool->_bucketCount ? pool->_bucketCount * 2 : InitialBucketCount);
+    InternedDictionaryRef *buckets;
+    SBUInteger bucketIndex;
 
-    if (dictCount == 0) {
-        /* Create a new dictionary if the cache is empty */
-        dictionary = AttributeDictionaryCreate(cache->_valueSize);
-    } else {
-        /* Reuse the last cached dictionary */
-        dictionary = ListGetVal(&cache->_attributeDicts, dictCount - 1);
-        ListRemoveAt(&cache->_attributeDicts, dictCount - 1);
+    buckets = SBAllocatorAllocateBlock(NULL, sizeof(InternedDictionaryRef) * bucketCount);
+    if (!buckets) {
+        return SBFalse;
+    }
+
+    for (bucketIndex = 0; bucketIndex < bucketCount; bucketIndex++) {
+        buckets[bucketIndex] = NULL;
+    }
+
+    for (bucketIndex = 0; bucketIndex < pool->_bucketCount; bucketIndex++) {
+        InternedDictionaryRef interned = pool->_buckets[bucketIndex];
+
+        while (interned) {
+            InternedDictionaryRef next = interned->next;
+            SBUInteger newIndex = interned->hash & (bucketCount - 1);
+
+            interned->next = buckets[newIndex];
+            buckets[newIndex] = interned;
+
+            interned = next;
+        }
     }
 
+    SBAllocatorDeallocateBlock(NULL, pool->_buckets);
+
+    pool->_buckets = buckets;
+    pool->_bucketCount = bucketCount;
+
+    return SBTrue;
+}
+
+/**
+ * Returns the canonical dictionary holding the same attributes as the candidate, taking over the
+ * retained values of the candidate and leaving it empty. The returned dictionary is retained.
+ */
+static AttributeDictionaryRef InternAttributeDictionary(AttributeDictionaryPoolRef pool,
+    AttributeDictionaryRef candidate, SBAttributeRegistryRef registry)
+{
+    SBUInteger hash = AttributeDictionaryGetHash(candidate, registry);
+    InternedDictionaryRef interned;
+
+    if (pool->_bucketCount > 0) {
+        interned = pool->_buckets[hash & (pool->_bucketCount - 1)];
+
+        /* Look for an existing dictionary with equal attributes */
+        while (interned) {
+            if (interned->hash == hash
+                && AttributeDictionaryIsEqual(&interned->dictionary, candidate, registry)) {
+                interned->refCount += 1;
+                AttributeDictionaryClear(candidate, registry);
+
+                return &interned->dictionary;
+            }
+
+            interned = interned->next;
+        }
+    }
+
+    /* Keep the load factor at most one */
+    if (pool->_count >= pool->_bucketCount && !GrowAttributeDictionaryPool(pool)) {
+        return NULL;
+    }
+
+    /* Allocate the presence mask along with the dictionary */
+    interned = SBAllocatorAllocateBlock(NULL,
+        sizeof(InternedDictionary) + sizeof(SBUInt32) * pool->_maskWordCount);
+
+    if (interned) {
+        SBUInteger bucketIndex = hash & (pool->_bucketCount - 1);
+
+        /* Move the items of the candidate into the new dictionary */
+        interned->dictionary = *candidate;
+        AttributeDictionaryInitialize(candidate, pool->_valueSize);
+
+        interned->presenceMask = (SBUInt32 *)(interned + 1);
+        AttributeDictionaryGetPresenceMask(&interned->dictionary,
+            interned->presenceMask, pool->_maskWordCount);
+
+        interned->hash = hash;
+        interned->refCount = 1;
+        interned->next = pool->_buckets[bucketIndex];
+
+        pool->_buckets[bucketIndex] = interned;
+        pool->_count += 1;
+    }
+
+    return (interned ? &interned->dictionary : NULL);
+}
+
+/**
+ * Adds a reference to an interned dictionary.
+ */
+static AttributeDictionaryRef RetainAttributeDictionary(AttributeDictionaryRef dictionary)
+{
+    GetInternedDictionary(dictionary)->refCount += 1;
+
     return dictionary;
 }
 
 /**
- * Caches an attribute dictionary for later reuse. The dictionary is cleared before caching.
+ * Removes a reference to an interned dictionary, destroying it when no reference remains.
  */
-static void StoreAttributeDictionaryInCache(AttributeDictionaryCacheRef cache,
+static void ReleaseAttributeDictionary(AttributeDictionaryPoolRef pool,
     AttributeDictionaryRef dictionary, SBAttributeRegistryRef registry)
 {
-    AttributeDictionaryClear(dictionary, registry);
-    ListAdd(&cache->_attributeDicts, &dictionary);
+    InternedDictionaryRef interned = GetInternedDictionary(dictionary);
+
+    interned->refCount -= 1;
+
+    if (interned->refCount == 0) {
+        InternedDictionaryRef *link = &pool->_buckets[interned->hash & (pool->_bucketCount - 1)];
+
+        /* Unlink the dictionary from its bucket */
+        while (*link != interned) {
+            link = &(*link)->next;
+        }
+        *link = interned->next;
+
+        pool->_count -= 1;
+
+        AttributeDictionaryFinalize(&interned->dictionary, registry);
+        SBAllocatorDeallocateBlock(NULL, interned);
+    }
 }
 
+#undef InitialBucketCount
+
 /* =========================================================================
  * Attribute Manager Implementation
  * ========================================================================= */
@@ -241,34 +362,6 @@ static void ShrinkRangeToExcludeBoundaryParagraphs(AttributeManagerRef manager,
     }
 }
 
-/**
- * Calculates the end index (exclusive) of an attribute entry.
- *
- * For all entries except the last, the end is the start of the next entry.
- * For the last entry, the end is the total code unit count.
- */
-static SBUInteger GetAttributeEntryEndIndex(AttributeManagerRef manager, SBUInteger entryIndex)
-{
-    if (entryIndex < manager->_entries.count - 1) {
-        const AttributeEntry *nextEntry = ListGetRef(&manager->_entries, entryIndex + 1);
-        return nextEntry->index;
-    }
-
-    return manager->_stringLength;
-}
-
-/**
- * Shifts all entry indices starting from a given position by a delta amount.
- */
-static void ShiftAttributeEntryRanges(AttributeManagerRef manager,
-    SBUInteger entryIndex, SBInteger indexDelta) {
-    while (entryIndex < manager->_entries.count) {
-        AttributeEntry *currentEntry = ListGetRef(&manager->_entries, entryIndex);
-        currentEntry->index += indexDelta;
-        entryIndex += 1;
-    }
-}
-
 /**
  * Applies an attribute operation to a dictionary.
  *
@@ -295,13 +388,72 @@ static void ApplyOperationToAttributes(AttributeDictionaryRef attributes,
     }
 }
 
+/**
+ * Returns the interned result of applying an operation to interned attributes, or NULL if the
+ * operation makes no change or the result could not be allocated, so that the callers keep the
+ * original attributes in both cases. The returned dictionary is retained.
+ */
+static AttributeDictionaryRef DeriveAttributes(AttributeManagerRef manager,
+    AttributeDictionaryRef attributes, AttributeOperationType operation,
+    AttributeOperationParams params)
+{
+    SBAttributeRegistryRef registry = manager->_registry;
+    AttributeDictionaryRef workingAttributes = &manager->_workDict;
+    AttributeDictionaryRef derivedAttributes;
+    SBBoolean unchanged = SBTrue;
+
+    /* Apply the operation on a working copy as interned attributes are immutable */
+    AttributeDictionarySet(workingAttributes, attributes, registry);
+    ApplyOperationToAttributes(workingAttributes, operation, params, registry, &unchanged);
+
+    if (unchanged) {
+        AttributeDictionaryClear(workingAttributes, registry);
+        return NULL;
+    }
+
+    derivedAttributes = InternAttributeDictionary(&manager->_pool, workingAttributes, registry);
+
+    if (!derivedAttributes) {
+        AttributeDictionaryClear(workingAttributes, registry);
+    }
+
+    return derivedAttributes;
+}
+
+/**
+ * Applies an operation to the attributes of an entry, replacing them with the interned result.
+ */
+static void ApplyOperationToEntry(AttributeManagerRef manager, AttributeEntryRef entry,
+    AttributeOperationType operation, AttributeOperationParams params)
+{
+    AttributeDictionaryRef modifiedAttributes;
+
+    modifiedAttributes = DeriveAttributes(manager, entry->attributes, operation, params);
+
+    if (modifiedAttributes) {
+        ReleaseAttributeDictionary(&manager->_pool, entry->attributes, manager->_registry);
+        entry->attributes = modifiedAttributes;
+    }
+}
+
+/**
+ * Returns the retained interned dictionary having no attributes, which cannot fail as the manager
+ * keeps a reference to it.
+ */
+static AttributeDictionaryRef AcquireEmptyAttributes(AttributeManagerRef manager)
+{
+    return RetainAttributeDictionary(manager->_emptyDict);
+}
+
 /**
  * Splits an attribute entry at specified index and applies operation to one side.
  *
  * @param manager
  *      The attribute manager containing the entries.
- * @param entryIndex
- *      Index of the entry to split.
+ * @param entry
+ *      The entry to split.
+ * @param entryStart
+ *      Code unit index where the entry starts.
  * @param splitIndex
  *      Code unit index where to split the entry.
  * @param operation
@@ -311,56 +463,43 @@ static void ApplyOperationToAttributes(AttributeDictionaryRef attributes,
  * @param updateTarget
  *      Which side of split receives the modified attributes.
  * @return
- *      SBTrue if split was performed, SBFalse if no split needed.
+ *      The new right side entry if split was performed, NULL if no split needed.
  */
-static SBBoolean SplitAttributesEntry(AttributeManagerRef manager,
-    SBUInteger entryIndex, SBUInteger splitIndex, AttributeOperationType operation,
-    AttributeOperationParams params, SplitUpdateTarget updateTarget)
+static AttributeEntryRef SplitAttributesEntry(AttributeManagerRef manager,
+    AttributeEntryRef entry, SBUInteger entryStart, SBUInteger splitIndex,
+    AttributeOperationType operation, AttributeOperationParams params,
+    SplitUpdateTarget updateTarget)
 {
-    SBAttributeRegistryRef registry = manager->_registry;
-    AttributeEntry firstEntry;
-    SBUInteger entryEnd;
-
-    firstEntry = ListGetVal(&manager->_entries, entryIndex);
-    entryEnd = GetAttributeEntryEndIndex(manager, entryIndex);
+    SBUInteger entryEnd = entryStart + entry->length;
 
     /* Only split if split index is strictly between entry boundaries */
-    if (splitIndex > firstEntry.index && splitIndex < entryEnd) {
-        SBBoolean unchanged = SBTrue;
+    if (splitIndex > entryStart && splitIndex < entryEnd) {
         AttributeDictionaryRef modifiedAttributes;
 
-        /* Create working copy of attributes for modification */
-        modifiedAttributes = AcquireAttributeDictionaryFromCache(&manager->_cache);
-        AttributeDictionarySet(modifiedAttributes, firstEntry.attributes, registry);
-
         /* Apply operation to determine if changes would occur */
-        ApplyOperationToAttributes(modifiedAttributes, operation, params, registry, &unchanged);
+        modifiedAttributes = DeriveAttributes(manager, entry->attributes, operation, params);
 
-        if (unchanged) {
-            /* Operation produces no change - no split needed, cache the copy */
-            StoreAttributeDictionaryInCache(&manager->_cache, modifiedAttributes, registry);
-        } else {
-            AttributeEntry newEntry;
-            newEntry.index = splitIndex;
+        /* Operation produces no change - no split needed */
+        if (modifiedAttributes) {
+            AttributeDictionaryRef rightAttributes;
 
             if (updateTarget == SplitUpdateTargetRight) {
                 /* Right side gets modified attributes, left side keeps original */
-                newEntry.attributes = modifiedAttributes;
+                rightAttributes = modifiedAttributes;
             } else {
-                AttributeEntry *original = ListGetRef(&manager->_entries, entryIndex);
-
                 /* Left side gets modified attributes, right side keeps original */
-                newEntry.attributes = original->attributes;
-                original->attributes = modifiedAttributes;
+                rightAttributes = entry->attributes;
+                entry->attributes = modifiedAttributes;
             }
 
-            ListInsert(&manager->_entries, entryIndex + 1, &newEntry);
+            AttributeEntryTreeSetLength(&manager->_entries, entry, splitIndex - entryStart);
 
-            return SBTrue;
+            return AttributeEntryTreeInsertAfter(&manager->_entries, entry,
+                entryEnd - splitIndex, rightAttributes);
         }
     }
 
-    return SBFalse;
+    return NULL;
 }
 
 /**
@@ -386,65 +525,60 @@ static void ApplyOperationOverRange(AttributeManagerRef manager,
     SBUInteger index, SBUInteger length,
     AttributeOperationType operation, AttributeOperationParams params)
 {
-    SBAttributeRegistryRef registry = manager->_registry;
+    AttributeEntryTreeRef entries = &manager->_entries;
     SBUInteger rangeStart = index;
     SBUInteger rangeEnd = index + length;
-    SBUInteger entryIndex;
-    AttributeEntry *entry;
+    AttributeEntryRef entry;
+    SBUInteger entryStart;
     SBUInteger entryEnd;
 
     /* Locate the entry containing the range start */
-    entry = AttributeManagerFindEntry(manager, rangeStart, &entryIndex, &entryEnd);
+    entry = AttributeManagerFindEntry(manager, rangeStart, &entryStart, &entryEnd);
 
-    if (rangeStart == entry->index && rangeEnd == entryEnd) {
+    if (rangeStart == entryStart && rangeEnd == entryEnd) {
         /* CASE 1: Operation covers entire entry exactly */
-        ApplyOperationToAttributes(entry->attributes, operation, params, registry, NULL);
-    } else if (rangeStart > entry->index && rangeEnd < entryEnd) {
+        ApplyOperationToEntry(manager, entry, operation, params);
+    } else if (rangeStart > entryStart && rangeEnd < entryEnd) {
         /* CASE 2: Operation is entirely within one entry - split into 3 */
         AttributeDictionaryRef modifiedAttributes;
-        SBBoolean unchanged;
-
-        modifiedAttributes = AcquireAttributeDictionaryFromCache(&manager->_cache);
-        AttributeDictionarySet(modifiedAttributes, entry->attributes, registry);
-        ApplyOperationToAttributes(modifiedAttributes, operation, params, registry, &unchanged);
 
-        if (unchanged) {
-            /* No changes needed - don't split */
-            StoreAttributeDictionaryInCache(&manager->_cache, modifiedAttributes, registry);
-        } else {
-            AttributeDictionaryRef cloneAttributes;
+        modifiedAttributes = DeriveAttributes(manager, entry->attributes, operation, params);
 
-            cloneAttributes = AcquireAttributeDictionaryFromCache(&manager->_cache);
-            AttributeDictionarySet(cloneAttributes, entry->attributes, registry);
+        /* No changes needed - don't split */
+        if (modifiedAttributes) {
+            /* Right entry shares the original attributes with the left one */
+            AttributeDictionaryRef cloneAttributes = RetainAttributeDictionary(entry->attributes);
+            AttributeEntryRef middleEntry;
 
-            /* Reserve space for 2 new entries */
-            ListReserveRange(&manager->_entries, entryIndex + 1, 2);
+            /* Left entry: keeps original attributes */
+            AttributeEntryTreeSetLength(entries, entry, rangeStart - entryStart);
 
             /* Middle entry: gets modified attributes */
-            entry = ListGetRef(&manager->_entries, entryIndex + 1);
-            entry->index = rangeStart;
-            entry->attributes = modifiedAttributes;
+            middleEntry = AttributeEntryTreeInsertAfter(entries, entry,
+                rangeEnd - rangeStart, modifiedAttributes);
 
             /* Right entry: keeps original attributes */
-            entry = ListGetRef(&manager->_entries, entryIndex + 2);
-            entry->index = rangeEnd;
-            entry->attributes = cloneAttributes;
+            AttributeEntryTreeInsertAfter(entries, middleEntry,
+                entryEnd - rangeEnd, cloneAttributes);
         }
     } else {
         /* CASE 3: Operation spans multiple entries - handle boundaries and interior */
         SBBoolean entryProcessed = SBFalse;
+        AttributeEntryRef rightEntry;
 
         /* Split at range start if needed */
-        if (SplitAttributesEntry(manager, entryIndex, rangeStart,
-                operation, params, SplitUpdateTargetRight)) {
+        rightEntry = SplitAttributesEntry(manager, entry, entryStart, rangeStart,
+            operation, params, SplitUpdateTargetRight);
+
+        if (rightEntry) {
             entryProcessed = SBTrue;    /* Split already applied operation */
-            entryIndex += 1;            /* Move to new right-side entry */
+            entry = rightEntry;         /* Move to new right-side entry */
+            entryStart = rangeStart;
         }
 
         /* Process all entries intersecting with the operation range */
         while (rangeStart < rangeEnd) {
-            entry = ListGetRef(&manager->_entries, entryIndex);
-            entryEnd = GetAttributeEntryEndIndex(manager, entryIndex);
+            entryEnd = entryStart + entry->length;
 
             /* Split at range end if current entry extends beyond operation range */
             if (entryEnd > rangeEnd) {
@@ -452,7 +586,7 @@ static void ApplyOperationOverRange(AttributeManagerRef manager,
                  * Split at range end - modified attributes go to left side (range interior) so the
                  * portion inside range gets the operation applied
                  */
-                SplitAttributesEntry(manager, entryIndex, rangeEnd,
+                SplitAttributesEntry(manager, entry, entryStart, rangeEnd,
                     operation, params, SplitUpdateTargetLeft);
                 /* Remaining portion beyond range is unmodified */
                 break;
@@ -460,12 +594,13 @@ static void ApplyOperationOverRange(AttributeManagerRef manager,
 
             /* Apply operation to current entry if not already processed by split */
             if (!entryProcessed) {
-                ApplyOperationToAttributes(entry->attributes, operation, params, registry, NULL);
+                ApplyOperationToEntry(manager, entry, operation, params);
             }
 
             /* Advance to next entry */
             rangeStart = entryEnd;
-            entryIndex += 1;
+            entryStart = entryEnd;
+            entry = entry->next;
             entryProcessed = SBFalse;
         }
     }
@@ -525,7 +660,7 @@ static void AdjustParagraphAttributesAfterMerge(AttributeManagerRef manager,
             SBUInteger paragraphStart = precedingParagraph->index;
             SBUInteger paragraphEnd = paragraphStart + precedingParagraph->length;
             AttributeDictionaryRef paragraphAttributes;
-            AttributeEntry *entry;
+            AttributeEntryRef entry;
 
             paragraphAttributes = &manager->_tempDict;
 
@@ -563,49 +698,261 @@ static void AdjustParagraphAttributesAfterMerge(AttributeManagerRef manager,
  */
 static void InsertFirstAttributeEntry(AttributeManagerRef manager)
 {
-    AttributeEntry entry;
+    AttributeEntryTreeInsertAfter(&manager->_entries, NULL, 0, AcquireEmptyAttributes(manager));
+}
 
-    entry.index = 0;
-    entry.attributes = AcquireAttributeDictionaryFromCache(&manager->_cache);
+/**
+ * Removes an attribute entry and releases its interned dictionary.
+ */
+static void RemoveAttributeEntry(AttributeManagerRef manager, AttributeEntryRef entry)
+{
+    ReleaseAttributeDictionary(&manager->_pool, entry->attributes, manager->_registry);
+    AttributeEntryTreeRemove(&manager->_entries, entry);
+}
 
-    ListAdd(&manager->_entries, &entry);
+/**
+ * Releases the interned dictionaries of all attribute entries.
+ */
+static void ReleaseAllAttributeEntries(AttributeManagerRef manager)
+{
+    AttributeEntryRef entry;
+
+    for (entry = manager->_entries.first; entry; entry = entry->next) {
+        ReleaseAttributeDictionary(&manager->_pool, entry->attributes, manager->_registry);
+    }
 }
 
 /**
- * Removes and caches a range of attribute entries.
+ * A run of code units with the same attributes produced while sweeping attribute spans.
+ */
+typedef struct _AttributeSegment {
+    SBUInteger length;
+    AttributeDictionaryRef attributes;      /**< Retained interned attributes */
+} AttributeSegment;
+
+typedef LIST(AttributeSegment) AttributeSegmentList;
+
+/**
+ * Checks whether a span sets a registered character-scoped attribute over a non-empty range.
+ */
+static SBBoolean IsCharacterAttributeSpan(AttributeManagerRef manager, const SBAttributeSpan *span)
+{
+    const SBAttributeInfo *attributeInfo;
+
+    attributeInfo = SBAttributeRegistryGetInfoReference(manager->_registry, span->attributeID);
+
+    return (span->length > 0 && attributeInfo
+            && attributeInfo->scope != SBAttributeScopeParagraph);
+}
+
+/**
+ * Merges all character-scoped spans into the entries in a single sweep over the entries and spans.
+ *
+ * The text is cut into segments at entry boundaries and span boundaries. Each segment gets the
+ * attributes of its entry merged with the values of all the spans covering it, later spans taking
+ * precedence over earlier ones, and adjacent segments with identical attributes are coalesced. The
+ * entries are then rebuilt from the segments in linear time.
  *
- * Attempts to cache each removed entry's dictionary for reuse, then removes all entries in the
- * specified range from the entries list.
+ * @return
+ *      SBTrue if the spans were applied, SBFalse if the memory could not be allocated, in which case
+ *      the entries are left untouched.
  */
-static void RemoveAttributeEntryRange(AttributeManagerRef manager,
-    SBUInteger index, SBUInteger length)
+static SBBoolean ApplyCharacterAttributeSpans(AttributeManagerRef manager,
+    const SBAttributeSpan *spans, SBUInteger count)
 {
-    SBAttributeRegistryRef registry = manager->_registry;
-    SBUInteger rangeEnd = index + length;
-    SBUInteger entryIndex;
+    AttributeDictionaryRef spanAttributes = &manager->_tempDict;
+    AttributeDictionaryRef lastBase = NULL;
+    AttributeDictionaryRef lastResult = NULL;
+    LIST(AttributeSegment) segments;
+    LIST(SBUInteger) activeSpans;
+    SBBoolean succeeded = SBTrue;
+    AttributeOperationParams params;
+    const AttributeEntry *entry;
+    SBUInteger entryEnd;
+    SBUInteger position;
+    SBUInteger spanIndex;
+    SBUInteger itemIndex;
+
+    ListInitialize(&segments, sizeof(AttributeSegment));
+    ListInitialize(&activeSpans, sizeof(SBUInteger));
+
+    params.apply.attributes = spanAttributes;
+
+    entry = manager->_entries.first;
+    entryEnd = entry->length;
+    position = 0;
+    spanIndex = 0;
+
+    while (position < manager->_stringLength) {
+        SBBoolean activeChanged = SBFalse;
+        AttributeDictionaryRef attributes;
+        SBUInteger segmentEnd;
+        SBUInteger keptCount;
+
+        /* Deactivate the spans ending at current position */
+        keptCount = 0;
+
+        for (itemIndex = 0; itemIndex < activeSpans.count; itemIndex++) {
+            SBUInteger activeIndex = ListGetVal(&activeSpans, itemIndex);
+            const SBAttributeSpan *span = &spans[activeIndex];
+
+            if (span->index + span->length > position) {
+                ListSetVal(&activeSpans, keptCount, activeIndex);
+                keptCount += 1;
+            }
+        }
+
+        if (keptCount != activeSpans.count) {
+            ListRemoveRange(&activeSpans, keptCount, activeSpans.count - keptCount);
+            activeChanged = SBTrue;
+        }
+
+        /* Activate the spans starting at current position, keeping their order */
+        while (spanIndex < count && spans[spanIndex].index <= position) {
+            if (IsCharacterAttributeSpan(manager, &spans[spanIndex])) {
+                if (!ListAdd(&activeSpans, &spanIndex)) {
+                    succeeded = SBFalse;
+                    break;
+                }
+
+                activeChanged = SBTrue;
+            }
+
+            spanIndex += 1;
+        }
+
+        if (!succeeded) {
+            break;
+        }
+
+        /* The segment ends at the nearest entry or span boundary */
+        segmentEnd = entryEnd;
+
+        if (spanIndex < count && spans[spanIndex].index < segmentEnd) {
+            segmentEnd = spans[spanIndex].index;
+        }
+
+        for (itemIndex = 0; itemIndex < activeSpans.count; itemIndex++) {
+            const SBAttributeSpan *span = &spans[ListGetVal(&activeSpans, itemIndex)];
+            SBUInteger spanEnd = span->index + span->length;
+
+            if (spanEnd < segmentEnd) {
+                segmentEnd = spanEnd;
+            }
+        }
+
+        if (activeChanged) {
+            /* Collect the values of active spans, later ones overriding earlier ones */
+            AttributeDictionaryClear(spanAttributes, NULL);
+
+            for (itemIndex = 0; itemIndex < activeSpans.count; itemIndex++) {
+                const SBAttributeSpan *span = &spans[ListGetVal(&activeSpans, itemIndex)];
+
+                AttributeDictionaryPut(spanAttributes,
+                    span->attributeID, span->attributeValue, NULL, NULL);
+            }
+
+            lastBase = NULL;
+        }
+
+        /* Determine the attributes of the segment */
+        if (activeSpans.count == 0) {
+            attributes = RetainAttributeDictionary(entry->attributes);
+        } else if (entry->attributes == lastBase) {
+            /* Same entry attributes with same spans always produce the same result */
+            attributes = RetainAttributeDictionary(lastResult);
+        } else {
+            attributes = DeriveAttributes(manager, entry->attributes,
+                AttributeOperationApply, params);
 
-    for (entryIndex = index; entryIndex < rangeEnd; entryIndex++) {
-        AttributeEntry *entry = ListGetRef(&manager->_entries, entryIndex);
-        StoreAttributeDictionaryInCache(&manager->_cache, entry->attributes, registry);
+            if (!attributes) {
+                attributes = RetainAttributeDictionary(entry->attributes);
+            }
+
+            lastBase = entry->attributes;
+            lastResult = attributes;
+        }
+
+        /* Coalesce with the previous segment having identical attributes */
+        if (segments.count > 0
+                && ListGetRef(&segments, segments.count - 1)->attributes == attributes) {
+            ListGetRef(&segments, segments.count - 1)->length += segmentEnd - position;
+            ReleaseAttributeDictionary(&manager->_pool, attributes, manager->_registry);
+        } else {
+            AttributeSegment segment;
+            segment.length = segmentEnd - position;
+            segment.attributes = attributes;
+
+            if (!ListAdd(&segments, &segment)) {
+                ReleaseAttributeDictionary(&manager->_pool, attributes, manager->_registry);
+                succeeded = SBFalse;
+                break;
+            }
+        }
+
+        position = segmentEnd;
+
+        /* Move to the next entry when the current one is consumed */
+        if (position == entryEnd && entry->next) {
+            entry = entry->next;
+            entryEnd += entry->length;
+        }
     }
 
-    ListRemoveRange(&manager->_entries, index, length);
+    if (succeeded) {
+        /* Replace all entries with the segments */
+        ReleaseAllAttributeEntries(manager);
+        AttributeEntryTreeRemoveAll(&manager->_entries);
+
+        for (itemIndex = 0; itemIndex < segments.count; itemIndex++) {
+            AttributeSegment *segment = ListGetRef(&segments, itemIndex);
+
+            AttributeEntryTreeBulkAppend(&manager->_entries, segment->length, segment->attributes);
+        }
+
+        AttributeEntryTreeEndBulkAppend(&manager->_entries);
+    } else {
+        for (itemIndex = 0; itemIndex < segments.count; itemIndex++) {
+            AttributeSegment *segment = ListGetRef(&segments, itemIndex);
+
+            ReleaseAttributeDictionary(&manager->_pool, segment->attributes, manager->_registry);
+        }
+    }
+
+    ListFinalize(&activeSpans);
+    ListFinalize(&segments);
+
+    return succeeded;
 }
 
-SB_INTERNAL void AttributeManagerInitialize(AttributeManagerRef manager,
+SB_INTERNAL SBBoolean AttributeManagerInitialize(AttributeManagerRef manager,
     SBTextRef parent, SBAttributeRegistryRef registry)
 {
+    SBBoolean isInitialized = SBTrue;
+
     manager->parent = parent;
     manager->_registry = registry;
     manager->_stringLength = 0;
 
     if (registry) {
         /* Initialize all structures only when a registry is provided */
-        InitializeAttributeDictionaryCache(&manager->_cache, registry->valueSize);
+        InitializeAttributeDictionaryPool(&manager->_pool, registry->valueSize, registry->count);
         AttributeDictionaryInitialize(&manager->_tempDict, registry->valueSize);
-        ListInitialize(&manager->_entries, sizeof(AttributeEntry));
-        InsertFirstAttributeEntry(manager);
+        AttributeDictionaryInitialize(&manager->_workDict, registry->valueSize);
+        AttributeEntryTreeInitialize(&manager->_entries);
+
+        /* Keep the empty attributes so that resetting an entry never needs an allocation */
+        manager->_emptyDict = InternAttributeDictionary(&manager->_pool,
+            &manager->_workDict, registry);
+
+        if (manager->_emptyDict) {
+            InsertFirstAttributeEntry(manager);
+        } else {
+            isInitialized = SBFalse;
+        }
     }
+
+    return isInitialized;
 }
 
 SB_INTERNAL void AttributeManagerFinalize(AttributeManagerRef manager)
@@ -613,184 +960,323 @@ SB_INTERNAL void AttributeManagerFinalize(AttributeManagerRef manager)
     SBAttributeRegistryRef registry = manager->_registry;
 
     if (registry) {
-        SBUInteger entryCount = manager->_entries.count;
-        SBUInteger entryIndex;
-
         AttributeDictionaryFinalize(&manager->_tempDict, NULL);
-        FinalizeAttributeDictionaryCache(&manager->_cache, registry);
+        AttributeDictionaryFinalize(&manager->_workDict, registry);
+
+        /* Release the attributes of all entries */
+        ReleaseAllAttributeEntries(manager);
 
-        /* Finalize all entries */
-        for (entryIndex = 0; entryIndex < entryCount; entryIndex++) {
-            AttributeEntry *entry = ListGetRef(&manager->_entries, entryIndex);
-            AttributeDictionaryDestroy(entry->attributes, registry);
+        if (manager->_emptyDict) {
+            ReleaseAttributeDictionary(&manager->_pool, manager->_emptyDict, registry);
         }
 
-        ListFinalize(&manager->_entries);
+        FinalizeAttributeDictionaryPool(&manager->_pool, registry);
+        AttributeEntryTreeFinalize(&manager->_entries);
     }
 }
 
-SB_INTERNAL void AttributeManagerCopyAttributes(AttributeManagerRef manager,
+SB_INTERNAL SBBoolean AttributeManagerCopyAttributes(AttributeManagerRef manager,
     const AttributeManager *source)
 {
     SBAttributeRegistryRef registry = manager->_registry;
+    SBBoolean isCopied = SBTrue;
 
     if (registry) {
-        SBUInteger entryCount = source->_entries.count;
-        SBUInteger entryIndex;
-
-        /* Clear existing entries and cache their dictionaries */
-        RemoveAttributeEntryRange(manager, 0, manager->_entries.count);
-        /* Reserve space for source entries */
-        ListReserveRange(&manager->_entries, 0, entryCount);
-
-        /* Deep copy each entry and its attributes */
-        for (entryIndex = 0; entryIndex < entryCount; entryIndex++) {
-            const AttributeEntry *sourceEntry = ListGetRef(&source->_entries, entryIndex);
-            AttributeEntry *newEntry = ListGetRef(&manager->_entries, entryIndex);
+        AttributeDictionaryRef workingAttributes = &manager->_workDict;
+        AttributeDictionaryRef lastSource = NULL;
+        AttributeDictionaryRef lastCopy = NULL;
+        const AttributeEntry *sourceEntry;
+
+        /* Clear existing entries and release their dictionaries */
+        ReleaseAllAttributeEntries(manager);
+        AttributeEntryTreeRemoveAll(&manager->_entries);
+
+        /* Append a copy of each entry, interning its attributes in this manager */
+        for (sourceEntry = source->_entries.first; sourceEntry; sourceEntry = sourceEntry->next) {
             AttributeDictionaryRef cloneAttributes;
 
-            cloneAttributes = AcquireAttributeDictionaryFromCache(&manager->_cache);
-            AttributeDictionarySet(cloneAttributes, sourceEntry->attributes, registry);
+            if (sourceEntry->attributes == lastSource) {
+                /* Interned source attributes are equal only if they are identical */
+                cloneAttributes = RetainAttributeDictionary(lastCopy);
+            } else {
+                AttributeDictionarySet(workingAttributes, sourceEntry->attributes, registry);
+                cloneAttributes = InternAttributeDictionary(&manager->_pool,
+                    workingAttributes, registry);
+
+                if (!cloneAttributes) {
+                    AttributeDictionaryClear(workingAttributes, registry);
+                    isCopied = SBFalse;
+                    break;
+                }
+
+                lastSource = sourceEntry->attributes;
+                lastCopy = cloneAttributes;
+            }
 
-            newEntry->index = sourceEntry->index;
-            newEntry->attributes = cloneAttributes;
+            AttributeEntryTreeBulkAppend(&manager->_entries, sourceEntry->length, cloneAttributes);
         }
 
+        AttributeEntryTreeEndBulkAppend(&manager->_entries);
         manager->_stringLength = source->_stringLength;
     }
+
+    return isCopied;
 }
 
-SB_INTERNAL AttributeEntry *AttributeManagerFindEntry(AttributeManagerRef manager,
-    SBUInteger stringIndex, SBUInteger *entryIndex, SBUInteger *entryEnd)
+SB_INTERNAL AttributeEntryRef AttributeManagerFindEntry(AttributeManagerRef manager,
+    SBUInteger stringIndex, SBUInteger *entryStart, SBUInteger *entryEnd)
 {
-    AttributeEntry *entries = manager->_entries.items;
-    SBUInteger count = manager->_entries.count;
-    SBUInteger stringLength = manager->_stringLength;
-    SBUInteger low;
-    SBUInteger high;
+    AttributeEntryRef entry;
+    SBUInteger runStart;
 
-    SBAssert(entries && count > 0);
+    SBAssert(manager->_entries.count > 0);
 
-    low = 0;
-    high = count - 1;
+    entry = AttributeEntryTreeFind(&manager->_entries, stringIndex, &runStart);
 
-    while (low <= high) {
-        SBUInteger mid = low + (high - low) / 2;
-        AttributeEntry *entry;
-        SBUInteger runStart;
-        SBUInteger runEnd;
+    if (entry) {
+        if (entryStart) {
+            *entryStart = runStart;
+        }
+        if (entryEnd) {
+            *entryEnd = runStart + entry->length;
+        }
+    }
 
-        entry = &entries[mid];
-        runStart = entry->index;
-        runEnd = (mid < count - 1) ? entries[mid + 1].index : stringLength;
+    return entry;
+}
 
-        if (stringIndex < runStart) {
-            /* Target is before the current entry */
-            high = mid - 1;
-        } else if (stringIndex >= runEnd) {
-            /* Target is after the current entry */
-            low = mid + 1;
+/**
+ * Resizes the attribute entries for a replaced range without looking at the paragraphs.
+ *
+ * @return
+ *      SBTrue if the replacement may have merged paragraphs, SBFalse otherwise.
+ */
+static SBBoolean ResizeAttributeRange(AttributeManagerRef manager,
+    SBUInteger replaceStart, SBUInteger oldLength, SBUInteger newLength)
+{
+    SBAttributeRegistryRef registry = manager->_registry;
+    AttributeEntryTreeRef entries = &manager->_entries;
+    SBUInteger replaceEnd = replaceStart + oldLength;
+    SBInteger lengthDelta = (SBInteger)(newLength - oldLength);
+
+    if (replaceStart == manager->_stringLength) {
+        /* Appending at end - extend the last entry */
+        AttributeEntryTreeSetLength(entries, entries->last, entries->last->length + newLength);
+        manager->_stringLength += lengthDelta;
+    } else if (entries->count == 1) {
+        /* Single entry covers all text - simple update */
+        AttributeEntryTreeSetLength(entries, entries->first,
+            entries->first->length - oldLength + newLength);
+        manager->_stringLength += lengthDelta;
+    } else {
+        SBUInteger stringIndex;
+        AttributeEntryRef entry;
+        SBUInteger entryStart;
+        SBUInteger entryEnd;
+
+        /* Select which adjacent code unit's attributes to extend into the range */
+        if (oldLength == 0 && replaceStart > 0) {
+            /* Insertion: use attributes from the code unit before insertion point */
+            stringIndex = replaceStart - 1;
         } else {
-            /* Target is within the current entry */
-            if (entryIndex) {
-                *entryIndex = mid;
+            /* Replacement: use attributes from the first replaced code unit */
+            stringIndex = replaceStart;
+        }
+
+        /* Find the entry containing the reference code unit */
+        entry = AttributeManagerFindEntry(manager, stringIndex, &entryStart, &entryEnd);
+
+        /* Remove entries that are completely covered by the replacement range */
+        while (entryEnd < replaceEnd) {
+            AttributeEntryRef nextEntry = entry->next;
+            SBUInteger nextEnd = entryEnd + nextEntry->length;
+
+            if (nextEnd <= replaceEnd) {
+                /* This entry is completely within replacement range - remove it */
+                RemoveAttributeEntry(manager, nextEntry);
+                entryEnd = nextEnd;
+            } else {
+                /* Entry extends beyond replacement range - move its start to range end */
+                AttributeEntryTreeSetLength(entries, nextEntry, nextEnd - replaceEnd);
+                entryEnd = replaceEnd;
             }
-            if (entryEnd) {
-                *entryEnd = runEnd;
+        }
+
+        /* Special handling for pure deletions */
+        if (newLength == 0 && entryStart == replaceStart && entryEnd == replaceEnd) {
+            /* The first entry exactly matches the deleted range */
+            if (entries->count > 1) {
+                /* Safe to delete - not the only entry */
+                RemoveAttributeEntry(manager, entry);
+                entry = NULL;
+            } else {
+                /* This is the only entry - reset it to cover the empty text */
+                ReleaseAttributeDictionary(&manager->_pool, entry->attributes, registry);
+                entry->attributes = AcquireEmptyAttributes(manager);
             }
+        }
 
-            return entry;
+        /* Resize the first entry, implicitly shifting all entries after it */
+        if (entry) {
+            AttributeEntryTreeSetLength(entries, entry,
+                entryEnd - entryStart - oldLength + newLength);
         }
+        manager->_stringLength += lengthDelta;
+
+        /* Deletion or replacement can cause paragraph merges */
+        return (newLength == 0 || oldLength > 0);
     }
 
-    return NULL;
+    return SBFalse;
 }
 
 SB_INTERNAL void AttributeManagerReplaceRange(AttributeManagerRef manager,
     SBUInteger replaceStart, SBUInteger oldLength, SBUInteger newLength)
 {
-    SBAttributeRegistryRef registry = manager->_registry;
+    if (manager->_registry) {
+        if (ResizeAttributeRange(manager, replaceStart, oldLength, newLength)) {
+            AdjustParagraphAttributesAfterMerge(manager, replaceStart, newLength);
+        }
+    }
+}
 
-    if (registry) {
-        SBUInteger replaceEnd = replaceStart + oldLength;
-        SBInteger lengthDelta = (SBInteger)(newLength - oldLength);
-
-        if (replaceStart == manager->_stringLength) {
-            /* Appending at end - no entries to adjust */
-            manager->_stringLength += lengthDelta;
-        } else if (manager->_entries.count == 1) {
-            /* Single entry covers all text - simple update */
-            manager->_stringLength += lengthDelta;
+/**
+ * Appends a segment of edited code units, coalescing it with the previous one having identical
+ * attributes.
+ */
+static SBBoolean AppendEditedSegment(AttributeManagerRef manager,
+    AttributeSegmentList *segments, SBUInteger length, AttributeDictionaryRef attributes)
+{
+    if (segments->count > 0 && ListGetRef(segments, segments->count - 1)->attributes == attributes) {
+        ListGetRef(segments, segments->count - 1)->length += length;
+    } else {
+        AttributeSegment segment;
+        segment.length = length;
+        segment.attributes = RetainAttributeDictionary(attributes);
+
+        if (!ListAdd(segments, &segment)) {
+            ReleaseAttributeDictionary(&manager->_pool, attributes, manager->_registry);
+            return SBFalse;
+        }
+    }
+
+    return SBTrue;
+}
+
+/**
+ * Rebuilds the entries from the pieces of an edit log in a single pass over the pieces and the
+ * original entries.
+ *
+ * @return
+ *      SBTrue if the entries were rebuilt, SBFalse if the memory could not be allocated, in which
+ *      case the entries are left untouched.
+ */
+static SBBoolean RebuildEntriesFromEditPieces(AttributeManagerRef manager, const EditLog *log)
+{
+    AttributeSegmentList segments;
+    SBBoolean succeeded = SBTrue;
+    SBUInteger pieceIndex;
+    SBUInteger itemIndex;
+
+    ListInitialize(&segments, sizeof(AttributeSegment));
+
+    for (pieceIndex = 0; succeeded && pieceIndex < log->pieces.count; pieceIndex++) {
+        const EditPiece *piece = ListGetRef(&log->pieces, pieceIndex);
+
+        if (piece->isInserted) {
+            AttributeDictionaryRef attributes = manager->_emptyDict;
+
+            if (piece->source != SBInvalidIndex) {
+                AttributeEntryRef entry;
+
+                entry = AttributeManagerFindEntry(manager, piece->source, NULL, NULL);
+                attributes = entry->attributes;
+            }
+
+            succeeded = AppendEditedSegment(manager, &segments, piece->length, attributes);
         } else {
-            SBUInteger stringIndex;
-            SBUInteger firstIndex;
+            SBUInteger position = piece->offset;
+            SBUInteger pieceEnd = piece->offset + piece->length;
+            AttributeEntryRef entry;
             SBUInteger entryEnd;
-            SBUInteger shiftStart;
 
-            /* Select which adjacent code unit's attributes to extend into the range */
-            if (oldLength == 0 && replaceStart > 0) {
-                /* Insertion: use attributes from the code unit before insertion point */
-                stringIndex = replaceStart - 1;
-            } else {
-                /* Replacement: use attributes from the first replaced code unit */
-                stringIndex = replaceStart;
-            }
+            /* Carry over the attributes of the original entries covering the piece */
+            entry = AttributeManagerFindEntry(manager, position, NULL, &entryEnd);
+
+            while (succeeded && position < pieceEnd) {
+                SBUInteger segmentEnd = (entryEnd < pieceEnd ? entryEnd : pieceEnd);
 
-            /* Find the entry containing the reference code unit */
-            AttributeManagerFindEntry(manager, stringIndex, &firstIndex, &entryEnd);
-            shiftStart = firstIndex + 1;
-
-            /* Remove entries that are completely covered by the replacement range */
-            if (entryEnd < replaceEnd) {
-                SBUInteger removalStart = firstIndex + 1; /* Keep first entry */
-                SBUInteger removalCount = 0;
-                SBUInteger scanIndex;
-
-                /* Scan entries to find which ones are completely covered */
-                for (scanIndex = removalStart; scanIndex < manager->_entries.count; scanIndex++) {
-                    entryEnd = GetAttributeEntryEndIndex(manager, scanIndex);
-
-                    if (entryEnd <= replaceEnd) {
-                        /* This entry is completely within replacement range - mark for removal */
-                        removalCount += 1;
-                    } else {
-                        /* Entry extends beyond replacement range - adjust its start position */
-                        AttributeEntry *currentEntry = ListGetRef(&manager->_entries, scanIndex);
-                        currentEntry->index = replaceEnd;
-                        break;
-                    }
+                succeeded = AppendEditedSegment(manager, &segments,
+                    segmentEnd - position, entry->attributes);
+
+                position = segmentEnd;
+
+                if (position == entryEnd && entry->next) {
+                    entry = entry->next;
+                    entryEnd += entry->length;
                 }
+            }
+        }
+    }
 
-                /* Remove all marked entries */
-                RemoveAttributeEntryRange(manager, removalStart, removalCount);
+    if (succeeded) {
+        /* Replace all entries with the segments, keeping an empty one for an empty text */
+        ReleaseAllAttributeEntries(manager);
+        AttributeEntryTreeRemoveAll(&manager->_entries);
+
+        if (segments.count == 0) {
+            InsertFirstAttributeEntry(manager);
+        } else {
+            for (itemIndex = 0; itemIndex < segments.count; itemIndex++) {
+                AttributeSegment *segment = ListGetRef(&segments, itemIndex);
+
+                AttributeEntryTreeBulkAppend(&manager->_entries,
+                    segment->length, segment->attributes);
             }
 
-            /* Special handling for pure deletions */
-            if (newLength == 0) {
-                AttributeEntry *entry = ListGetRef(&manager->_entries, firstIndex);
-                entryEnd = GetAttributeEntryEndIndex(manager, firstIndex);
-
-                /* Check if the first entry exactly matches the deleted range */
-                if (entry->index == replaceStart && entryEnd == replaceEnd) {
-                    if (firstIndex != 0 || manager->_entries.count > 1) {
-                        /* Safe to delete - not the only entry */
-                        RemoveAttributeEntryRange(manager, firstIndex, 1);
-                        shiftStart -= 1;
-                    } else {
-                        /* This is the only entry - reset it to cover the empty text */
-                        AttributeDictionaryClear(entry->attributes, registry);
-                        entry->index = 0;
-                    }
-                }
+            AttributeEntryTreeEndBulkAppend(&manager->_entries);
+        }
+
+        manager->_stringLength = log->length;
+    } else {
+        for (itemIndex = 0; itemIndex < segments.count; itemIndex++) {
+            AttributeSegment *segment = ListGetRef(&segments, itemIndex);
+
+            ReleaseAttributeDictionary(&manager->_pool, segment->attributes, manager->_registry);
+        }
+    }
+
+    ListFinalize(&segments);
+
+    return succeeded;
+}
+
+SB_INTERNAL void AttributeManagerReplaceRegions(AttributeManagerRef manager, const EditLog *log)
+{
+    if (manager->_registry) {
+        const EditRegion *regions = log->regions.items;
+        SBUInteger count = log->regions.count;
+        SBUInteger regionIndex;
+
+        if (!RebuildEntriesFromEditPieces(manager, log)) {
+            /*
+             * Resize the entries region by region instead, so that all regions are in the final
+             * positions, though inserted code units then take the attributes next to their region.
+             */
+            for (regionIndex = 0; regionIndex < count; regionIndex++) {
+                const EditRegion *region = &regions[regionIndex];
+
+                ResizeAttributeRange(manager, region->newIndex,
+                    region->oldLength, region->newLength);
             }
+        }
 
-            /* Shift all entries after the modified region */
-            ShiftAttributeEntryRanges(manager, shiftStart, lengthDelta);
-            manager->_stringLength += lengthDelta;
+        /* Unify the attributes of merged paragraphs against the final paragraphs */
+        for (regionIndex = 0; regionIndex < count; regionIndex++) {
+            const EditRegion *region = &regions[regionIndex];
 
-            if (newLength == 0 || oldLength > 0) {
-                /* Deletion or replacement can cause paragraph merges */
-                AdjustParagraphAttributesAfterMerge(manager, replaceStart, newLength);
+            if (region->newLength == 0 || region->oldLength > 0) {
+                AdjustParagraphAttributesAfterMerge(manager, region->newIndex, region->newLength);
             }
         }
     }
@@ -861,12 +1347,40 @@ SB_INTERNAL void AttributeManagerRemoveAttribute(AttributeManagerRef manager,
     }
 }
 
+SB_INTERNAL void AttributeManagerApplyAttributeSpans(AttributeManagerRef manager,
+    const SBAttributeSpan *spans, SBUInteger count)
+{
+    SBAttributeRegistryRef registry = manager->_registry;
+
+    if (registry && count > 0 && manager->_stringLength > 0) {
+        SBBoolean sweepSucceeded;
+        SBUInteger spanIndex;
+
+        sweepSucceeded = ApplyCharacterAttributeSpans(manager, spans, count);
+
+        for (spanIndex = 0; spanIndex < count; spanIndex++) {
+            const SBAttributeSpan *span = &spans[spanIndex];
+
+            if (span->length > 0) {
+                if (!IsCharacterAttributeSpan(manager, span)) {
+                    /* Paragraph-scoped spans are expanded to whole paragraphs individually */
+                    AttributeManagerSetAttribute(manager, span->index, span->length,
+                        span->attributeID, span->attributeValue);
+                } else if (!sweepSucceeded) {
+                    /* Fall back to applying the spans one by one */
+                    AttributeManagerSetAttribute(manager, span->index, span->length,
+                        span->attributeID, span->attributeValue);
+                }
+            }
+        }
+    }
+}
+
 SB_INTERNAL SBBoolean AttributeManagerGetOnwardRunByFilteringID(AttributeManagerRef manager,
     SBUInteger *runStart, SBUInteger rangeEnd,
     SBAttributeID attributeID, AttributeDictionaryRef output)
 {
     SBAttributeRegistryRef registry = manager->_registry;
-    SBUInteger entryIndex;
     const AttributeEntry *entry;
     const void *initialValue;
 
@@ -879,11 +1393,9 @@ SB_INTERNAL SBBoolean AttributeManagerGetOnwardRunByFilteringID(AttributeManager
     }
 
     /* Get the first entry and look for the attribute in it */
-    entry = AttributeManagerFindEntry(manager, *runStart, &entryIndex, runStart);
+    entry = AttributeManagerFindEntry(manager, *runStart, NULL, runStart);
     initialValue = AttributeDictionaryFindValue(entry->attributes, attributeID);
 
-    entryIndex += 1;
-
     if (initialValue) {
         /* Put the initial item to the output dictionary */
         AttributeDictionaryPut(output, attributeID, initialValue, NULL, NULL);
@@ -893,11 +1405,14 @@ SB_INTERNAL SBBoolean AttributeManagerGetOnwardRunByFilteringID(AttributeManager
             SBBoolean valuesMatched = SBFalse;
             const void *subsequentValue;
 
-            entry = ListGetRef(&manager->_entries, entryIndex);
+            entry = entry->next;
             subsequentValue = AttributeDictionaryFindValue(entry->attributes, attributeID);
 
             /* Check if the attribute value matches */
-            if (subsequentValue) {
+            if (subsequentValue == initialValue) {
+                /* Same interned dictionary */
+                valuesMatched = SBTrue;
+            } else if (subsequentValue) {
                 valuesMatched = SBAttributeRegistryIsEqualAttribute(registry,
                     attributeID, initialValue, subsequentValue);
             }
@@ -907,15 +1422,14 @@ SB_INTERNAL SBBoolean AttributeManagerGetOnwardRunByFilteringID(AttributeManager
                 break;
             }
 
-            *runStart = GetAttributeEntryEndIndex(manager, entryIndex);
-            entryIndex += 1;
+            *runStart += entry->length;
         }
     } else {
         /* Iterate while the attribute doesn't exist */
         while (*runStart < rangeEnd) {
             const void *subsequentItem;
 
-            entry = ListGetRef(&manager->_entries, entryIndex);
+            entry = entry->next;
             subsequentItem = AttributeDictionaryFindValue(entry->attributes, attributeID);
 
             /* Stop when the attribute appears */
@@ -923,8 +1437,7 @@ SB_INTERNAL SBBoolean AttributeManagerGetOnwardRunByFilteringID(AttributeManager
                 break;
             }
 
-            *runStart = GetAttributeEntryEndIndex(manager, entryIndex);
-            entryIndex += 1;
+            *runStart += entry->length;
         }
     }
 
@@ -940,7 +1453,7 @@ SB_INTERNAL SBBoolean AttributeManagerGetOnwardRunByFilteringCollection(Attribut
     SBAttributeScope filterScope, SBAttributeGroup filterGroup, AttributeDictionaryRef output)
 {
     SBAttributeRegistryRef registry = manager->_registry;
-    SBUInteger entryIndex;
+    AttributeDictionaryRef initialAttributes;
     const AttributeEntry *entry;
 
     /* Clear the output dictionary before populating */
@@ -952,36 +1465,34 @@ SB_INTERNAL SBBoolean AttributeManagerGetOnwardRunByFilteringCollection(Attribut
     }
 
     /* Get the first entry and filter its attributes */
-    entry = AttributeManagerFindEntry(manager, *runStart, &entryIndex, runStart);
+    entry = AttributeManagerFindEntry(manager, *runStart, NULL, runStart);
     AttributeDictionaryFilter(entry->attributes, filterScope, filterGroup, registry, output);
-
-    entryIndex += 1;
+    initialAttributes = entry->attributes;
 
     if (AttributeDictionaryIsEmpty(output)) {
         /* Iterate while no matching attributes exist */
         while (*runStart < rangeEnd) {
-            entry = ListGetRef(&manager->_entries, entryIndex);
+            entry = entry->next;
 
             /* Stop when matching attributes appear */
             if (AttributeDictionaryMatchAny(entry->attributes, filterScope, filterGroup, registry)) {
                 break;
             }
 
-            *runStart = GetAttributeEntryEndIndex(manager, entryIndex);
-            entryIndex += 1;
+            *runStart += entry->length;
         }
     } else {
         /* Iterate while the filtered attributes remain the same */
         while (*runStart < rangeEnd) {
-            entry = ListGetRef(&manager->_entries, entryIndex);
+            entry = entry->next;
 
-            /* Stop if filtered attributes change */
-            if (!AttributeDictionaryMatchAll(entry->attributes, filterScope, filterGroup, registry, output)) {
+            /* Stop if filtered attributes change, unless the dictionary is the same interned one */
+            if (entry->attributes != initialAttributes
+                && !AttributeDictionaryMatchAll(entry->attributes, filterScope, filterGroup, registry, output)) {
                 break;
             }
 
-            *runStart = GetAttributeEntryEndIndex(manager, entryIndex);
-            entryIndex += 1;
+            *runStart += entry->length;
         }
     }
 
@@ -992,4 +1503,74 @@ SB_INTERNAL SBBoolean AttributeManagerGetOnwardRunByFilteringCollection(Attribut
     return SBTrue;
 }
 
+/**
+ * Checks whether two presence masks agree on all the attributes of a filter mask.
+ */
+static SBBoolean IsFilteredPresenceEqual(const SBUInt32 *firstMask, const SBUInt32 *secondMask,
+    const SBUInt32 *filterMask, SBUInteger wordCount)
+{
+    SBUInteger wordIndex;
+
+    for (wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+        if ((firstMask[wordIndex] ^ secondMask[wordIndex]) & filterMask[wordIndex]) {
+            return SBFalse;
+        }
+    }
+
+    return SBTrue;
+}
+
+SB_INTERNAL SBBoolean AttributeManagerGetOnwardRunByFilteringMask(AttributeManagerRef manager,
+    SBUInteger *runStart, SBUInteger rangeEnd,
+    const SBUInt32 *filterMask, AttributeDictionaryRef output)
+{
+    SBAttributeRegistryRef registry = manager->_registry;
+    SBUInteger wordCount = manager->_pool._maskWordCount;
+    AttributeDictionaryRef initialAttributes;
+    const SBUInt32 *initialMask;
+    const AttributeEntry *entry;
+
+    /* Clear the output dictionary before populating */
+    AttributeDictionaryClear(output, NULL);
+
+    /* Check for the possibility of a next run first */
+    if (*runStart >= rangeEnd) {
+        return SBFalse;
+    }
+
+    /* Get the first entry and filter its attributes */
+    entry = AttributeManagerFindEntry(manager, *runStart, NULL, runStart);
+    initialAttributes = entry->attributes;
+    initialMask = GetInternedDictionary(initialAttributes)->presenceMask;
+
+    AttributeDictionaryFilterByMask(initialAttributes, filterMask, output);
+
+    /* Iterate while the filtered attributes remain the same */
+    while (*runStart < rangeEnd) {
+        entry = entry->next;
+
+        if (entry->attributes != initialAttributes) {
+            const SBUInt32 *subsequentMask = GetInternedDictionary(entry->attributes)->presenceMask;
+
+            /* Stop if any filtered attribute appears or disappears */
+            if (!IsFilteredPresenceEqual(initialMask, subsequentMask, filterMask, wordCount)) {
+                break;
+            }
+
+            /* Stop if any filtered attribute takes a different value */
+            if (!AttributeDictionaryContainsAll(entry->attributes, output, registry)) {
+                break;
+            }
+        }
+
+        *runStart += entry->length;
+    }
+
+    if (*runStart > rangeEnd) {
+        *runStart = rangeEnd;
+    }
+
+    return SBTrue;
+}
+
 #endif
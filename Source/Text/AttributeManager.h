@@ -25,36 +25,52 @@
 #include <SheenBidi/SBAttributeRegistry.h>
 #include <SheenBidi/SBText.h>
 
-#include <Core/List.h>
 #include <Text/AttributeDictionary.h>
+#include <Text/AttributeEntryTree.h>
+#include <Text/EditLog.h>
 
-typedef struct _AttributeDictionaryCache {
-    LIST(AttributeDictionaryRef) _attributeDicts;
-    SBUInt8 _valueSize;
-} AttributeDictionaryCache, *AttributeDictionaryCacheRef;
+/**
+ * A canonical attribute dictionary shared by all entries having the same set of attributes.
+ */
+typedef struct _InternedDictionary {
+    AttributeDictionary dictionary;         /**< The immutable attributes, MUST be first */
+    struct _InternedDictionary *next;       /**< Next dictionary in the same bucket */
+    SBUInteger hash;                        /**< Hash of the attributes */
+    SBUInteger refCount;                    /**< Number of references held by entries */
+    SBUInt32 *presenceMask;                 /**< Mask of the attributes present */
+} InternedDictionary, *InternedDictionaryRef;
 
-typedef struct _AttributeEntry {
-    SBUInteger index;
-    AttributeDictionaryRef attributes;
-} AttributeEntry;
+/**
+ * A hash table keeping a single canonical dictionary for each distinct set of attributes.
+ */
+typedef struct _AttributeDictionaryPool {
+    InternedDictionaryRef *_buckets;
+    SBUInteger _bucketCount;
+    SBUInteger _count;
+    SBUInteger _maskWordCount;
+    SBUInt8 _valueSize;
+} AttributeDictionaryPool, *AttributeDictionaryPoolRef;
 
 typedef struct _AttributeManager {
     SBTextRef parent;
     SBAttributeRegistryRef _registry;
     SBUInteger _stringLength;
-    AttributeDictionaryCache _cache;
+    AttributeDictionaryPool _pool;
     AttributeDictionary _tempDict;
-    LIST(AttributeEntry) _entries;
+    AttributeDictionary _workDict;
+    AttributeDictionaryRef _emptyDict;      /**< Interned empty attributes kept by the manager */
+    AttributeEntryTree _entries;
 } AttributeManager, *AttributeManagerRef;
 
 /**
  * Initializes an attribute manager.
  *
  * Prepares the attribute manager for use by initializing its internal data structures. When a
- * registry is provided, the manager allocates a dictionary cache, a temporary dictionary for
- * operations, an entries list, and inserts the first entry at index 0 with an empty attribute
- * dictionary. If registry is NULL, the manager remains uninitialized and all subsequent operations
- * become no-ops.
+ * registry is provided, the manager allocates a dictionary pool, temporary dictionaries for
+ * operations, an entries tree, and inserts the first entry at index 0 with an empty attribute
+ * dictionary. The dictionaries of entries are interned in the pool, so entries with the same
+ * attributes share a single immutable dictionary. If registry is NULL, the manager remains
+ * uninitialized and all subsequent operations become no-ops.
  *
  * @param manager
  *      The attribute manager to initialize.
@@ -63,14 +79,17 @@ typedef struct _AttributeManager {
  * @param registry
  *      The attribute registry for managing attribute retention and release. If NULL, the manager
  *      will not allocate resources and all operations will be skipped.
+ * @return
+ *      SBTrue if the manager was initialized, SBFalse if the empty attribute dictionary could not
+ *      be allocated. The manager must be finalized in either case.
  */
-SB_INTERNAL void AttributeManagerInitialize(AttributeManagerRef manager,
+SB_INTERNAL SBBoolean AttributeManagerInitialize(AttributeManagerRef manager,
     SBTextRef parent, SBAttributeRegistryRef registry);
 
 /**
  * Finalizes an attribute manager and releases all resources.
  *
- * Releases all attribute dictionaries managed by the manager, clears the dictionary cache, and
+ * Releases all attribute dictionaries managed by the manager, clears the dictionary pool, and
  * finalizes all internal data structures. After calling this function, the manager must not be used
  * until re-initialized.
  *
@@ -83,11 +102,11 @@ SB_INTERNAL void AttributeManagerFinalize(AttributeManagerRef manager);
 /**
  * Copies all attributes from a source attribute manager to this manager.
  *
- * Creates deep copies of all attribute dictionaries from the source manager, preserving both the
- * entry indices and the attribute values. The process first removes and caches all existing entries
- * in the destination manager, reserves space for entries from the source, then iterates through
- * each source entry, copying its index and deep-copying its attribute dictionary (which retains all
- * attribute values through the registry).
+ * Copies all attribute dictionaries from the source manager, preserving both the entry ranges and
+ * the attribute values. The process first removes and releases all existing entries in the
+ * destination manager, then iterates through each source entry, appending an entry of the same
+ * length with an interned copy of its attribute dictionary (which retains all attribute values
+ * through the registry).
  *
  * @param manager
  *      The attribute manager to copy attributes into.
@@ -100,31 +119,37 @@ SB_INTERNAL void AttributeManagerFinalize(AttributeManagerRef manager);
  * @note
  *      All existing entries and attributes in the destination manager are replaced, not appended
  *      to. The code unit count is also synchronized from the source.
+ * @return
+ *      SBTrue if all attributes were copied, SBFalse if an attribute dictionary could not be
+ *      allocated, in which case the manager only holds the entries copied so far and must be
+ *      finalized.
  */
-SB_INTERNAL void AttributeManagerCopyAttributes(AttributeManagerRef manager,
+SB_INTERNAL SBBoolean AttributeManagerCopyAttributes(AttributeManagerRef manager,
     const AttributeManager *source);
 
 /**
  * Finds the attribute entry containing a specific code unit index.
  *
- * Performs a binary search through the entries list to locate the entry that covers the given code
- * unit index. Each entry covers a range from its index to the start of the next entry (or to the
- * total code unit count for the last entry). Returns the entry reference and optionally sets the
- * entry index.
+ * Descends the entries tree to locate the entry that covers the given code unit index in O(log n)
+ * time. Each entry covers a range of its own length, starting where the previous entry ends.
+ * Returns the entry reference and optionally sets the boundaries of the entry.
  *
  * @param manager
  *      The attribute manager to search.
  * @param stringIndex
  *      The code unit index to find.
- * @param[out] entryIndex
- *      Optional pointer to receive the index of the found entry in the entries list.
- *      If NULL, the entry index is not returned.
+ * @param[out] entryStart
+ *      Optional pointer to receive the index of the first code unit covered by the found entry.
+ *      If NULL, the entry start is not returned.
+ * @param[out] entryEnd
+ *      Optional pointer to receive the index after the last code unit covered by the found entry.
+ *      If NULL, the entry end is not returned.
  * @return
  *      Pointer to the attribute entry containing the code unit, or NULL if not found.
  *      In practice, should always return a valid entry if the index is within valid bounds.
  */
-SB_INTERNAL AttributeEntry *AttributeManagerFindEntry(AttributeManagerRef manager,
-    SBUInteger stringIndex, SBUInteger *entryIndex, SBUInteger *entryEnd);
+SB_INTERNAL AttributeEntryRef AttributeManagerFindEntry(AttributeManagerRef manager,
+    SBUInteger stringIndex, SBUInteger *entryStart, SBUInteger *entryEnd);
 
 /**
  * Replaces a range of text and adjusts attribute entries accordingly.
@@ -146,6 +171,21 @@ SB_INTERNAL AttributeEntry *AttributeManagerFindEntry(AttributeManagerRef manage
 SB_INTERNAL void AttributeManagerReplaceRange(AttributeManagerRef manager,
     SBUInteger replaceStart, SBUInteger oldLength, SBUInteger newLength);
 
+/**
+ * Applies all the edits of an editing session at once and adjusts attribute entries accordingly.
+ *
+ * The entries are rebuilt from the pieces of the log, where the inserted code units take the
+ * attributes of their recorded source, the same as if the edits were applied one by one. Paragraph
+ * merges are only handled afterwards, so the paragraphs of the text must already reflect the final
+ * code units.
+ *
+ * @param manager
+ *      The attribute manager to modify.
+ * @param log
+ *      The edit log whose regions have been collected.
+ */
+SB_INTERNAL void AttributeManagerReplaceRegions(AttributeManagerRef manager, const EditLog *log);
+
 #define AttributeManagerReserveRange(manager, index, length) \
     AttributeManagerReplaceRange(manager, index, 0, length)
 
@@ -201,6 +241,26 @@ SB_INTERNAL void AttributeManagerSetAttribute(AttributeManagerRef manager,
 SB_INTERNAL void AttributeManagerRemoveAttribute(AttributeManagerRef manager,
     SBUInteger index, SBUInteger length, SBAttributeID attributeID);
 
+/**
+ * Sets the attributes of a list of spans sorted by their start index.
+ *
+ * The result is the same as setting the attribute of each span in order. Character-scoped spans are
+ * merged into the entries in a single sweep over the entries and the spans, producing coalesced
+ * interned dictionaries and rebuilding the entries in O(spans + entries) time, whereas
+ * paragraph-scoped spans are expanded to whole paragraphs and applied individually. Unregistered
+ * attributes and empty spans are skipped.
+ *
+ * @param manager
+ *      The attribute manager to modify. If manager has no registry, this function returns
+ *      immediately without performing any operations.
+ * @param spans
+ *      The spans sorted by their start index, each lying within the text bounds.
+ * @param count
+ *      The number of spans.
+ */
+SB_INTERNAL void AttributeManagerApplyAttributeSpans(AttributeManagerRef manager,
+    const SBAttributeSpan *spans, SBUInteger count);
+
 /**
  * Retrieves the next contiguous run with uniform value for a specific attribute.
  *
@@ -273,6 +333,36 @@ SB_INTERNAL SBBoolean AttributeManagerGetOnwardRunByFilteringCollection(Attribut
     SBUInteger *runStart, SBUInteger rangeEnd,
     SBAttributeScope filterScope, SBAttributeGroup filterGroup, AttributeDictionaryRef output);
 
+/**
+ * Retrieves the next contiguous run with uniform values for a set of attributes.
+ *
+ * Finds the next "run" starting from runStart, where a run is a maximal contiguous range of code
+ * units in which none of the attributes of the filter mask changes, either by appearing,
+ * disappearing or taking a different value.
+ * Each interned dictionary carries a precomputed mask of its attributes, so a change in presence
+ * is detected by masking and comparing words, and values are only compared when the presence of
+ * filtered attributes is the same and the dictionaries are not identical.
+ *
+ * @param manager
+ *      The attribute manager to query.
+ * @param[in,out] runStart
+ *      Pointer to the starting code unit index. On return, updated to the index immediately
+ *      following the end of the found run.
+ * @param rangeEnd
+ *      The exclusive upper bound for the search. The run does not include this index.
+ * @param filterMask
+ *      The mask of attributes to filter by, having a bit for each attribute of the registry.
+ * @param[out] output
+ *      Dictionary to populate with the filtered attribute items of the run; will be empty if none
+ *      of the filtered attributes is present. Always cleared at the start.
+ * @return
+ *      SBTrue if runStart < rangeEnd (a run was processed), SBFalse if runStart >= rangeEnd on
+ *      entry (no more runs available).
+ */
+SB_INTERNAL SBBoolean AttributeManagerGetOnwardRunByFilteringMask(AttributeManagerRef manager,
+    SBUInteger *runStart, SBUInteger rangeEnd,
+    const SBUInt32 *filterMask, AttributeDictionaryRef output);
+
 #endif
 
 #endif
@@ -0,0 +1,364 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <API/SBBase.h>
+
+#if SB_TEXT_API_SUPPORTED
+
+#include <stddef.h>
+#include <string.h>
+
+#include <API/SBAssert.h>
+#include <Core/List.h>
+
+#include "EditLog.h"
+
+SB_INTERNAL void EditLogInitialize(EditLogRef log, SBUInteger codeUnitSize)
+{
+    ListInitialize(&log->pieces, sizeof(EditPiece));
+    ListInitialize(&log->insertedUnits, codeUnitSize);
+    ListInitialize(&log->regions, sizeof(EditRegion));
+
+    log->_cachedIndex = 0;
+    log->_cachedStart = 0;
+    log->originalLength = 0;
+    log->length = 0;
+    log->hasEdits = SBFalse;
+}
+
+SB_INTERNAL void EditLogFinalize(EditLogRef log)
+{
+    ListFinalize(&log->pieces);
+    ListFinalize(&log->insertedUnits);
+    ListFinalize(&log->regions);
+}
+
+SB_INTERNAL void EditLogReset(EditLogRef log)
+{
+    ListRemoveAll(&log->pieces);
+    ListRemoveAll(&log->insertedUnits);
+    ListRemoveAll(&log->regions);
+
+    log->_cachedIndex = 0;
+    log->_cachedStart = 0;
+    log->originalLength = 0;
+    log->length = 0;
+    log->hasEdits = SBFalse;
+}
+
+/**
+ * Finds the piece containing the given position of the edited code units, walking from the piece
+ * found last time as consecutive edits are usually close to each other.
+ *
+ * @return
+ *      The index of the piece containing the position, or the count of pieces if the position is at
+ *      the end.
+ */
+static SBUInteger LocateEditPiece(EditLogRef log, SBUInteger position, SBUInteger *pieceStart)
+{
+    SBUInteger pieceIndex = log->_cachedIndex;
+    SBUInteger start = log->_cachedStart;
+
+    while (position < start) {
+        pieceIndex -= 1;
+        start -= ListGetRef(&log->pieces, pieceIndex)->length;
+    }
+
+    while (pieceIndex < log->pieces.count) {
+        SBUInteger length = ListGetRef(&log->pieces, pieceIndex)->length;
+
+        if (position < start + length) {
+            break;
+        }
+
+        start += length;
+        pieceIndex += 1;
+    }
+
+    log->_cachedIndex = pieceIndex;
+    log->_cachedStart = start;
+
+    *pieceStart = start;
+
+    return pieceIndex;
+}
+
+/**
+ * Makes sure that a piece starts at the given position of the edited code units, splitting the
+ * piece containing it if needed.
+ *
+ * @return
+ *      The index of the piece starting at the position, the count of pieces if the position is at
+ *      the end, or SBInvalidIndex if memory allocation failed.
+ */
+static SBUInteger SplitEditPieces(EditLogRef log, SBUInteger position)
+{
+    SBUInteger pieceStart;
+    SBUInteger pieceIndex;
+    EditPiece *piece;
+    EditPiece secondHalf;
+    SBUInteger splitLength;
+
+    pieceIndex = LocateEditPiece(log, position, &pieceStart);
+
+    if (pieceIndex == log->pieces.count || position == pieceStart) {
+        return pieceIndex;
+    }
+
+    piece = ListGetRef(&log->pieces, pieceIndex);
+    splitLength = position - pieceStart;
+
+    secondHalf = *piece;
+    secondHalf.offset += splitLength;
+    secondHalf.length -= splitLength;
+
+    if (!ListInsert(&log->pieces, pieceIndex + 1, &secondHalf)) {
+        return SBInvalidIndex;
+    }
+
+    /* The insertion may have moved the pieces */
+    piece = ListGetRef(&log->pieces, pieceIndex);
+    piece->length = splitLength;
+
+    return pieceIndex + 1;
+}
+
+/**
+ * Returns the original code unit whose attributes the code unit at the given position of the
+ * edited code units carries.
+ */
+static SBUInteger FindAttributeSource(EditLogRef log, SBUInteger position)
+{
+    SBUInteger pieceStart;
+    SBUInteger pieceIndex;
+    const EditPiece *piece;
+
+    pieceIndex = LocateEditPiece(log, position, &pieceStart);
+    piece = ListGetRef(&log->pieces, pieceIndex);
+
+    if (piece->isInserted) {
+        return piece->source;
+    }
+
+    return piece->offset + (position - pieceStart);
+}
+
+SB_INTERNAL SBBoolean EditLogRecord(EditLogRef log, SBUInteger originalLength,
+    SBUInteger index, SBUInteger oldLength, const void *codeUnitBuffer, SBUInteger newLength)
+{
+    SBUInteger source = SBInvalidIndex;
+    SBUInteger pieceCount;
+    SBUInteger firstIndex;
+    SBUInteger lastIndex;
+
+    if (!log->hasEdits) {
+        /* Start with a single piece covering the original code units */
+        if (originalLength > 0) {
+            EditPiece piece;
+
+            piece.offset = 0;
+            piece.length = originalLength;
+            piece.source = SBInvalidIndex;
+            piece.isInserted = SBFalse;
+
+            if (!ListAdd(&log->pieces, &piece)) {
+                return SBFalse;
+            }
+        }
+
+        log->originalLength = originalLength;
+        log->length = originalLength;
+        log->hasEdits = SBTrue;
+    }
+
+    SBAssert(index <= log->length && oldLength <= log->length - index);
+
+    /*
+     * Inserted code units take the attributes of the preceding code unit, while replacing ones take
+     * the attributes of the first replaced code unit, the same as in immediate editing.
+     */
+    if (newLength > 0 && log->length > 0) {
+        source = FindAttributeSource(log, (oldLength == 0 && index > 0) ? index - 1 : index);
+    }
+
+    /* Isolate the pieces covering the replaced range */
+    lastIndex = SplitEditPieces(log, index + oldLength);
+    if (lastIndex == SBInvalidIndex) {
+        return SBFalse;
+    }
+    pieceCount = log->pieces.count;
+    firstIndex = SplitEditPieces(log, index);
+    if (firstIndex == SBInvalidIndex) {
+        return SBFalse;
+    }
+    if (log->pieces.count > pieceCount) {
+        /* Splitting at the start shifted the pieces of the range end */
+        lastIndex += 1;
+    }
+
+    if (newLength > 0) {
+        SBUInteger offset = log->insertedUnits.count;
+        SBUInteger byteCount = newLength * log->insertedUnits.itemSize;
+
+        if (!ListReserveRange(&log->insertedUnits, offset, newLength)) {
+            return SBFalse;
+        }
+        memcpy(ListGetPtr(&log->insertedUnits, offset), codeUnitBuffer, byteCount);
+
+        if (firstIndex < lastIndex) {
+            /* Reuse the first replaced piece for the new code units */
+            EditPiece *piece = ListGetRef(&log->pieces, firstIndex);
+
+            piece->offset = offset;
+            piece->length = newLength;
+            piece->source = source;
+            piece->isInserted = SBTrue;
+
+            firstIndex += 1;
+        } else {
+            EditPiece piece;
+
+            piece.offset = offset;
+            piece.length = newLength;
+            piece.source = source;
+            piece.isInserted = SBTrue;
+
+            if (!ListInsert(&log->pieces, firstIndex, &piece)) {
+                return SBFalse;
+            }
+
+            firstIndex += 1;
+            lastIndex += 1;
+        }
+    }
+
+    /* Remove the pieces of the replaced range */
+    ListRemoveRange(&log->pieces, firstIndex, lastIndex - firstIndex);
+
+    /* Extend the preceding piece if the new code units continue it */
+    if (newLength > 0 && firstIndex > 1) {
+        EditPiece *previous = ListGetRef(&log->pieces, firstIndex - 2);
+        EditPiece *current = ListGetRef(&log->pieces, firstIndex - 1);
+
+        if (previous->isInserted && previous->offset + previous->length == current->offset
+            && previous->source == current->source) {
+            previous->length += current->length;
+            ListRemoveAt(&log->pieces, firstIndex - 1);
+
+            firstIndex -= 1;
+        }
+    }
+
+    /* The piece following the edit starts right after the new code units */
+    log->_cachedIndex = firstIndex;
+    log->_cachedStart = index + newLength;
+
+    log->length = log->length - oldLength + newLength;
+
+    return SBTrue;
+}
+
+SB_INTERNAL void EditLogCopyCodeUnits(EditLogRef log, const void *originalUnits, void *destination)
+{
+    SBUInteger codeUnitSize = log->insertedUnits.itemSize;
+    const SBUInt8 *original = originalUnits;
+    SBUInt8 *output = destination;
+    SBUInteger pieceIndex;
+
+    for (pieceIndex = 0; pieceIndex < log->pieces.count; pieceIndex++) {
+        const EditPiece *piece = ListGetRef(&log->pieces, pieceIndex);
+        SBUInteger byteCount = piece->length * codeUnitSize;
+        const SBUInt8 *source;
+
+        if (piece->isInserted) {
+            source = EditLogGetInsertedUnits(log, piece);
+        } else {
+            source = original + piece->offset * codeUnitSize;
+        }
+
+        memcpy(output, source, byteCount);
+        output += byteCount;
+    }
+}
+
+SB_INTERNAL SBBoolean EditLogCollectRegions(EditLogRef log)
+{
+    SBUInteger expectedOffset = 0;
+    SBUInteger newIndex = 0;
+    SBUInteger pieceIndex;
+    EditRegion region;
+    SBBoolean hasRegion = SBFalse;
+
+    ListRemoveAll(&log->regions);
+
+    for (pieceIndex = 0; pieceIndex < log->pieces.count; pieceIndex++) {
+        const EditPiece *piece = ListGetRef(&log->pieces, pieceIndex);
+
+        if (piece->isInserted) {
+            /* Inserted code units open a region or extend the current one */
+            if (!hasRegion) {
+                region.oldIndex = expectedOffset;
+                region.newIndex = newIndex;
+                region.newLength = 0;
+                hasRegion = SBTrue;
+            }
+
+            region.newLength += piece->length;
+        } else {
+            if (!hasRegion && piece->offset != expectedOffset) {
+                /* Original code units were removed before this piece */
+                region.oldIndex = expectedOffset;
+                region.newIndex = newIndex;
+                region.newLength = 0;
+                hasRegion = SBTrue;
+            }
+
+            if (hasRegion) {
+                region.oldLength = piece->offset - region.oldIndex;
+
+                if (!ListAdd(&log->regions, &region)) {
+                    return SBFalse;
+                }
+                hasRegion = SBFalse;
+            }
+
+            expectedOffset = piece->offset + piece->length;
+        }
+
+        newIndex += piece->length;
+    }
+
+    /* Close the region reaching the end of the original code units */
+    if (!hasRegion && expectedOffset != log->originalLength) {
+        region.oldIndex = expectedOffset;
+        region.newIndex = newIndex;
+        region.newLength = 0;
+        hasRegion = SBTrue;
+    }
+
+    if (hasRegion) {
+        region.oldLength = log->originalLength - region.oldIndex;
+
+        if (!ListAdd(&log->regions, &region)) {
+            return SBFalse;
+        }
+    }
+
+    return SBTrue;
+}
+
+#endif
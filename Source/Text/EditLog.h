@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _SB_INTERNAL_EDIT_LOG_H
+#define _SB_INTERNAL_EDIT_LOG_H
+
+#include <API/SBBase.h>
+
+#if SB_TEXT_API_SUPPORTED
+
+#include <Core/List.h>
+
+/**
+ * A piece of the edited code units, taken either from the original code units or from the code
+ * units inserted during the editing session.
+ */
+typedef struct _EditPiece {
+    SBUInteger offset;          /**< Offset in the original or in the inserted code units */
+    SBUInteger length;          /**< Number of code units in the piece */
+    SBUInteger source;          /**< Original code unit whose attributes the inserted code units
+                                     take, or SBInvalidIndex if the text was empty */
+    SBBoolean isInserted;       /**< Whether the piece refers to the inserted code units */
+} EditPiece;
+
+/**
+ * A maximal range of the original code units replaced by a run of new code units.
+ */
+typedef struct _EditRegion {
+    SBUInteger oldIndex;        /**< Start of the replaced range in the original code units */
+    SBUInteger oldLength;       /**< Number of original code units replaced */
+    SBUInteger newIndex;        /**< Start of the replacement in the edited code units */
+    SBUInteger newLength;       /**< Number of code units in the replacement */
+} EditRegion;
+
+/**
+ * A log of the code unit edits made during an editing session.
+ *
+ * The edited code units are described as a sequence of pieces over the original code units and an
+ * append-only buffer of inserted code units, so recording an edit never moves the text itself. The
+ * piece of an edit is located from the one found by the previous edit, so edits close to each
+ * other cost little beyond shifting the list of pieces. Once the session ends, the edits are turned
+ * into sorted regions of the original code units and applied in a single pass.
+ */
+typedef struct _EditLog {
+    LIST(EditPiece) pieces;     /**< Pieces making up the edited code units, in order */
+    List insertedUnits;         /**< Code units inserted during the session */
+    LIST(EditRegion) regions;   /**< Regions collected by EditLogCollectRegions */
+    SBUInteger _cachedIndex;
+    SBUInteger _cachedStart;
+    SBUInteger originalLength;  /**< Number of original code units */
+    SBUInteger length;          /**< Number of edited code units */
+    SBBoolean hasEdits;         /**< Whether any edit has been recorded */
+} EditLog, *EditLogRef;
+
+SB_INTERNAL void EditLogInitialize(EditLogRef log, SBUInteger codeUnitSize);
+SB_INTERNAL void EditLogFinalize(EditLogRef log);
+
+/**
+ * Discards all the recorded edits, keeping the allocated memory for the next session.
+ */
+SB_INTERNAL void EditLogReset(EditLogRef log);
+
+/**
+ * Records the replacement of a range of the edited code units.
+ *
+ * @param log
+ *      The edit log.
+ * @param originalLength
+ *      Number of original code units, only consulted for the first edit of a session.
+ * @param index
+ *      Start of the replaced range, relative to the code units produced by the previous edits.
+ * @param oldLength
+ *      Number of code units being replaced.
+ * @param codeUnitBuffer
+ *      The replacement code units.
+ * @param newLength
+ *      Number of replacement code units.
+ * @return
+ *      SBTrue if the edit was recorded, SBFalse if memory allocation failed.
+ */
+SB_INTERNAL SBBoolean EditLogRecord(EditLogRef log, SBUInteger originalLength,
+    SBUInteger index, SBUInteger oldLength, const void *codeUnitBuffer, SBUInteger newLength);
+
+/**
+ * Returns the inserted code units referred to by a piece.
+ */
+#define EditLogGetInsertedUnits(log, piece) \
+    ListGetPtr(&(log)->insertedUnits, (piece)->offset)
+
+/**
+ * Writes the edited code units into a buffer having room for `log->length` code units.
+ *
+ * @param log
+ *      The edit log.
+ * @param originalUnits
+ *      The original code units.
+ * @param destination
+ *      The buffer receiving the edited code units; must not overlap the original code units.
+ */
+SB_INTERNAL void EditLogCopyCodeUnits(EditLogRef log, const void *originalUnits, void *destination);
+
+/**
+ * Collects the recorded edits into `log->regions`, sorted by their position and with no two
+ * regions touching each other.
+ *
+ * @return
+ *      SBTrue if the regions were collected, SBFalse if memory allocation failed.
+ */
+SB_INTERNAL SBBoolean EditLogCollectRegions(EditLogRef log);
+
+#endif
+
+#endif
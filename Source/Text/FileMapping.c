@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <API/SBBase.h>
+
+#if SB_TEXT_API_SUPPORTED
+
+#include <stddef.h>
+
+#include "FileMapping.h"
+
+#ifdef HAS_FILE_MAPPING_SUPPORT
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SB_INTERNAL SBBoolean FileMappingOpen(const char *path, const void **buffer, SBUInteger *size)
+{
+#ifdef HAS_FILE_MAPPING_SUPPORT
+    SBBoolean succeeded = SBFalse;
+    int descriptor;
+
+    descriptor = open(path, O_RDONLY);
+
+    if (descriptor != -1) {
+        struct stat status;
+
+        if (fstat(descriptor, &status) == 0 && status.st_size >= 0
+                && (off_t)(SBUInteger)status.st_size == status.st_size) {
+            *size = (SBUInteger)status.st_size;
+
+            if (*size == 0) {
+                /* An empty file cannot be mapped */
+                *buffer = NULL;
+                succeeded = SBTrue;
+            } else {
+                void *address = mmap(NULL, *size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+                if (address != MAP_FAILED) {
+                    *buffer = address;
+                    succeeded = SBTrue;
+                }
+            }
+        }
+
+        /* The mapping remains valid after the file is closed */
+        close(descriptor);
+    }
+
+    return succeeded;
+#else
+    (void)path;
+    (void)buffer;
+    (void)size;
+
+    return SBFalse;
+#endif
+}
+
+SB_INTERNAL void FileMappingClose(const void *buffer, SBUInteger size)
+{
+#ifdef HAS_FILE_MAPPING_SUPPORT
+    if (buffer) {
+        munmap((void *)buffer, size);
+    }
+#else
+    (void)buffer;
+    (void)size;
+#endif
+}
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _SB_INTERNAL_FILE_MAPPING_H
+#define _SB_INTERNAL_FILE_MAPPING_H
+
+#include <API/SBBase.h>
+
+#if SB_TEXT_API_SUPPORTED
+
+/* Check for POSIX memory mapping availability */
+#if defined(__unix__) || defined(__unix) || defined(unix) \
+        || (defined(__APPLE__) && defined(__MACH__)) || defined(__linux__)
+#define HAS_FILE_MAPPING_SUPPORT
+#endif
+
+/**
+ * Maps the contents of a file into memory for reading.
+ *
+ * @param path
+ *      The path of the file to map.
+ * @param buffer
+ *      A pointer to receive the address of the mapped contents, or `NULL` for an empty file.
+ * @param size
+ *      A pointer to receive the size of the file in bytes.
+ * @return
+ *      `SBTrue` if the file has been mapped, `SBFalse` if it could not be opened or mapping is not
+ *      supported on the platform.
+ */
+SB_INTERNAL SBBoolean FileMappingOpen(const char *path, const void **buffer, SBUInteger *size);
+
+/**
+ * Unmaps the contents of a file previously mapped with `FileMappingOpen`.
+ */
+SB_INTERNAL void FileMappingClose(const void *buffer, SBUInteger size);
+
+#endif
+
+#endif
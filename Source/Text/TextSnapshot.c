@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <API/SBBase.h>
+
+#if SB_TEXT_API_SUPPORTED
+
+#include <stddef.h>
+#include <string.h>
+
+#include "TextSnapshot.h"
+
+#define FNVOffsetBasis  ((SBUInt64)0xCBF29CE4 << 32 | 0x84222325)
+#define FNVPrime        ((SBUInt64)0x00000100 << 32 | 0x000001B3)
+
+SB_INTERNAL void TextSnapshotWriterInitialize(TextSnapshotWriterRef writer,
+    void *buffer, SBUInteger capacity)
+{
+    writer->_buffer = buffer;
+    writer->_capacity = (buffer ? capacity : 0);
+    writer->size = 0;
+}
+
+SB_INTERNAL void TextSnapshotWriteBytes(TextSnapshotWriterRef writer,
+    const void *bytes, SBUInteger count)
+{
+    if (count == 0) {
+        return;
+    }
+
+    if (writer->_buffer && writer->size <= writer->_capacity
+            && count <= writer->_capacity - writer->size) {
+        memcpy(writer->_buffer + writer->size, bytes, count);
+    }
+
+    writer->size += count;
+}
+
+SB_INTERNAL void TextSnapshotWriteUInt8(TextSnapshotWriterRef writer, SBUInt8 value)
+{
+    TextSnapshotWriteBytes(writer, &value, sizeof(value));
+}
+
+SB_INTERNAL void TextSnapshotWriteUInt32(TextSnapshotWriterRef writer, SBUInt32 value)
+{
+    TextSnapshotWriteBytes(writer, &value, sizeof(value));
+}
+
+SB_INTERNAL void TextSnapshotWriteUInt64(TextSnapshotWriterRef writer, SBUInt64 value)
+{
+    TextSnapshotWriteBytes(writer, &value, sizeof(value));
+}
+
+SB_INTERNAL void TextSnapshotReaderInitialize(TextSnapshotReaderRef reader,
+    const void *buffer, SBUInteger size)
+{
+    reader->_buffer = buffer;
+    reader->_size = (buffer ? size : 0);
+    reader->offset = 0;
+    reader->isValid = SBTrue;
+}
+
+SB_INTERNAL const void *TextSnapshotReadBytes(TextSnapshotReaderRef reader, SBUInteger count)
+{
+    const void *bytes = NULL;
+
+    if (reader->isValid && count <= reader->_size - reader->offset) {
+        bytes = reader->_buffer + reader->offset;
+        reader->offset += count;
+    } else {
+        reader->isValid = SBFalse;
+    }
+
+    return bytes;
+}
+
+SB_INTERNAL SBUInt8 TextSnapshotReadUInt8(TextSnapshotReaderRef reader)
+{
+    const void *bytes = TextSnapshotReadBytes(reader, sizeof(SBUInt8));
+    SBUInt8 value = 0;
+
+    if (bytes) {
+        memcpy(&value, bytes, sizeof(value));
+    }
+
+    return value;
+}
+
+SB_INTERNAL SBUInt32 TextSnapshotReadUInt32(TextSnapshotReaderRef reader)
+{
+    const void *bytes = TextSnapshotReadBytes(reader, sizeof(SBUInt32));
+    SBUInt32 value = 0;
+
+    if (bytes) {
+        /* The fields are not aligned within the snapshot */
+        memcpy(&value, bytes, sizeof(value));
+    }
+
+    return value;
+}
+
+SB_INTERNAL SBUInt64 TextSnapshotReadUInt64(TextSnapshotReaderRef reader)
+{
+    const void *bytes = TextSnapshotReadBytes(reader, sizeof(SBUInt64));
+    SBUInt64 value = 0;
+
+    if (bytes) {
+        memcpy(&value, bytes, sizeof(value));
+    }
+
+    return value;
+}
+
+SB_INTERNAL SBUInt64 TextSnapshotHashBytes(const void *bytes, SBUInteger count)
+{
+    const SBUInt8 *data = bytes;
+    SBUInt64 hash = FNVOffsetBasis;
+    SBUInteger index;
+
+    for (index = 0; index < count; index++) {
+        hash ^= data[index];
+        hash *= FNVPrime;
+    }
+
+    return hash;
+}
+
+#undef FNVOffsetBasis
+#undef FNVPrime
+
+#endif
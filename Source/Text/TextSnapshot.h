@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _SB_INTERNAL_TEXT_SNAPSHOT_H
+#define _SB_INTERNAL_TEXT_SNAPSHOT_H
+
+#include <SheenBidi/SBVersion.h>
+
+#include <API/SBBase.h>
+
+#if SB_TEXT_API_SUPPORTED
+
+/**
+ * Identifies a text snapshot, also revealing a snapshot written with a different byte order.
+ */
+#define TextSnapshotMagic           0x53425453
+
+/**
+ * Version of the snapshot layout, to be incremented whenever the layout changes.
+ */
+#define TextSnapshotFormatVersion   2
+
+/**
+ * Version of the Unicode data the snapshot depends on.
+ */
+#define TextSnapshotUnicodeVersion                      \
+(                                                       \
+   ((SBUInt32)SHEENBIDI_UNICODE_VERSION_MAJOR << 16)    \
+ | ((SBUInt32)SHEENBIDI_UNICODE_VERSION_MINOR << 8)     \
+ | ((SBUInt32)SHEENBIDI_UNICODE_VERSION_PATCH)          \
+)
+
+/**
+ * Writes the fields of a snapshot in native byte order. Without a buffer, or once the capacity is
+ * exceeded, the writer only measures the size of the snapshot.
+ */
+typedef struct _TextSnapshotWriter {
+    SBUInt8 *_buffer;
+    SBUInteger _capacity;
+    SBUInteger size;            /**< Number of bytes in the snapshot so far */
+} TextSnapshotWriter, *TextSnapshotWriterRef;
+
+/**
+ * Reads the fields of a snapshot, failing as soon as a field lies beyond its end.
+ */
+typedef struct _TextSnapshotReader {
+    const SBUInt8 *_buffer;
+    SBUInteger _size;
+    SBUInteger offset;          /**< Number of bytes read so far */
+    SBBoolean isValid;          /**< Whether all reads have been within the snapshot */
+} TextSnapshotReader, *TextSnapshotReaderRef;
+
+SB_INTERNAL void TextSnapshotWriterInitialize(TextSnapshotWriterRef writer,
+    void *buffer, SBUInteger capacity);
+
+SB_INTERNAL void TextSnapshotWriteBytes(TextSnapshotWriterRef writer,
+    const void *bytes, SBUInteger count);
+
+SB_INTERNAL void TextSnapshotWriteUInt8(TextSnapshotWriterRef writer, SBUInt8 value);
+
+SB_INTERNAL void TextSnapshotWriteUInt32(TextSnapshotWriterRef writer, SBUInt32 value);
+
+SB_INTERNAL void TextSnapshotWriteUInt64(TextSnapshotWriterRef writer, SBUInt64 value);
+
+SB_INTERNAL void TextSnapshotReaderInitialize(TextSnapshotReaderRef reader,
+    const void *buffer, SBUInteger size);
+
+/**
+ * Returns a pointer to the next bytes of the snapshot, or `NULL` if they lie beyond its end.
+ */
+SB_INTERNAL const void *TextSnapshotReadBytes(TextSnapshotReaderRef reader, SBUInteger count);
+
+SB_INTERNAL SBUInt8 TextSnapshotReadUInt8(TextSnapshotReaderRef reader);
+
+SB_INTERNAL SBUInt32 TextSnapshotReadUInt32(TextSnapshotReaderRef reader);
+
+SB_INTERNAL SBUInt64 TextSnapshotReadUInt64(TextSnapshotReaderRef reader);
+
+/**
+ * Computes the 64-bit FNV-1a hash of the code units a snapshot belongs to, which also serves as
+ * the checksum of the snapshot payload.
+ */
+SB_INTERNAL SBUInt64 TextSnapshotHashBytes(const void *bytes, SBUInteger count);
+
+#endif
+
+#endif
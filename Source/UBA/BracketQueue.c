@@ -19,6 +19,7 @@
 #include <API/SBAssert.h>
 #include <API/SBBase.h>
 #include <API/SBCodepoint.h>
+#include <API/SBStatistics.h>
 #include <Core/Memory.h>
 #include <UBA/BidiChain.h>
 
@@ -68,6 +69,8 @@ static BracketQueueElement *InsertBracketQueueElement(BracketQueueRef queue)
                 rearList->next = NULL;
 
                 previousList->next = rearList;
+
+                SB_STATISTICS_INCREMENT(StatisticBracketQueueChunks);
             }
         }
 
@@ -18,6 +18,8 @@
 #include <API/SBBase.h>
 #include <API/SBCodepoint.h>
 #include <API/SBLog.h>
+#include <API/SBStatistics.h>
+#include <API/SBTrace.h>
 #include <Data/PairingLookup.h>
 #include <UBA/BidiChain.h>
 #include <UBA/BracketQueue.h>
@@ -245,6 +247,7 @@ static SBBoolean ResolveBrackets(IsolatingRunRef isolatingRun)
             switch (bracketType) {
             case BracketTypeOpen:
                 if (BracketQueueGetOpenPairCount(queue) >= BracketQueueMaxOpenPairs) {
+                    SB_STATISTICS_INCREMENT(StatisticBracketLimitHits);
                     /* Stop further processing. */
                     return SBTrue;
                 }
@@ -462,6 +465,23 @@ static void ResolveImplicitLevels(IsolatingRunRef isolatingRun)
     }
 }
 
+/**
+ * Counts the code units covered by the level runs of the isolating run.
+ */
+static SBUInteger CountCodeUnits(IsolatingRunRef isolatingRun)
+{
+    const LevelRun *levelRun = isolatingRun->baseLevelRun;
+    SBUInteger codeUnitCount = 0;
+
+    while (levelRun) {
+        codeUnitCount += BidiChainGetOffset(isolatingRun->bidiChain, levelRun->subsequentLink)
+                       - BidiChainGetOffset(isolatingRun->bidiChain, levelRun->firstLink);
+        levelRun = levelRun->next;
+    }
+
+    return codeUnitCount;
+}
+
 SB_INTERNAL void IsolatingRunInitialize(IsolatingRunRef isolatingRun, MemoryRef memory)
 {
     BracketQueueInitialize(&isolatingRun->_bracketQueue, memory);
@@ -469,9 +489,20 @@ SB_INTERNAL void IsolatingRunInitialize(IsolatingRunRef isolatingRun, MemoryRef
 
 SB_INTERNAL SBBoolean IsolatingRunResolve(IsolatingRunRef isolatingRun)
 {
+    SBUInteger codeUnitCount = 0;
     BidiLink lastLink;
     BidiLink subsequentLink;
 
+    /* Walking the level runs is only worth it when the count is charged or reported. */
+    if (ResolutionBudgetIsLimited(isolatingRun->budget) || SB_TRACE_IS_ACTIVE()) {
+        codeUnitCount = CountCodeUnits(isolatingRun);
+    }
+
+    if (!ResolutionBudgetSpend(isolatingRun->budget, codeUnitCount)) {
+        return SBFalse;
+    }
+
+    SB_TRACE_BEGIN(SBTraceStageIsolatingRun, codeUnitCount);
     SB_LOG_BLOCK_OPENER("Identified Isolating Run");
 
     /* Attach level run links to form isolating run. */
@@ -493,6 +524,7 @@ SB_INTERNAL SBBoolean IsolatingRunResolve(IsolatingRunRef isolatingRun)
 
     /* Rule N0 */
     if (!ResolveBrackets(isolatingRun)) {
+        SB_TRACE_END(SBTraceStageIsolatingRun, codeUnitCount);
         return SBFalse;
     }
 
@@ -518,6 +550,7 @@ SB_INTERNAL SBBoolean IsolatingRunResolve(IsolatingRunRef isolatingRun)
     BidiChainSetNext(isolatingRun->bidiChain, lastLink, subsequentLink);
 
     SB_LOG_BLOCK_CLOSER();
+    SB_TRACE_END(SBTraceStageIsolatingRun, codeUnitCount);
 
     return SBTrue;
 }
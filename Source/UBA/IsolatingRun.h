@@ -23,6 +23,7 @@
 #include <UBA/BidiChain.h>
 #include <UBA/BracketQueue.h>
 #include <UBA/LevelRun.h>
+#include <UBA/ResolutionBudget.h>
 
 typedef struct _IsolatingRun {
     const SBCodepointSequence *codepointSequence;
@@ -30,6 +31,7 @@ typedef struct _IsolatingRun {
     BidiChainRef bidiChain;
     const LevelRun *baseLevelRun;
     const LevelRun *_lastLevelRun;
+    ResolutionBudgetRef budget;
     BracketQueue _bracketQueue;
     SBUInteger paragraphOffset;
     BidiLink _originalLink;
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stddef.h>
+
+#include <API/SBBase.h>
+
+#include "ResolutionBudget.h"
+
+SB_INTERNAL void ResolutionBudgetInitialize(ResolutionBudgetRef budget,
+    const SBParagraphLimits *limits)
+{
+    budget->shouldCancel = NULL;
+    budget->info = NULL;
+    budget->remainingUnits = (SBUInteger)-1;
+    budget->unitsToPoll = SB_CONFIG_RESOLUTION_POLL_INTERVAL;
+    budget->isLimited = SBFalse;
+    budget->isExhausted = SBFalse;
+
+    if (limits) {
+        budget->shouldCancel = limits->shouldCancel;
+        budget->info = limits->info;
+
+        if (limits->maxWorkUnits > 0) {
+            budget->remainingUnits = limits->maxWorkUnits;
+            budget->isLimited = SBTrue;
+        }
+
+        if (limits->shouldCancel) {
+            budget->isLimited = SBTrue;
+        }
+    }
+}
+
+SB_INTERNAL SBBoolean ResolutionBudgetSpend(ResolutionBudgetRef budget, SBUInteger units)
+{
+    if (budget->isExhausted) {
+        return SBFalse;
+    }
+
+    if (units > budget->remainingUnits) {
+        budget->isExhausted = SBTrue;
+        return SBFalse;
+    }
+
+    budget->remainingUnits -= units;
+
+    if (budget->shouldCancel) {
+        if (units < budget->unitsToPoll) {
+            budget->unitsToPoll -= units;
+        } else {
+            budget->unitsToPoll = SB_CONFIG_RESOLUTION_POLL_INTERVAL;
+
+            if (budget->shouldCancel(budget->info)) {
+                budget->isExhausted = SBTrue;
+                return SBFalse;
+            }
+        }
+    }
+
+    return SBTrue;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _SB_INTERNAL_RESOLUTION_BUDGET_H
+#define _SB_INTERNAL_RESOLUTION_BUDGET_H
+
+#include <SheenBidi/SBAlgorithm.h>
+
+#include <API/SBBase.h>
+
+typedef struct _ResolutionBudget {
+    SBAlgorithmCancelFunc shouldCancel; /**< Function polled for cancellation, if any */
+    void *info;                         /**< Context pointer passed to the cancellation function */
+    SBUInteger remainingUnits;          /**< Work units left before the budget runs out */
+    SBUInteger unitsToPoll;             /**< Work units left before the next poll */
+    SBBoolean isLimited;                /**< Whether spending can exhaust the budget */
+    SBBoolean isExhausted;              /**< Whether a limit has been hit */
+} ResolutionBudget, *ResolutionBudgetRef;
+
+/**
+ * Tells whether the spent work units need to be counted, which is not the case for a budget
+ * without any limit or cancellation function.
+ */
+#define ResolutionBudgetIsLimited(budget)   ((budget)->isLimited)
+
+/**
+ * Initializes the budget with the given limits, which can be NULL for an unlimited budget.
+ */
+SB_INTERNAL void ResolutionBudgetInitialize(ResolutionBudgetRef budget,
+    const SBParagraphLimits *limits);
+
+/**
+ * Spends the given number of work units, polling the cancellation function when due.
+ *
+ * @return
+ *      `SBTrue` if the resolution may continue, `SBFalse` if the budget is exhausted.
+ */
+SB_INTERNAL SBBoolean ResolutionBudgetSpend(ResolutionBudgetRef budget, SBUInteger units);
+
+#endif
@@ -18,6 +18,7 @@
 
 #include <API/SBAssert.h>
 #include <API/SBBase.h>
+#include <API/SBStatistics.h>
 #include <Core/Memory.h>
 #include <UBA/LevelRun.h>
 #include <UBA/RunKind.h>
@@ -48,6 +49,8 @@ static RunQueueListRef AllocateRunQueueListPool(RunQueueRef queue)
         RunQueueListRef current;
         SBUInteger index;
 
+        SB_STATISTICS_ADD(StatisticRunQueueChunks, listCount);
+
         /* First element. */
         current = &pool[0];
         current->previous = NULL;
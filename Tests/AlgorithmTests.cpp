@@ -14,9 +14,11 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <string>
@@ -504,7 +506,18 @@ void AlgorithmTests::run()
 {
     testBidiTypes();
     testParagraphBoundary();
+    testMultipleParagraphBoundaries();
     testParagraphCreation();
+    testParagraphLimits();
+    testLineCreation();
+    testLineMaps();
+    testRunsInEncoding();
+    testVisualSegments();
+    testCaretMovement();
+    testLineReordering();
+    testVisualCodeUnits();
+    testMirrorLocator();
+    testRunReordering();
     testBidiAlgorithm();
 }
 
@@ -636,6 +649,57 @@ void AlgorithmTests::testParagraphBoundary() {
     cout << endl;
 }
 
+void AlgorithmTests::testMultipleParagraphBoundaries() {
+    cout << "Running multiple paragraph boundary tests." << endl;
+
+    u16string text = u"a\r\nbc\n\r\u2029de\r";
+    const vector<SBUInteger> lengths = { 3, 3, 1, 1, 3 };
+    const vector<SBUInteger> separators = { 2, 1, 1, 1, 1 };
+
+    SBCodepointSequence sequence;
+    sequence.stringEncoding = SBStringEncodingUTF16;
+    sequence.stringBuffer = text.data();
+    sequence.stringLength = text.length();
+
+    auto algorithm = SBAlgorithmCreate(&sequence);
+    assert(algorithm != nullptr);
+
+    // Enumerate all paragraphs
+    SBUInteger offset = 0;
+    size_t index = 0;
+
+    while (offset < text.length()) {
+        SBUInteger actualLength;
+        SBUInteger separatorLength;
+
+        SBAlgorithmGetParagraphBoundary(algorithm, offset, UINTPTR_MAX,
+            &actualLength, &separatorLength);
+        assert(index < lengths.size());
+        assert(actualLength == lengths[index]);
+        assert(separatorLength == separators[index]);
+
+        offset += actualLength;
+        index += 1;
+    }
+    assert(index == lengths.size());
+
+    SBUInteger actualLength;
+    SBUInteger separatorLength;
+
+    // A suggested length ending before the separator must be respected
+    SBAlgorithmGetParagraphBoundary(algorithm, 3, 2, &actualLength, &separatorLength);
+    assert(actualLength == 2 && separatorLength == 0);
+
+    // A separator at the last suggested code unit must be included along with LF of CRLF
+    SBAlgorithmGetParagraphBoundary(algorithm, 0, 2, &actualLength, &separatorLength);
+    assert(actualLength == 3 && separatorLength == 2);
+
+    SBAlgorithmRelease(algorithm);
+
+    cout << "Passed." << endl;
+    cout << endl;
+}
+
 void AlgorithmTests::testParagraphCreation() {
     cout << "Running paragraph creation tests." << endl;
 
@@ -704,6 +768,855 @@ void AlgorithmTests::testParagraphCreation() {
     cout << endl;
 }
 
+void AlgorithmTests::testParagraphLimits() {
+    cout << "Running paragraph limit tests." << endl;
+
+    /* Deeply nested first strong isolates followed by mixed content. */
+    u16string text;
+    for (int i = 0; i < 2000; i++) {
+        text += u"\u2068(";
+    }
+    text += u"\u05D0 ab 12 [\u05D1]";
+    for (int i = 0; i < 2000; i++) {
+        text += u"\u2069";
+    }
+
+    SBCodepointSequence sequence;
+    sequence.stringEncoding = SBStringEncodingUTF16;
+    sequence.stringBuffer = text.data();
+    sequence.stringLength = text.length();
+
+    auto algorithm = SBAlgorithmCreate(&sequence);
+    auto length = text.length();
+
+    auto isDegradedTo = [&](SBParagraphRef paragraph, SBLevel level) {
+        auto levels = SBParagraphGetLevelsPtr(paragraph);
+
+        if (!SBParagraphIsDegraded(paragraph) || SBParagraphGetBaseLevel(paragraph) != level) {
+            return false;
+        }
+        for (SBUInteger i = 0; i < length; i++) {
+            if (levels[i] != level) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    /* Without any limit, the paragraph is resolved normally. */
+    SBParagraphLimits limits = { 0, 0, nullptr, nullptr, SBFalse };
+    auto expected = SBAlgorithmCreateParagraph(algorithm, 0, length, SBLevelDefaultRTL);
+    auto paragraph = SBAlgorithmCreateParagraphWithLimits(algorithm, 0, length, SBLevelDefaultRTL, &limits);
+    assert(paragraph != nullptr && !SBParagraphIsDegraded(paragraph));
+    assert(memcmp(SBParagraphGetLevelsPtr(paragraph), SBParagraphGetLevelsPtr(expected), length) == 0);
+    SBParagraphRelease(paragraph);
+    SBParagraphRelease(expected);
+
+    /* Maximum length. */
+    limits.maxLength = length - 1;
+    assert(SBAlgorithmCreateParagraphWithLimits(algorithm, 0, length, SBLevelDefaultLTR, &limits) == nullptr);
+
+    limits.fallback = SBTrue;
+    paragraph = SBAlgorithmCreateParagraphWithLimits(algorithm, 0, length, SBLevelDefaultLTR, &limits);
+    assert(paragraph != nullptr && isDegradedTo(paragraph, 0));
+    SBParagraphRelease(paragraph);
+
+    limits.maxLength = length;
+    paragraph = SBAlgorithmCreateParagraphWithLimits(algorithm, 0, length, SBLevelDefaultLTR, &limits);
+    assert(paragraph != nullptr && !SBParagraphIsDegraded(paragraph));
+    SBParagraphRelease(paragraph);
+
+    /* Maximum work units, exceeded by the scans of nested isolates. */
+    limits.maxLength = 0;
+    limits.maxWorkUnits = length * 4;
+    limits.fallback = SBFalse;
+    assert(SBAlgorithmCreateParagraphWithLimits(algorithm, 0, length, 1, &limits) == nullptr);
+
+    limits.fallback = SBTrue;
+    paragraph = SBAlgorithmCreateParagraphWithLimits(algorithm, 0, length, 1, &limits);
+    assert(paragraph != nullptr && isDegradedTo(paragraph, 1));
+
+    /* Lines of a degraded paragraph have a single run. */
+    auto line = SBParagraphCreateLine(paragraph, 0, length);
+    assert(SBLineGetRunCount(line) == 1);
+    SBLineRelease(line);
+    SBParagraphRelease(paragraph);
+
+    /* Cancellation after a few polls. */
+    struct Countdown {
+        int polls;
+
+        static SBBoolean shouldCancel(void *info) {
+            auto countdown = static_cast<Countdown *>(info);
+            return (--countdown->polls == 0);
+        }
+    } countdown = { 3 };
+
+    limits.maxWorkUnits = 0;
+    limits.shouldCancel = Countdown::shouldCancel;
+    limits.info = &countdown;
+    paragraph = SBAlgorithmCreateParagraphWithLimits(algorithm, 0, length, SBLevelDefaultLTR, &limits);
+    assert(countdown.polls == 0);
+    assert(paragraph != nullptr && isDegradedTo(paragraph, 0));
+    SBParagraphRelease(paragraph);
+
+    /* A cancellation function that never cancels does not change the result. */
+    countdown.polls = -1;
+    paragraph = SBAlgorithmCreateParagraphWithLimits(algorithm, 0, length, SBLevelDefaultLTR, &limits);
+    assert(countdown.polls < -1);
+    assert(paragraph != nullptr && !SBParagraphIsDegraded(paragraph));
+    SBParagraphRelease(paragraph);
+
+    SBAlgorithmRelease(algorithm);
+
+    cout << "Passed." << endl;
+    cout << endl;
+}
+
+void AlgorithmTests::testLineCreation() {
+    cout << "Running line creation tests." << endl;
+
+    /* Mixed directions with whitespace and segment separators at line ends. */
+    u16string text = u"abc \u05D0\u05D1 12\t\u05D2 def \u2067\u05D3\u2069 \u05D4 ghi  ";
+
+    SBCodepointSequence sequence;
+    sequence.stringEncoding = SBStringEncodingUTF16;
+    sequence.stringBuffer = text.data();
+    sequence.stringLength = text.length();
+
+    auto algorithm = SBAlgorithmCreate(&sequence);
+    auto paragraph = SBAlgorithmCreateParagraph(algorithm, 0, text.length(), SBLevelDefaultRTL);
+    assert(paragraph != nullptr);
+
+    auto test = [&](const vector<SBUInteger> &boundaries) {
+        SBUInteger lineCount = boundaries.size() - 1;
+        vector<SBLineRef> lines(lineCount);
+
+        assert(SBParagraphCreateLines(paragraph, boundaries.data(), lineCount, lines.data()));
+
+        for (SBUInteger i = 0; i < lineCount; i++) {
+            auto expected = SBParagraphCreateLine(paragraph, boundaries[i], boundaries[i + 1] - boundaries[i]);
+            auto runCount = SBLineGetRunCount(lines[i]);
+
+            assert(SBLineGetOffset(lines[i]) == SBLineGetOffset(expected));
+            assert(SBLineGetLength(lines[i]) == SBLineGetLength(expected));
+            assert(runCount == SBLineGetRunCount(expected));
+            assert(equal(SBLineGetRunsPtr(lines[i]), SBLineGetRunsPtr(lines[i]) + runCount,
+                         SBLineGetRunsPtr(expected), [](const SBRun &a, const SBRun &b) {
+                return a.offset == b.offset && a.length == b.length && a.level == b.level;
+            }));
+
+            SBLineRelease(expected);
+            SBLineRelease(lines[i]);
+        }
+    };
+
+    SBUInteger length = text.length();
+
+    test({0, length});
+    test({0, 4, 7, 10, length});
+    test({2, 11, 12, length - 1});
+
+    for (SBUInteger step = 1; step < length; step++) {
+        vector<SBUInteger> boundaries;
+
+        for (SBUInteger offset = 0; offset < length; offset += step) {
+            boundaries.push_back(offset);
+        }
+        boundaries.push_back(length);
+
+        test(boundaries);
+    }
+
+    /* Lines of a batch must stay valid regardless of the order of their release. */
+    {
+        const SBUInteger boundaries[] = { 0, 4, 7, 10, length };
+        SBLineRef lines[4];
+
+        assert(SBParagraphCreateLines(paragraph, boundaries, 4, lines));
+
+        auto retained = SBLineRetain(lines[1]);
+        auto runCount = SBLineGetRunCount(retained);
+
+        for (SBUInteger i = 4; i > 0; i--) {
+            SBLineRelease(lines[i - 1]);
+        }
+
+        assert(SBLineGetOffset(retained) == 4);
+        assert(SBLineGetRunsPtr(retained)[runCount - 1].length > 0);
+        assert(SBLineGetVisualToLogicalMapPtr(retained) != nullptr);
+
+        SBLineRelease(retained);
+    }
+
+    /* Invalid boundaries must be rejected. */
+    const SBUInteger empty[] = { 4, 4, 8 };
+    const SBUInteger outside[] = { 0, length + 1 };
+    SBLineRef lines[2] = { nullptr, nullptr };
+
+    assert(!SBParagraphCreateLines(paragraph, empty, 2, lines));
+    assert(!SBParagraphCreateLines(paragraph, outside, 1, lines));
+    assert(!SBParagraphCreateLines(paragraph, empty, 0, lines));
+
+    SBParagraphRelease(paragraph);
+    SBAlgorithmRelease(algorithm);
+
+    cout << "Passed." << endl;
+    cout << endl;
+}
+
+void AlgorithmTests::testLineMaps() {
+    cout << "Running line map tests." << endl;
+
+    /* Nested embeddings produce runs at multiple levels. */
+    u16string text = u"ab \u05D0\u05D1 12 \u05D2 cd \u202Aef \u05D3\u202C gh";
+
+    SBCodepointSequence sequence;
+    sequence.stringEncoding = SBStringEncodingUTF16;
+    sequence.stringBuffer = text.data();
+    sequence.stringLength = text.length();
+
+    auto algorithm = SBAlgorithmCreate(&sequence);
+
+    for (SBLevel baseLevel : { SBLevel(0), SBLevel(1) }) {
+        auto paragraph = SBAlgorithmCreateParagraph(algorithm, 0, text.length(), baseLevel);
+        auto line = SBParagraphCreateLine(paragraph, 1, text.length() - 2);
+        auto offset = SBLineGetOffset(line);
+        auto length = SBLineGetLength(line);
+        auto runs = SBLineGetRunsPtr(line);
+        auto runCount = SBLineGetRunCount(line);
+
+        /* Build the expected visual order directly from the runs. */
+        vector<SBUInteger> expected;
+        vector<SBUInteger> runOf(length);
+
+        for (SBUInteger i = 0; i < runCount; i++) {
+            for (SBUInteger j = 0; j < runs[i].length; j++) {
+                auto logical = (runs[i].level & 1 ? runs[i].length - j - 1 : j) + runs[i].offset - offset;
+                expected.push_back(logical);
+                runOf[logical] = i;
+            }
+        }
+
+        auto visualToLogical = SBLineGetVisualToLogicalMapPtr(line);
+        auto logicalToVisual = SBLineGetLogicalToVisualMapPtr(line);
+        assert(visualToLogical != nullptr && logicalToVisual != nullptr);
+        assert(SBLineGetVisualToLogicalMapPtr(line) == visualToLogical);
+
+        for (SBUInteger i = 0; i < length; i++) {
+            assert(visualToLogical[i] == expected[i]);
+            assert(logicalToVisual[visualToLogical[i]] == i);
+
+            SBUInteger runIndex;
+            SBUInteger visualIndex;
+            assert(SBLineFindRun(line, offset + i, &runIndex, &visualIndex));
+            assert(runIndex == runOf[i]);
+            assert(visualIndex == logicalToVisual[i]);
+        }
+
+        assert(!SBLineFindRun(line, offset - 1, nullptr, nullptr));
+        assert(!SBLineFindRun(line, offset + length, nullptr, nullptr));
+
+        SBLineRelease(line);
+        SBParagraphRelease(paragraph);
+    }
+
+    SBAlgorithmRelease(algorithm);
+
+    cout << "Passed." << endl;
+    cout << endl;
+}
+
+void AlgorithmTests::testVisualSegments() {
+    cout << "Running visual segments tests." << endl;
+
+    u16string text = u"ab \u05D0\u05D1 12 \u05D2 cd \u202Aef \u05D3\u202C gh \u05D4\u05D5";
+
+    SBCodepointSequence sequence;
+    sequence.stringEncoding = SBStringEncodingUTF16;
+    sequence.stringBuffer = text.data();
+    sequence.stringLength = text.length();
+
+    auto algorithm = SBAlgorithmCreate(&sequence);
+
+    for (SBLevel baseLevel : { SBLevel(0), SBLevel(1) }) {
+        auto paragraph = SBAlgorithmCreateParagraph(algorithm, 0, text.length(), baseLevel);
+        auto line = SBParagraphCreateLine(paragraph, 2, text.length() - 3);
+        auto offset = SBLineGetOffset(line);
+        auto length = SBLineGetLength(line);
+        auto runCount = SBLineGetRunCount(line);
+        auto logicalToVisual = SBLineGetLogicalToVisualMapPtr(line);
+
+        /* Level of each code unit in visual order. */
+        vector<SBLevel> visualLevels(length);
+        for (SBUInteger i = 0; i < length; i++) {
+            SBUInteger runIndex;
+            SBUInteger visualIndex;
+
+            SBLineFindRun(line, offset + i, &runIndex, &visualIndex);
+            visualLevels[visualIndex] = SBLineGetRunsPtr(line)[runIndex].level;
+        }
+
+        for (SBUInteger start = 0; start < text.length(); start++) {
+            for (SBUInteger end = start + 1; end <= text.length(); end++) {
+                /* Group the selected visual positions into contiguous segments of one level. */
+                vector<bool> selected(length, false);
+                for (SBUInteger i = max(start, offset); i < min(end, offset + length); i++) {
+                    selected[logicalToVisual[i - offset]] = true;
+                }
+
+                vector<SBVisualSegment> expected;
+                for (SBUInteger v = 0; v < length; v++) {
+                    if (!selected[v]) {
+                        continue;
+                    }
+                    if (!expected.empty()) {
+                        auto &last = expected.back();
+                        if (last.visualOffset + last.length == v && last.level == visualLevels[v]) {
+                            last.length += 1;
+                            continue;
+                        }
+                    }
+                    expected.push_back({ v, 1, visualLevels[v] });
+                }
+
+                vector<SBVisualSegment> segments(runCount);
+                auto count = SBLineGetVisualSegments(line, start, end - start, segments.data(), runCount);
+
+                assert(count == expected.size());
+                for (SBUInteger i = 0; i < count; i++) {
+                    assert(segments[i].visualOffset == expected[i].visualOffset);
+                    assert(segments[i].length == expected[i].length);
+                    assert(segments[i].level == expected[i].level);
+                }
+
+                /* A small array must only report the needed capacity. */
+                if (count > 1) {
+                    assert(SBLineGetVisualSegments(line, start, end - start, segments.data(), 0) > 0);
+                }
+            }
+        }
+
+        SBLineRelease(line);
+        SBParagraphRelease(paragraph);
+    }
+
+    SBAlgorithmRelease(algorithm);
+
+    cout << "Passed." << endl;
+    cout << endl;
+}
+
+void AlgorithmTests::testRunsInEncoding() {
+    cout << "Running runs in encoding tests." << endl;
+
+    /* Mixed directions with code points of every UTF-8 length. */
+    string text = u8"ab\u00E9 \u05D0\U00010900\u05D1 12 \u20AC \u202B\u05D2d\u202C";
+
+    SBCodepointSequence sequence;
+    sequence.stringEncoding = SBStringEncodingUTF8;
+    sequence.stringBuffer = text.data();
+    sequence.stringLength = text.length();
+
+    auto algorithm = SBAlgorithmCreate(&sequence);
+
+    for (SBLevel baseLevel : { SBLevel(0), SBLevel(1) }) {
+        auto paragraph = SBAlgorithmCreateParagraph(algorithm, 0, text.length(), baseLevel);
+        auto line = SBParagraphCreateLine(paragraph, 1, text.length() - 1);
+        auto runs = SBLineGetRunsPtr(line);
+        auto runCount = SBLineGetRunCount(line);
+
+        for (SBStringEncoding encoding : { SBStringEncodingUTF8, SBStringEncodingUTF16, SBStringEncodingUTF32 }) {
+            vector<SBRun> converted(runCount);
+            assert(SBLineGetRunsInEncoding(line, encoding, converted.data()));
+
+            for (SBUInteger i = 0; i < runCount; i++) {
+                SBUInteger bounds[2] = { runs[i].offset, runs[i].offset + runs[i].length };
+                SBCodepointSequenceConvertIndexes(&sequence, SBStringEncodingUTF8, encoding, bounds, 2);
+
+                assert(converted[i].offset == bounds[0]);
+                assert(converted[i].length == bounds[1] - bounds[0]);
+                assert(converted[i].level == runs[i].level);
+            }
+        }
+
+        SBRun dummy;
+        assert(!SBLineGetRunsInEncoding(line, 4, &dummy));
+
+        SBLineRelease(line);
+        SBParagraphRelease(paragraph);
+    }
+
+    SBAlgorithmRelease(algorithm);
+
+    cout << "Passed." << endl;
+    cout << endl;
+}
+
+void AlgorithmTests::testCaretMovement() {
+    cout << "Running caret movement tests." << endl;
+
+    /* Mixed directions with supplementary code points in both of them. */
+    u16string text = u"ab\U0001D400 \u05D0\U00010900\u05D1 12 c \u202B\u05D2d\u202C";
+
+    SBCodepointSequence sequence;
+    sequence.stringEncoding = SBStringEncodingUTF16;
+    sequence.stringBuffer = text.data();
+    sequence.stringLength = text.length();
+
+    auto algorithm = SBAlgorithmCreate(&sequence);
+
+    for (SBLevel baseLevel : { SBLevel(0), SBLevel(1) }) {
+        auto paragraph = SBAlgorithmCreateParagraph(algorithm, 0, text.length(), baseLevel);
+        auto line = SBParagraphCreateLine(paragraph, 0, text.length());
+        auto length = SBLineGetLength(line);
+        auto logicalToVisual = SBLineGetLogicalToVisualMapPtr(line);
+
+        auto isRTL = [&](SBUInteger index) {
+            SBUInteger runIndex;
+            SBLineFindRun(line, index, &runIndex, nullptr);
+            return (SBLineGetRunsPtr(line)[runIndex].level & 1) != 0;
+        };
+        auto visualPosition = [&](const SBCaret &caret) {
+            if ((caret.affinity == SBCaretAffinityDownstream && caret.index < length) || caret.index == 0) {
+                return logicalToVisual[caret.index] + (isRTL(caret.index) ? 1 : 0);
+            }
+            return logicalToVisual[caret.index - 1] + (isRTL(caret.index - 1) ? 0 : 1);
+        };
+
+        /* Move to the visually leftmost position. */
+        SBCaret caret = { 5, SBCaretAffinityDownstream };
+        SBCaret moved;
+
+        while (SBLineMoveCaret(line, &caret, SBCaretDirectionLeft, &moved)) {
+            assert(visualPosition(moved) < visualPosition(caret));
+            caret = moved;
+        }
+        assert(visualPosition(caret) == 0);
+
+        /* Walk to the right, one code point at a time, and back. */
+        SBUInteger steps = 0;
+
+        while (SBLineMoveCaret(line, &caret, SBCaretDirectionRight, &moved)) {
+            auto distance = visualPosition(moved) - visualPosition(caret);
+            assert(distance == 1 || distance == 2);
+
+            SBCaret back;
+            assert(SBLineMoveCaret(line, &moved, SBCaretDirectionLeft, &back));
+            assert(visualPosition(back) == visualPosition(caret));
+
+            caret = moved;
+            steps += 1;
+        }
+        assert(visualPosition(caret) == length);
+        assert(steps == length - 2);
+
+        SBCaret outside = { length + 1, SBCaretAffinityUpstream };
+        assert(!SBLineMoveCaret(line, &outside, SBCaretDirectionLeft, &moved));
+
+        SBLineRelease(line);
+        SBParagraphRelease(paragraph);
+    }
+
+    SBAlgorithmRelease(algorithm);
+
+    cout << "Passed." << endl;
+    cout << endl;
+}
+
+void AlgorithmTests::testLineReordering() {
+    cout << "Running line reordering tests." << endl;
+
+    u16string text = u"ab \u05D0\u05D1\u05D2 12 cd \u202Bef \u05D3\u202C";
+
+    SBCodepointSequence sequence;
+    sequence.stringEncoding = SBStringEncodingUTF16;
+    sequence.stringBuffer = text.data();
+    sequence.stringLength = text.length();
+
+    auto algorithm = SBAlgorithmCreate(&sequence);
+    auto paragraph = SBAlgorithmCreateParagraph(algorithm, 0, text.length(), 1);
+    auto line = SBParagraphCreateLine(paragraph, 0, text.length());
+    auto length = SBLineGetLength(line);
+    auto visualToLogical = SBLineGetVisualToLogicalMapPtr(line);
+
+    /* Packed arrays of all common element sizes. */
+    auto testPacked = [&](auto element) {
+        using Element = decltype(element);
+        vector<Element> source(length);
+        vector<Element> destination(length);
+
+        for (SBUInteger i = 0; i < length; i++) {
+            source[i] = Element(i);
+        }
+
+        assert(SBLineReorderElements(line, source.data(), destination.data(), length,
+                                     sizeof(Element), sizeof(Element), nullptr));
+
+        for (SBUInteger i = 0; i < length; i++) {
+            assert(destination[i] == Element(visualToLogical[i]));
+        }
+    };
+
+    testPacked(uint8_t());
+    testPacked(uint16_t());
+    testPacked(uint32_t());
+    testPacked(uint64_t());
+
+    /* A strided field within an array of structures. */
+    struct Glyph {
+        uint16_t id;
+        uint16_t cluster;
+        float advance;
+    };
+
+    vector<Glyph> glyphs(length);
+    vector<Glyph> visualGlyphs(length);
+
+    for (SBUInteger i = 0; i < length; i++) {
+        glyphs[i] = { uint16_t(i), uint16_t(i), 0.0f };
+    }
+
+    assert(SBLineReorderElements(line, glyphs.data(), visualGlyphs.data(), length,
+                                 sizeof(uint16_t), sizeof(Glyph), nullptr));
+
+    for (SBUInteger i = 0; i < length; i++) {
+        assert(visualGlyphs[i].id == visualToLogical[i]);
+    }
+
+    /* Many-to-one and one-to-many glyph mappings through a cluster map. */
+    vector<SBUInteger> clusterMap;
+    vector<uint32_t> glyphIDs;
+
+    for (SBUInteger i = 0; i < length; i++) {
+        /* Drop every third code unit and double every fourth one. */
+        if (i % 3 == 1) {
+            continue;
+        }
+
+        clusterMap.push_back(i);
+        glyphIDs.push_back(uint32_t(i * 2));
+
+        if (i % 4 == 0) {
+            clusterMap.push_back(i);
+            glyphIDs.push_back(uint32_t(i * 2 + 1));
+        }
+    }
+
+    vector<uint32_t> expected;
+
+    for (SBUInteger r = 0; r < SBLineGetRunCount(line); r++) {
+        const SBRun &run = SBLineGetRunsPtr(line)[r];
+        vector<uint32_t> runGlyphs;
+
+        for (size_t g = 0; g < glyphIDs.size(); g++) {
+            if (clusterMap[g] >= run.offset && clusterMap[g] < run.offset + run.length) {
+                runGlyphs.push_back(glyphIDs[g]);
+            }
+        }
+        if (run.level & 1) {
+            reverse(runGlyphs.begin(), runGlyphs.end());
+        }
+
+        expected.insert(expected.end(), runGlyphs.begin(), runGlyphs.end());
+    }
+
+    vector<uint32_t> visualIDs(glyphIDs.size());
+
+    assert(SBLineReorderElements(line, glyphIDs.data(), visualIDs.data(), glyphIDs.size(),
+                                 sizeof(uint32_t), sizeof(uint32_t), clusterMap.data()));
+    assert(visualIDs == expected);
+
+    /* Invalid arguments must be rejected. */
+    assert(!SBLineReorderElements(line, glyphIDs.data(), visualIDs.data(), glyphIDs.size(),
+                                  sizeof(uint32_t), sizeof(uint32_t), nullptr));
+    assert(!SBLineReorderElements(line, glyphIDs.data(), visualIDs.data(), glyphIDs.size(),
+                                  sizeof(uint32_t), sizeof(uint16_t), clusterMap.data()));
+
+    SBLineRelease(line);
+    SBParagraphRelease(paragraph);
+    SBAlgorithmRelease(algorithm);
+
+    cout << "Passed." << endl;
+    cout << endl;
+}
+
+template<class String>
+static void testVisualString(SBStringEncoding encoding, const String &text, const String &expected,
+    SBUInteger lineLength = SBUInteger(-1))
+{
+    SBCodepointSequence sequence;
+    sequence.stringEncoding = encoding;
+    sequence.stringBuffer = text.data();
+    sequence.stringLength = text.length();
+
+    if (lineLength == SBUInteger(-1)) {
+        lineLength = text.length();
+    }
+
+    auto algorithm = SBAlgorithmCreate(&sequence);
+    auto paragraph = SBAlgorithmCreateParagraph(algorithm, 0, text.length(), 1);
+    auto line = SBParagraphCreateLine(paragraph, 0, lineLength);
+
+    /* Nothing is written into a buffer that is too small. */
+    String visual(lineLength, 0);
+    assert(SBLineGetVisualCodeUnits(line, nullptr, 0) == lineLength);
+    assert(SBLineGetVisualCodeUnits(line, &visual[0], lineLength - 1) == lineLength);
+    assert(visual == String(lineLength, 0));
+
+    assert(SBLineGetVisualCodeUnits(line, &visual[0], lineLength) == lineLength);
+    assert(visual == expected);
+
+    SBLineRelease(line);
+    SBParagraphRelease(paragraph);
+    SBAlgorithmRelease(algorithm);
+}
+
+void AlgorithmTests::testVisualCodeUnits() {
+    cout << "Running visual code units tests." << endl;
+
+    /* Brackets of right-to-left runs are mirrored while CRLF and multi-byte sequences stay intact. */
+    testVisualString(SBStringEncodingUTF8,
+                     string(u8"\u05D0(\u05D1<ab>)\r\n"),
+                     string(u8"\r\n(<ab>\u05D1)\u05D0"));
+    testVisualString(SBStringEncodingUTF16,
+                     u16string(u"\u05D0(\u05D1<ab>)\r\n"),
+                     u16string(u"\r\n(<ab>\u05D1)\u05D0"));
+    testVisualString(SBStringEncodingUTF32,
+                     u32string(U"\u05D0(\u05D1<ab>)\r\n"),
+                     u32string(U"\r\n(<ab>\u05D1)\u05D0"));
+
+    /* Supplementary code points and a lone CR keep their code units in logical order. */
+    testVisualString(SBStringEncodingUTF16,
+                     u16string(u"\U00010900\u2264\U00010901\r"),
+                     u16string(u"\r\U00010901\u2265\U00010900"));
+
+    /* Malformed sequences are copied as they are. */
+    testVisualString(SBStringEncodingUTF8,
+                     string("\xD7\x90\xE2\x80[\xD7\x91"),
+                     string("\xD7\x91]\xE2\x80\xD7\x90"));
+
+    /* Sequences cut by the end of a line are copied as they are. */
+    testVisualString(SBStringEncodingUTF8,
+                     string(u8"\u05D0\u05D1"),
+                     string("\xD7\xD7\x90"), 3);
+    testVisualString(SBStringEncodingUTF16,
+                     u16string(u"\u05D0\U00010900"),
+                     u16string(u"\xD802\u05D0"), 2);
+
+    cout << "Passed." << endl;
+    cout << endl;
+}
+
+void AlgorithmTests::testMirrorLocator() {
+    cout << "Running mirror locator tests." << endl;
+
+    /* All ASCII code points and a few others within an override, plus a left-to-right part. */
+    u32string text = U"\u202E";
+    for (char32_t c = 0x20; c < 0x7F; c++) {
+        text += c;
+    }
+    text += U"\u2208\u2264\u00AB\U0001D6DB\u202C (a) \u05D0[\u05D1]";
+
+    SBCodepointSequence sequence;
+    sequence.stringEncoding = SBStringEncodingUTF32;
+    sequence.stringBuffer = text.data();
+    sequence.stringLength = text.length();
+
+    auto algorithm = SBAlgorithmCreate(&sequence);
+    auto paragraph = SBAlgorithmCreateParagraph(algorithm, 0, text.length(), 0);
+    auto line = SBParagraphCreateLine(paragraph, 0, text.length());
+    auto levels = SBParagraphGetLevelsPtr(paragraph);
+
+    vector<SBMirrorAgent> expected;
+
+    for (SBUInteger i = 0; i < text.length(); i++) {
+        auto mirror = SBCodepointGetMirror(text[i]);
+
+        if ((levels[i] & 1) && mirror) {
+            expected.push_back({ i, mirror, SBCodepoint(text[i]) });
+        }
+    }
+    assert(expected.size() > 8);
+
+    auto locator = SBMirrorLocatorCreate();
+    SBMirrorLocatorLoadLine(locator, line, text.data());
+
+    auto equals = [](const SBMirrorAgent &a, const SBMirrorAgent &b) {
+        return a.index == b.index && a.mirror == b.mirror && a.codepoint == b.codepoint;
+    };
+
+    /* Bulk calls of every size must find the same mirrors in logical order. */
+    for (SBUInteger maxCount = 1; maxCount <= expected.size() + 1; maxCount++) {
+        vector<SBMirrorAgent> actual;
+        vector<SBMirrorAgent> agents(maxCount);
+        SBUInteger count;
+
+        do {
+            count = SBMirrorLocatorGetMirrors(locator, agents.data(), maxCount);
+            actual.insert(actual.end(), agents.begin(), agents.begin() + count);
+        } while (count == maxCount);
+
+        assert(actual.size() == expected.size());
+        assert(equal(actual.begin(), actual.end(), expected.begin(), equals));
+    }
+
+    /* The iterator must agree with the bulk form. */
+    auto agent = SBMirrorLocatorGetAgent(locator);
+    size_t index = 0;
+
+    while (SBMirrorLocatorMoveNext(locator)) {
+        assert(index < expected.size());
+        assert(equals(*agent, expected[index]));
+        index += 1;
+    }
+    assert(index == expected.size());
+    assert(agent->index == SBUInteger(-1) && agent->mirror == 0);
+
+    SBMirrorLocatorRelease(locator);
+    SBLineRelease(line);
+    SBParagraphRelease(paragraph);
+    SBAlgorithmRelease(algorithm);
+
+    cout << "Passed." << endl;
+    cout << endl;
+}
+
+static void testLineRunOrder(const u16string &text, SBLevel baseLevel)
+{
+    SBCodepointSequence sequence;
+    sequence.stringEncoding = SBStringEncodingUTF16;
+    sequence.stringBuffer = text.data();
+    sequence.stringLength = text.length();
+
+    auto algorithm = SBAlgorithmCreate(&sequence);
+    auto paragraph = SBAlgorithmCreateParagraph(algorithm, 0, text.length(), baseLevel);
+    auto line = SBParagraphCreateLine(paragraph, 0, text.length());
+    auto runs = SBLineGetRunsPtr(line);
+    auto runCount = SBLineGetRunCount(line);
+
+    /* Reorder the runs in logical order by reversing them once for each level (rule L2). */
+    vector<SBRun> expected(runs, runs + runCount);
+    sort(expected.begin(), expected.end(), [](const SBRun &a, const SBRun &b) {
+        return a.offset < b.offset;
+    });
+
+    SBLevel maxLevel = 0;
+    for (const auto &run : expected) {
+        maxLevel = max(maxLevel, run.level);
+    }
+
+    for (SBLevel level = maxLevel; level > 0; level--) {
+        for (size_t start = 0; start < expected.size(); start++) {
+            if (expected[start].level >= level) {
+                size_t end = start + 1;
+                while (end < expected.size() && expected[end].level >= level) {
+                    end += 1;
+                }
+
+                reverse(expected.begin() + start, expected.begin() + end);
+                start = end;
+            }
+        }
+    }
+
+    for (SBUInteger i = 0; i < runCount; i++) {
+        assert(runs[i].offset == expected[i].offset);
+        assert(runs[i].length == expected[i].length);
+        assert(runs[i].level == expected[i].level);
+    }
+
+    SBLineRelease(line);
+    SBParagraphRelease(paragraph);
+    SBAlgorithmRelease(algorithm);
+}
+
+void AlgorithmTests::testRunReordering() {
+    cout << "Running run reordering tests." << endl;
+
+    const char16_t embeddings[] = { u'\u202A', u'\u202B', u'\u202D', u'\u202E' };
+    const char16_t letters[] = { u'a', u'\u05D0', u'1', u' ', u'\u0661' };
+    uint32_t seed = 1;
+
+    auto random = [&](uint32_t bound) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % bound;
+    };
+
+    /* Randomly nested embeddings and overrides. */
+    for (int i = 0; i < 200; i++) {
+        u16string text;
+        int depth = 0;
+
+        for (int j = 0; j < 60; j++) {
+            auto choice = random(4);
+
+            if (choice == 0 && depth < 100) {
+                text += embeddings[random(4)];
+                depth += 1;
+            } else if (choice == 1 && depth > 0) {
+                text += u'\u202C';
+                depth -= 1;
+            } else {
+                text += letters[random(5)];
+            }
+        }
+
+        testLineRunOrder(text, 0);
+        testLineRunOrder(text, 1);
+    }
+
+    /* Deep nesting up to the maximum level, repeated to produce thousands of runs. */
+    u16string text;
+
+    for (int i = 0; i < 40; i++) {
+        for (int j = 0; j < 124; j++) {
+            text += (j & 1 ? u'\u202A' : u'\u202B');
+            text += (j & 1 ? u'a' : u'\u05D0');
+        }
+        for (int j = 0; j < 124; j++) {
+            text += u'\u202C';
+            text += (j & 1 ? u'b' : u'\u05D1');
+        }
+    }
+
+    testLineRunOrder(text, 0);
+    testLineRunOrder(text, 1);
+
+#ifdef SB_CONFIG_ENABLE_STATISTICS
+    /* The deep nesting is reordered in steps linear to the number of runs, whereas reversing the
+     * runs once for each level would take as many steps as the levels times the runs. */
+    {
+        SBCodepointSequence sequence;
+        sequence.stringEncoding = SBStringEncodingUTF16;
+        sequence.stringBuffer = text.data();
+        sequence.stringLength = text.length();
+
+        auto algorithm = SBAlgorithmCreate(&sequence);
+        auto paragraph = SBAlgorithmCreateParagraph(algorithm, 0, text.length(), 0);
+
+        SBStatistics before;
+        SBStatistics after;
+
+        SBStatisticsGetSnapshot(&before);
+        auto line = SBParagraphCreateLine(paragraph, 0, text.length());
+        SBStatisticsGetSnapshot(&after);
+
+        auto runCount = SBLineGetRunCount(line);
+        auto steps = after.runReorderSteps - before.runReorderSteps;
+        assert(runCount > 1000);
+        assert(steps > 0 && steps <= runCount * 6);
+
+        SBLineRelease(line);
+        SBParagraphRelease(paragraph);
+        SBAlgorithmRelease(algorithm);
+    }
+#endif
+
+    cout << "Passed." << endl;
+    cout << endl;
+}
+
 #ifdef STANDALONE_TESTING
 
 int main(int argc, const char *argv[]) {
@@ -39,7 +39,18 @@ public:
 
     void testBidiTypes();
     void testParagraphBoundary();
+    void testMultipleParagraphBoundaries();
     void testParagraphCreation();
+    void testParagraphLimits();
+    void testLineCreation();
+    void testLineMaps();
+    void testRunsInEncoding();
+    void testVisualSegments();
+    void testCaretMovement();
+    void testLineReordering();
+    void testVisualCodeUnits();
+    void testMirrorLocator();
+    void testRunReordering();
     void testBidiAlgorithm();
 
 private:
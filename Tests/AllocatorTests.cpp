@@ -31,8 +31,12 @@
 
 extern "C" {
 #include <API/SBAllocator.h>
+#include <Core/Object.h>
+#include <Core/ObjectPool.h>
 }
 
+#include <SheenBidi/SBStatistics.h>
+
 #include "AllocatorTests.h"
 
 using namespace std;
@@ -58,6 +62,8 @@ void AllocatorTests::run() {
     testCustomAllocatorProtocol();
     testDefaultAllocatorChanges();
     testThreadSafeDefaultAllocatorSwitch();
+    testObjectPoolReuse();
+    testStatisticsSnapshot();
 }
 
 void AllocatorTests::testBasicBlockAllocation() {
@@ -488,6 +494,180 @@ void AllocatorTests::testThreadSafeDefaultAllocatorSwitch() {
     SBAllocatorRelease(allocators[1]);
 }
 
+void AllocatorTests::testObjectPoolReuse() {
+#if !defined(SB_CONFIG_UNITY) && defined(SB_CONFIG_ENABLE_OBJECT_POOL)
+    struct PooledObject {
+        ObjectBase base;
+        uint8_t data[100];
+    };
+
+    const SBUInteger size = sizeof(PooledObject);
+    void *pointer = nullptr;
+    ObjectPoolCounters counters;
+
+    SBAllocatorDrainObjectPool();
+
+    ObjectRef object1 = ObjectCreate(&size, 1, &pointer, nullptr);
+    assert(object1 != nullptr);
+    ObjectRelease(object1);
+
+    // The released block should be handed out again for an object of the same size class
+    ObjectRef object2 = ObjectCreate(&size, 1, &pointer, nullptr);
+    assert(object2 == object1);
+    assert(ObjectGetRetainCount(object2) == 1);
+
+    ObjectPoolGetCounters(&counters);
+    assert(counters.misses == 1);
+    assert(counters.hits == 1);
+    assert(counters.recycles == 1);
+
+    ObjectRelease(object2);
+
+    // Retention should be bounded by the capacity of each size class
+    vector<ObjectRef> objects;
+    for (size_t i = 0; i < SB_CONFIG_OBJECT_POOL_CAPACITY + 4; i++) {
+        objects.push_back(ObjectCreate(&size, 1, &pointer, nullptr));
+    }
+    for (auto object : objects) {
+        ObjectRelease(object);
+    }
+
+    ObjectPoolGetCounters(&counters);
+    assert(counters.discards == 4);
+
+    SBAllocatorDrainObjectPool();
+
+    ObjectPoolGetCounters(&counters);
+    assert(counters.hits == 0 && counters.misses == 0);
+
+    // Blocks should be returned to the allocator they were obtained from
+    {
+        struct Data {
+            size_t allocateCount = 0;
+            size_t deallocateCount = 0;
+        } data;
+
+        SBAllocatorProtocol protocol = {
+            [](SBUInteger size, void *info) -> void * {
+                static_cast<Data *>(info)->allocateCount += 1;
+                return malloc(size);
+            },
+            [](void *pointer, SBUInteger newSize, void *info) -> void * {
+                return realloc(pointer, newSize);
+            },
+            [](void *pointer, void *info) {
+                static_cast<Data *>(info)->deallocateCount += 1;
+                free(pointer);
+            },
+            nullptr,
+            nullptr,
+            nullptr
+        };
+
+        // Retain a block of the native allocator in the pool
+        ObjectRelease(ObjectCreate(&size, 1, &pointer, nullptr));
+
+        SBAllocatorRef allocator = SBAllocatorCreate(&protocol, &data);
+        SBAllocatorSetDefault(allocator);
+
+        ObjectRef object = ObjectCreate(&size, 1, &pointer, nullptr);
+        assert(object != nullptr);
+        assert(data.allocateCount == 1);
+
+        // The block of the custom allocator should not be retained by the pool
+        ObjectRelease(object);
+        assert(data.deallocateCount == 1);
+
+        // The retained native block should not reach the custom allocator
+        SBAllocatorDrainObjectPool();
+        assert(data.deallocateCount == 1);
+
+        SBAllocatorSetDefault(nullptr);
+        SBAllocatorRelease(allocator);
+    }
+
+#ifdef SB_CONFIG_ENABLE_STATISTICS
+    // Blocks retained by a thread should be reclaimed when it exits
+    {
+        SBStatistics before;
+        SBStatistics after;
+
+        SBStatisticsGetSnapshot(&before);
+
+        thread worker([&]() {
+            ObjectRelease(ObjectCreate(&size, 1, &pointer, nullptr));
+
+            ObjectPoolCounters workerCounters;
+            ObjectPoolGetCounters(&workerCounters);
+            assert(workerCounters.recycles == 1);
+        });
+        worker.join();
+
+        SBStatisticsGetSnapshot(&after);
+        assert(after.blockAllocations - before.blockAllocations
+               == after.blockDeallocations - before.blockDeallocations);
+    }
+#endif
+#endif
+}
+
+void AllocatorTests::testStatisticsSnapshot() {
+#if !defined(SB_CONFIG_UNITY) && defined(SB_CONFIG_ENABLE_STATISTICS)
+    SBStatistics before;
+    SBStatistics after;
+
+    SBStatisticsGetSnapshot(&before);
+
+    void *pointer = SBAllocatorAllocateBlock(nullptr, 100);
+    assert(pointer != nullptr);
+
+    SBStatisticsGetSnapshot(&after);
+    assert(after.blockAllocations - before.blockAllocations == 1);
+    assert(after.blockDeallocations == before.blockDeallocations);
+
+    SBAllocatorDeallocateBlock(nullptr, pointer);
+
+    SBStatisticsGetSnapshot(&after);
+    assert(after.blockDeallocations - before.blockDeallocations == 1);
+
+    // Counters of finished threads should remain part of the totals
+    thread worker([]() {
+        void *pointer = SBAllocatorAllocateBlock(nullptr, 100);
+        SBAllocatorDeallocateBlock(nullptr, pointer);
+    });
+    worker.join();
+
+    SBStatisticsGetSnapshot(&after);
+    assert(after.blockAllocations - before.blockAllocations == 2);
+    assert(after.blockDeallocations - before.blockDeallocations == 2);
+
+    // Snapshots taken while another thread is counting should never go backwards
+    const size_t iterations = 10000;
+    atomic<bool> isFinished(false);
+
+    SBStatisticsGetSnapshot(&before);
+
+    thread counter([&]() {
+        for (size_t i = 0; i < iterations; i++) {
+            SBAllocatorDeallocateBlock(nullptr, SBAllocatorAllocateBlock(nullptr, 16));
+        }
+        isFinished = true;
+    });
+
+    SBUInteger lastAllocations = before.blockAllocations;
+    while (!isFinished) {
+        SBStatisticsGetSnapshot(&after);
+        assert(after.blockAllocations >= lastAllocations);
+        lastAllocations = after.blockAllocations;
+    }
+    counter.join();
+
+    SBStatisticsGetSnapshot(&after);
+    assert(after.blockAllocations - before.blockAllocations == iterations);
+    assert(after.blockDeallocations - before.blockDeallocations == iterations);
+#endif
+}
+
 #ifdef STANDALONE_TESTING
 
 int main(int argc, const char *argv[]) {
@@ -39,6 +39,8 @@ private:
     void testCustomAllocatorProtocol();
     void testDefaultAllocatorChanges();
     void testThreadSafeDefaultAllocatorSwitch();
+    void testObjectPoolReuse();
+    void testStatisticsSnapshot();
 };
 
 }
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <random>
@@ -309,6 +310,7 @@ void AttributeManagerTests::run() {
     testAttributeRemovalEdgeCases();
     testOperationsWithNullRegistry();
     testZeroLengthOperations();
+    testInternedDictionaries();
 
     // Replacement tests
     testReplaceRangePureInsertion();
@@ -323,6 +325,7 @@ void AttributeManagerTests::run() {
     testReplaceRangeComplexAttributePatterns();
     testReplaceRangeMultipleAttributes();
     testReplaceRangeAttributeInheritance();
+    testReplaceRangeRandomEdits();
 
     // Run iteration tests
     testGetRunByIDBasic();
@@ -697,6 +700,49 @@ void AttributeManagerTests::testZeroLengthOperations() {
     SBTextRelease(text);
 }
 
+void AttributeManagerTests::testInternedDictionaries() {
+    auto text = SBTextCreateWithDefaultRegistry();
+    SBTextAppendRandomCodeUnits(text, 40);
+
+    auto manager = &text->attributeManager;
+    auto registry = manager->_registry;
+    auto color = SBAttributeRegistryGetAttributeID(registry, AttributeName::Color);
+    auto font = SBAttributeRegistryGetAttributeID(registry, AttributeName::Font);
+
+    AttributePool pool;
+    auto red = pool.add(Color::Red);
+    auto otherRed = pool.add(Color::Red);
+    auto arial = pool.add(Font::Arial);
+
+    // Apply equal styles to disjoint ranges, using distinct but equal values
+    for (SBUInteger index = 0; index < 40; index += 8) {
+        auto value = (index % 16 == 0 ? red : otherRed);
+        SBTextSetAttribute(text, index, 4, color, value);
+        SBTextSetAttribute(text, index, 4, font, arial);
+    }
+
+    // Styled ranges share one dictionary, and so do the unstyled gaps
+    auto styled = AttributeManagerFindEntry(manager, 0, nullptr, nullptr)->attributes;
+    auto unstyled = AttributeManagerFindEntry(manager, 4, nullptr, nullptr)->attributes;
+
+    for (SBUInteger index = 0; index < 40; index += 8) {
+        assert(AttributeManagerFindEntry(manager, index, nullptr, nullptr)->attributes == styled);
+        assert(AttributeManagerFindEntry(manager, index + 4, nullptr, nullptr)->attributes == unstyled);
+    }
+    assert(styled != unstyled);
+    assert(manager->_pool._count == 2);
+
+    // Removing the style from one range must not affect the others
+    SBTextRemoveAttribute(text, 8, 4, color);
+    assert(verifyAttribute(manager, 8, color, AttributeValue::None));
+    assert(verifyAttribute(manager, 8, font, Font::Arial));
+    assert(verifyAttribute(manager, 16, color, Color::Red));
+    assert(AttributeManagerFindEntry(manager, 16, nullptr, nullptr)->attributes == styled);
+    assert(manager->_pool._count == 3);
+
+    SBTextRelease(text);
+}
+
 void AttributeManagerTests::testReplaceRangePureInsertion() {
     auto text = SBTextCreateWithDefaultRegistry();
     SBTextAppendRandomCodeUnits(text, 10);
@@ -1135,6 +1181,98 @@ void AttributeManagerTests::testReplaceRangeZeroLengthOperations() {
     SBTextRelease(text);
 }
 
+void AttributeManagerTests::testReplaceRangeRandomEdits() {
+    auto text = SBTextCreateWithDefaultRegistry();
+    SBTextAppendRandomCodeUnits(text, 200);
+
+    auto manager = &text->attributeManager;
+    auto registry = manager->_registry;
+    auto color = SBAttributeRegistryGetAttributeID(registry, AttributeName::Color);
+
+    AttributePool pool;
+    const vector<AttributeValue *> colors = {
+        pool.add(Color::Red), pool.add(Color::Green), pool.add(Color::Blue)
+    };
+
+    // Reference model holding the color index of each code unit, -1 for no color
+    vector<int> model(200, -1);
+    mt19937 generator(42);
+
+    auto random = [&](size_t bound) {
+        return static_cast<size_t>(generator() % bound);
+    };
+
+    for (int step = 0; step < 2000; step++) {
+        size_t length = model.size();
+        size_t index = random(length + 1);
+        size_t count = random(min<size_t>(length - index, 12) + 1);
+
+        switch (random(4)) {
+        case 0:
+            if (count > 0) {
+                // Apply a color
+                int value = static_cast<int>(random(colors.size()));
+                SBTextSetAttribute(text, index, count, color, colors[value]);
+                fill(model.begin() + index, model.begin() + index + count, value);
+            }
+            break;
+
+        case 1:
+            if (count > 0) {
+                // Remove the color
+                SBTextRemoveAttribute(text, index, count, color);
+                fill(model.begin() + index, model.begin() + index + count, -1);
+            }
+            break;
+
+        case 2: {
+            // Insert code units, inheriting the attributes of the preceding one
+            size_t newCount = random(8) + 1;
+            int value = (index > 0 ? model[index - 1] : (length > 0 ? model[0] : -1));
+            SBTextReplaceWithRandomCodeUnits(text, index, 0, newCount);
+            model.insert(model.begin() + index, newCount, value);
+            break;
+        }
+
+        case 3:
+            if (count > 0 && count < length) {
+                // Replace or delete code units
+                size_t newCount = random(3);
+                int value = model[index];
+                SBTextReplaceWithRandomCodeUnits(text, index, count, newCount);
+                model.erase(model.begin() + index, model.begin() + index + count);
+                model.insert(model.begin() + index, newCount, value);
+            }
+            break;
+        }
+
+        assert(manager->_stringLength == model.size());
+        assert(AttributeEntryTreeGetLength(&manager->_entries) == model.size());
+    }
+
+    for (size_t index = 0; index < model.size(); index++) {
+        const AttributeValue &expected = (model[index] < 0
+            ? AttributeValue::None : *colors[model[index]]);
+        assert(verifyAttribute(manager, index, color, expected));
+    }
+
+    // The threaded entries must agree with the tree
+    size_t entryCount = 0;
+    size_t entryStart = 0;
+    for (auto entry = manager->_entries.first; entry; entry = entry->next) {
+        SBUInteger foundStart;
+        assert(AttributeManagerFindEntry(manager, entryStart, &foundStart, nullptr) == entry);
+        assert(foundStart == entryStart);
+
+        entryStart += entry->length;
+        entryCount += 1;
+    }
+    assert(entryStart == model.size());
+    assert(entryCount == manager->_entries.count);
+
+    SBTextRelease(text);
+}
+
 void AttributeManagerTests::testGetRunByIDBasic() {
     auto text = SBTextCreateWithDefaultRegistry();
     SBTextInsertRandomParagraph(text, 0, 10);
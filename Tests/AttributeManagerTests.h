@@ -41,6 +41,7 @@ private:
     static void testAttributeRemovalEdgeCases();
     static void testOperationsWithNullRegistry();
     static void testZeroLengthOperations();
+    static void testInternedDictionaries();
 
     static void testReplaceRangePureInsertion();
     static void testReplaceRangePureDeletion();
@@ -56,6 +57,7 @@ private:
     static void testReplaceRangeAttributeInheritance();
     static void testReplaceRangeEdgeCases();
     static void testReplaceRangeZeroLengthOperations();
+    static void testReplaceRangeRandomEdits();
 
     static void testGetRunByIDBasic();
     static void testGetRunByFilteredCollection();
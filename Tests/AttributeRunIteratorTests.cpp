@@ -118,6 +118,7 @@ void AttributeRunIteratorTests::run() {
     testBasicIteration();
     testAttributeBoundaries();
     testMultipleAttributes();
+    testAttributeIDSet();
     testOverlappingRuns();
     testAttributeMerging();
     testRetainRelease();
@@ -273,6 +274,111 @@ void AttributeRunIteratorTests::testMultipleAttributes() {
     SBTextRelease(text);
 }
 
+void AttributeRunIteratorTests::testAttributeIDSet() {
+    auto text = SBTextCreateTest("Hello\nWorld");
+    auto registry = SBTextGetAttributeRegistry(text);
+
+    auto typeface = SBAttributeRegistryGetAttributeID(registry, AttributeName::Typeface);
+    auto alignment = SBAttributeRegistryGetAttributeID(registry, AttributeName::Alignment);
+
+    SBTextSetAttribute(text, 0, 3, typeface, &Typeface::Serif);
+    SBTextSetAttribute(text, 8, 3, typeface, &Typeface::Monospace);
+    SBTextSetAttribute(text, 0, 6, alignment, &Alignment::Leading);
+    SBTextSetAttribute(text, 6, 5, alignment, &Alignment::Center);
+
+    auto iterator = SBAttributeRunIteratorCreate(text);
+    auto run = SBAttributeRunIteratorGetCurrent(iterator);
+
+    // Test 1: A run breaks whenever any attribute of the set changes
+    {
+        const SBAttributeID ids[] = { typeface, alignment };
+        SBAttributeRunIteratorSetupAttributeIDs(iterator, ids, 2);
+
+        assert(SBAttributeRunIteratorMoveNext(iterator));
+        assert(run->index == 0);
+        assert(run->length == 3);
+        assert(verifyAttributes(run->attributes, {
+            {alignment, Alignment::Leading}, {typeface, Typeface::Serif}
+        }));
+
+        assert(SBAttributeRunIteratorMoveNext(iterator));
+        assert(run->index == 3);
+        assert(run->length == 3);
+        assert(verifyAttributes(run->attributes, {{alignment, Alignment::Leading}}));
+
+        assert(SBAttributeRunIteratorMoveNext(iterator));
+        assert(run->index == 6);
+        assert(run->length == 2);
+        assert(verifyAttributes(run->attributes, {{alignment, Alignment::Center}}));
+
+        assert(SBAttributeRunIteratorMoveNext(iterator));
+        assert(run->index == 8);
+        assert(run->length == 3);
+        assert(verifyAttributes(run->attributes, {
+            {alignment, Alignment::Center}, {typeface, Typeface::Monospace}
+        }));
+
+        assert(!SBAttributeRunIteratorMoveNext(iterator));
+    }
+
+    // Test 2: Changes of attributes outside the set are ignored and empty runs are skipped
+    {
+        const SBAttributeID ids[] = { typeface, SBAttributeIDNone };
+        SBAttributeRunIteratorSetupAttributeIDs(iterator, ids, 2);
+
+        assert(SBAttributeRunIteratorMoveNext(iterator));
+        assert(run->index == 0);
+        assert(run->length == 3);
+        assert(verifyAttributes(run->attributes, {{typeface, Typeface::Serif}}));
+
+        assert(SBAttributeRunIteratorMoveNext(iterator));
+        assert(run->index == 8);
+        assert(run->length == 3);
+        assert(verifyAttributes(run->attributes, {{typeface, Typeface::Monospace}}));
+
+        assert(!SBAttributeRunIteratorMoveNext(iterator));
+    }
+
+    // Test 3: Equal values set separately still form a single run
+    {
+        const SBAttributeID ids[] = { alignment };
+
+        SBTextSetAttribute(text, 3, 2, typeface, &Typeface::Serif);
+        SBAttributeRunIteratorSetupAttributeIDs(iterator, ids, 1);
+
+        assert(SBAttributeRunIteratorMoveNext(iterator));
+        assert(run->index == 0);
+        assert(run->length == 6);
+        assert(verifyAttributes(run->attributes, {{alignment, Alignment::Leading}}));
+
+        assert(SBAttributeRunIteratorMoveNext(iterator));
+        assert(run->index == 6);
+        assert(run->length == 5);
+        assert(verifyAttributes(run->attributes, {{alignment, Alignment::Center}}));
+
+        assert(!SBAttributeRunIteratorMoveNext(iterator));
+    }
+
+    // Test 4: An empty set yields no runs
+    {
+        SBAttributeRunIteratorSetupAttributeIDs(iterator, nullptr, 0);
+        assert(!SBAttributeRunIteratorMoveNext(iterator));
+    }
+
+    // Test 5: Switching back to a single ID filter disables the set
+    {
+        SBAttributeRunIteratorSetupAttributeID(iterator, typeface);
+
+        assert(SBAttributeRunIteratorMoveNext(iterator));
+        assert(run->index == 0);
+        assert(run->length == 5);
+        assert(verifyAttributes(run->attributes, {{typeface, Typeface::Serif}}));
+    }
+
+    SBAttributeRunIteratorRelease(iterator);
+    SBTextRelease(text);
+}
+
 void AttributeRunIteratorTests::testOverlappingRuns() {
     auto text = SBTextCreateTest("Sheen");
     auto registry = SBTextGetAttributeRegistry(text);
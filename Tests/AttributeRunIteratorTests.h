@@ -28,6 +28,7 @@ private:
     static void testBasicIteration();
     static void testAttributeBoundaries();
     static void testMultipleAttributes();
+    static void testAttributeIDSet();
     static void testOverlappingRuns();
     static void testAttributeMerging();
     static void testRetainRelease();
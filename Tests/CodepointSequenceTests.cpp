@@ -16,8 +16,10 @@
 
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
+#include <SheenBidi/SBAlgorithm.h>
 #include <SheenBidi/SBBase.h>
 #include <SheenBidi/SBCodepointSequence.h>
 
@@ -322,11 +324,113 @@ void CodepointSequenceTests::testUTF32()
     u32Test({ 0x10FFFF }, { 0x10FFFF });
 }
 
+template<class CodeUnitType>
+static void parallelTest(SBStringEncoding encoding, const vector<CodeUnitType> &buffer)
+{
+    SBCodepointSequence sequence;
+    sequence.stringEncoding = encoding;
+    sequence.stringBuffer = (void *)buffer.data();
+    sequence.stringLength = buffer.size();
+
+    SBAlgorithmRef serial = SBAlgorithmCreate(&sequence);
+    assert(serial != nullptr);
+
+    /* Run the tasks in reverse order to make sure that chunks don't depend on each other. */
+    SBAlgorithmExecutor executor;
+    executor.execute = [](SBUInteger taskCount, SBAlgorithmTaskFunc task, void *context, void *) {
+        while (taskCount--) {
+            task(context, taskCount);
+        }
+    };
+    executor.info = nullptr;
+
+    for (SBUInteger chunkLength = 1; chunkLength <= buffer.size(); chunkLength++) {
+        executor.chunkLength = chunkLength;
+
+        SBAlgorithmRef parallel = SBAlgorithmCreateWithExecutor(&sequence, &executor);
+        assert(parallel != nullptr);
+        assert(memcmp(SBAlgorithmGetBidiTypesPtr(parallel), SBAlgorithmGetBidiTypesPtr(serial),
+                      buffer.size() * sizeof(SBBidiType)) == 0);
+
+        SBAlgorithmRelease(parallel);
+    }
+
+    SBAlgorithmRelease(serial);
+}
+
+void CodepointSequenceTests::testParallelClassification()
+{
+    /* Valid sequences of all lengths mixed with malformed ones. */
+    parallelTest<uint8_t>(SBStringEncodingUTF8, {
+        'a', 0xD8, 0xA7, 0xE2, 0x80, 0x8F, 0xF0, 0x9F, 0x98, 0x80, '\n',
+        0x80, 0x80, 0xE2, 0x80, 'b', 0xF0, 0x9F, 0x98, 0xC2, 0xA9, 0xBF, 0xBF, 0xBF, 0xBF, 0xBF
+    });
+    parallelTest<uint16_t>(SBStringEncodingUTF16, {
+        'a', 0x05D0, 0xD83D, 0xDE00, 0xDC00, 0xDC00, 0xD800, 'b', 0x2029, 0xD83D, 0xD83D, 0xDE00
+    });
+    parallelTest<uint32_t>(SBStringEncodingUTF32, {
+        'a', 0x05D0, 0x1F600, 0x110000, 0x2029, 'b'
+    });
+}
+
+template<class CodeUnitType>
+static void convTest(SBStringEncoding encoding, const vector<CodeUnitType> &buffer,
+    SBStringEncoding source, SBStringEncoding target,
+    vector<SBUInteger> indexes, const vector<SBUInteger> &expected)
+{
+    SBCodepointSequence sequence;
+    sequence.stringEncoding = encoding;
+    sequence.stringBuffer = (void *)buffer.data();
+    sequence.stringLength = buffer.size();
+
+    SBCodepointSequenceConvertIndexes(&sequence, source, target, indexes.data(), indexes.size());
+    assert(indexes == expected);
+}
+
+void CodepointSequenceTests::testIndexConversion()
+{
+    /* Code points of one, two, three and four bytes. */
+    vector<uint8_t> utf8 = {
+        'a', 0xD8, 0xA7, 0xE2, 0x82, 0xAC, 0xF0, 0x9F, 0x98, 0x80, 'b'
+    };
+    vector<uint16_t> utf16 = { 'a', 0x0627, 0x20AC, 0xD83D, 0xDE00, 'b' };
+    vector<uint32_t> utf32 = { 'a', 0x0627, 0x20AC, 0x1F600, 'b' };
+
+    convTest(SBStringEncodingUTF8, utf8, SBStringEncodingUTF8, SBStringEncodingUTF16,
+             {0, 1, 2, 3, 6, 10, 11, 20}, {0, 1, 1, 2, 3, 5, 6, 6});
+    convTest(SBStringEncodingUTF8, utf8, SBStringEncodingUTF8, SBStringEncodingUTF32,
+             {0, 1, 2, 3, 6, 10, 11, 20}, {0, 1, 1, 2, 3, 4, 5, 5});
+    convTest(SBStringEncodingUTF8, utf8, SBStringEncodingUTF16, SBStringEncodingUTF8,
+             {0, 1, 2, 3, 4, 5, 6}, {0, 1, 3, 6, 6, 10, 11});
+    convTest(SBStringEncodingUTF8, utf8, SBStringEncodingUTF8, SBStringEncodingUTF8,
+             {0, 2, 20}, {0, 2, 20});
+
+    /* Indexes out of order restart the walk. */
+    convTest(SBStringEncodingUTF8, utf8, SBStringEncodingUTF8, SBStringEncodingUTF16,
+             {10, 1, 6, 3}, {5, 1, 3, 2});
+
+    /* The index spaces do not depend on the encoding of the string. */
+    convTest(SBStringEncodingUTF16, utf16, SBStringEncodingUTF8, SBStringEncodingUTF16,
+             {0, 1, 2, 3, 6, 10, 11, 20}, {0, 1, 1, 2, 3, 5, 6, 6});
+    convTest(SBStringEncodingUTF16, utf16, SBStringEncodingUTF16, SBStringEncodingUTF32,
+             {0, 3, 4, 5, 6}, {0, 3, 3, 4, 5});
+    convTest(SBStringEncodingUTF32, utf32, SBStringEncodingUTF32, SBStringEncodingUTF8,
+             {0, 1, 2, 3, 4, 5}, {0, 1, 3, 6, 10, 11});
+
+    /* Malformed code units count as a replacement character in the other spaces. */
+    convTest(SBStringEncodingUTF16, vector<uint16_t>{ 'a', 0xD800, 'b' },
+             SBStringEncodingUTF16, SBStringEncodingUTF8, {0, 1, 2, 3}, {0, 1, 4, 5});
+    convTest(SBStringEncodingUTF8, vector<uint8_t>{ 'a', 0x80, 0xE2, 0x82, 'b' },
+             SBStringEncodingUTF8, SBStringEncodingUTF16, {0, 1, 2, 4, 5}, {0, 1, 2, 3, 4});
+}
+
 void CodepointSequenceTests::run()
 {
     testUTF8();
     testUTF16();
     testUTF32();
+    testParallelClassification();
+    testIndexConversion();
 }
 
 #ifdef STANDALONE_TESTING
@@ -29,6 +29,8 @@ private:
     void testUTF8();
     void testUTF16();
     void testUTF32();
+    void testParallelClassification();
+    void testIndexConversion();
 };
 
 }
@@ -14,25 +14,36 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <map>
+#include <random>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include <SheenBidi/SBAttributeList.h>
 #include <SheenBidi/SBAttributeRegistry.h>
 #include <SheenBidi/SBCodepointSequence.h>
+#include <SheenBidi/SBStatistics.h>
 #include <SheenBidi/SBText.h>
 #include <SheenBidi/SBTextConfig.h>
 
 extern "C" {
+#include <API/SBParagraph.h>
 #include <API/SBText.h>
 #include <Core/List.h>
 }
 
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#include <unistd.h>
+#endif
+
 #include "TextTests.h"
 
 using namespace std;
@@ -160,6 +171,9 @@ static void verifyAttributeRuns(SBTextRef text, SBAttributeScope scope,
 void TextTests::run() {
     testCreateImmutableText();
     testCreateEmptyMutableText();
+    testCreateWithBuffer();
+    testCreateWithMappedFile();
+    testSnapshots();
     testCreateCopyWithDifferentEncodings();
     testCreateImmutableCopy();
     testCreateMutableCopy();
@@ -172,16 +186,21 @@ void TextTests::run() {
     testGetBidiTypes();
     testGetScripts();
     testGetResolvedLevels();
+    testSpanAccessors();
     testGetCodeUnitParagraphInfo();
     testIterators();
     testEditingSession();
+    testBatchedEditing();
+    testIncrementalScripts();
     testEdgeCases();
     testInvalidOperations();
     testReferenceCounting();
     testDifferentBaseLevels();
     testComplexBidirectionalText();
     testParagraphScenarios();
+    testAttributeRegistry();
     testSetAttribute();
+    testApplyAttributeSpans();
     testRemoveAttribute();
     testAttributeEdgeCases();
     testAttributeComplexScenarios();
@@ -210,6 +229,386 @@ void TextTests::testCreateEmptyMutableText() {
     SBTextRelease(text);
 }
 
+void TextTests::testCreateWithBuffer() {
+    struct ReleaseRecord {
+        const void *buffer = nullptr;
+        SBUInteger length = 0;
+        int count = 0;
+    };
+
+    auto release = [](const void *buffer, SBUInteger length, void *info) {
+        auto record = static_cast<ReleaseRecord *>(info);
+        record->buffer = buffer;
+        record->length = length;
+        record->count += 1;
+    };
+
+    // The text refers to the buffer and analyzes it like a copied one
+    {
+        u16string content = u"Hello \u0627\u0644\u0639\u0631\u0628\u064A\u0629\nSecond (line)";
+        ReleaseRecord record;
+
+        auto text = SBTextCreateWithBuffer(content.data(), content.length(), SBStringEncodingUTF16,
+                                           DefaultTextConfig, release, &record);
+        assert(text != nullptr);
+        assert(static_cast<const void *>(text->codeUnits.data) == content.data());
+        assert(!text->isMutable);
+
+        auto expected = SBTextCreate(content.data(), content.length(), SBStringEncodingUTF16,
+                                     DefaultTextConfig);
+        auto length = content.length();
+
+        vector<SBLevel> levels(length), expectedLevels(length);
+        SBTextGetResolvedLevels(text, 0, length, levels.data());
+        SBTextGetResolvedLevels(expected, 0, length, expectedLevels.data());
+        assert(levels == expectedLevels);
+
+        vector<SBScript> scripts(length), expectedScripts(length);
+        SBTextGetScripts(text, 0, length, scripts.data());
+        SBTextGetScripts(expected, 0, length, expectedScripts.data());
+        assert(scripts == expectedScripts);
+
+        verifyParagraphRanges(text, {{0, 14}, {14, 13}});
+
+        // A copy owns its code units and outlives the buffer reference
+        auto copy = SBTextCreateMutableCopy(text);
+        assert(static_cast<const void *>(copy->codeUnits.data) != content.data());
+
+        SBTextRelease(expected);
+        SBTextRelease(text);
+
+        assert(record.count == 1);
+        assert(record.buffer == content.data());
+        assert(record.length == length);
+
+        SBTextAppendCodeUnits(copy, u"!", 1);
+        assert(SBTextGetLength(copy) == length + 1);
+        SBTextRelease(copy);
+    }
+
+    // An empty buffer is released with the text
+    {
+        ReleaseRecord record;
+
+        auto text = SBTextCreateWithBuffer(nullptr, 0, SBStringEncodingUTF8,
+                                           DefaultTextConfig, release, &record);
+        assert(text != nullptr);
+        assert(SBTextGetLength(text) == 0);
+
+        SBTextRelease(text);
+        assert(record.count == 1);
+    }
+}
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+static string writeTemporaryFile(const void *data, size_t size) {
+    auto directory = getenv("TMPDIR");
+    string pathTemplate = string(directory && *directory ? directory : "/tmp")
+                        + "/TextTests.XXXXXX";
+    vector<char> pathBuffer(pathTemplate.begin(), pathTemplate.end());
+    pathBuffer.push_back('\0');
+
+    auto descriptor = mkstemp(pathBuffer.data());
+    assert(descriptor != -1);
+
+    auto written = write(descriptor, data, size);
+    assert(written == static_cast<ssize_t>(size));
+    close(descriptor);
+
+    return string(pathBuffer.data());
+}
+#endif
+
+void TextTests::testCreateWithMappedFile() {
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+    string content = "First \xD8\xA7\xD9\x84\xD8\xB9\nSecond";
+    auto temporaryPath = writeTemporaryFile(content.data(), content.length());
+    auto path = temporaryPath.c_str();
+
+    auto text = SBTextCreateWithMappedFile(path, SBStringEncodingUTF8, DefaultTextConfig);
+    assert(text != nullptr);
+    assert(SBTextGetLength(text) == content.length());
+    verifyParagraphRanges(text, {{0, 13}, {13, 6}});
+
+    vector<char> codeUnits(content.length());
+    SBTextGetCodeUnits(text, 0, content.length(), codeUnits.data());
+    assert(string(codeUnits.begin(), codeUnits.end()) == content);
+
+    auto expected = SBTextCreate(content.data(), content.length(), SBStringEncodingUTF8,
+                                 DefaultTextConfig);
+    vector<SBLevel> levels(content.length()), expectedLevels(content.length());
+    SBTextGetResolvedLevels(text, 0, content.length(), levels.data());
+    SBTextGetResolvedLevels(expected, 0, content.length(), expectedLevels.data());
+    assert(levels == expectedLevels);
+
+    SBTextRelease(expected);
+    SBTextRelease(text);
+
+    // The size of the file must be a multiple of the code unit size
+    assert(SBTextCreateWithMappedFile(path, SBStringEncodingUTF32, DefaultTextConfig) == nullptr);
+
+    remove(path);
+
+    assert(SBTextCreateWithMappedFile(path, SBStringEncodingUTF8, DefaultTextConfig) == nullptr);
+#endif
+}
+
+static vector<uint8_t> writeSnapshot(SBTextRef text) {
+    auto size = SBTextWriteSnapshot(text, nullptr, 0);
+    vector<uint8_t> snapshot(size);
+
+    assert(size > 0);
+    assert(SBTextWriteSnapshot(text, snapshot.data(), size - 1) == size);
+    assert(SBTextWriteSnapshot(text, snapshot.data(), size) == size);
+
+    return snapshot;
+}
+
+static void verifySameAnalysis(SBTextRef text, SBTextRef expected) {
+    auto length = SBTextGetLength(expected);
+    assert(SBTextGetLength(text) == length);
+
+    vector<SBBidiType> bidiTypes(length), expectedBidiTypes(length);
+    SBTextGetBidiTypes(text, 0, length, bidiTypes.data());
+    SBTextGetBidiTypes(expected, 0, length, expectedBidiTypes.data());
+    assert(bidiTypes == expectedBidiTypes);
+
+    vector<SBScript> scripts(length), expectedScripts(length);
+    SBTextGetScripts(text, 0, length, scripts.data());
+    SBTextGetScripts(expected, 0, length, expectedScripts.data());
+    assert(scripts == expectedScripts);
+
+    vector<SBLevel> levels(length), expectedLevels(length);
+    SBTextGetResolvedLevels(text, 0, length, levels.data());
+    SBTextGetResolvedLevels(expected, 0, length, expectedLevels.data());
+    assert(levels == expectedLevels);
+
+    assert(text->paragraphs.count == expected->paragraphs.count);
+
+    for (size_t i = 0; i < expected->paragraphs.count; ++i) {
+        auto paragraph = ListGetRef(&text->paragraphs, i);
+        auto expectedParagraph = ListGetRef(&expected->paragraphs, i);
+
+        assert(paragraph->index == expectedParagraph->index);
+        assert(paragraph->length == expectedParagraph->length);
+        assert(SBParagraphGetBaseLevel(paragraph->bidiParagraph)
+               == SBParagraphGetBaseLevel(expectedParagraph->bidiParagraph));
+    }
+}
+
+void TextTests::testSnapshots() {
+    u16string content = u"Hello (\u05D0\u05D1\u05D2) world\n"
+                        u"\u0627\u0644\u0639\u0631\u0628\u064A\u0629 123 \u4E2D\u6587\r\n"
+                        u"\u202BEmbedded\u202C text";
+    auto length = content.length();
+    auto text = SBTextCreate(content.data(), length, SBStringEncodingUTF16, DefaultTextConfig);
+    auto snapshot = writeSnapshot(text);
+
+    // A text restored from the snapshot has the same analysis without running the algorithm
+    {
+        SBStatistics before;
+        SBStatistics after;
+
+        SBStatisticsGetSnapshot(&before);
+        auto restored = SBTextCreateWithSnapshot(content.data(), length, SBStringEncodingUTF16,
+                                                 DefaultTextConfig, snapshot.data(), snapshot.size());
+        SBStatisticsGetSnapshot(&after);
+
+        assert(restored != nullptr);
+        assert(after.codeUnitsClassified == before.codeUnitsClassified);
+        assert(after.paragraphsResolved == before.paragraphsResolved);
+        assert(after.codeUnitsScripted == before.codeUnitsScripted);
+        verifySameAnalysis(restored, text);
+
+        // Lines can be created from the restored paragraphs
+        auto visualIterator = SBTextCreateVisualRunIterator(restored, 0, length);
+        SBUInteger visualLength = 0;
+
+        while (SBVisualRunIteratorMoveNext(visualIterator)) {
+            visualLength += SBVisualRunIteratorGetCurrent(visualIterator)->length;
+        }
+        assert(visualLength == length);
+
+        SBVisualRunIteratorRelease(visualIterator);
+
+        // The restored text writes the same snapshot
+        assert(writeSnapshot(restored) == snapshot);
+
+        // Script anchors are restored, so that edits resume script resolution from them
+        size_t anchorCount = 0;
+
+        for (size_t i = 0; i < text->paragraphs.count; ++i) {
+            auto paragraph = ListGetRef(&restored->paragraphs, i);
+            auto original = ListGetRef(&text->paragraphs, i);
+
+            assert(paragraph->scriptAnchors.count == original->scriptAnchors.count);
+            for (size_t j = 0; j < original->scriptAnchors.count; ++j) {
+                assert(ListGetVal(&paragraph->scriptAnchors, j)
+                       == ListGetVal(&original->scriptAnchors, j));
+            }
+
+            anchorCount += original->scriptAnchors.count;
+        }
+        assert(anchorCount > 0);
+
+        // A mutable copy of the restored text remains editable
+        auto copy = SBTextCreateMutableCopy(restored);
+        SBTextInsertCodeUnits(copy, 3, u"(\u05D3)", 3);
+        SBTextDeleteCodeUnits(copy, 20, 4);
+
+        auto copyLength = SBTextGetLength(copy);
+        vector<char16_t> copyUnits(copyLength);
+        SBTextGetCodeUnits(copy, 0, copyLength, copyUnits.data());
+
+        auto expected = SBTextCreate(copyUnits.data(), copyLength, SBStringEncodingUTF16,
+                                     DefaultTextConfig);
+        verifySameAnalysis(copy, expected);
+
+        SBTextRelease(expected);
+        SBTextRelease(copy);
+        SBTextRelease(restored);
+    }
+
+    // The snapshot is rejected for different code units or settings
+    {
+        u16string changed = content;
+        changed[1] = u'a';
+
+        assert(SBTextCreateWithSnapshot(changed.data(), length, SBStringEncodingUTF16,
+                                        DefaultTextConfig, snapshot.data(), snapshot.size()) == nullptr);
+        assert(SBTextCreateWithSnapshot(content.data(), length - 1, SBStringEncodingUTF16,
+                                        DefaultTextConfig, snapshot.data(), snapshot.size()) == nullptr);
+        assert(SBTextCreateWithSnapshot(content.data(), length, SBStringEncodingUTF8,
+                                        DefaultTextConfig, snapshot.data(), snapshot.size()) == nullptr);
+
+        auto config = SBTextConfigCreate();
+        SBTextConfigSetBaseLevel(config, 1);
+        assert(SBTextCreateWithSnapshot(content.data(), length, SBStringEncodingUTF16,
+                                        config, snapshot.data(), snapshot.size()) == nullptr);
+        SBTextConfigRelease(config);
+    }
+
+    // A damaged snapshot is rejected
+    {
+        for (size_t size = 0; size < snapshot.size(); ++size) {
+            assert(SBTextCreateWithSnapshot(content.data(), length, SBStringEncodingUTF16,
+                                            DefaultTextConfig, snapshot.data(), size) == nullptr);
+        }
+
+        auto versioned = snapshot;
+        versioned[4] += 1;
+        assert(SBTextCreateWithSnapshot(content.data(), length, SBStringEncodingUTF16,
+                                        DefaultTextConfig, versioned.data(), versioned.size()) == nullptr);
+
+        // Any damaged byte is caught by the checksum of the payload or the header fields
+        mt19937 random(49);
+
+        for (int attempt = 0; attempt < 200; ++attempt) {
+            auto damaged = snapshot;
+            damaged[random() % damaged.size()] ^= static_cast<uint8_t>(1 + random() % 255);
+
+            assert(SBTextCreateWithSnapshot(content.data(), length, SBStringEncodingUTF16,
+                                            DefaultTextConfig, damaged.data(), damaged.size()) == nullptr);
+        }
+
+        auto readUInt64 = [&](size_t offset) {
+            uint64_t value;
+            memcpy(&value, &snapshot[offset], sizeof(value));
+            return static_cast<size_t>(value);
+        };
+
+        // Recomputes the checksum of a payload, so that its fields are validated on their own
+        const size_t headerSize = 46;
+        auto reseal = [&](vector<uint8_t> bytes) {
+            uint64_t hash = 0xCBF29CE484222325;
+            for (size_t i = headerSize; i < bytes.size(); ++i) {
+                hash ^= bytes[i];
+                hash *= 0x00000100000001B3;
+            }
+            memcpy(&bytes[headerSize - 8], &hash, sizeof(hash));
+            return bytes;
+        };
+        assert(reseal(snapshot) == snapshot);
+
+        // Skip the header, the bidi types, the paragraph count and the first paragraph
+        size_t bidiTypesOffset = headerSize;
+        size_t offset = headerSize + length + 8;
+        offset += 18 + readUInt64(offset + 8);
+        offset += 8 + readUInt64(offset) * 9;
+        offset += 8 + readUInt64(offset) * 8;
+
+        size_t secondLength = readUInt64(offset + 8);
+        size_t levelsOffset = offset + 18;
+        size_t scriptOffset = levelsOffset + secondLength + 8 + 8;
+        assert(snapshot[offset + 16] == 1);
+        assert(snapshot[levelsOffset] == 1);
+        assert(snapshot[scriptOffset] == SBScriptARAB);
+
+        // A changed level or bidi type which is valid in itself is rejected by the checksum
+        auto raised = snapshot;
+        raised[levelsOffset] = 3;
+        assert(SBTextCreateWithSnapshot(content.data(), length, SBStringEncodingUTF16,
+                                        DefaultTextConfig, raised.data(), raised.size()) == nullptr);
+
+        raised = reseal(raised);
+        auto accepted = SBTextCreateWithSnapshot(content.data(), length, SBStringEncodingUTF16,
+                                                 DefaultTextConfig, raised.data(), raised.size());
+        assert(accepted != nullptr);
+        SBTextRelease(accepted);
+
+        auto retyped = snapshot;
+        retyped[bidiTypesOffset] = (retyped[bidiTypesOffset] == SBBidiTypeL ? SBBidiTypeR : SBBidiTypeL);
+        assert(SBTextCreateWithSnapshot(content.data(), length, SBStringEncodingUTF16,
+                                        DefaultTextConfig, retyped.data(), retyped.size()) == nullptr);
+
+        // A level below the paragraph level is rejected
+        auto lowered = snapshot;
+        lowered[levelsOffset] = 0;
+        lowered = reseal(lowered);
+        assert(SBTextCreateWithSnapshot(content.data(), length, SBStringEncodingUTF16,
+                                        DefaultTextConfig, lowered.data(), lowered.size()) == nullptr);
+
+        // A script past the last known one is rejected
+        auto unknown = snapshot;
+        unknown[scriptOffset] = SBScriptTOLS + 1;
+        unknown = reseal(unknown);
+        assert(SBTextCreateWithSnapshot(content.data(), length, SBStringEncodingUTF16,
+                                        DefaultTextConfig, unknown.data(), unknown.size()) == nullptr);
+    }
+
+    // An empty text has a snapshot too
+    {
+        auto empty = SBTextCreate(u"", 0, SBStringEncodingUTF16, DefaultTextConfig);
+        auto emptySnapshot = writeSnapshot(empty);
+
+        auto restored = SBTextCreateWithSnapshot(u"", 0, SBStringEncodingUTF16, DefaultTextConfig,
+                                                 emptySnapshot.data(), emptySnapshot.size());
+        assert(restored != nullptr);
+        assert(SBTextGetLength(restored) == 0);
+
+        SBTextRelease(restored);
+        SBTextRelease(empty);
+    }
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+    // A snapshot file is mapped for restoring the text
+    {
+        auto temporaryPath = writeTemporaryFile(snapshot.data(), snapshot.size());
+        auto path = temporaryPath.c_str();
+
+        auto restored = SBTextCreateWithSnapshotFile(content.data(), length, SBStringEncodingUTF16,
+                                                     DefaultTextConfig, path);
+        assert(restored != nullptr);
+        verifySameAnalysis(restored, text);
+        SBTextRelease(restored);
+
+        remove(path);
+    }
+#endif
+
+    SBTextRelease(text);
+}
+
 void TextTests::testCreateCopyWithDifferentEncodings() {
     // Test UTF-8
     auto text8 = SBTextCreate("Test UTF-8", 10, SBStringEncodingUTF8, DefaultTextConfig);
@@ -253,6 +652,43 @@ void TextTests::testCreateImmutableCopy() {
     SBTextRelease(copy);
 }
 
+static void verifyFreshlyAnalyzed(SBTextRef text) {
+    auto length = SBTextGetLength(text);
+
+    vector<uint32_t> codeUnits(length);
+    SBTextGetCodeUnits(text, 0, length, codeUnits.data());
+
+    auto expected = SBTextCreate(codeUnits.data(), length, SBStringEncodingUTF32, DefaultTextConfig);
+
+    vector<SBBidiType> bidiTypes(length), expectedBidiTypes(length);
+    SBTextGetBidiTypes(text, 0, length, bidiTypes.data());
+    SBTextGetBidiTypes(expected, 0, length, expectedBidiTypes.data());
+    assert(bidiTypes == expectedBidiTypes);
+
+    vector<SBScript> scripts(length), expectedScripts(length);
+    SBTextGetScripts(text, 0, length, scripts.data());
+    SBTextGetScripts(expected, 0, length, expectedScripts.data());
+    assert(scripts == expectedScripts);
+
+    vector<SBLevel> levels(length), expectedLevels(length);
+    SBTextGetResolvedLevels(text, 0, length, levels.data());
+    SBTextGetResolvedLevels(expected, 0, length, expectedLevels.data());
+    assert(levels == expectedLevels);
+
+    assert(text->paragraphs.count == expected->paragraphs.count);
+
+    for (size_t i = 0; i < expected->paragraphs.count; ++i) {
+        auto paragraph = ListGetRef(&text->paragraphs, i);
+        auto expectedParagraph = ListGetRef(&expected->paragraphs, i);
+
+        assert(paragraph->index == expectedParagraph->index);
+        assert(paragraph->length == expectedParagraph->length);
+        assert(!paragraph->needsReanalysis);
+    }
+
+    SBTextRelease(expected);
+}
+
 void TextTests::testCreateMutableCopy() {
     auto content = "Original Text";
     auto original = SBTextCreate(content, 13, SBStringEncodingUTF8, DefaultTextConfig);
@@ -270,6 +706,64 @@ void TextTests::testCreateMutableCopy() {
 
     SBTextRelease(original);
     SBTextRelease(mutableCopy);
+
+    // An empty text can be copied too
+    auto empty = SBTextCreateMutable(SBStringEncodingUTF8, DefaultTextConfig);
+    auto emptyCopy = SBTextCreateMutableCopy(empty);
+    assert(emptyCopy != nullptr);
+    assert(SBTextGetLength(emptyCopy) == 0);
+
+    SBTextRelease(empty);
+    SBTextRelease(emptyCopy);
+
+    // A copy takes the resolved levels of the original over its own buffers without resolving them
+    {
+        u32string text = U"First \u05D0\u05D1 line\n\u0627\u0644\u0639 (second)\nThird 123";
+        auto source = SBTextCreate(text.data(), text.length(), SBStringEncodingUTF32,
+                                   DefaultTextConfig);
+        auto length = SBTextGetLength(source);
+
+#ifdef SB_CONFIG_ENABLE_STATISTICS
+        SBStatistics before;
+        SBStatistics after;
+
+        SBStatisticsGetSnapshot(&before);
+#endif
+
+        auto copy = SBTextCreateMutableCopy(source);
+        assert(copy != nullptr);
+
+#ifdef SB_CONFIG_ENABLE_STATISTICS
+        SBStatisticsGetSnapshot(&after);
+        assert(after.paragraphsResolved == before.paragraphsResolved);
+        assert(after.paragraphsReanalyzed == before.paragraphsReanalyzed);
+#endif
+
+        assert(copy->paragraphs.count == 3);
+
+        for (size_t i = 0; i < copy->paragraphs.count; ++i) {
+            auto paragraph = ListGetRef(&copy->paragraphs, i);
+            auto sourceParagraph = ListGetRef(&source->paragraphs, i);
+            auto bidiParagraph = paragraph->bidiParagraph;
+
+            assert(!paragraph->needsReanalysis);
+            assert(bidiParagraph != sourceParagraph->bidiParagraph);
+            assert(bidiParagraph->codepointSequence.stringBuffer == copy->codeUnits.data);
+            assert(bidiParagraph->refTypes == &copy->bidiTypes.items[paragraph->index]);
+        }
+
+        vector<SBLevel> levels(length), sourceLevels(length);
+        SBTextGetResolvedLevels(copy, 0, length, levels.data());
+        SBTextGetResolvedLevels(source, 0, length, sourceLevels.data());
+        assert(levels == sourceLevels);
+
+        // Releasing the original leaves the copy intact
+        SBTextRelease(source);
+        SBTextAppendCodeUnits(copy, U" end", 4);
+        verifyFreshlyAnalyzed(copy);
+
+        SBTextRelease(copy);
+    }
 }
 
 void TextTests::testGetCodeUnits() {
@@ -462,6 +956,88 @@ void TextTests::testGetResolvedLevels() {
     SBTextRelease(text);
 }
 
+void TextTests::testSpanAccessors() {
+    u32string content = U"Hello \u05D0\u05D1\u05D2\n\u0627\u0644\u0639 123\n\u4E2D\u6587 text";
+    auto length = content.length();
+    auto text = SBTextCreateMutable(SBStringEncodingUTF32, DefaultTextConfig);
+    SBTextAppendCodeUnits(text, content.data(), length);
+    verifyParagraphRanges(text, {{0, 10}, {10, 8}, {18, 7}});
+
+    vector<SBBidiType> types(length);
+    vector<SBScript> scripts(length);
+    vector<SBLevel> levels(length);
+    SBTextGetBidiTypes(text, 0, length, types.data());
+    SBTextGetScripts(text, 0, length, scripts.data());
+    SBTextGetResolvedLevels(text, 0, length, levels.data());
+
+    // Bidi types are viewed over the whole range at once
+    {
+        SBUInteger spanLength = 0;
+        auto span = SBTextGetBidiTypesSpan(text, 3, 20, &spanLength);
+        assert(spanLength == 20);
+        assert(span == &text->bidiTypes.items[3]);
+        assert(memcmp(span, &types[3], spanLength * sizeof(SBBidiType)) == 0);
+    }
+
+    // Scripts and levels are viewed paragraph by paragraph directly from their storage
+    {
+        const vector<pair<size_t, size_t>> expectedSpans = {{3, 7}, {10, 8}, {18, 5}};
+        SBUInteger index = 3;
+        SBUInteger remaining = 20;
+        size_t spanIndex = 0;
+
+        while (remaining > 0) {
+            const TextParagraph *paragraph = ListGetRef(&text->paragraphs, spanIndex);
+            SBParagraphRef bidiParagraph = paragraph->bidiParagraph;
+            SBUInteger scriptLength = 0;
+            SBUInteger levelLength = 0;
+            auto scriptSpan = SBTextGetScriptsSpan(text, index, remaining, &scriptLength);
+            auto levelSpan = SBTextGetResolvedLevelsSpan(text, index, remaining, &levelLength);
+
+            assert(index == expectedSpans[spanIndex].first);
+            assert(scriptLength == expectedSpans[spanIndex].second);
+            assert(levelLength == scriptLength);
+            assert(scriptSpan == &paragraph->scripts.items[index - paragraph->index]);
+            assert(levelSpan == SBParagraphGetLevelsPtr(bidiParagraph)
+                                + (index - SBParagraphGetOffset(bidiParagraph)));
+            assert(memcmp(scriptSpan, &scripts[index], scriptLength * sizeof(SBScript)) == 0);
+            assert(memcmp(levelSpan, &levels[index], levelLength * sizeof(SBLevel)) == 0);
+
+            index += scriptLength;
+            remaining -= scriptLength;
+            spanIndex += 1;
+        }
+        assert(spanIndex == expectedSpans.size());
+    }
+
+    // Copies of a range starting inside a paragraph continue through the following paragraphs
+    {
+        vector<SBScript> partialScripts(20);
+        vector<SBLevel> partialLevels(20);
+        SBTextGetScripts(text, 3, 20, partialScripts.data());
+        SBTextGetResolvedLevels(text, 3, 20, partialLevels.data());
+
+        assert(equal(partialScripts.begin(), partialScripts.end(), scripts.begin() + 3));
+        assert(equal(partialLevels.begin(), partialLevels.end(), levels.begin() + 3));
+    }
+
+    // Views reflect the analysis of the text after an edit
+    {
+        SBTextDeleteCodeUnits(text, 9, 1);
+        verifyParagraphRanges(text, {{0, 17}, {17, 7}});
+
+        SBUInteger spanLength = 0;
+        auto levelSpan = SBTextGetResolvedLevelsSpan(text, 0, length - 1, &spanLength);
+        vector<SBLevel> editedLevels(length - 1);
+        SBTextGetResolvedLevels(text, 0, length - 1, editedLevels.data());
+
+        assert(spanLength == 17);
+        assert(memcmp(levelSpan, editedLevels.data(), spanLength * sizeof(SBLevel)) == 0);
+    }
+
+    SBTextRelease(text);
+}
+
 void TextTests::testGetCodeUnitParagraphInfo() {
     auto content = "First paragraph.\nSecond paragraph.";
     auto text = SBTextCreate(content, 34, SBStringEncodingUTF8, DefaultTextConfig);
@@ -510,6 +1086,114 @@ void TextTests::testIterators() {
     SBAttributeRunIteratorRelease(attributeRunIterator);
 
     SBTextRelease(text);
+
+    // Runs reported in another index encoding match the converted code unit runs
+    {
+        string content = "abc \xD8\xA7\xD9\x84\xD8\xB9 (\xF0\x9F\x98\x80) 12\n"
+                         "\xD7\x90\xD7\x91 xyz \xC3\xA9\r\n"
+                         "\xD8\xA7 def \xF0\x90\x8C\xB0";
+        auto length = static_cast<SBUInteger>(content.length());
+        auto utf8Text = SBTextCreate(content.data(), length, SBStringEncodingUTF8, DefaultTextConfig);
+
+        SBCodepointSequence sequence;
+        sequence.stringEncoding = SBStringEncodingUTF8;
+        sequence.stringBuffer = content.data();
+        sequence.stringLength = length;
+
+        using Run = tuple<SBUInteger, SBUInteger, SBUInt32>;
+
+        auto logicalRuns = [&](SBUInteger index, SBUInteger count, SBStringEncoding encoding) {
+            auto iterator = SBTextCreateLogicalRunIterator(utf8Text);
+            auto current = SBLogicalRunIteratorGetCurrent(iterator);
+            vector<Run> runs;
+
+            // Setting up the encoding restarts an iteration in progress
+            SBLogicalRunIteratorReset(iterator, index, count);
+            assert(SBLogicalRunIteratorMoveNext(iterator));
+            SBLogicalRunIteratorSetupIndexEncoding(iterator, encoding);
+
+            while (SBLogicalRunIteratorMoveNext(iterator)) {
+                runs.emplace_back(current->index, current->length, current->level);
+            }
+
+            SBLogicalRunIteratorRelease(iterator);
+            return runs;
+        };
+        auto scriptRuns = [&](SBUInteger index, SBUInteger count, SBStringEncoding encoding) {
+            auto iterator = SBTextCreateScriptRunIterator(utf8Text);
+            auto current = SBScriptRunIteratorGetCurrent(iterator);
+            vector<Run> runs;
+
+            SBScriptRunIteratorReset(iterator, index, count);
+            assert(SBScriptRunIteratorMoveNext(iterator));
+            SBScriptRunIteratorSetupIndexEncoding(iterator, encoding);
+
+            while (SBScriptRunIteratorMoveNext(iterator)) {
+                runs.emplace_back(current->index, current->length, current->script);
+            }
+
+            SBScriptRunIteratorRelease(iterator);
+            return runs;
+        };
+        auto visualRuns = [&](SBUInteger index, SBUInteger count, SBStringEncoding encoding) {
+            auto iterator = SBTextCreateVisualRunIterator(utf8Text, index, count);
+            auto current = SBVisualRunIteratorGetCurrent(iterator);
+            vector<Run> runs;
+
+            assert(SBVisualRunIteratorMoveNext(iterator));
+            SBVisualRunIteratorSetupIndexEncoding(iterator, encoding);
+
+            while (SBVisualRunIteratorMoveNext(iterator)) {
+                runs.emplace_back(current->index, current->length, current->level);
+            }
+
+            SBVisualRunIteratorRelease(iterator);
+            return runs;
+        };
+        auto convertRuns = [&](vector<Run> runs, SBStringEncoding encoding) {
+            for (auto &run : runs) {
+                SBUInteger bounds[] = { get<0>(run), get<0>(run) + get<1>(run) };
+                SBCodepointSequenceConvertIndexes(&sequence, SBStringEncodingUTF8, encoding,
+                                                  bounds, 2);
+                get<0>(run) = bounds[0];
+                get<1>(run) = bounds[1] - bounds[0];
+            }
+            return runs;
+        };
+
+        // The whole text and a window starting and ending inside paragraphs
+        auto windowStart = static_cast<SBUInteger>(content.find('('));
+        auto windowEnd = static_cast<SBUInteger>(content.find(" def"));
+        const pair<SBUInteger, SBUInteger> windows[] = {
+            { 0, length }, { windowStart, windowEnd - windowStart }
+        };
+
+        for (auto &window : windows) {
+            for (auto encoding : { SBStringEncodingUTF16, SBStringEncodingUTF32 }) {
+                auto index = window.first;
+                auto count = window.second;
+
+                assert(logicalRuns(index, count, encoding)
+                       == convertRuns(logicalRuns(index, count, SBStringEncodingUTF8), encoding));
+                assert(scriptRuns(index, count, encoding)
+                       == convertRuns(scriptRuns(index, count, SBStringEncodingUTF8), encoding));
+                assert(visualRuns(index, count, encoding)
+                       == convertRuns(visualRuns(index, count, SBStringEncodingUTF8), encoding));
+            }
+        }
+
+        // Code point runs of the whole text cover it without gaps in logical order
+        auto runs = logicalRuns(0, length, SBStringEncodingUTF32);
+        SBUInteger expectedIndex = 0;
+
+        for (auto &run : runs) {
+            assert(get<0>(run) == expectedIndex);
+            expectedIndex += get<1>(run);
+        }
+        assert(expectedIndex == 32);
+
+        SBTextRelease(utf8Text);
+    }
 }
 
 void TextTests::testEditingSession() {
@@ -535,6 +1219,329 @@ void TextTests::testEditingSession() {
     SBTextRelease(text);
 }
 
+static vector<map<SBAttributeID, AttributeValue>> getCodeUnitAttributes(SBTextRef text,
+    SBAttributeScope scope) {
+    vector<map<SBAttributeID, AttributeValue>> attributes(SBTextGetLength(text));
+
+    auto iterator = SBTextCreateAttributeRunIterator(text);
+    auto current = SBAttributeRunIteratorGetCurrent(iterator);
+
+    SBAttributeRunIteratorSetupAttributeCollection(iterator, SBAttributeGroupNone, scope);
+
+    while (SBAttributeRunIteratorMoveNext(iterator)) {
+        auto itemCount = SBAttributeListGetCount(current->attributes);
+
+        for (SBUInteger attrIndex = 0; attrIndex < itemCount; attrIndex++) {
+            auto item = reinterpret_cast<const AttributeItem *>(
+                SBAttributeListGetItem(current->attributes, attrIndex));
+
+            for (SBUInteger i = 0; i < current->length; i++) {
+                attributes.at(current->index + i)[item->attributeID] = item->attributeValue;
+            }
+        }
+    }
+
+    SBAttributeRunIteratorRelease(iterator);
+
+    return attributes;
+}
+
+void TextTests::testBatchedEditing() {
+    const vector<u32string> pieces = {
+        U"abc", U" ", U"\n", U"\r", U"\r\n", U"\u0627\u0644\u0639", U"(", U")", U"\u05D0", U"12"
+    };
+
+    // Edits recorded in a session produce the same text and attributes as edits applied one by
+    // one, analyzed as if it was created from scratch
+    {
+        static const AttributeValue colors[] = { "red", "green", "blue" };
+        mt19937 random(46);
+
+        u32string initial = U"First line\nSecond \u0627\u0644 line\r\nThird\rFourth";
+        auto batched = SBTextCreateMutable(SBStringEncodingUTF32, DefaultTextConfig);
+        auto immediate = SBTextCreateMutable(SBStringEncodingUTF32, DefaultTextConfig);
+
+        SBTextAppendCodeUnits(batched, initial.data(), initial.length());
+        SBTextAppendCodeUnits(immediate, initial.data(), initial.length());
+
+        for (int session = 0; session < 20; ++session) {
+            auto textLength = SBTextGetLength(immediate);
+
+            if (textLength > 0) {
+                auto index = static_cast<SBUInteger>(random() % textLength);
+                auto count = static_cast<SBUInteger>(random() % (textLength - index)) + 1;
+                auto &color = colors[random() % 3];
+
+                SBTextSetAttribute(batched, index, count, AttributeID::Color, &color);
+                SBTextSetAttribute(immediate, index, count, AttributeID::Color, &color);
+            }
+
+            SBTextBeginEditing(batched);
+
+            for (int edit = 0; edit < 25; ++edit) {
+                auto length = SBTextGetLength(immediate);
+                auto index = static_cast<SBUInteger>(random() % (length + 1));
+                auto removal = static_cast<SBUInteger>(random() % 4);
+                auto &piece = pieces[random() % pieces.size()];
+
+                if (removal > length - index) {
+                    removal = length - index;
+                }
+
+                switch (random() % 3) {
+                case 0:
+                    SBTextInsertCodeUnits(batched, index, piece.data(), piece.length());
+                    SBTextInsertCodeUnits(immediate, index, piece.data(), piece.length());
+                    break;
+
+                case 1:
+                    SBTextDeleteCodeUnits(batched, index, removal);
+                    SBTextDeleteCodeUnits(immediate, index, removal);
+                    break;
+
+                default:
+                    SBTextReplaceCodeUnits(batched, index, removal, piece.data(), piece.length());
+                    SBTextReplaceCodeUnits(immediate, index, removal, piece.data(), piece.length());
+                    break;
+                }
+
+                assert(SBTextGetLength(batched) == SBTextGetLength(immediate));
+            }
+
+            SBTextEndEditing(batched);
+
+            auto length = SBTextGetLength(immediate);
+            vector<uint32_t> codeUnits(length), expectedCodeUnits(length);
+            SBTextGetCodeUnits(batched, 0, length, codeUnits.data());
+            SBTextGetCodeUnits(immediate, 0, length, expectedCodeUnits.data());
+            assert(codeUnits == expectedCodeUnits);
+
+            assert(getCodeUnitAttributes(batched, SBAttributeScopeCharacter)
+                   == getCodeUnitAttributes(immediate, SBAttributeScopeCharacter));
+
+            verifyFreshlyAnalyzed(batched);
+            verifyFreshlyAnalyzed(immediate);
+        }
+
+        SBTextRelease(batched);
+        SBTextRelease(immediate);
+    }
+
+    // Paragraphs untouched by the edits keep their analysis
+    {
+        u32string content = U"One\nTwo\nThree\nFour";
+        auto text = SBTextCreateMutable(SBStringEncodingUTF32, DefaultTextConfig);
+        SBTextAppendCodeUnits(text, content.data(), content.length());
+
+#ifdef SB_CONFIG_ENABLE_STATISTICS
+        SBStatistics before;
+        SBStatistics after;
+
+        SBStatisticsGetSnapshot(&before);
+#endif
+
+        SBTextBeginEditing(text);
+        SBTextInsertCodeUnits(text, 0, U"Zero ", 5);
+        SBTextReplaceCodeUnits(text, 9, 3, U"Line\n1", 6);
+        SBTextDeleteCodeUnits(text, 0, 1);
+        SBTextEndEditing(text);
+
+        verifyParagraphRanges(text, {{0, 8}, {8, 5}, {13, 2}, {15, 6}, {21, 4}});
+
+#ifdef SB_CONFIG_ENABLE_STATISTICS
+        SBStatisticsGetSnapshot(&after);
+        // Only the three edited paragraphs are resolved again
+        assert(after.paragraphsResolved - before.paragraphsResolved == 3);
+        assert(after.paragraphsReanalyzed - before.paragraphsReanalyzed == 3);
+#endif
+
+        // Runs of the moved paragraphs are reported at their new positions
+        auto logicalIterator = SBTextCreateLogicalRunIterator(text);
+        auto logicalRun = SBLogicalRunIteratorGetCurrent(logicalIterator);
+        SBUInteger logicalEnd = 0;
+
+        while (SBLogicalRunIteratorMoveNext(logicalIterator)) {
+            assert(logicalRun->index == logicalEnd);
+            logicalEnd += logicalRun->length;
+        }
+        assert(logicalEnd == 25);
+
+        SBLogicalRunIteratorRelease(logicalIterator);
+
+        auto visualIterator = SBTextCreateVisualRunIterator(text, 15, 10);
+        auto visualRun = SBVisualRunIteratorGetCurrent(visualIterator);
+
+        assert(SBVisualRunIteratorMoveNext(visualIterator));
+        assert(visualRun->index == 15);
+        assert(visualRun->length == 6);
+        assert(SBVisualRunIteratorMoveNext(visualIterator));
+        assert(visualRun->index == 21);
+        assert(visualRun->length == 4);
+        assert(!SBVisualRunIteratorMoveNext(visualIterator));
+
+        SBVisualRunIteratorRelease(visualIterator);
+
+        SBTextRelease(text);
+    }
+
+    // Inserted code units take the attributes of the preceding code unit even next to a deletion,
+    // while replacing ones take the attributes of the first replaced code unit
+    {
+        AttributeValue redColor("red");
+        AttributeValue blueColor("blue");
+
+        for (bool isReplaced : { false, true }) {
+            auto text = SBTextCreateMutable(SBStringEncodingUTF8, DefaultTextConfig);
+            SBTextAppendCodeUnits(text, "AB", 2);
+            SBTextSetAttribute(text, 0, 1, AttributeID::Color, &redColor);
+            SBTextSetAttribute(text, 1, 1, AttributeID::Color, &blueColor);
+
+            SBTextBeginEditing(text);
+            if (isReplaced) {
+                SBTextReplaceCodeUnits(text, 1, 1, "C", 1);
+            } else {
+                SBTextDeleteCodeUnits(text, 1, 1);
+                SBTextInsertCodeUnits(text, 1, "C", 1);
+            }
+            SBTextEndEditing(text);
+
+            if (isReplaced) {
+                verifyAttributeRuns(text, SBAttributeScopeCharacter, {
+                    {0, 1, {{AttributeID::Color, redColor}}},
+                    {1, 1, {{AttributeID::Color, blueColor}}}
+                });
+            } else {
+                verifyAttributeRuns(text, SBAttributeScopeCharacter, {
+                    {0, 2, {{AttributeID::Color, redColor}}}
+                });
+            }
+
+            SBTextRelease(text);
+        }
+    }
+
+    // Reading the text in a session applies the pending edits
+    {
+        auto text = SBTextCreateMutable(SBStringEncodingUTF8, DefaultTextConfig);
+        SBTextAppendCodeUnits(text, "Hello World", 11);
+
+        SBTextBeginEditing(text);
+        SBTextDeleteCodeUnits(text, 5, 6);
+        SBTextAppendCodeUnits(text, "\nThere", 6);
+        assert(SBTextGetLength(text) == 11);
+
+        char buffer[11];
+        SBTextGetCodeUnits(text, 0, 11, buffer);
+        assert(memcmp(buffer, "Hello\nThere", 11) == 0);
+
+        SBTextInsertCodeUnits(text, 0, "Oh ", 3);
+        SBTextEndEditing(text);
+
+        verifyParagraphRanges(text, {{0, 9}, {9, 5}});
+
+        SBTextRelease(text);
+    }
+}
+
+void TextTests::testIncrementalScripts() {
+    const vector<u32string> pieces = {
+        U"abc", U" ", U"12", U"(", U")", U"[", U"]", U"\u00AB", U"\u00BB", U"\u0301",
+        U"\u0627\u0644\u0639", U"\u05D0", U"\u4E2D\u6587", U"\u03B1\u03B2", U"\n"
+    };
+
+    // Scripts re-resolved around the edits match the ones resolved from scratch
+    {
+        mt19937 random(47);
+
+        u32string initial = U"Latin (\u0627\u0644\u0639 [\u4E2D] \u03B1) 12 \u05D0 end";
+        auto text = SBTextCreateMutable(SBStringEncodingUTF32, DefaultTextConfig);
+        SBTextAppendCodeUnits(text, initial.data(), initial.length());
+
+        for (int edit = 0; edit < 400; ++edit) {
+            auto length = SBTextGetLength(text);
+            auto index = static_cast<SBUInteger>(random() % (length + 1));
+            auto removal = static_cast<SBUInteger>(random() % 4);
+            auto &piece = pieces[random() % pieces.size()];
+
+            if (removal > length - index) {
+                removal = length - index;
+            }
+
+            switch (random() % 3) {
+            case 0:
+                SBTextInsertCodeUnits(text, index, piece.data(), piece.length());
+                break;
+
+            case 1:
+                SBTextDeleteCodeUnits(text, index, removal);
+                break;
+
+            default:
+                SBTextReplaceCodeUnits(text, index, removal, piece.data(), piece.length());
+                break;
+            }
+
+            verifyFreshlyAnalyzed(text);
+
+            // A copy keeps the anchors of the paragraphs
+            if (edit % 50 == 0) {
+                auto copy = SBTextCreateMutableCopy(text);
+                SBTextAppendCodeUnits(copy, U" \u0627", 2);
+                verifyFreshlyAnalyzed(copy);
+                SBTextRelease(copy);
+            }
+        }
+
+        SBTextRelease(text);
+    }
+
+    // Runs are resolved only up to the first unchanged boundary after the edit, whether it is
+    // applied immediately or at the end of an editing session
+    for (bool isBatched : { false, true }) {
+        u32string content = U"abc \u0627\u0644 def \u4E2D\u6587 ghi\nnext";
+        auto text = SBTextCreateMutable(SBStringEncodingUTF32, DefaultTextConfig);
+        SBTextAppendCodeUnits(text, content.data(), content.length());
+
+        auto paragraph = ListGetRef(&text->paragraphs, 0);
+        vector<SBUInteger> anchors(paragraph->scriptAnchors.items,
+                                   paragraph->scriptAnchors.items + paragraph->scriptAnchors.count);
+        assert((anchors == vector<SBUInteger>{4, 7, 11, 14}));
+
+        // Clear the scripts after the first run so that resolving them again would be noticed
+        vector<SBScript> scripts(paragraph->scripts.items,
+                                 paragraph->scripts.items + paragraph->scripts.count);
+        for (size_t i = 4; i < scripts.size(); ++i) {
+            ListSetVal(&paragraph->scripts, i, SBScriptNil);
+        }
+
+        if (isBatched) {
+            SBTextBeginEditing(text);
+            SBTextInsertCodeUnits(text, 1, U"xy", 2);
+            SBTextEndEditing(text);
+        } else {
+            SBTextInsertCodeUnits(text, 1, U"xy", 2);
+        }
+
+        paragraph = ListGetRef(&text->paragraphs, 0);
+        anchors.assign(paragraph->scriptAnchors.items,
+                       paragraph->scriptAnchors.items + paragraph->scriptAnchors.count);
+        assert((anchors == vector<SBUInteger>{6, 9, 13, 16}));
+
+        for (size_t i = 0; i < paragraph->scripts.count; ++i) {
+            if (i < 6) {
+                assert(ListGetVal(&paragraph->scripts, i) == SBScriptLATN);
+            } else {
+                assert(ListGetVal(&paragraph->scripts, i) == SBScriptNil);
+                ListSetVal(&paragraph->scripts, i, scripts[i - 2]);
+            }
+        }
+
+        verifyFreshlyAnalyzed(text);
+
+        SBTextRelease(text);
+    }
+}
+
 void TextTests::testEdgeCases() {
     // Test empty text
     auto emptyText = SBTextCreate("", 0, SBStringEncodingUTF8, DefaultTextConfig);
@@ -1147,6 +2154,61 @@ void TextTests::testParagraphScenarios() {
     }
 }
 
+void TextTests::testAttributeRegistry() {
+    const vector<SBAttributeInfo> infos = {
+        {"weight", 1, SBAttributeScopeCharacter},
+        {"alignment", 2, SBAttributeScopeParagraph},
+        {"color", 1, SBAttributeScopeCharacter}
+    };
+
+    // Names are found through the hash index of a sorted registry
+    {
+        auto registry = SBAttributeRegistryCreate(infos.data(), infos.size(),
+            sizeof(AttributeValue), nullptr);
+        SBAttributeInfo info;
+
+        for (const auto &expected : infos) {
+            auto attributeID = SBAttributeRegistryGetAttributeID(registry, expected.name);
+            assert(attributeID != SBAttributeIDNone);
+            assert(SBAttributeRegistryGetAttributeInfo(registry, attributeID, &info));
+            assert(string(info.name) == expected.name);
+            assert(info.scope == expected.scope);
+        }
+
+        assert(SBAttributeRegistryGetAttributeID(registry, "colour") == SBAttributeIDNone);
+        assert(SBAttributeRegistryGetAttributeID(registry, "") == SBAttributeIDNone);
+        assert(!SBAttributeRegistryGetAttributeInfo(registry, SBAttributeIDNone, &info));
+        assert(!SBAttributeRegistryGetAttributeInfo(registry,
+            SBAttributeIDMakeFixed(infos.size(), sizeof(AttributeValue)), &info));
+
+        SBAttributeRegistryRelease(registry);
+    }
+
+    // Fixed IDs follow the order of attribute infos
+    {
+        auto registry = SBAttributeRegistryCreateWithFixedIDs(infos.data(), infos.size(),
+            sizeof(AttributeValue), nullptr);
+
+        for (size_t index = 0; index < infos.size(); index++) {
+            auto attributeID = SBAttributeIDMakeFixed(index, sizeof(AttributeValue));
+            SBAttributeInfo info;
+
+            assert(SBAttributeRegistryGetAttributeID(registry, infos[index].name) == attributeID);
+            assert(SBAttributeRegistryGetAttributeInfo(registry, attributeID, &info));
+            assert(string(info.name) == infos[index].name);
+        }
+
+        SBAttributeRegistryRelease(registry);
+    }
+
+    // A registry without attributes finds nothing
+    {
+        auto registry = SBAttributeRegistryCreate(nullptr, 0, sizeof(AttributeValue), nullptr);
+        assert(SBAttributeRegistryGetAttributeID(registry, "color") == SBAttributeIDNone);
+        SBAttributeRegistryRelease(registry);
+    }
+}
+
 void TextTests::testSetAttribute() {
     // Test setting character-scoped attribute
     {
@@ -1259,6 +2321,54 @@ void TextTests::testSetAttribute() {
     }
 }
 
+void TextTests::testApplyAttributeSpans() {
+    auto text = SBTextCreateMutable(SBStringEncodingUTF8, DefaultTextConfig);
+    assert(text != nullptr);
+
+    auto content = "First paragraph.\nSecond paragraph.";
+    SBTextAppendCodeUnits(text, content, 34);
+
+    AttributeValue red("red");
+    AttributeValue blue("blue");
+    AttributeValue green("green");
+    AttributeValue yellow("yellow");
+    AttributeValue center("center");
+
+    // Existing attributes outside and inside the spans must be preserved
+    SBTextSetAttribute(text, 28, 6, AttributeID::Color, &yellow);
+
+    // Applying no spans should have no effect
+    SBTextApplyAttributeSpans(text, nullptr, 0);
+
+    const vector<SBAttributeSpan> spans = {
+        {0, 10, AttributeID::Color, &red},
+        {2, 3, AttributeID::Alignment, &center},
+        {5, 10, AttributeID::Color, &blue},
+        {20, 4, AttributeID::Color, &green},
+        {20, 2, AttributeID::Color, &red},
+        {26, 0, AttributeID::Color, &blue},
+        {30, 2, AttributeID::Color, &blue}
+    };
+    SBTextApplyAttributeSpans(text, spans.data(), spans.size());
+
+    // Later spans take precedence where they overlap
+    verifyAttributeRuns(text, SBAttributeScopeCharacter, {
+        {0, 5, {{AttributeID::Color, red}}},
+        {5, 10, {{AttributeID::Color, blue}}},
+        {20, 2, {{AttributeID::Color, red}}},
+        {22, 2, {{AttributeID::Color, green}}},
+        {28, 2, {{AttributeID::Color, yellow}}},
+        {30, 2, {{AttributeID::Color, blue}}},
+        {32, 2, {{AttributeID::Color, yellow}}}
+    });
+    // Paragraph-scoped spans cover whole paragraphs
+    verifyAttributeRuns(text, SBAttributeScopeParagraph, {
+        {0, 17, {{AttributeID::Alignment, center}}}
+    });
+
+    SBTextRelease(text);
+}
+
 void TextTests::testRemoveAttribute() {
     // Test removing character-scoped attribute
     {
@@ -28,6 +28,9 @@ public:
 private:
     void testCreateImmutableText();
     void testCreateEmptyMutableText();
+    void testCreateWithBuffer();
+    void testCreateWithMappedFile();
+    void testSnapshots();
     void testCreateCopyWithDifferentEncodings();
     void testCreateImmutableCopy();
     void testCreateMutableCopy();
@@ -40,16 +43,21 @@ private:
     void testGetBidiTypes();
     void testGetScripts();
     void testGetResolvedLevels();
+    void testSpanAccessors();
     void testGetCodeUnitParagraphInfo();
     void testIterators();
     void testEditingSession();
+    void testBatchedEditing();
+    void testIncrementalScripts();
     void testEdgeCases();
     void testInvalidOperations();
     void testReferenceCounting();
     void testDifferentBaseLevels();
     void testComplexBidirectionalText();
     void testParagraphScenarios();
+    void testAttributeRegistry();
     void testSetAttribute();
+    void testApplyAttributeSpans();
     void testRemoveAttribute();
     void testAttributeEdgeCases();
     void testAttributeComplexScenarios();
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2025 Muhammad Tayyab Akram
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <SheenBidi/SBAlgorithm.h>
+#include <SheenBidi/SBBase.h>
+#include <SheenBidi/SBCodepointSequence.h>
+#include <SheenBidi/SBConfig.h>
+#include <SheenBidi/SBLine.h>
+#include <SheenBidi/SBParagraph.h>
+#include <SheenBidi/SBTrace.h>
+
+#include "TraceTests.h"
+
+using namespace std;
+using namespace SheenBidi;
+
+namespace {
+
+struct TraceRecord {
+    bool isBegin;
+    SBTraceStage stage;
+    SBUInteger codeUnitCount;
+};
+
+struct TraceLog {
+    vector<TraceRecord> records;
+
+    SBTraceHandler handler() {
+        return {
+            [](const SBTraceEvent *event, void *info) {
+                auto log = static_cast<TraceLog *>(info);
+                log->records.push_back({ true, event->stage, event->codeUnitCount });
+            },
+            [](const SBTraceEvent *event, void *info) {
+                auto log = static_cast<TraceLog *>(info);
+                log->records.push_back({ false, event->stage, event->codeUnitCount });
+            },
+            this
+        };
+    }
+
+    // Returns the counts of the begin and end events of a stage, verifying that all events are
+    // paired and properly nested.
+    vector<pair<SBUInteger, SBUInteger>> stageRanges(SBTraceStage stage) const {
+        vector<pair<SBUInteger, SBUInteger>> ranges;
+        vector<size_t> openIndexes;
+
+        for (size_t i = 0; i < records.size(); i++) {
+            const auto &record = records[i];
+
+            if (record.isBegin) {
+                openIndexes.push_back(i);
+            } else {
+                assert(!openIndexes.empty());
+
+                const auto &begin = records[openIndexes.back()];
+                assert(begin.stage == record.stage);
+                openIndexes.pop_back();
+
+                if (record.stage == stage) {
+                    ranges.push_back({ begin.codeUnitCount, record.codeUnitCount });
+                }
+            }
+        }
+        assert(openIndexes.empty());
+
+        return ranges;
+    }
+};
+
+}
+
+void TraceTests::run() {
+#ifdef SB_CONFIG_DISABLE_TRACE
+    cout << "Tracing is disabled due to which the event test cases will be skipped." << endl;
+#endif
+
+    testHandlerRegistration();
+    testParagraphEvents();
+    testBoundaryEvents();
+    testInactiveHandler();
+}
+
+void TraceTests::testHandlerRegistration() {
+    TraceLog log;
+    SBTraceHandler handler = log.handler();
+
+    assert(SBTraceGetHandler() == nullptr);
+
+    SBTraceSetHandler(&handler);
+#ifndef SB_CONFIG_DISABLE_TRACE
+    assert(SBTraceGetHandler() == &handler);
+#else
+    assert(SBTraceGetHandler() == nullptr);
+#endif
+
+    SBTraceSetHandler(nullptr);
+    assert(SBTraceGetHandler() == nullptr);
+}
+
+void TraceTests::testParagraphEvents() {
+#ifndef SB_CONFIG_DISABLE_TRACE
+    // "abc (אבג) def\nxyz" in UTF-8
+    const char string[] = "abc (\xD7\x90\xD7\x91\xD7\x92) def\nxyz";
+    const SBUInteger stringLength = sizeof(string) - 1;
+    const SBUInteger paragraphLength = 17;
+
+    TraceLog log;
+    SBTraceHandler handler = log.handler();
+    SBCodepointSequence sequence = { SBStringEncodingUTF8, (void *)string, stringLength };
+
+    SBTraceSetHandler(&handler);
+
+    SBAlgorithmRef algorithm = SBAlgorithmCreate(&sequence);
+    SBParagraphRef paragraph = SBAlgorithmCreateParagraph(algorithm, 0, stringLength, SBLevelDefaultLTR);
+    SBLineRef line = SBParagraphCreateLine(paragraph, 0, paragraphLength);
+
+    SBTraceSetHandler(nullptr);
+
+    assert(SBParagraphGetLength(paragraph) == paragraphLength);
+
+    // The whole string should be classified at once
+    auto classification = log.stageRanges(SBTraceStageClassification);
+    assert(classification.size() == 1);
+    assert(classification[0] == make_pair(stringLength, stringLength));
+
+    // The boundary should begin with the suggested length and end with the actual one
+    auto boundary = log.stageRanges(SBTraceStageBoundary);
+    assert(boundary.size() == 1);
+    assert(boundary[0] == make_pair(stringLength, paragraphLength));
+
+    auto explicitLevels = log.stageRanges(SBTraceStageExplicitLevels);
+    assert(explicitLevels.size() == 1);
+    assert(explicitLevels[0] == make_pair(paragraphLength, paragraphLength));
+
+    // The isolating runs should together cover the whole paragraph
+    auto isolatingRuns = log.stageRanges(SBTraceStageIsolatingRun);
+    SBUInteger isolatingLength = 0;
+    assert(!isolatingRuns.empty());
+    for (const auto &range : isolatingRuns) {
+        assert(range.first == range.second);
+        isolatingLength += range.first;
+    }
+    assert(isolatingLength == paragraphLength);
+
+    auto levelReset = log.stageRanges(SBTraceStageLevelReset);
+    assert(levelReset.size() == 1);
+    assert(levelReset[0] == make_pair(paragraphLength, paragraphLength));
+
+    auto reordering = log.stageRanges(SBTraceStageReordering);
+    assert(reordering.size() == 1);
+    assert(reordering[0] == make_pair(paragraphLength, paragraphLength));
+
+    SBLineRelease(line);
+    SBParagraphRelease(paragraph);
+    SBAlgorithmRelease(algorithm);
+#endif
+}
+
+void TraceTests::testBoundaryEvents() {
+#ifndef SB_CONFIG_DISABLE_TRACE
+    const char string[] = "first\r\nsecond\nthird";
+    const SBUInteger stringLength = sizeof(string) - 1;
+
+    TraceLog log;
+    SBTraceHandler handler = log.handler();
+    SBCodepointSequence sequence = { SBStringEncodingUTF8, (void *)string, stringLength };
+
+    SBAlgorithmRef algorithm = SBAlgorithmCreate(&sequence);
+
+    SBTraceSetHandler(&handler);
+
+    // Each lookup should end with the length of the paragraph actually found
+    SBAlgorithmGetParagraphBoundary(algorithm, 0, stringLength, nullptr, nullptr);
+    SBAlgorithmGetParagraphBoundary(algorithm, 7, stringLength - 7, nullptr, nullptr);
+    SBAlgorithmGetParagraphBoundary(algorithm, 14, 3, nullptr, nullptr);
+
+    SBTraceSetHandler(nullptr);
+
+    auto boundary = log.stageRanges(SBTraceStageBoundary);
+    assert(boundary.size() == 3);
+    assert(boundary[0] == make_pair(stringLength, SBUInteger(7)));
+    assert(boundary[1] == make_pair(stringLength - 7, SBUInteger(7)));
+    assert(boundary[2] == make_pair(SBUInteger(3), SBUInteger(3)));
+    assert(log.records.size() == 6);
+
+    SBAlgorithmRelease(algorithm);
+#endif
+}
+
+void TraceTests::testInactiveHandler() {
+    const char string[] = "abc \xD7\x90\xD7\x91\xD7\x92";
+    const SBUInteger stringLength = sizeof(string) - 1;
+
+    TraceLog log;
+    SBTraceHandler handler = log.handler();
+    SBCodepointSequence sequence = { SBStringEncodingUTF8, (void *)string, stringLength };
+
+    // No events should be delivered to a handler that has been replaced
+    SBTraceSetHandler(&handler);
+    SBTraceSetHandler(nullptr);
+
+    SBAlgorithmRef algorithm = SBAlgorithmCreate(&sequence);
+    SBParagraphRef paragraph = SBAlgorithmCreateParagraph(algorithm, 0, stringLength, SBLevelDefaultLTR);
+    SBLineRef line = SBParagraphCreateLine(paragraph, 0, stringLength);
+
+    assert(log.records.empty());
+
+    SBLineRelease(line);
+    SBParagraphRelease(paragraph);
+    SBAlgorithmRelease(algorithm);
+}
+
+#ifdef STANDALONE_TESTING
+
+int main(int argc, const char *argv[]) {
+    TraceTests traceTests;
+    traceTests.run();
+
+    return 0;
+}
+
+#endif